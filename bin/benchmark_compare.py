@@ -0,0 +1,87 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# Andre Anjos <andre.anjos@idiap.ch>
+# Thu  4 Jul 10:12:31 2013 CEST
+
+"""Compares benchmark results to a stored baseline.
+
+Both arguments are either JSON files written by a benchmark program (with
+--json) or directories containing such files, as written by 'make
+benchmark_run'. Benchmarks are matched by suite, name and parameters, and
+their median times are compared. Benchmarks that got slower by more than the
+threshold are flagged and make this program exit with status 1.
+
+To store a baseline, copy the 'benchmark' directory of the build tree after
+running 'make benchmark_run' on the reference version.
+"""
+
+import os
+import sys
+import json
+import optparse
+
+def load(path):
+  """Returns a dictionary (suite, name, parameters) -> result"""
+
+  if os.path.isdir(path):
+    files = [os.path.join(path, k) for k in sorted(os.listdir(path)) \
+        if k.endswith('.json')]
+  else:
+    files = [path]
+
+  retval = {}
+  for f in files:
+    data = json.load(open(f, 'rt'))
+    for r in data['results']:
+      retval[(data['suite'], r['name'], r['parameters'])] = r
+  return retval
+
+def main():
+
+  parser = optparse.OptionParser(usage="%prog [options] BASELINE CURRENT",
+      description=__doc__.split('\n\n')[1].replace('\n', ' '))
+  parser.add_option('-t', '--threshold', type='float', default=0.1,
+      help="relative slowdown above which a benchmark is flagged [default: %default]")
+  parser.add_option('-m', '--metric', choices=('median', 'min', 'mean'),
+      default='median', help="which timing to compare [default: %default]")
+  parser.add_option('-a', '--all', action='store_true', default=False,
+      help="also print benchmarks that did not get slower")
+  options, args = parser.parse_args()
+
+  if len(args) != 2:
+    parser.error("needs a baseline and the current results")
+
+  baseline = load(args[0])
+  current = load(args[1])
+
+  slower = 0
+  for key in sorted(current):
+    if key not in baseline:
+      if options.all:
+        print("%-60s %10s %10s %8s" % ('/'.join(key), '-', '-', 'new'))
+      continue
+    before = baseline[key][options.metric]
+    after = current[key][options.metric]
+    ratio = after / before if before > 0 else 1.
+    flag = ''
+    if ratio > 1. + options.threshold:
+      flag = 'SLOWER'
+      slower += 1
+    elif ratio < 1. - options.threshold:
+      flag = 'faster'
+    if flag == 'SLOWER' or options.all:
+      print("%-60s %10.3g %10.3g %7.2fx %s" % ('/'.join(key), before, after,
+        ratio, flag))
+
+  missing = [k for k in baseline if k not in current]
+  if missing and options.all:
+    for key in sorted(missing):
+      print("%-60s %10s %10s %8s" % ('/'.join(key), '-', '-', 'missing'))
+
+  print("%d of %d benchmarks got slower by more than %d%%" % (slower,
+    len([k for k in current if k in baseline]), 100 * options.threshold))
+
+  return 1 if slower else 0
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -7,6 +7,10 @@
  * blitz array of a given type into a blitz array of an other type. Typically,
  * this can be used to rescale a 16 bit precision grayscale image (2d array)
  * into an 8 bit precision grayscale image.
+ *
+ * Contiguous arrays are converted by detail::convert(), which has SSE2
+ * versions for the conversions between uint8_t/uint16_t and float/double.
+ * Large arrays are converted on several threads.
  * @see bob::core::cast
  *
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
@@ -28,6 +32,8 @@
 #define BOB_CORE_ARRAY_CONVERT_H
 
 #include <limits>
+#include <cstddef>
+#include <stdint.h>
 #include <blitz/array.h>
 #include <bob/core/array_exception.h>
 #include <bob/core/assert.h>
@@ -38,6 +44,61 @@ namespace bob { namespace core { namespace array {
  * @{
  */
 
+namespace detail {
+
+/**
+ * @brief Converts the n contiguous elements of src into dst, using the given
+ * ranges, one element at a time.
+ */
+template<typename T, typename U>
+void convertScalar(const U* src, T* dst, size_t n,
+  T dst_min, T dst_max, U src_min, U src_max)
+{
+  double src_ratio = 1. / ( src_max - src_min);
+  T dst_diff = dst_max - dst_min;
+  for (size_t i=0; i<n; ++i) {
+    if (src[i] < src_min)
+      throw bob::core::array::ConvertInputBelowMinRange(src[i], src_min);
+    if (src[i] > src_max)
+      throw bob::core::array::ConvertInputAboveMaxRange(src[i], src_max);
+    // If the destination is an integer-like type, we need to add 0.5 s.t.
+    // the round done by the implicit conversion is correct
+    dst[i] = dst_min + (((src[i]-src_min)*src_ratio) * 
+      dst_diff + (std::numeric_limits<T>::is_integer?0.5:0));
+  }
+}
+
+/**
+ * @brief Converts the n contiguous elements of src into dst, using the given
+ * ranges. This is specialized below for the most frequent conversions.
+ */
+template<typename T, typename U>
+void convert(const U* src, T* dst, size_t n,
+  T dst_min, T dst_max, U src_min, U src_max)
+{
+  convertScalar(src, dst, n, dst_min, dst_max, src_min, src_max);
+}
+
+/**
+ * @brief Specializations of detail::convert() which use SSE2, if available,
+ * and several threads for large arrays. They give the same results as the
+ * scalar version.
+ */
+#define CONVERT_CONTIGUOUS_DECL(T, U) template<> \
+  void convert<T, U>(const U* src, T* dst, size_t n, \
+    T dst_min, T dst_max, U src_min, U src_max);
+
+CONVERT_CONTIGUOUS_DECL(float, uint8_t)
+CONVERT_CONTIGUOUS_DECL(double, uint8_t)
+CONVERT_CONTIGUOUS_DECL(float, uint16_t)
+CONVERT_CONTIGUOUS_DECL(double, uint16_t)
+CONVERT_CONTIGUOUS_DECL(uint8_t, float)
+CONVERT_CONTIGUOUS_DECL(uint8_t, double)
+CONVERT_CONTIGUOUS_DECL(uint16_t, float)
+CONVERT_CONTIGUOUS_DECL(uint16_t, double)
+
+}
+
 /**
  * @brief Function which converts a 1D blitz::array of a given type into
  * a 1D blitz::array of an other type, using the given ranges.
@@ -50,6 +111,11 @@ blitz::Array<T,1> convert(const blitz::Array<U,1>& src,
   blitz::Array<T,1> dst( src.extent(0) );
   if (src_min == src_max)
     throw bob::core::array::ConvertZeroInputRange();
+  if (bob::core::array::isCContiguous(src)) {
+    detail::convert(src.data(), dst.data(), src.numElements(),
+      dst_min, dst_max, src_min, src_max);
+    return dst;
+  }
   double src_ratio = 1. / ( src_max - src_min);
   T dst_diff = dst_max - dst_min;
   for (int i=0; i<src.extent(0); ++i) {
@@ -77,6 +143,11 @@ blitz::Array<T,2> convert(const blitz::Array<U,2>& src,
   blitz::Array<T,2> dst( src.extent(0), src.extent(1) );
   if (src_min == src_max)
     throw bob::core::array::ConvertZeroInputRange();
+  if (bob::core::array::isCContiguous(src)) {
+    detail::convert(src.data(), dst.data(), src.numElements(),
+      dst_min, dst_max, src_min, src_max);
+    return dst;
+  }
   double src_ratio = 1. / ( src_max - src_min);
   T dst_diff = dst_max - dst_min;
   for (int i=0; i<src.extent(0); ++i) 
@@ -105,6 +176,11 @@ blitz::Array<T,3> convert(const blitz::Array<U,3>& src,
   blitz::Array<T,3> dst( src.extent(0), src.extent(1), src.extent(2) );
   if (src_min == src_max)
     throw bob::core::array::ConvertZeroInputRange();
+  if (bob::core::array::isCContiguous(src)) {
+    detail::convert(src.data(), dst.data(), src.numElements(),
+      dst_min, dst_max, src_min, src_max);
+    return dst;
+  }
   double src_ratio = 1. / ( src_max - src_min);
   T dst_diff = dst_max - dst_min;
   for (int i=0; i<src.extent(0); ++i)
@@ -135,6 +211,11 @@ blitz::Array<T,4> convert(const blitz::Array<U,4>& src,
     src.extent(3) );
   if (src_min == src_max)
     throw bob::core::array::ConvertZeroInputRange();
+  if (bob::core::array::isCContiguous(src)) {
+    detail::convert(src.data(), dst.data(), src.numElements(),
+      dst_min, dst_max, src_min, src_max);
+    return dst;
+  }
   double src_ratio = 1. / ( src_max - src_min);
   T dst_diff = dst_max - dst_min;
   for (int i=0; i<src.extent(0); ++i)
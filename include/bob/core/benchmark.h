@@ -0,0 +1,259 @@
+/**
+ * @file bob/core/benchmark.h
+ * @date 2013-07-04
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief A minimal harness for the benchmark programs, built with the
+ * 'benchmark' target.
+ *
+ * Each program creates a Suite from its command line and runs named,
+ * parameterized benchmarks on it. Every benchmark is called once to warm up
+ * and then repeatedly, until enough time was spent measuring it. Results are
+ * printed as a table and, with --json, written as a JSON file that
+ * bin/benchmark_compare.py can compare against a stored baseline.
+ *
+ * Command line options understood by all benchmark programs:
+ *
+ *   --json FILE        write the results as JSON to FILE ('-' for stdout)
+ *   --filter TEXT      only run benchmarks whose 'name/parameters' contain TEXT
+ *   --repetitions N    measure exactly N calls of each benchmark
+ *   --min-time S       measure each benchmark for at least S seconds
+ *   --quick            skip the largest problem sizes
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_CORE_BENCHMARK_H
+#define BOB_CORE_BENCHMARK_H
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <boost/lexical_cast.hpp>
+
+#include <bob/core/instrument.h>
+
+namespace bob { namespace core { namespace benchmark {
+  /**
+   * @ingroup CORE
+   * @{
+   */
+
+  /**
+   * @brief The timings of one benchmark, in seconds per call
+   */
+  struct Result {
+    std::string name;
+    std::string parameters; ///< e.g. "n=256", may be empty
+    size_t repetitions; ///< number of measured calls
+    double min;
+    double median;
+    double mean;
+  };
+
+  /**
+   * @brief A set of benchmarks run by one program
+   */
+  class Suite {
+
+    public:
+
+      /**
+       * @brief Creates a suite, parsing the benchmark options from the
+       * command line. Prints the usage and exits on invalid options.
+       */
+      Suite(const std::string& name, int argc, char** argv):
+        m_name(name),
+        m_repetitions(0),
+        m_min_time(0.5),
+        m_quick(false)
+      {
+        for (int i=1; i<argc; ++i) {
+          std::string arg(argv[i]);
+          bool has_value = (i+1 < argc);
+          try {
+            if (arg == "--json" && has_value) m_json = argv[++i];
+            else if (arg == "--filter" && has_value) m_filter = argv[++i];
+            else if (arg == "--repetitions" && has_value)
+              m_repetitions = boost::lexical_cast<size_t>(argv[++i]);
+            else if (arg == "--min-time" && has_value)
+              m_min_time = boost::lexical_cast<double>(argv[++i]);
+            else if (arg == "--quick") m_quick = true;
+            else usage(argv[0], arg);
+          }
+          catch (boost::bad_lexical_cast&) {
+            usage(argv[0], arg);
+          }
+        }
+
+        table() << std::left << std::setw(28) << "benchmark"
+          << std::setw(28) << "parameters" << std::right
+          << std::setw(8) << "calls" << std::setw(14) << "median [s]"
+          << std::setw(14) << "min [s]" << std::endl;
+      }
+
+      /**
+       * @brief Tells if the largest problem sizes should be skipped
+       */
+      bool quick() const { return m_quick; }
+
+      /**
+       * @brief Tells if the benchmark would be run, given the filter. Use it
+       * to skip the preparation of benchmarks that would not run.
+       */
+      bool selected(const std::string& name,
+          const std::string& parameters="") const {
+        return (name + "/" + parameters).find(m_filter) != std::string::npos;
+      }
+
+      /**
+       * @brief Measures the given functor, which is called without arguments
+       */
+      template <typename F>
+      void run(const std::string& name, const std::string& parameters, F f) {
+        if (!selected(name, parameters)) return;
+
+        const uint64_t min_time = static_cast<uint64_t>(m_min_time * 1e9);
+        std::vector<uint64_t> samples;
+        uint64_t spent = 0;
+
+        //warm-up call, kept as a sample if it is already long enough
+        uint64_t start = bob::core::instrument::now();
+        f();
+        uint64_t duration = bob::core::instrument::now() - start;
+        if (!m_repetitions && duration >= min_time) {
+          samples.push_back(duration);
+          spent = duration;
+        }
+
+        while (!enough(samples.size(), spent, min_time)) {
+          start = bob::core::instrument::now();
+          f();
+          duration = bob::core::instrument::now() - start;
+          samples.push_back(duration);
+          spent += duration;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        Result r;
+        r.name = name;
+        r.parameters = parameters;
+        r.repetitions = samples.size();
+        r.min = 1e-9 * samples.front();
+        r.median = 1e-9 * samples[samples.size()/2];
+        r.mean = 1e-9 * spent / samples.size();
+        m_results.push_back(r);
+
+        table() << std::left << std::setw(28) << r.name
+          << std::setw(28) << r.parameters << std::right
+          << std::setw(8) << r.repetitions << std::setw(14) << r.median
+          << std::setw(14) << r.min << std::endl;
+      }
+
+      /**
+       * @brief Writes the JSON output, if requested. Returns the exit status
+       * of the program.
+       */
+      int finish() const {
+        if (m_json.empty()) return EXIT_SUCCESS;
+        if (m_json == "-") {
+          write_json(std::cout);
+          return EXIT_SUCCESS;
+        }
+        std::ofstream os(m_json.c_str());
+        write_json(os);
+        if (!os) {
+          std::cerr << "could not write benchmark results to `" << m_json
+            << "'" << std::endl;
+          return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+      }
+
+      /**
+       * @brief The results measured so far
+       */
+      const std::vector<Result>& results() const { return m_results; }
+
+    private: //methods
+
+      /**
+       * Tells if enough calls were measured: at least 3 and m_min_time, but
+       * a single call may suffice if it takes much longer than that
+       */
+      bool enough(size_t calls, uint64_t spent, uint64_t min_time) const {
+        if (m_repetitions) return calls >= m_repetitions;
+        if (spent < min_time) return false;
+        return calls >= 3 || spent >= 10 * min_time;
+      }
+
+      /**
+       * The results table goes to stderr if the JSON goes to stdout
+       */
+      std::ostream& table() const {
+        return (m_json == "-") ? std::cerr : std::cout;
+      }
+
+      void usage(const char* program, const std::string& arg) const {
+        std::cerr << "invalid option `" << arg << "'" << std::endl
+          << "usage: " << program << " [--json FILE] [--filter TEXT]"
+          << " [--repetitions N] [--min-time SECONDS] [--quick]" << std::endl;
+        std::exit(EXIT_FAILURE);
+      }
+
+      void write_json(std::ostream& os) const {
+        os << std::setprecision(9);
+        os << "{\"suite\": \"" << m_name << "\", \"results\": [";
+        for (size_t k=0; k<m_results.size(); ++k) {
+          const Result& r = m_results[k];
+          os << (k ? ",\n" : "\n") << "{\"name\": \"" << r.name
+            << "\", \"parameters\": \"" << r.parameters
+            << "\", \"repetitions\": " << r.repetitions
+            << ", \"min\": " << r.min << ", \"median\": " << r.median
+            << ", \"mean\": " << r.mean << "}";
+        }
+        os << "\n]}" << std::endl;
+      }
+
+    private: //representation
+
+      std::string m_name;
+      std::string m_json; ///< where to write the results, if not empty
+      std::string m_filter;
+      size_t m_repetitions; ///< 0: as many as fit in m_min_time
+      double m_min_time; ///< in seconds
+      bool m_quick;
+      std::vector<Result> m_results;
+
+  };
+
+  /**
+   * @brief Formats a benchmark parameter, as in param("n", 256) == "n=256"
+   */
+  template <typename T>
+  std::string param(const std::string& name, const T& value) {
+    return name + "=" + boost::lexical_cast<std::string>(value);
+  }
+
+  /**
+   * @}
+   */
+}}}
+
+#endif /* BOB_CORE_BENCHMARK_H */
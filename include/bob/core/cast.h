@@ -27,7 +27,9 @@
 #include <bob/core/assert.h>
 #include <blitz/array.h>
 #include <stdint.h>
+#include <cstddef>
 #include <complex>
+#include <limits>
 
 namespace bob { namespace core {
 /**
@@ -85,6 +87,49 @@ COMPLEX_TO_COMPLEX_FULL_DECL(std::complex<float>)
 COMPLEX_TO_COMPLEX_FULL_DECL(std::complex<double>)
 COMPLEX_TO_COMPLEX_FULL_DECL(std::complex<long double>)
 
+namespace detail {
+
+/**
+ * @brief Casts a floating-point value to an integer type, saturating the
+ * values beyond its range. NaNs become 0.
+ */
+template<typename T, typename U>
+inline T saturate(const U& in) {
+  if (in != in) return 0;
+  if (in <= static_cast<U>(std::numeric_limits<T>::min()))
+    return std::numeric_limits<T>::min();
+  if (in >= static_cast<U>(std::numeric_limits<T>::max()))
+    return std::numeric_limits<T>::max();
+  return static_cast<T>(in);
+}
+
+}
+
+/**
+ * @brief Specializations of the cast function from floating-point to
+ * integer types, for which static_cast is undefined out of range: values
+ * are saturated instead, and NaNs become 0.
+ */
+#define FLOAT_TO_INTEGER(FLOAT, INT) template<> \
+  inline INT cast<INT, FLOAT>( const FLOAT& in) \
+  { \
+    return detail::saturate<INT>(in); \
+  }
+
+#define FLOAT_TO_INTEGER_FULL(FLOAT) \
+  FLOAT_TO_INTEGER(FLOAT, int8_t) \
+  FLOAT_TO_INTEGER(FLOAT, int16_t) \
+  FLOAT_TO_INTEGER(FLOAT, int32_t) \
+  FLOAT_TO_INTEGER(FLOAT, int64_t) \
+  FLOAT_TO_INTEGER(FLOAT, uint8_t) \
+  FLOAT_TO_INTEGER(FLOAT, uint16_t) \
+  FLOAT_TO_INTEGER(FLOAT, uint32_t) \
+  FLOAT_TO_INTEGER(FLOAT, uint64_t)
+
+FLOAT_TO_INTEGER_FULL(float)
+FLOAT_TO_INTEGER_FULL(double)
+FLOAT_TO_INTEGER_FULL(long double)
+
 /**
  * @}
  */
@@ -95,10 +140,46 @@ namespace array {
  * @ingroup CORE_ARRAY
  * @{
  */
+
+namespace detail {
+
+/**
+ * @brief Casts the n contiguous elements of in into out. This is the scalar
+ * version, which is specialized below for the most frequent casts.
+ */
+template<typename T, typename U>
+void cast(const U* in, T* out, size_t n) {
+  for( size_t i=0; i<n; ++i)
+    out[i] = bob::core::cast<T>( in[i]);
+}
+
+/**
+ * @brief Specializations of detail::cast() which use SSE2, if available,
+ * and several threads for large arrays. As with the scalar cast, values
+ * beyond the range of an integer destination type are saturated, and NaNs
+ * become 0.
+ */
+#define CAST_CONTIGUOUS_DECL(T, U) template<> \
+  void cast<T, U>(const U* in, T* out, size_t n);
+
+CAST_CONTIGUOUS_DECL(float, uint8_t)
+CAST_CONTIGUOUS_DECL(double, uint8_t)
+CAST_CONTIGUOUS_DECL(float, uint16_t)
+CAST_CONTIGUOUS_DECL(double, uint16_t)
+CAST_CONTIGUOUS_DECL(uint8_t, float)
+CAST_CONTIGUOUS_DECL(uint8_t, double)
+CAST_CONTIGUOUS_DECL(uint16_t, float)
+CAST_CONTIGUOUS_DECL(uint16_t, double)
+
+}
 template<typename T, typename U> 
 blitz::Array<T,1> cast(const blitz::Array<U,1>& in) {
   bob::core::array::assertZeroBase(in);
   blitz::Array<T,1> out(in.extent(0));
+  if (bob::core::array::isCContiguous(in)) {
+    detail::cast(in.data(), out.data(), in.numElements());
+    return out;
+  }
   for( int i=0; i<in.extent(0); ++i)
     out(i) = bob::core::cast<T>( in(i));
   return out;
@@ -108,6 +189,10 @@ template<typename T, typename U>
 blitz::Array<T,2> cast(const blitz::Array<U,2>& in) {
   bob::core::array::assertZeroBase(in);
   blitz::Array<T,2> out(in.extent(0),in.extent(1));
+  if (bob::core::array::isCContiguous(in)) {
+    detail::cast(in.data(), out.data(), in.numElements());
+    return out;
+  }
   for( int i=0; i<in.extent(0); ++i)
     for( int j=0; j<in.extent(1); ++j)
       out(i,j) = bob::core::cast<T>( in(i,j) );
@@ -118,6 +203,10 @@ template<typename T, typename U>
 blitz::Array<T,3> cast(const blitz::Array<U,3>& in) {
   bob::core::array::assertZeroBase(in);
   blitz::Array<T,3> out(in.extent(0),in.extent(1),in.extent(2));
+  if (bob::core::array::isCContiguous(in)) {
+    detail::cast(in.data(), out.data(), in.numElements());
+    return out;
+  }
   for( int i=0; i<in.extent(0); ++i)
     for( int j=0; j<in.extent(1); ++j)
       for( int k=0; k<in.extent(2); ++k)
@@ -129,6 +218,10 @@ template<typename T, typename U>
 blitz::Array<T,4> cast(const blitz::Array<U,4>& in) {
   bob::core::array::assertZeroBase(in);
   blitz::Array<T,4> out(in.extent(0),in.extent(1),in.extent(2),in.extent(3));
+  if (bob::core::array::isCContiguous(in)) {
+    detail::cast(in.data(), out.data(), in.numElements());
+    return out;
+  }
   for( int i=0; i<in.extent(0); ++i)
     for( int j=0; j<in.extent(1); ++j)
       for( int k=0; k<in.extent(2); ++k)
@@ -0,0 +1,251 @@
+/**
+ * @file bob/core/instrument.h
+ * @date 2013-07-02
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Low-overhead counters and timers that can stay in production code.
+ *
+ * Probes are declared where they are used, through the macros at the end of
+ * this file, and registered by name the first time the code reaches them.
+ * Each thread accumulates into its own slots, which are only summed when the
+ * statistics are read. When a thread exits, its slots are added to those of
+ * the threads that exited before it and freed. While instrumentation is
+ * disabled (the default), a probe costs a single flag check. If Bob is
+ * configured with WITH_INSTRUMENTATION=OFF, the macros expand to nothing.
+ *
+ * Instrumentation is enabled at run time with enable(), or by setting the
+ * environment variable BOB_INSTRUMENT. If that variable contains a file
+ * name, a Chrome trace (chrome://tracing) is recorded and written to that
+ * file when the program exits.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_CORE_INSTRUMENT_H
+#define BOB_CORE_INSTRUMENT_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <atomic>
+#include <stdint.h>
+#include <boost/preprocessor/cat.hpp>
+#include <bob/config.h>
+
+namespace bob { namespace core { namespace instrument {
+  /**
+   * @ingroup CORE
+   * @{
+   */
+
+  /**
+   * @brief The maximum number of distinct probes in a program
+   */
+  static const size_t MAX_PROBES = 512;
+
+  /**
+   * @brief What a probe measures
+   */
+  typedef enum ProbeType {
+    Counter = 0, ///< sums the amounts it is given
+    Timer ///< sums the time spent in scopes, in nanoseconds
+  } ProbeType;
+
+  namespace detail {
+    extern std::atomic<bool> enabled; ///< are probes recording?
+    extern std::atomic<bool> tracing; ///< do timers record trace events?
+  }
+
+  /**
+   * @brief Tells if probes are currently recording
+   */
+  inline bool enabled() {
+    return detail::enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Starts or stops recording on all probes
+   */
+  void enable(bool on=true);
+
+  /**
+   * @brief Tells if timers currently record trace events
+   */
+  inline bool tracing() {
+    return detail::tracing.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Starts or stops recording trace events on timers. Starting a
+   * trace also enables instrumentation.
+   */
+  void trace(bool on=true);
+
+  /**
+   * @brief Monotonic time, in nanoseconds
+   */
+  uint64_t now();
+
+  /**
+   * @brief A named counter or timer. Probes with the same name share their
+   * statistics, so the same quantity can be counted in several places.
+   */
+  class Probe {
+
+    public:
+
+      /**
+       * @brief Registers a probe, or finds the one with the same name.
+       * Throws std::invalid_argument if the name is registered with another
+       * type, or std::length_error if there are already MAX_PROBES probes.
+       */
+      Probe(const std::string& name, ProbeType type=Counter);
+
+      /**
+       * @brief Adds an amount (or a time, for timers) to this probe, for
+       * the current thread
+       */
+      void add(uint64_t amount=1) const;
+
+      /**
+       * @brief Adds the amount if instrumentation is enabled
+       */
+      inline void operator()(uint64_t amount=1) const {
+        if (enabled()) add(amount);
+      }
+
+      /**
+       * @brief The name of this probe
+       */
+      const std::string& name() const;
+
+      /**
+       * @brief The index of this probe in the registry
+       */
+      inline size_t id() const { return m_id; }
+
+      /**
+       * @brief How many times add() was called, summed over all threads
+       */
+      uint64_t calls() const;
+
+      /**
+       * @brief The sum of all amounts, over all threads
+       */
+      uint64_t total() const;
+
+    private: //representation
+
+      size_t m_id; ///< where our slots are
+
+  };
+
+  /**
+   * @brief Times the scope it lives in, on a Timer probe. If tracing, also
+   * records a trace event for the scope.
+   */
+  class ScopedTimer {
+
+    public:
+
+      /**
+       * @brief Starts timing, if instrumentation is enabled
+       */
+      explicit ScopedTimer(const Probe& probe):
+        m_probe(probe),
+        m_start(enabled() ? now() : 0) {
+      }
+
+      /**
+       * @brief Adds the time spent since construction to the probe
+       */
+      ~ScopedTimer() { if (m_start) stop(); }
+
+    private: //methods
+
+      void stop();
+
+    private: //representation
+
+      const Probe& m_probe;
+      uint64_t m_start; ///< 0 if not timing
+
+  };
+
+  /**
+   * @brief The statistics of one probe
+   */
+  struct Statistics {
+    std::string name;
+    ProbeType type;
+    uint64_t calls; ///< number of times the probe was hit
+    uint64_t total; ///< sum of the amounts, in nanoseconds for timers
+    size_t threads; ///< number of threads that hit the probe
+  };
+
+  /**
+   * @brief Returns the statistics of all probes, in registration order
+   */
+  std::vector<Statistics> statistics();
+
+  /**
+   * @brief Zeroes all probes and discards recorded trace events
+   */
+  void reset();
+
+  /**
+   * @brief Writes the statistics of all probes as a JSON object
+   */
+  void write_json(std::ostream& os);
+
+  /**
+   * @brief Writes the recorded trace events and the final value of counters
+   * in the Chrome trace event format (JSON), which can be loaded in
+   * chrome://tracing
+   */
+  void write_trace(std::ostream& os);
+
+  /**
+   * @}
+   */
+}}}
+
+#if WITH_INSTRUMENTATION
+
+/**
+ * @brief Adds an amount to the counter with the given name. The amount is
+ * only evaluated if instrumentation is enabled.
+ */
+#define BOB_COUNT(name, amount) do { \
+  static const bob::core::instrument::Probe bob_probe(name); \
+  if (bob::core::instrument::enabled()) bob_probe.add(amount); \
+} while (0)
+
+/**
+ * @brief Times the rest of the current scope on the timer with the given
+ * name
+ */
+#define BOB_TIME_SCOPE(name) \
+  static const bob::core::instrument::Probe BOOST_PP_CAT(bob_probe_, __LINE__)(name, bob::core::instrument::Timer); \
+  bob::core::instrument::ScopedTimer BOOST_PP_CAT(bob_timer_, __LINE__)(BOOST_PP_CAT(bob_probe_, __LINE__))
+
+#else
+
+#define BOB_COUNT(name, amount) do {} while (0)
+#define BOB_TIME_SCOPE(name)
+
+#endif
+
+#endif /* BOB_CORE_INSTRUMENT_H */
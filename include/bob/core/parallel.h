@@ -0,0 +1,197 @@
+/**
+ * @file bob/core/parallel.h
+ * @date Mon Jun 10 10:12:27 2013 +0200
+ * @author Manuel Guenther <Manuel.Guenther@idiap.ch>
+ *
+ * @brief Splits loops into consecutive chunks that are processed by several
+ * threads, and passes work items between producer and consumer threads.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_CORE_PARALLEL_H
+#define BOB_CORE_PARALLEL_H
+
+#include <vector>
+#include <deque>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+namespace bob { namespace core {
+  /**
+   * @ingroup CORE
+   * @{
+   */
+
+  /**
+   * @brief Returns the number of threads to be used, when 0 threads are
+   * requested (i.e., the number of available cores)
+   */
+  inline size_t number_of_threads(size_t requested=0) {
+    if (requested) return requested;
+    size_t cores = boost::thread::hardware_concurrency();
+    return cores ? cores : 1;
+  }
+
+  namespace detail {
+    /**
+     * Runs one chunk in a thread. This is a functor rather than a
+     * boost::bind() expression, since binding an op that is itself a bind
+     * expression would evaluate it in place.
+     */
+    template <typename TOp> struct parallel_chunk {
+      TOp op;
+      size_t thread;
+      size_t begin;
+      size_t end;
+      std::exception_ptr* error;
+      void operator()() {
+        try {
+          op(thread, begin, end);
+        }
+        catch (...) {
+          *error = std::current_exception();
+        }
+      }
+    };
+  }
+
+  /**
+   * @brief Splits the range [0, size) into consecutive chunks and calls
+   * op(thread_index, begin, end) for each chunk in a separate thread. The
+   * chunks are assigned to the threads in order, so the chunk of thread i
+   * always precedes the chunk of thread i+1. The first exception thrown by
+   * any of the threads is re-thrown in the calling thread after all threads
+   * have finished.
+   *
+   * If num_of_threads is 0, the number of available cores is used. If only a
+   * single thread is required, op is called directly in the calling thread.
+   */
+  template <typename TOp> void parallel_for(size_t size, TOp op,
+      size_t num_of_threads=0) {
+
+    num_of_threads = std::min(number_of_threads(num_of_threads), size);
+    if (num_of_threads <= 1) {
+      if (size) op(0, 0, size);
+      return;
+    }
+
+    std::vector<std::exception_ptr> errors(num_of_threads);
+    boost::thread_group threads;
+    size_t chunk = size / num_of_threads, rest = size % num_of_threads;
+    for (size_t ith = 0, begin = 0; ith < num_of_threads; ++ith) {
+      size_t end = begin + chunk + (ith < rest ? 1 : 0);
+      detail::parallel_chunk<TOp> job = {op, ith, begin, end, &errors[ith]};
+      threads.create_thread(job);
+      begin = end;
+    }
+    threads.join_all();
+
+    for (size_t ith = 0; ith < num_of_threads; ++ith)
+      if (errors[ith]) std::rethrow_exception(errors[ith]);
+  }
+
+  /**
+   * @brief A first-in first-out queue holding at most a fixed number of
+   * items, which hands items over from producer to consumer threads. Pushing
+   * blocks while the queue is full and popping blocks while it is empty.
+   *
+   * Once the queue is closed, pushing fails immediately, while popping
+   * returns the remaining items and fails after that. Closing wakes up all
+   * blocked threads, so either side can use it to stop the other one.
+   */
+  template <typename T> class bounded_queue {
+
+    public:
+
+      /**
+       * @brief Creates an open queue that holds up to capacity items
+       */
+      explicit bounded_queue(size_t capacity):
+        m_capacity(std::max(capacity, (size_t)1)),
+        m_closed(false) {
+      }
+
+      /**
+       * @brief Appends an item, waiting for space if the queue is full.
+       * Returns false (and drops the item) if the queue is closed.
+       */
+      bool push(const T& item) {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        while (!m_closed && m_items.size() >= m_capacity) m_not_full.wait(lock);
+        if (m_closed) return false;
+        m_items.push_back(item);
+        m_not_empty.notify_one();
+        return true;
+      }
+
+      /**
+       * @brief Removes the oldest item, waiting for one if the queue is
+       * empty. Returns false if the queue is empty and closed.
+       */
+      bool pop(T& item) {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        while (!m_closed && m_items.empty()) m_not_empty.wait(lock);
+        if (m_items.empty()) return false;
+        item = m_items.front();
+        m_items.pop_front();
+        m_not_full.notify_one();
+        return true;
+      }
+
+      /**
+       * @brief Closes the queue and wakes up all waiting threads
+       */
+      void close() {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        m_closed = true;
+        m_not_full.notify_all();
+        m_not_empty.notify_all();
+      }
+
+      /**
+       * @brief The number of items currently waiting in the queue
+       */
+      size_t size() const {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        return m_items.size();
+      }
+
+      /**
+       * @brief The maximum number of items in the queue
+       */
+      size_t capacity() const { return m_capacity; }
+
+    private: //representation
+
+      mutable boost::mutex m_mutex;
+      boost::condition_variable m_not_full;
+      boost::condition_variable m_not_empty;
+      std::deque<T> m_items;
+      size_t m_capacity;
+      bool m_closed;
+
+  };
+
+  /**
+   * @}
+   */
+}}
+
+#endif /* BOB_CORE_PARALLEL_H */
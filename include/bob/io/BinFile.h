@@ -26,6 +26,7 @@
 #include <bob/core/cast.h>
 #include <bob/core/array.h>
 #include <bob/io/BinFileHeader.h>
+#include <bob/io/MappedFile.h>
 #include <bob/io/Exception.h>
 
 namespace bob { namespace io {
@@ -42,7 +43,8 @@ namespace bob { namespace io {
     _unset   = 0,
     _append  = 1L << 0,
     _in      = 1L << 3,
-    _out     = 1L << 4
+    _out     = 1L << 4,
+    _map     = 1L << 5
   };
 
   /**
@@ -60,9 +62,12 @@ namespace bob { namespace io {
       static const openmode append  = _append;
       static const openmode in      = _in;
       static const openmode out     = _out; 
+      static const openmode map     = _map;
 
       /**
-       * Constructor
+       * Constructor. If the file is opened for reading only and the map flag
+       * is set, the file is mapped into memory and arrays are read from the
+       * mapped pages instead of through a stream.
        */
       BinFile(const std::string& filename, openmode f);
 
@@ -99,6 +104,20 @@ namespace bob { namespace io {
       void read(bob::core::array::interface& a);
       void read(size_t index, bob::core::array::interface& a);
 
+      /**
+       * Returns the array at the given position. If the file is mapped into
+       * memory, the returned array maps the pages of the file privately,
+       * without copying them: modifying it changes neither the file nor
+       * other reads. Otherwise, the array is read into newly allocated
+       * memory.
+       */
+      boost::shared_ptr<bob::core::array::interface> view(size_t index);
+
+      /**
+       * Tells if arrays are read from a memory map of the file
+       */
+      inline bool isMapped() const { return m_map.get() != 0; }
+
       /**
        * Gets the Element type
        *
@@ -209,6 +228,7 @@ namespace bob { namespace io {
       std::fstream m_stream;
       detail::BinFileHeader m_header;
       openmode m_openmode;
+      boost::shared_ptr<detail::MappedFile> m_map;
   };
 
   inline _BinFileFlag operator&(_BinFileFlag a, _BinFileFlag b) { 
@@ -76,13 +76,17 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
        * b) Will contain the exact number of dimensions of the input type.
        *
        * When you set "list" to true (the default), datasets are created with
-       * chunking automatically enabled (the chunk size is set to the size of
-       * the given variable) and an extra dimension is inserted to accommodate
-       * list operations.
+       * chunking automatically enabled and an extra dimension is inserted to
+       * accommodate list operations.
+       *
+       * Each chunk holds "chunk_size" consecutive entries of the list (or
+       * rows of the array, if it is compressed but not a list). If you set it
+       * to zero (the default), the number of entries is chosen so that each
+       * chunk takes about 64 kilobytes.
        */
       Dataset(boost::shared_ptr<Group> parent, const std::string& name,
           const bob::io::HDF5Type& type, bool list=true,
-          size_t compression=0);
+          size_t compression=0, size_t chunk_size=0);
 
     public: //api
 
@@ -263,6 +267,46 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
           return readArray<T,N>(0);
         }
 
+      /**
+       * Reads "value.extent(0)" consecutive entries, starting at "start",
+       * with a single HDF5 operation. The remaining dimensions of the given
+       * array have to match the shape of the entries in this dataset. To read
+       * scalars, use a 1D array.
+       *
+       * @param start The position of the first entry to read
+       * @param value The output array. This variable has to be a zero-based
+       * C-style contiguous storage array. If that is not the case, we will
+       * raise an exception.
+       */
+      template <typename T, int N>
+        void readRange(size_t start, blitz::Array<T,N>& value) {
+          bob::core::array::assertCZeroBaseContiguous(value);
+          bob::io::HDF5Type dest_type(value);
+          read_range_buffer(start, dest_type, reinterpret_cast<void*>(value.data()));
+        }
+
+      /**
+       * Reads "count" consecutive entries, starting at "start", into an array
+       * allocated dynamically. The same conditions as for readRange(start,
+       * value) apply.
+       */
+      template <typename T, int N>
+        blitz::Array<T,N> readRange(size_t start, size_t count) {
+          for (size_t k=0; k<m_descr.size(); ++k) {
+            const bob::io::HDF5Shape& S = m_descr[k].type.shape();
+            if ((N == 1 && S.n() == 1 && S[0] == 1) || S.n() == N-1) {
+              blitz::TinyVector<int,N> shape;
+              shape(0) = count;
+              for (int i=1; i<N; ++i) shape(i) = S[i-1];
+              blitz::Array<T,N> retval(shape);
+              readRange(start, retval);
+              return retval;
+            }
+          }
+          throw bob::io::HDF5IncompatibleIO(url(),
+              m_descr[0].type.str(), "dynamic shape unknown");
+        }
+
       /**
        * DATA WRITING FUNCTIONALITY
        */
@@ -381,6 +425,24 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
           }
       }
 
+      /**
+       * Appends "value.extent(0)" entries to this dataset with a single HDF5
+       * operation. The remaining dimensions of the given array have to match
+       * the shape of the entries in this dataset. To append scalars, use a 1D
+       * array. This dataset has to be expandible (chunked).
+       */
+      template <typename T, int N>
+        void addRange(const blitz::Array<T,N>& value) {
+          bob::io::HDF5Type dest_type(value);
+          if(!bob::core::array::isCZeroBaseContiguous(value)) {
+            blitz::Array<T,N> tmp = bob::core::array::ccopy(value);
+            extend_range_buffer(dest_type, reinterpret_cast<const void*>(tmp.data()));
+          }
+          else {
+            extend_range_buffer(dest_type, reinterpret_cast<const void*>(value.data()));
+          }
+        }
+
     private: //apis
 
       /**
@@ -393,6 +455,21 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
       std::vector<bob::io::HDF5Descriptor>::iterator select (size_t index,
           const bob::io::HDF5Type& dest);
 
+      /**
+       * Selects the entries [start, start+count) of the file, where count is
+       * the first dimension of the given range type, and creates a matching
+       * memory space.
+       */
+      std::vector<bob::io::HDF5Descriptor>::iterator select_range
+        (size_t start, const bob::io::HDF5Type& range,
+         boost::shared_ptr<hid_t>& memspace);
+
+      /**
+       * Extends the dataset with "count" entries of the given type. Returns
+       * the position of the first new entry.
+       */
+      size_t extend (size_t count, const bob::io::HDF5Type& dest);
+
     public: //direct access for other bindings -- don't use these!
 
       /**
@@ -412,6 +489,26 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
        */
       void extend_buffer (const bob::io::HDF5Type& dest, const void* buffer);
 
+      /**
+       * Reads consecutive entries into the given (user) buffer. The first
+       * dimension of the range type is the number of entries, the remaining
+       * ones describe each entry (1D ranges are made of scalars).
+       */
+      void read_range_buffer (size_t start, const bob::io::HDF5Type& range,
+          void* buffer);
+
+      /**
+       * Writes consecutive entries from the given buffer into the file.
+       */
+      void write_range_buffer (size_t start, const bob::io::HDF5Type& range,
+          const void* buffer);
+
+      /**
+       * Extend the dataset with all entries in the given buffer.
+       */
+      void extend_range_buffer (const bob::io::HDF5Type& range,
+          const void* buffer);
+
     public: //attribute support
 
       /**
@@ -538,6 +635,13 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
 
   };
       
+  /**
+   * Returns the type of each entry in a range of consecutive entries, i.e.,
+   * the range type without its first dimension. 1D ranges are made of
+   * scalars.
+   */
+  bob::io::HDF5Type range_entry_type(const bob::io::HDF5Type& range);
+
   /**
    * std::string specialization
    */
@@ -56,9 +56,13 @@ namespace bob { namespace io {
 
       /**
        * Constructor, starts a new HDF5File object giving it a file name and an
-       * action: excl/trunc/in/inout
+       * action: excl/trunc/in/inout. Optionally, sets the size in bytes of
+       * the raw data chunk cache kept for each dataset in this file. Larger
+       * caches help when reading or appending to large, chunked datasets.
+       * The value of zero keeps the HDF5 default (1 MiB).
        */
-      HDF5File (const std::string& filename, mode_t mode);
+      HDF5File (const std::string& filename, mode_t mode,
+          size_t cache_size=0);
 
       /**
        * Destructor virtualization
@@ -96,6 +100,11 @@ namespace bob { namespace io {
        */
       const std::string& filename() const { return m_file->filename(); }
 
+      /**
+       * Returns the size in bytes of the raw data chunk cache of each dataset
+       */
+      size_t cacheSize() const { return m_file->cache_size(); }
+
       /**
        * Returns the current working path, fully resolved. This is
        * re-calculated every time you call this method.
@@ -242,6 +251,29 @@ namespace bob { namespace io {
           return readArray<T,N>(path, 0);
       }
 
+      /**
+       * Reads value.extent(0) consecutive entries of a dataset, starting at
+       * position pos, into a single array with one dimension more than the
+       * entries (use a 1D array for scalars). This is much faster than
+       * reading the entries one by one. Raises an exception if the type is
+       * incompatible or if the range does not exist. Relative paths are
+       * accepted.
+       */
+      template <typename T, int N> void readRange(const std::string& path,
+          size_t pos, blitz::Array<T,N>& value) {
+        (*m_cwd)[path]->readRange(pos, value);
+      }
+
+      /**
+       * Reads count consecutive entries of a dataset, starting at position
+       * pos. Destination array is allocated internally and returned by
+       * value.
+       */
+      template <typename T, int N> blitz::Array<T,N> readRange
+        (const std::string& path, size_t pos, size_t count) {
+        return (*m_cwd)[path]->readRange<T,N>(pos, count);
+      }
+
       /**
        * Modifies the value of a scalar inside the file. Relative paths are
        * accepted.
@@ -313,19 +345,41 @@ namespace bob { namespace io {
        * level. Note this setting has no effect if the Dataset already exists
        * on file, in which case the current setting for that dataset is
        * respected. The maximum value for the gzip compression is 9. The value
-       * of zero turns compression off (the default).
+       * of zero turns compression off (the default). The chunk size sets the
+       * number of entries stored together on the file; if zero (the
+       * default), it is chosen automatically.
        */
       template <typename T> void appendArray(const std::string& path,
-          const T& value, size_t compression=0) {
+          const T& value, size_t compression=0, size_t chunk_size=0) {
         if (!m_file->writeable()) {
           boost::format m("cannot append array to dataset '%s' at path '%s' of file '%s' because it is not writeable");
           m % path % m_cwd->path() % m_file->filename();
           throw std::runtime_error(m.str());
         }
-        if (!contains(path)) m_cwd->create_dataset(path, bob::io::HDF5Type(value), true, compression);
+        if (!contains(path)) m_cwd->create_dataset(path, bob::io::HDF5Type(value), true, compression, chunk_size);
         (*m_cwd)[path]->addArray(value);
       }
 
+      /**
+       * Appends value.extent(0) entries to a dataset with a single operation.
+       * Each entry has the shape of the given array without its first
+       * dimension (use a 1D array to append scalars). If the dataset does not
+       * yet exist, one is created with these characteristics, the given
+       * compression level and chunk size, as for appendArray(). Relative
+       * paths are accepted.
+       */
+      template <typename T, int N> void appendRange(const std::string& path,
+          const blitz::Array<T,N>& value, size_t compression=0,
+          size_t chunk_size=0) {
+        if (!m_file->writeable()) {
+          boost::format m("cannot append range to dataset '%s' at path '%s' of file '%s' because it is not writeable");
+          m % path % m_cwd->path() % m_file->filename();
+          throw std::runtime_error(m.str());
+        }
+        if (!contains(path)) m_cwd->create_dataset(path, detail::hdf5::range_entry_type(bob::io::HDF5Type(value)), true, compression, chunk_size);
+        (*m_cwd)[path]->addRange(value);
+      }
+
       /**
        * Sets the scalar at position 0 to the given value. This method is
        * equivalent to checking if the scalar at position 0 exists and then
@@ -370,7 +424,7 @@ namespace bob { namespace io {
        * existing data is compatible with the required type.
        */
       void create (const std::string& path, const HDF5Type& dest, bool list,
-          size_t compression);
+          size_t compression, size_t chunk_size=0);
 
       /**
        * Reads data from the file into a buffer. The given buffer contains
@@ -394,6 +448,21 @@ namespace bob { namespace io {
       void extend_buffer (const std::string& path,
           const HDF5Type& type, const void* buffer);
 
+      /**
+       * Reads consecutive entries, starting at pos, into a buffer. The first
+       * dimension of the given type is the number of entries to read, the
+       * remaining dimensions describe each entry.
+       */
+      void read_range_buffer (const std::string& path, size_t pos,
+          const HDF5Type& type, void* buffer) const;
+
+      /**
+       * extend the dataset with all the entries in the buffer. The first
+       * dimension of the given type is the number of entries to append.
+       */
+      void extend_range_buffer (const std::string& path,
+          const HDF5Type& type, const void* buffer);
+
       /**
        * Copy construct an already opened HDF5File; just creates a shallow copy
        * of the file
@@ -48,9 +48,11 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
       Group(boost::shared_ptr<Group> parent, const std::string& name);
 
       /**
-       * Binds to an existing group in a parent, reads all the group contents
-       * recursively. Note that the last parameter is there only to
-       * differentiate from the above constructor. It is ignored.
+       * Binds to an existing group in a parent. The group contents are not
+       * read: sub-groups and datasets are looked up on the file when they are
+       * first accessed and the group is only iterated when its contents are
+       * listed. Note that the last parameter is there only to differentiate
+       * from the above constructor. It is ignored.
        */
       Group(boost::shared_ptr<Group> parent,  const std::string& name,
           bool open);
@@ -60,13 +62,6 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
        */
       Group(boost::shared_ptr<File> parent);
 
-      /**
-       * Recursively open sub-groups and datasets. This cannot be done at the
-       * constructor because of a enable_shared_from_this<> restriction that
-       * results in a bad weak pointer exception being raised.
-       */
-      void open_recursively();
-
     public: //api
 
       /**
@@ -136,12 +131,10 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
       virtual const boost::shared_ptr<Group> cd(const std::string& path) const;
 
       /**
-       * Get a mapping of all child groups
+       * Get a mapping of all child groups. All child groups are opened.
        */
       virtual const std::map<std::string, boost::shared_ptr<Group> >& groups()
-        const {
-        return m_groups;
-      }
+        const;
 
       /**
        * Create a new subgroup with a given name.
@@ -180,12 +173,10 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
       virtual bool has_group(const std::string& path) const;
 
       /**
-       * Get all datasets attached to this group
+       * Get all datasets attached to this group. All datasets are opened.
        */
       virtual const std::map<std::string, boost::shared_ptr<Dataset> >&
-        datasets() const {
-          return m_datasets;
-        }
+        datasets() const;
 
       /**
        * Creates a new HDF5 dataset from scratch and inserts it in this group.
@@ -201,13 +192,13 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
        * of dimensions of the input type.
        *
        * When you set "list" to true (the default), datasets are created with
-       * chunking automatically enabled (the chunk size is set to the size of
-       * the given variable) and an extra dimension is inserted to accomodate
-       * list operations.
+       * chunking automatically enabled and an extra dimension is inserted to
+       * accomodate list operations. The number of entries per chunk is set
+       * by "chunk_size" or, if that is zero, chosen automatically.
        */
       virtual boost::shared_ptr<Dataset> create_dataset
         (const std::string& path, const bob::io::HDF5Type& type, bool list=true,
-         size_t compression=0);
+         size_t compression=0, size_t chunk_size=0);
 
       /**
        * Deletes a dataset in this group
@@ -248,8 +239,10 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
        * container with T = std::string and accepting push_back()
        */
       template <typename T> void dataset_paths (T& container) const {
-        for (std::map<std::string, boost::shared_ptr<io::detail::hdf5::Dataset> >::const_iterator it=m_datasets.begin(); it != m_datasets.end(); ++it) container.push_back(it->second->path());
-        for (std::map<std::string, boost::shared_ptr<io::detail::hdf5::Group> >::const_iterator it=m_groups.begin(); it != m_groups.end(); ++it) it->second->dataset_paths(container);
+        list_contents();
+        const std::string prefix = path() + "/";
+        for (std::map<std::string, boost::shared_ptr<io::detail::hdf5::Dataset> >::const_iterator it=m_datasets.begin(); it != m_datasets.end(); ++it) container.push_back(prefix + it->first);
+        for (std::map<std::string, boost::shared_ptr<io::detail::hdf5::Group> >::const_iterator it=m_groups.begin(); it != m_groups.end(); ++it) child_group(it->first)->dataset_paths(container);
       }
 
       /**
@@ -257,19 +250,21 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
        * container with T = std::string and accepting push_back()
        */
       template <typename T> void subgroup_paths (T& container, bool recursive = true) const {
+        list_contents();
         for (std::map<std::string, boost::shared_ptr<io::detail::hdf5::Group> >::const_iterator it=m_groups.begin(); it != m_groups.end(); ++it){
           container.push_back(it->first);
           if (recursive)
-            it->second->subgroup_paths(container);
+            child_group(it->first)->subgroup_paths(container);
         }
       }
 
       /**
        * Callback function for group iteration. Two cases are blessed here:
        *
-       * 1. Object is another group. In this case just instantiate the group and
-       *    recursively iterate from there
-       * 2. Object is a dataset. Instantiate it.
+       * 1. Object is another group. Record its name, so it can be opened
+       *    when accessed.
+       * 2. Object is a dataset. Record its name, so it can be opened when
+       *    accessed.
        *
        * Only hard-links are considered. At the time being, no soft links.
        */
@@ -379,6 +374,33 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
       void write_attribute (const std::string& name,
           const bob::io::HDF5Type& dest, const void* buffer);
 
+    private: //lazy discovery of the group contents
+
+      /**
+       * Iterates over this group, if not done before, and records the names
+       * of all sub-groups and datasets. These are only opened when accessed.
+       */
+      void list_contents() const;
+
+      /**
+       * Looks up a single name on the file, if the group was not iterated
+       * yet, and records it as a sub-group or a dataset.
+       */
+      void probe(const std::string& name) const;
+
+      /**
+       * Returns the (opened) child group or dataset with the given name, or
+       * an empty pointer if there is no such child.
+       */
+      boost::shared_ptr<Group> child_group(const std::string& name) const;
+      boost::shared_ptr<Dataset> child_dataset(const std::string& name) const;
+
+      /**
+       * Forgets what is known about a child, which is looked up again on the
+       * next access.
+       */
+      void forget(const std::string& name);
+
     private: //not implemented
 
       /**
@@ -397,8 +419,9 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
       std::string m_name; ///< my name
       boost::shared_ptr<hid_t> m_id; ///< the HDF5 Group this object points to
       boost::weak_ptr<Group> m_parent;
-      std::map<std::string, boost::shared_ptr<Group> > m_groups;
-      std::map<std::string, boost::shared_ptr<Dataset> > m_datasets;
+      mutable std::map<std::string, boost::shared_ptr<Group> > m_groups; ///< known sub-groups, empty if not opened yet
+      mutable std::map<std::string, boost::shared_ptr<Dataset> > m_datasets; ///< known datasets, empty if not opened yet
+      mutable bool m_listed; ///< are all sub-groups and datasets known?
       //std::map<std::string, boost::shared_ptr<Attribute> > m_attributes;
 
   };
@@ -57,10 +57,11 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
 
       /**
        * Creates a new HDF5 file. Optionally set the userblock size (multiple
-       * of 2 number of bytes).
+       * of 2 number of bytes) and the size in bytes of the raw data chunk
+       * cache kept for each dataset (zero keeps the HDF5 default of 1 MiB).
        */
       File(const boost::filesystem::path& path, unsigned int flags,
-          size_t userblock_size=0);
+          size_t userblock_size=0, size_t cache_size=0);
 
       /**
        * Copies a file by creating a copy of each of its groups
@@ -92,6 +93,11 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
        */
       size_t userblock_size() const;
 
+      /**
+       * Returns the size in bytes of the raw data chunk cache of each dataset
+       */
+      size_t cache_size() const;
+
       /**
        * Copies the userblock into a string -- not yet implemented. If you want
        * to do it, read the code for the command-line utilitlies h5jam and
@@ -133,6 +139,7 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
       const boost::filesystem::path m_path; ///< path to the file
       unsigned int m_flags; ///< flags used to open it
       boost::shared_ptr<hid_t> m_fcpl; ///< file creation property lists
+      boost::shared_ptr<hid_t> m_fapl; ///< file access property lists
       boost::shared_ptr<hid_t> m_id; ///< the HDF5 id attributed to this file.
       boost::shared_ptr<RootGroup> m_root;
   };
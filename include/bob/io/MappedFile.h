@@ -0,0 +1,86 @@
+/**
+ * @file bob/io/MappedFile.h
+ * @date 2013-06-26
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief A read-only memory map of a file, used by the BinFile and
+ * TensorFile readers to access arrays without going through a stream.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_IO_MAPPEDFILE_H
+#define BOB_IO_MAPPEDFILE_H
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <bob/core/array.h>
+
+namespace bob { namespace io { namespace detail {
+
+  /**
+   * Maps a whole file into memory, read-only. Views get their own private
+   * mapping of the pages they cover: pages that are modified through a view
+   * are copied and never written back to the file, nor seen by other reads
+   * or views. Please note that this class is for private use of the BinFile
+   * and TensorFile types.
+   */
+  class MappedFile {
+
+    public:
+
+      /**
+       * Maps the given file, which has to exist and be non-empty
+       */
+      MappedFile(const std::string& path);
+
+      /**
+       * Destructor
+       */
+      virtual ~MappedFile();
+
+      /**
+       * The size of the mapped file, in bytes
+       */
+      inline size_t size() const { return m_map.size(); }
+
+      /**
+       * Returns a pointer to the given range of bytes, checking that it lies
+       * inside the file. If ranges are fetched one after the other, the
+       * kernel is advised to read the next pages ahead.
+       */
+      const char* fetch(size_t offset, size_t length);
+
+      /**
+       * Returns an array that points to the given range of bytes, without
+       * copying them. The array maps these bytes privately (copy-on-write),
+       * so it can be modified and can outlive this object.
+       */
+      boost::shared_ptr<bob::core::array::interface> view(size_t offset,
+          const bob::core::array::typeinfo& info);
+
+    private: //representation
+
+      std::string m_path; ///< the mapped file
+      boost::iostreams::mapped_file_source m_map; ///< the file contents
+      size_t m_next; ///< where a sequential fetch would start
+      size_t m_prefetched; ///< up to where we asked for read-ahead
+
+  };
+
+}}}
+
+#endif /* BOB_IO_MAPPEDFILE_H */
@@ -25,6 +25,7 @@
 
 #include <bob/core/blitz_array.h>
 #include <bob/io/TensorFileHeader.h>
+#include <bob/io/MappedFile.h>
 #include <bob/io/Exception.h>
 
 namespace bob { namespace io {
@@ -37,7 +38,8 @@ namespace bob { namespace io {
     _unset   = 0,
     _append  = 1L << 0,
     _in      = 1L << 3,
-    _out     = 1L << 4
+    _out     = 1L << 4,
+    _map     = 1L << 5
   };
 
   /**
@@ -55,9 +57,12 @@ namespace bob { namespace io {
       static const openmode append  = _append;
       static const openmode in      = _in;
       static const openmode out     = _out; 
+      static const openmode map     = _map;
 
       /**
-       * Constructor
+       * Constructor. If the file is opened for reading only and the map flag
+       * is set, the file is mapped into memory and arrays are read from the
+       * mapped pages instead of through a stream.
        */
       TensorFile(const std::string& filename, openmode f);
 
@@ -103,6 +108,22 @@ namespace bob { namespace io {
        */
       void read (size_t index, bob::core::array::interface& data);
 
+      /**
+       * Returns the array at the given position. Tensors are stored in
+       * column-major order: if the file is mapped into memory and this order
+       * coincides with the row-major order of the returned array (i.e. at
+       * most one of its dimensions is larger than 1), the returned array
+       * maps the pages of the file privately, without copying them:
+       * modifying it changes neither the file nor other reads. Otherwise,
+       * the array is re-ordered into newly allocated memory.
+       */
+      boost::shared_ptr<bob::core::array::interface> view(size_t index);
+
+      /**
+       * Tells if arrays are read from a memory map of the file
+       */
+      inline bool isMapped() const { return m_map.get() != 0; }
+
       /**
        * Peeks the file and returns the currently set typeinfo
        */
@@ -216,6 +237,7 @@ namespace bob { namespace io {
       detail::TensorFileHeader m_header;
       openmode m_openmode;
       boost::shared_ptr<void> m_buffer; 
+      boost::shared_ptr<detail::MappedFile> m_map;
   };
 
   inline _TensorFileFlag operator&(_TensorFileFlag a, _TensorFileFlag b) { 
@@ -25,10 +25,14 @@
 #define BOB_IO_VIDEOREADER_H
 
 #include <string>
+#include <vector>
+#include <exception>
 #include <blitz/array.h>
 #include <stdint.h>
+#include <boost/thread.hpp>
 
 #include <bob/core/array.h>
+#include <bob/core/parallel.h>
 #include <bob/io/VideoUtilities.h>
 
 namespace bob { namespace io {
@@ -45,7 +49,8 @@ namespace bob { namespace io {
    * bob, which is not the case presently). So, the input of data using this
    * class uses uint8_t as base element type. Output will be colored using the
    * RGB standard, with each band varying between 0 and 255, with zero meaning
-   * pure black and 255, pure white (color).
+   * pure black and 255, pure white (color). Optionally, only the luminance of
+   * each frame can be read, which skips the color conversion altogether.
    */
   class VideoReader {
 
@@ -56,8 +61,15 @@ namespace bob { namespace io {
        * combination of format and codec are known to work and have been
        * tested, otherwise an exception is raised. If you set 'check' to
        * 'false', though, we will ignore this check.
+       *
+       * If 'gray' is set, frames are read as grayscale images (height, width)
+       * taken from the luminance of the video, instead of RGB images. The
+       * decoder may use up to 'threads' threads (0 means one per core). If
+       * 'prefetch' is not 0, iterators decode up to that number of frames
+       * ahead on a background thread, while you process the current one.
        */
-      VideoReader(const std::string& filename, bool check=true);
+      VideoReader(const std::string& filename, bool check=true,
+          bool gray=false, size_t threads=1, size_t prefetch=0);
 
       /**
        * Opens a new Video stream copying information from another VideoStream
@@ -133,6 +145,21 @@ namespace bob { namespace io {
        */
       inline const std::string& info() const { return m_formatted_info; }
 
+      /**
+       * Tells if frames are read as grayscale images
+       */
+      inline bool isGray() const { return m_gray; }
+
+      /**
+       * Returns the number of threads the decoder may use
+       */
+      inline size_t decoderThreads() const { return m_threads; }
+
+      /**
+       * Returns the number of frames iterators decode ahead
+       */
+      inline size_t prefetchFrames() const { return m_prefetch; }
+
       /**
        * Returns the typing information for this video
        */
@@ -163,6 +190,13 @@ namespace bob { namespace io {
       size_t load(blitz::Array<uint8_t,4>& data,
           bool throw_on_error=false, void (*check)(void)=0) const;
 
+      /**
+       * Loads all of the grayscale video stream in a blitz array organized in
+       * this way: (frames, height, width). Works like the method above.
+       */
+      size_t load(blitz::Array<uint8_t,3>& data,
+          bool throw_on_error=false, void (*check)(void)=0) const;
+
       /**
        * Loads all of the video stream in a buffer. Resizes the buffer if
        * the space and type are not good.
@@ -179,12 +213,67 @@ namespace bob { namespace io {
       size_t load(bob::core::array::interface& b, 
           bool throw_on_error=false, void (*check)(void)=0) const;
 
+      /**
+       * Builds the index of keyframes in the video stream, by scanning the
+       * file without decoding it. Once the index is built, iterators that are
+       * fast-forwarded seek to the last keyframe before their destination
+       * and only decode the frames after it.
+       *
+       * If 'cache' is set, the index is read from a file next to the video,
+       * named after it with an additional '.keyframes' extension, unless the
+       * video changed since it was written. Otherwise, the index is built and
+       * saved to that file, if possible.
+       */
+      void index(bool cache=false) const;
+
+      /**
+       * Tells if the keyframe index has been built
+       */
+      inline bool isIndexed() const { return m_indexed; }
+
+      /**
+       * Returns the numbers of the keyframes that iterators can seek in the
+       * video stream. Frames are numbered in display order, as they are
+       * read sequentially. This is empty unless the index has been built.
+       */
+      inline const std::vector<size_t>& keyframes() const 
+      { return m_keyframes; }
+
+      /**
+       * Reads the frames with the given numbers, in the given order, into a
+       * buffer organized like the one of load(), with as many frames as
+       * there are numbers. Frames are read in increasing order, seeking
+       * keyframes in between: the index is built if it was not already.
+       * Raises if one of the numbers is not smaller than numberOfFrames().
+       *
+       * The flag 'throw_on_error' works like for load(). Returns the number
+       * of frames read: if this is smaller than the number of frames
+       * requested, the remaining frames in the buffer are undefined.
+       */
+      size_t read(const std::vector<size_t>& frames,
+          bob::core::array::interface& b, bool throw_on_error=false) const;
+
+      /**
+       * Reads the frames with the given numbers into a blitz array
+       * organized as (frames, color-bands, height, width). See above.
+       */
+      size_t read(const std::vector<size_t>& frames,
+          blitz::Array<uint8_t,4>& data, bool throw_on_error=false) const;
+
+      /**
+       * Reads the frames with the given numbers of a grayscale video into
+       * a blitz array organized as (frames, height, width). See above.
+       */
+      size_t read(const std::vector<size_t>& frames,
+          blitz::Array<uint8_t,3>& data, bool throw_on_error=false) const;
+
     private: //methods
 
       /**
        * Opens the previously set up Video stream for the reader
        */
-      void open(const std::string& filename, bool check);
+      void open(const std::string& filename, bool check, bool gray,
+          size_t threads, size_t prefetch);
 
     public: //iterators
 
@@ -234,10 +323,12 @@ namespace bob { namespace io {
           //const_iterator operator++ (int); //too inefficient!
 
           /**
-           * Fast-forward the video readout by N frames, return self. This
+           * Fast-forward the video readout by N frames, return self. Unless
+           * the keyframe index of the parent has been built, this
            * implementation is slow because of ffmpeg limitations. It has no
            * precise frame lookup function. What we have to do is to read
-           * frame-by-frame and stop when you want to.
+           * frame-by-frame and stop when you want to. With the index, we
+           * seek the last keyframe before the destination first.
            */
           const_iterator& operator+= (size_t frames);
 
@@ -299,6 +390,13 @@ namespace bob { namespace io {
            */
           bool read (blitz::Array<uint8_t,3>& data, bool throw_on_error=false);
 
+          /**
+           * Reads the currently pointed frame of a grayscale video and
+           * advances one position. Works like the method above, with 'data'
+           * organized as (height, width).
+           */
+          bool read (blitz::Array<uint8_t,2>& data, bool throw_on_error=false);
+
           /**
            * Resets the current iterator state by closing and re-opening the
            * movie file and positioning the frame pointer to the first frame in
@@ -336,6 +434,47 @@ namespace bob { namespace io {
            */
           void init();
 
+          /**
+           * Decodes the next frame in the file into 'data', which is laid out
+           * as described by 'info'. Only the prefetching thread calls this
+           * method while it runs.
+           */
+          bool decode(uint8_t* data, const bob::core::array::typeinfo& info,
+              size_t frame, bool throw_on_error);
+
+          /**
+           * Decodes frames into the prefetch queue, until the end of the file
+           * or until the queue is closed. Runs on its own thread.
+           */
+          void prefetch(size_t frame);
+
+          /**
+           * Starts decoding frames ahead from the current one, if the parent
+           * asks for it
+           */
+          void start_prefetch();
+
+          /**
+           * Stops decoding frames ahead, dropping the ones already decoded
+           */
+          void stop_prefetch();
+
+          /**
+           * Takes the next frame out of the prefetch queue, copying it into
+           * 'data' if that is given.
+           */
+          bool next_prefetched(bob::core::array::interface* data,
+              bool throw_on_error);
+
+          /**
+           * A frame decoded ahead by the prefetching thread
+           */
+          struct prefetched_frame {
+            boost::shared_array<uint8_t> data; ///< in the parent's frame layout
+            bool ok; ///< false if the frame could not be read
+            std::exception_ptr error; ///< why the frame could not be read
+          };
+
         private: //representation
           const VideoReader* m_parent; ///< who generated me
           boost::shared_ptr<AVFormatContext> m_format_context; ///< format context
@@ -347,6 +486,8 @@ namespace bob { namespace io {
           blitz::Array<uint8_t,3> m_rgb_array; ///< temporary
           boost::shared_ptr<SwsContext> m_swscaler; ///< software scaler
           size_t m_current_frame; ///< the current frame to be read
+          boost::shared_ptr<bob::core::bounded_queue<prefetched_frame> > m_queue; ///< frames decoded ahead
+          boost::shared_ptr<boost::thread> m_prefetcher; ///< decodes ahead
 
         public: //friendship
 
@@ -368,6 +509,9 @@ namespace bob { namespace io {
 
       std::string m_filepath; ///< the name of the file we are manipulating
       bool m_check; ///< shall I check for compatibility when opening?
+      bool m_gray; ///< shall I only read the luminance of the frames?
+      size_t m_threads; ///< how many threads the decoder may use
+      size_t m_prefetch; ///< how many frames iterators decode ahead
       size_t m_height; ///< the height of the video frames (number of rows)
       size_t m_width; ///< the width of the video frames (number of columns)
       size_t m_nframes; ///< the number of frames in this video file
@@ -380,6 +524,9 @@ namespace bob { namespace io {
       std::string m_formatted_info; ///< printable information about the video
       bob::core::array::typeinfo m_typeinfo_video; ///< read whole video type
       bob::core::array::typeinfo m_typeinfo_frame; ///< read single frame type
+      mutable bool m_indexed; ///< was the keyframe index built?
+      mutable std::vector<size_t> m_keyframes; ///< keyframe numbers
+      mutable std::vector<int64_t> m_keyframe_timestamps; ///< to seek them
   };
 
 }}
@@ -113,7 +113,9 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
    ************************************************************************/
 
   /**
-   * Creates a new codec context and verify all is good.
+   * Creates a new codec context and verify all is good. If more than one
+   * thread is requested, the codec is allowed to use FFmpeg's internal frame
+   * and slice threading, if available.
    *
    * @note The returned object knows how to correctly delete itself, freeing
    * all acquired resources. Nonetheless, when this object is used in
@@ -121,7 +123,8 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
    * respected.
    */
   boost::shared_ptr<AVCodecContext> make_codec_context(
-      const std::string& filename, AVStream* stream, AVCodec* codec);
+      const std::string& filename, AVStream* stream, AVCodec* codec,
+      size_t threads=1);
 
   /**
    * Allocates the software scaler that handles size and pixel format
@@ -188,11 +191,24 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
    */
   boost::shared_ptr<AVFrame> make_empty_frame(const std::string& filename);
 
+  /**
+   * Returns 'true' if the first plane of frames in the given pixel format
+   * holds the full-range (0-255) luminance, which can be used as a grayscale
+   * image without any conversion.
+   */
+  bool luma_is_gray (PixelFormat pixel_format);
+
   /**
    * Reads a single video frame from the stream. Input data must be previously
    * allocated and be of the right type and size for holding the frame
    * contents. It is an error to try to read past the end of the file.
    *
+   * Data is packed RGB (height, width, 3), unless 'gray' is set, in which
+   * case it is the luminance (height, width) and the scaler should convert
+   * to PIX_FMT_GRAY8. If the scaler is empty in this case, the first plane
+   * of the decoded frame is copied, which is only correct if
+   * luma_is_gray() for the codec pixel format.
+   *
    * @return true if it manages to load a video frame or false otherwise.
    */
   bool read_video_frame (const std::string& filename, int current_frame,
@@ -200,7 +216,7 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
       boost::shared_ptr<AVCodecContext> codec_context,
       boost::shared_ptr<SwsContext> swscaler,
       boost::shared_ptr<AVFrame> context_frame, uint8_t* data,
-      bool throw_on_error);
+      bool throw_on_error, bool gray=false);
 
   /**
    * Reads a single video frame from the stream, but skip it in the fastest
@@ -214,6 +230,27 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
       boost::shared_ptr<AVCodecContext> codec_context,
       boost::shared_ptr<AVFrame> context_frame, bool throw_on_error);
 
+  /**
+   * Scans all packets of the video stream without decoding them, and lists
+   * the keyframes from which decoding outputs frames in display order: their
+   * frame numbers (in display order, as the decoder outputs them) and their
+   * timestamps (in stream time base units), which can be used to seek to
+   * them. The list is empty if frames cannot be numbered in display order
+   * without decoding them. The format context is left at the end of the file.
+   */
+  void index_keyframes (const std::string& filename, int stream_index,
+      boost::shared_ptr<AVFormatContext> format_context,
+      std::vector<size_t>& frames, std::vector<int64_t>& timestamps);
+
+  /**
+   * Seeks the video stream to the keyframe with the given timestamp (in
+   * stream time base units), as given by index_keyframes(), and flushes the
+   * decoder. The next decoded frame is that keyframe.
+   */
+  void seek_keyframe (const std::string& filename, int stream_index,
+      boost::shared_ptr<AVFormatContext> format_context,
+      boost::shared_ptr<AVCodecContext> codec_context, int64_t timestamp);
+
   /************************************************************************
    * Video writing specific utilities
    ************************************************************************/
@@ -298,6 +335,30 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
     boost::shared_array<uint8_t> buffer,
     size_t buffer_size);
 
+  /**
+   * Returns the name of a pixel format
+   */
+  std::string pixel_format_name (PixelFormat pixel_format);
+
+  /**
+   * Returns the number of bytes of a frame in the given pixel format, with
+   * its planes one after the other, as the encoder frames lay them out.
+   */
+  size_t native_frame_size (PixelFormat pixel_format, size_t height,
+      size_t width);
+
+  /**
+   * Writes a data frame that is already in the pixel format of the encoder,
+   * laid out as described by native_frame_size(), into the encoder stream.
+   * This skips the color conversion of write_video_frame().
+   */
+  void write_native_video_frame (const uint8_t* data,
+    const std::string& filename,
+    boost::shared_ptr<AVFormatContext> format_context,
+    boost::shared_ptr<AVStream> stream,
+    boost::shared_ptr<AVFrame> context_frame,
+    boost::shared_array<uint8_t> buffer,
+    size_t buffer_size);
 
 }}}}
 
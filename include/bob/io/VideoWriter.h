@@ -24,7 +24,11 @@
 #ifndef BOB_IO_VIDEOWRITER_H
 #define BOB_IO_VIDEOWRITER_H
 
+#include <exception>
+#include <boost/thread.hpp>
+
 #include <bob/core/array.h>
+#include <bob/core/parallel.h>
 #include <bob/io/VideoUtilities.h>
 
 namespace bob { namespace io {
@@ -58,11 +62,18 @@ namespace bob { namespace io {
        * and codec are known to work and have been tested, otherwise an
        * exception is raised. If you set 'check' to 'false', though, we will
        * ignore this check.
+       * @param threads The maximum number of threads the encoder may use. If
+       * set to 0, use one thread per core.
+       * @param queue If not 0, frames are encoded asynchronously: append()
+       * copies them into a queue that holds up to this number of frames and
+       * returns, while a background thread encodes and writes them. It only
+       * waits if the queue is full. Encoding errors are reported by the next
+       * call to append() or close().
        */
       VideoWriter(const std::string& filename, size_t height, size_t width,
           double framerate=25., double bitrate=1500000., size_t gop=12,
           const std::string& codec="", const std::string& format="",
-          bool check=true);
+          bool check=true, size_t threads=1, size_t queue=0);
 
       /**
        * Destructor virtualization
@@ -71,7 +82,8 @@ namespace bob { namespace io {
 
       /**
        * Closes the current video stream and forces writing the trailer. After
-       * this point the video becomes invalid.
+       * this point the video becomes invalid. In asynchronous mode, waits for
+       * all queued frames to be encoded first.
        */
       void close();
 
@@ -122,6 +134,17 @@ namespace bob { namespace io {
        */
       inline bool is_opened() const { return m_opened; }
 
+      /**
+       * Returns the maximum number of threads the encoder may use
+       */
+      inline size_t encoderThreads() const { return m_threads; }
+
+      /**
+       * Returns how many frames may wait to be encoded in asynchronous mode,
+       * or 0 if frames are encoded as they are appended
+       */
+      inline size_t queueSize() const { return m_queue_size; }
+
       /**
        * Some utility information
        */
@@ -137,6 +160,11 @@ namespace bob { namespace io {
       std::string codecLongName() const { 
         return m_stream->codec->codec->long_name; 
       }
+
+      /**
+       * Name of the pixel format of the encoder, used by appendNative()
+       */
+      std::string pixelFormat() const;
       
       /**
        * Returns a string containing the format information
@@ -155,6 +183,13 @@ namespace bob { namespace io {
       const bob::core::array::typeinfo& frame_type() const 
       { return m_typeinfo_frame; }
 
+      /**
+       * Type information of the frames accepted by appendNative(): a 1D
+       * buffer holding a frame in the pixel format of the encoder.
+       */
+      const bob::core::array::typeinfo& native_frame_type() const 
+      { return m_typeinfo_native; }
+
       /**
        * Writes a set of frames to the file. The frame set should be setup as a
        * blitz::Array<> with 4 dimensions organized in this way:
@@ -184,6 +219,48 @@ namespace bob { namespace io {
        */
       void append(const bob::core::array::interface& data);
 
+      /**
+       * Writes a new frame that is already in the pixel format of the encoder
+       * (see pixelFormat()), with its planes one after the other, as
+       * described by native_frame_type(). This skips the color conversion
+       * that append() has to do.
+       */
+      void appendNative(const bob::core::array::interface& data);
+
+    private: //methods
+
+      /**
+       * Checks the file is still opened and the background encoder (if any)
+       * did not fail, raising otherwise.
+       */
+      void check_writable() const;
+
+      /**
+       * Encodes a contiguous frame, either in Bob's planar RGB format or in
+       * the native format of the encoder, or queues a copy of it for the
+       * background encoder.
+       */
+      void write(const uint8_t* data, bool native);
+
+      /**
+       * Encodes a contiguous frame right away
+       */
+      void encode(const uint8_t* data, bool native);
+
+      /**
+       * Encodes the frames in the queue until it is closed. This runs on the
+       * background thread.
+       */
+      void encode_queued();
+
+      /**
+       * A frame waiting to be encoded by the background thread
+       */
+      struct queued_frame {
+        boost::shared_array<uint8_t> data; ///< a copy of the frame
+        bool native; ///< is it in the format of the encoder?
+      };
+
     private: //not implemented
 
       VideoWriter(const VideoWriter& other);
@@ -211,7 +288,14 @@ namespace bob { namespace io {
       std::string m_formatname;
       bob::core::array::typeinfo m_typeinfo_video;
       bob::core::array::typeinfo m_typeinfo_frame;
+      bob::core::array::typeinfo m_typeinfo_native;
       size_t m_current_frame;
+      size_t m_threads;
+      size_t m_queue_size;
+      boost::shared_ptr<bob::core::bounded_queue<queued_frame> > m_queue; ///< frames to encode
+      boost::shared_ptr<boost::thread> m_encoder; ///< encodes queued frames
+      std::exception_ptr m_error; ///< why the background encoder stopped
+      mutable boost::mutex m_error_mutex; ///< protects m_error
 
   };
 
@@ -514,8 +514,10 @@ namespace bob {
       for(size_t by=0; by<m_nb_blocks_y; ++by)
         for(size_t bx=0; bx<m_nb_blocks_x; ++bx)
         {
-          blitz::Range ry(by,by+m_block_y-1);
-          blitz::Range rx(bx,bx+m_block_x-1);
+          const size_t cy = by*(m_block_y-m_block_ov_y);
+          const size_t cx = bx*(m_block_x-m_block_ov_x);
+          blitz::Range ry(cy,cy+m_block_y-1);
+          blitz::Range rx(cx,cx+m_block_x-1);
           blitz::Array<double,3> cells_block = m_cell_descriptor(ry,rx,rall);
           blitz::Array<double,1> block = output(by,bx,rall);
           normalizeBlock_(cells_block, block, m_block_norm, 
@@ -87,6 +87,25 @@ namespace bob { namespace ip {
       mutable std::string m_message;
   };
 
+  /**
+    * This exception is thrown when a (y,x) position, e.g., a node of a
+    * Gabor graph, lies outside of the image
+   */
+  class PositionOutOfImage: public Exception {
+    public:
+      PositionOutOfImage(const int y, const int x, const int height,
+        const int width) throw();
+      virtual ~PositionOutOfImage() throw();
+      virtual const char* what() const throw();
+
+    private:
+      int m_y;
+      int m_x;
+      int m_height;
+      int m_width;
+      mutable std::string m_message;
+  };
+
 }}
 
 #endif /* BOB_IP_EXCEPTION_H */
@@ -24,6 +24,7 @@
 #include <boost/shared_ptr.hpp>
 #include "bob/core/assert.h"
 #include "bob/core/check.h"
+#include "bob/core/parallel.h"
 #include "bob/ip/GeomNorm.h"
 #include "bob/ip/rotate.h"
 
@@ -118,6 +119,27 @@ namespace bob {
           blitz::Array<bool,2>& dst_mask, const double e1_y, const double e1_x,
           const double e2_y, const double e2_x) const;
 
+        /**
+          * @brief Process a batch of N face images of identical size by
+          * applying the geometric normalization. Row i of eye_positions
+          * contains the coordinates (e1_y, e1_x, e2_y, e2_x) of the eyes
+          * in image i. The images are distributed over the given number of
+          * threads (0: all cores).
+          *
+          * Unlike the single image versions, this function does
+          * not modify this object (i.e., getLastAngle(), getLastScale() and
+          * getGeomNorm() are not updated), so that it can be called
+          * concurrently.
+          */
+        template <typename T> void operator()(const blitz::Array<T,3>& src, 
+          const blitz::Array<double,2>& eye_positions, 
+          blitz::Array<double,3>& dst, const size_t number_of_threads=1) const;
+        template <typename T> void operator()(const blitz::Array<T,3>& src, 
+          const blitz::Array<bool,3>& src_mask, 
+          const blitz::Array<double,2>& eye_positions, 
+          blitz::Array<double,3>& dst, blitz::Array<bool,3>& dst_mask, 
+          const size_t number_of_threads=1) const;
+
         /**
          * @brief Getter function for the bob::ip::GeomNorm object that is doing the job.
          *
@@ -134,6 +156,19 @@ namespace bob {
           blitz::Array<bool,2>& dst_mask, const double e1_y, const double e1_x,
           const double e2_y, const double e2_x) const;
 
+        template <typename T, bool mask> 
+        void processBatch(size_t, size_t begin, size_t end,
+          const blitz::Array<T,3>& src, const blitz::Array<bool,3>& src_mask,
+          const blitz::Array<double,2>& eye_positions,
+          blitz::Array<double,3>& dst, blitz::Array<bool,3>& dst_mask) const;
+
+        /**
+          * @brief Returns the geometric normalization for the given eye
+          * positions, without modifying this object
+          */
+        GeomNorm computeGeomNorm(const double e1_y, const double e1_x,
+          const double e2_y, const double e2_x) const;
+
         /**
           * Attributes
           */
@@ -196,12 +231,11 @@ namespace bob {
       blitz::Array<bool,2>& dst_mask, const double e1_y, const double e1_x,
       const double e2_y, const double e2_x) const
     { 
-      // Get angle to horizontal
-      m_cache_angle = getAngleToHorizontal(e1_y, e1_x, e2_y, e2_x) - m_eyes_angle;
+      // Get angle to horizontal and scaling factor
+      const GeomNorm geom_norm = computeGeomNorm(e1_y, e1_x, e2_y, e2_x);
+      m_cache_angle = geom_norm.getRotationAngle();
       m_geom_norm->setRotationAngle(m_cache_angle);
-
-      // Get scaling factor
-      m_cache_scale = m_eyes_distance / sqrt( (e1_y-e2_y)*(e1_y-e2_y) + (e1_x-e2_x)*(e1_x-e2_x) );
+      m_cache_scale = geom_norm.getScalingFactor();
       m_geom_norm->setScalingFactor(m_cache_scale);
 
       // Get the center (of the eye centers segment)
@@ -215,6 +249,99 @@ namespace bob {
         m_geom_norm->operator()(src, dst, center_y, center_x);
     }
 
+    template <typename T> 
+    inline void bob::ip::FaceEyesNorm::operator()(const blitz::Array<T,3>& src, 
+      const blitz::Array<double,2>& eye_positions, 
+      blitz::Array<double,3>& dst, const size_t number_of_threads) const
+    {
+      // Check input
+      bob::core::array::assertZeroBase(src);
+      bob::core::array::assertZeroBase(eye_positions);
+      bob::core::array::assertSameDimensionLength(eye_positions.extent(0), src.extent(0));
+      bob::core::array::assertSameDimensionLength(eye_positions.extent(1), 4);
+
+      // Check output
+      bob::core::array::assertZeroBase(dst);
+      bob::core::array::assertSameShape(dst, blitz::shape(src.extent(0), m_out_shape(0), m_out_shape(1)));
+
+      // Process
+      blitz::Array<bool,3> src_mask, dst_mask;
+      bob::core::parallel_for(src.extent(0), 
+        boost::bind(&FaceEyesNorm::processBatch<T,false>, this, _1, _2, _3, 
+          boost::cref(src), boost::cref(src_mask), boost::cref(eye_positions),
+          boost::ref(dst), boost::ref(dst_mask)),
+        number_of_threads);
+    }
+
+    template <typename T> 
+    inline void bob::ip::FaceEyesNorm::operator()(const blitz::Array<T,3>& src, 
+      const blitz::Array<bool,3>& src_mask, 
+      const blitz::Array<double,2>& eye_positions, 
+      blitz::Array<double,3>& dst, blitz::Array<bool,3>& dst_mask, 
+      const size_t number_of_threads) const
+    {
+      // Check input
+      bob::core::array::assertZeroBase(src);
+      bob::core::array::assertZeroBase(src_mask);
+      bob::core::array::assertSameShape(src, src_mask);
+      bob::core::array::assertZeroBase(eye_positions);
+      bob::core::array::assertSameDimensionLength(eye_positions.extent(0), src.extent(0));
+      bob::core::array::assertSameDimensionLength(eye_positions.extent(1), 4);
+
+      // Check output
+      bob::core::array::assertZeroBase(dst);
+      bob::core::array::assertZeroBase(dst_mask);
+      bob::core::array::assertSameShape(dst, dst_mask);
+      bob::core::array::assertSameShape(dst, blitz::shape(src.extent(0), m_out_shape(0), m_out_shape(1)));
+
+      // Process
+      bob::core::parallel_for(src.extent(0), 
+        boost::bind(&FaceEyesNorm::processBatch<T,true>, this, _1, _2, _3, 
+          boost::cref(src), boost::cref(src_mask), boost::cref(eye_positions),
+          boost::ref(dst), boost::ref(dst_mask)),
+        number_of_threads);
+    }
+
+    namespace detail {
+      /**
+       * @brief Wraps the i-th image of a batch from its data. Slicing the
+       *   shared batch inside the workers is not thread-safe, as it updates
+       *   the reference count of the underlying blitz memory block.
+       */
+      template <typename T>
+      inline blitz::Array<T,2> image_at(const blitz::Array<T,3>& a, const int i)
+      {
+        return blitz::Array<T,2>(const_cast<T*>(a.data()) + i * a.stride(0),
+          blitz::shape(a.extent(1), a.extent(2)),
+          blitz::shape(a.stride(1), a.stride(2)), blitz::neverDeleteData);
+      }
+    }
+
+    template <typename T, bool mask> 
+    inline void bob::ip::FaceEyesNorm::processBatch(size_t, size_t begin, 
+      size_t end, const blitz::Array<T,3>& src, 
+      const blitz::Array<bool,3>& src_mask, 
+      const blitz::Array<double,2>& eye_positions,
+      blitz::Array<double,3>& dst, blitz::Array<bool,3>& dst_mask) const
+    {
+      for (int i = begin; i < (int)end; ++i){
+        const double e1_y = eye_positions(i,0), e1_x = eye_positions(i,1),
+                     e2_y = eye_positions(i,2), e2_x = eye_positions(i,3);
+        const GeomNorm geom_norm = computeGeomNorm(e1_y, e1_x, e2_y, e2_x);
+        const double center_y = (e1_y + e2_y) / 2., center_x = (e1_x + e2_x) / 2.;
+
+        const blitz::Array<T,2> src_slice = detail::image_at(src, i);
+        blitz::Array<double,2> dst_slice = detail::image_at(dst, i);
+        if (mask){
+          const blitz::Array<bool,2> src_mask_slice = detail::image_at(src_mask, i);
+          blitz::Array<bool,2> dst_mask_slice = detail::image_at(dst_mask, i);
+          geom_norm(src_slice, src_mask_slice, dst_slice, dst_mask_slice, center_y, center_x);
+        } else {
+          geom_norm(src_slice, dst_slice, center_y, center_x);
+        }
+      }
+    }
+
   }
 /**
  * @}
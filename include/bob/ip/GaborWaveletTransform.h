@@ -139,6 +139,13 @@ namespace bob {
           blitz::Array<std::complex<double>,3>& trafo_image
         );
 
+        //! \brief performs Gabor wavelet transform of a real-valued image and returns vector of complex images
+        //! (using a real-to-complex Fourier transform)
+        void performGWT(
+          const blitz::Array<double,2>& gray_image,
+          blitz::Array<std::complex<double>,3>& trafo_image
+        );
+
         //! \brief performs Gabor wavelet transform and creates 4D image
         //! (absolute part and phase part)
         void computeJetImage(
@@ -147,6 +154,14 @@ namespace bob {
           bool do_normalize = true
         );
 
+        //! \brief performs Gabor wavelet transform of a real-valued image and creates 4D image
+        //! (absolute part and phase part)
+        void computeJetImage(
+          const blitz::Array<double,2>& gray_image,
+          blitz::Array<double,4>& jet_image,
+          bool do_normalize = true
+        );
+
         //! \brief performs Gabor wavelet transform and creates 3D image
         //! (absolute parts of the responses only)
         void computeJetImage(
@@ -155,6 +170,47 @@ namespace bob {
           bool do_normalize = true
         );
 
+        //! \brief performs Gabor wavelet transform of a real-valued image and creates 3D image
+        //! (absolute parts of the responses only)
+        void computeJetImage(
+          const blitz::Array<double,2>& gray_image,
+          blitz::Array<double,3>& jet_image,
+          bool do_normalize = true
+        );
+
+        //! \brief sets the number of threads that are used to compute the Gabor wavelet transform;
+        //! 0 means: use all available cores
+        void setNumberOfThreads(unsigned number_of_threads){m_number_of_threads = number_of_threads;}
+        //! returns the number of threads that are used to compute the Gabor wavelet transform
+        unsigned numberOfThreads() const {return m_number_of_threads;}
+
+        //! \brief generates the truncated spatial domain Gabor wavelets for the given resolution.
+        //! Wavelet values below epsilon times the maximum absolute value of the wavelet are discarded.
+        void generateSpatialKernels(blitz::TinyVector<unsigned,2> resolution, double epsilon = 1e-6);
+
+        //! returns the spatial domain Gabor wavelet with the given index, centered in the returned array
+        const blitz::Array<std::complex<double>,2>& getSpatialKernel(unsigned index) const {if (index < m_spatial_kernels.size()) return m_spatial_kernels[index]; else throw bob::core::Exception();}
+
+        //! \brief computes the Gabor jets (absolute part and phase part) only at the given (y,x) positions,
+        //! by convolving the image with the truncated spatial domain Gabor wavelets;
+        //! throws bob::ip::PositionOutOfImage if a position lies outside of the image
+        void computeGraphJets(
+          const blitz::Array<std::complex<double>,2>& gray_image,
+          const blitz::Array<int,2>& positions,
+          blitz::Array<double,3>& graph_jets,
+          bool do_normalize = true
+        );
+
+        //! \brief computes the Gabor jets (absolute parts of the responses only) only at the given (y,x) positions,
+        //! by convolving the image with the truncated spatial domain Gabor wavelets;
+        //! throws bob::ip::PositionOutOfImage if a position lies outside of the image
+        void computeGraphJets(
+          const blitz::Array<std::complex<double>,2>& gray_image,
+          const blitz::Array<int,2>& positions,
+          blitz::Array<double,2>& graph_jets,
+          bool do_normalize = true
+        );
+
         //! \brief saves the parameters of this Gabor wavelet family to file
         void save(bob::io::HDF5File& file) const;
 
@@ -165,6 +221,24 @@ namespace bob {
 
         void computeKernelFrequencies();
 
+        void computeFrequencyImage(const blitz::Array<std::complex<double>,2>& gray_image);
+        void computeFrequencyImage(const blitz::Array<double,2>& gray_image);
+
+        void transformFrequencyImage(blitz::Array<std::complex<double>,3>& trafo_image);
+        void transformFrequencyImage(blitz::Array<double,4>& jet_image, bool do_normalize);
+        void transformFrequencyImage(blitz::Array<double,3>& jet_image, bool do_normalize);
+
+        unsigned prepareThreads();
+        void transformLayers(size_t thread, size_t begin, size_t end, blitz::Array<std::complex<double>,3>& trafo_image);
+        void transformJets(size_t thread, size_t begin, size_t end, blitz::Array<double,4>& jet_image);
+        void transformAbsJets(size_t thread, size_t begin, size_t end, blitz::Array<double,3>& jet_image);
+
+        void computeSpatialResponses(
+          const blitz::Array<std::complex<double>,2>& gray_image,
+          int y,
+          int x
+        );
+
         double m_sigma;
         double m_pow_of_k;
         double m_k_max;
@@ -176,13 +250,25 @@ namespace bob {
 
         bob::sp::FFT2D m_fft;
         bob::sp::IFFT2D m_ifft;
+        bob::sp::RealFFT2D m_rfft;
 
         blitz::Array<std::complex<double>,2> m_temp_array, m_frequency_image;
+        // one temporary array per thread
+        std::vector<blitz::Array<std::complex<double>,2> > m_thread_arrays;
+
+        // the truncated Gabor wavelets in spatial domain, centered in their arrays
+        std::vector<blitz::Array<std::complex<double>,2> > m_spatial_kernels;
+        blitz::TinyVector<unsigned,2> m_spatial_resolution;
+        double m_spatial_epsilon;
+        // the responses of all Gabor wavelets at one position
+        blitz::Array<std::complex<double>,1> m_spatial_responses;
 
         //! The number of scales (levels, frequencies) of this family
         unsigned m_number_of_scales;
         //! The number of directions (orientations) of this family
         unsigned m_number_of_directions;
+        //! The number of threads used to compute the transform
+        unsigned m_number_of_threads;
     }; // class GaborWaveletTransform
 
     //! Normalizes a Gabor jet (vector of absolute values) to unit length
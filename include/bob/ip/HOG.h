@@ -35,6 +35,33 @@ namespace bob {
  */
   namespace ip {
 
+    namespace detail {
+      /**
+        * @brief Computes the two (neighbouring) bins to which a gradient
+        *   with the given orientation contributes, and the weight of the
+        *   first bin (the second one gets 1-weight).
+        */
+      inline void hogBins(const double orientation, const int nb_bins,
+        const double range_orientation, int& bin_index1, int& bin_index2,
+        double& weight)
+      {
+        // Computes "real" value of the closest bin
+        double bin = orientation / range_orientation * nb_bins;
+        // Computes the value of the "inferior" bin 
+        // ("superior" bin corresponds to the one after the inferior bin)
+        bin_index1 = floor(bin);
+        // Computes the weight for the "inferior" bin
+        weight = 1.-(bin-bin_index1);
+
+        // Computes integer indices in the range [0,nb_bins-1]
+        bin_index1 = bin_index1 % nb_bins;
+        // Additional check, because bin can be negative (hence bin_index1 as well, as an integer remainder)
+        if(bin_index1<0) bin_index1+=nb_bins; 
+        // bin_index1 and nb_bins are positive. Thus, bin_index2 (integer remainder) as well!
+        bin_index2 = (bin_index1+1) % nb_bins; 
+      }
+    }
+
     /**
       * @brief Function which computes an Histogram of Gradients for
       *   a given 'cell'. The inputs are the gradient magnitudes and the
@@ -249,6 +276,182 @@ namespace bob {
       forward_(input, output);
     }
 
+
+    /**
+      * @brief Class to extract HOG descriptors densely, e.g., for a sliding
+      *   window detector.
+      *   Instead of processing each window independently, the gradients
+      *   are computed once on the full image, and for each orientation bin,
+      *   an integral image of the (bilinearly binned) gradient magnitudes is
+      *   built. Afterwards, the histogram of any cell, and hence the
+      *   descriptor of any window, can be obtained with four look-ups per
+      *   bin.
+      *   The window size, the cell and block decompositions, the gradient
+      *   magnitude type and the block normalization are taken from a HOG
+      *   extractor. The descriptor of a window is identical to the one
+      *   computed by this HOG extractor on the window, except for the
+      *   gradients at the window border, which are computed with centered
+      *   differences using the neighbouring image pixels.
+      */
+    class DenseHOG
+    {
+      public:
+        /**
+          * Constructor, which takes the parameters of the given HOG
+          * extractor; its height and width define the window size.
+          */
+        template <typename T>
+        DenseHOG(const HOG<T>& hog);
+
+        /**
+          * Computes the gradient maps and the integral histograms of the
+          * given image
+          */
+        template <typename T>
+        void setImage(const blitz::Array<T,2>& image);
+
+        /**
+          * Returns the height and the width of the current image
+          */
+        size_t getImageHeight() const { return m_magnitude.extent(0); }
+        size_t getImageWidth() const { return m_magnitude.extent(1); }
+        /**
+          * Returns the number of bins of a cell histogram
+          */
+        size_t getCellDim() const { return m_cell_dim; }
+
+        /**
+          * Returns the shape of the descriptor of one window, which is
+          * identical to the output shape of the HOG extractor.
+          */
+        const blitz::TinyVector<int,3> getOutputShape() const;
+
+        /**
+          * Returns the shape (number of windows along Y x number of
+          * windows along X x descriptor length) of the output of
+          * descriptors() for the given window steps
+          */
+        const blitz::TinyVector<int,3> getGridShape(const size_t step_y,
+          const size_t step_x) const;
+
+        /**
+          * Computes the histogram of the orientations in the rectangle of
+          * the given size at the given (top-left) position of the image.
+          */
+        void histogram(const int y, const int x, const int height,
+          const int width, blitz::Array<double,1>& hist) const;
+
+        /**
+          * Computes the HOG descriptor of the window at the given (top-left)
+          * position of the image. The output is 3D, the first two dimensions
+          * being the y- and x- indices of the block, and the last one the
+          * index of the bin (among the concatenated cell histograms for
+          * this block).
+          */
+        void descriptor(const int y, const int x,
+          blitz::Array<double,3>& output) const;
+
+        /**
+          * Computes the HOG descriptors of all windows that fit into the
+          * image, at positions which are multiples of the given steps. The
+          * descriptor of the window at position (i*step_y, j*step_x) is
+          * stored in output(i,j,:) as a 1D vector. The rows of windows are
+          * distributed over the given number of threads (0: all cores).
+          */
+        void descriptors(const size_t step_y, const size_t step_x,
+          blitz::Array<double,3>& output,
+          const size_t number_of_threads=1) const;
+
+      private:
+        /**
+          * Computes the integral histograms from the gradient maps
+          */
+        void computeIntegral();
+
+        /**
+          * Computes the descriptor of the window at the given position into
+          * the given (contiguous) 1D output, using the given cell cache
+          */
+        void descriptor_(const int y, const int x,
+          blitz::Array<double,3>& cells, blitz::Array<double,1>& output) const;
+
+        /**
+          * Computes the descriptors of the window rows [begin, end)
+          */
+        void descriptorRows(size_t, size_t begin, size_t end,
+          const size_t step_y, const size_t step_x,
+          blitz::Array<double,3>& output) const;
+
+        // Window size
+        size_t m_height;
+        size_t m_width;
+        // Cell and block decompositions
+        size_t m_cell_dim;
+        bool m_full_orientation;
+        size_t m_cell_y;
+        size_t m_cell_x;
+        size_t m_cell_ov_y;
+        size_t m_cell_ov_x;
+        size_t m_nb_cells_y;
+        size_t m_nb_cells_x;
+        size_t m_block_y;
+        size_t m_block_x;
+        size_t m_block_ov_y;
+        size_t m_block_ov_x;
+        size_t m_nb_blocks_y;
+        size_t m_nb_blocks_x;
+        BlockNorm m_block_norm;
+        double m_block_norm_eps;
+        double m_block_norm_threshold;
+        // Gradient maps of the current image
+        GradientMaps m_gradient_maps;
+        blitz::Array<double,2> m_magnitude;
+        blitz::Array<double,2> m_orientation;
+        // Integral histograms (height+1 x width+1 x bins)
+        blitz::Array<double,3> m_integral;
+    };
+
+    template <typename T>
+    DenseHOG::DenseHOG(const HOG<T>& hog):
+      m_height(hog.getHeight()), m_width(hog.getWidth()),
+      m_cell_dim(hog.getCellDim()),
+      m_full_orientation(hog.getFullOrientation()),
+      m_cell_y(hog.getCellHeight()), m_cell_x(hog.getCellWidth()),
+      m_cell_ov_y(hog.getCellOverlapHeight()),
+      m_cell_ov_x(hog.getCellOverlapWidth()),
+      m_block_y(hog.getBlockHeight()), m_block_x(hog.getBlockWidth()),
+      m_block_ov_y(hog.getBlockOverlapHeight()),
+      m_block_ov_x(hog.getBlockOverlapWidth()),
+      m_block_norm(hog.getBlockNorm()),
+      m_block_norm_eps(hog.getBlockNormEps()),
+      m_block_norm_threshold(hog.getBlockNormThreshold()),
+      m_gradient_maps(0, 0, hog.getGradientMagnitudeType())
+    {
+      const blitz::TinyVector<int,3> shape = hog.getOutputShape();
+      const blitz::TinyVector<int,4> nb_cells = getBlock4DOutputShape(
+          m_height, m_width, m_cell_y, m_cell_x, m_cell_ov_y, m_cell_ov_x);
+      m_nb_cells_y = nb_cells(0);
+      m_nb_cells_x = nb_cells(1);
+      m_nb_blocks_y = shape(0);
+      m_nb_blocks_x = shape(1);
+    }
+
+    template <typename T>
+    void DenseHOG::setImage(const blitz::Array<T,2>& image)
+    {
+      bob::core::array::assertZeroBase(image);
+      if ((size_t)image.extent(0) < m_height || (size_t)image.extent(1) < m_width)
+        throw bob::core::InvalidArgumentException("The image must not be smaller than the window of the HOG extractor");
+
+      // Computes the gradient maps on the full image
+      m_gradient_maps.resize(image.extent(0), image.extent(1));
+      m_magnitude.resize(image.extent(0), image.extent(1));
+      m_orientation.resize(image.extent(0), image.extent(1));
+      m_gradient_maps.forward_(image, m_magnitude, m_orientation);
+
+      computeIntegral();
+    }
+
   }
 
 /**
@@ -30,12 +30,13 @@
 #include <math.h>
 #include <stdint.h>
 #include <numeric>
+#include <vector>
 
 #include <blitz/array.h>
 
 #include <bob/ip/Exception.h>
 #include <bob/core/assert.h>
-#include <bob/sp/interpolate.h>
+#include <bob/core/parallel.h>
 
 
 namespace bob { namespace ip {
@@ -165,9 +166,12 @@ namespace bob { namespace ip {
       /**
        * Extract LBP features from a 2D blitz::Array, and save
        *   the resulting LBP codes in the dst 2D blitz::Array.
+       *   The image is processed row by row; the rows can be distributed
+       *   over the given number of threads (0: all cores).
        */
       template <typename T>
-        void operator()(const blitz::Array<T,2>& src, blitz::Array<uint16_t,2>& dst) const;
+        void operator()(const blitz::Array<T,2>& src, blitz::Array<uint16_t,2>& dst,
+          const size_t number_of_threads=1) const;
 
       /**
        * Extract the LBP code of a 2D blitz::Array at the given
@@ -202,6 +206,39 @@ namespace bob { namespace ip {
       template <typename T>
         uint16_t lbp_code(const blitz::Array<T,2>& src, int y, int x) const;
 
+      /**
+       * Extract the LBP codes of the output rows [begin, end)
+       */
+      template <typename T>
+        void lbp_rows(size_t, size_t begin, size_t end, const blitz::Array<T,2>& src,
+          blitz::Array<uint16_t,2>& dst) const;
+
+      /**
+       * Compute the horizontal interpolation of the (circular) neighbors of
+       * the pixels x ... x+width-1, which is identical for all rows. For
+       * neighbor p and pixel i, the two columns and their weights are stored
+       * at index 2*(p*width+i) and 2*(p*width+i)+1 of columns and weights.
+       */
+      void interpolation_columns(int x, int width, int* columns, double* weights) const;
+
+      /**
+       * Sample the neighbors of the pixels (y, x) ... (y, x+width-1) of src.
+       * The values of neighbor p are stored in values[p*width] ... values[p*width + width-1],
+       * the values of the central pixels in center. For circular LBP's, the
+       * columns and weights of interpolation_columns() are required.
+       */
+      template <typename T>
+        void sample(const blitz::Array<T,2>& src, int y, int x, int width,
+          const int* columns, const double* weights, double* values, double* center) const;
+
+      /**
+       * Compute the LBP codes of width pixels from their sampled neighbors
+       * and central values, and convert them using the look up table.
+       * The scratch buffer needs to have width elements.
+       */
+      void lbp_codes(const double* values, const double* center, int width,
+          double* scratch, uint16_t* codes) const;
+
       /**
        * Attributes
        */
@@ -236,18 +273,17 @@ namespace bob { namespace ip {
 
 
   template <typename T>
-    inline void LBP::operator()(const blitz::Array<T,2>& src, blitz::Array<uint16_t,2>& dst) const
+    inline void LBP::operator()(const blitz::Array<T,2>& src, blitz::Array<uint16_t,2>& dst,
+        const size_t number_of_threads) const
     {
       bob::core::array::assertZeroBase(src);
       bob::core::array::assertZeroBase(dst);
       bob::core::array::assertSameShape(dst, getLBPShape(src) );
 
-      // offset in the source image
-      const int r_y = (int)ceil(m_R_y), r_x = (int)ceil(m_R_x);
-      // iterate over target pixels
-      for (int y = 0; y < dst.extent(0); ++y)
-        for (int x = 0; x < dst.extent(1); ++x)
-          dst(y, x) = lbp_code(src, y + r_y, x + r_x);
+      // iterate over target rows
+      bob::core::parallel_for(dst.extent(0),
+          boost::bind(&LBP::lbp_rows<T>, this, _1, _2, _3, boost::cref(src), boost::ref(dst)),
+          number_of_threads);
     }
 
 
@@ -266,58 +302,72 @@ namespace bob { namespace ip {
 
   template <typename T>
   inline uint16_t LBP::lbp_code(const blitz::Array<T,2>& src, int y, int x) const{
-    std::vector<double> pixels(m_P);
-    if (m_circular)
-      for (int p = 0; p < m_P; ++p)
-        pixels[p] = bob::sp::detail::bilinearInterpolationNoCheck(src, y + m_positions(p,0), x + m_positions(p,1));
-    else
-      for (int p = 0; p < m_P; ++p){
-        pixels[p] = static_cast<double>(src(y + static_cast<int>(m_positions(p,0)), x + static_cast<int>(m_positions(p,1))));
-      }
+    // at most 16 neighbors are supported
+    int columns[32];
+    double weights[32], pixels[16], center, scratch;
+    uint16_t lbp_code;
+    if (m_circular) interpolation_columns(x, 1, columns, weights);
+    sample(src, y, x, 1, columns, weights, pixels, &center);
+    lbp_codes(pixels, &center, 1, &scratch, &lbp_code);
+    return lbp_code;
+  }
 
-    double center = static_cast<double>(src(y, x));
-    double cmp_point = center;
-    if (m_to_average)
-      cmp_point = std::accumulate(pixels.begin(), pixels.end(), center) / (m_P + 1); // /(P+1) since (averaged over P+1 points)
-
-    // the formulas are implemented from Cosmin's thesis
-    uint16_t lbp_code = 0;
-    switch (m_eLBP_type){
-      case ELBP_REGULAR:{
-        for (int p = 0; p < m_P; ++p){
-          lbp_code <<= 1;
-          if (pixels[p] > cmp_point || bob::core::isClose(pixels[p], cmp_point)) ++lbp_code;
-        }
-        if (m_add_average_bit && !m_rotation_invariant && !m_uniform)
-        {
-          lbp_code <<= 1;
-          if (center > cmp_point || bob::core::isClose(center, cmp_point)) ++lbp_code;
-        }
-        break;
-      }
 
-      case ELBP_TRANSITIONAL:{
-        for (int p = 0; p < m_P; ++p){
-          lbp_code <<= 1;
-          if (pixels[p] > pixels[(p+1)%m_P] || bob::core::isClose(pixels[p], pixels[(p+1)%m_P])) ++lbp_code;
-        }
-        break;
-      }
+  template <typename T>
+  inline void LBP::lbp_rows(size_t, size_t begin, size_t end, const blitz::Array<T,2>& src,
+      blitz::Array<uint16_t,2>& dst) const{
+    // offset in the source image
+    const int r_y = (int)ceil(m_R_y), r_x = (int)ceil(m_R_x);
+    const int width = dst.extent(1);
+    if (!width) return;
+    // buffers for one row, which are re-used for all rows
+    std::vector<double> values(m_P * width + 1), center(width + 1), scratch(width + 1);
+    std::vector<uint16_t> codes(width + 1);
+    // the horizontal interpolation is the same for all rows
+    std::vector<int> columns(2 * m_P * width + 1);
+    std::vector<double> weights(2 * m_P * width + 1);
+    if (m_circular) interpolation_columns(r_x, width, &columns[0], &weights[0]);
+
+    for (int y = begin; y < (int)end; ++y){
+      sample(src, y + r_y, r_x, width, &columns[0], &weights[0], &values[0], &center[0]);
+      lbp_codes(&values[0], &center[0], width, &scratch[0], &codes[0]);
+      for (int x = 0; x < width; ++x)
+        dst(y, x) = codes[x];
+    }
+  }
 
-      case ELBP_DIRECTION_CODED:{
-        int p_half = m_P/2;
-        for (int p = 0; p < p_half; ++p){
-          lbp_code <<= 2;
-          if ((pixels[p] - cmp_point) * (pixels[p+p_half] - cmp_point) >= 0.) lbp_code += 1;
-          double p1 = std::abs(pixels[p] - cmp_point), p2 = std::abs(pixels[p+p_half] - cmp_point);
-          if ( p1 > p2 || bob::core::isClose(p1, p2) ) lbp_code += 2;
+
+  template <typename T>
+  inline void LBP::sample(const blitz::Array<T,2>& src, int y, int x, int width,
+      const int* columns, const double* weights, double* values, double* center) const{
+    const int stride = src.stride(1);
+    // the central pixels
+    const T* row = &src(y, x);
+    for (int i = 0; i < width; ++i)
+      center[i] = static_cast<double>(row[i * stride]);
+
+    for (int p = 0; p < m_P; ++p, values += width){
+      if (!m_circular){
+        // rectangular LBP's sample on the pixel grid
+        const T* r = &src(y + static_cast<int>(m_positions(p,0)), x + static_cast<int>(m_positions(p,1)));
+        for (int i = 0; i < width; ++i)
+          values[i] = static_cast<double>(r[i * stride]);
+      } else {
+        // bilinear interpolation, computed exactly as bob::sp::detail::bilinearInterpolationNoCheck()
+        const double py = y + m_positions(p,0);
+        const int yl = static_cast<int>(floor(py)), yh = static_cast<int>(ceil(py));
+        const double wy = yh - py;
+        const T* low = &src(yl, 0), * high = &src(yh, 0);
+        const int* c = columns + 2 * p * width;
+        const double* w = weights + 2 * p * width;
+        for (int i = 0; i < width; ++i){
+          const int xl = c[2*i] * stride, xh = c[2*i+1] * stride;
+          const double Il = w[2*i] * low[xl] + w[2*i+1] * low[xh];
+          const double Ih = w[2*i] * high[xl] + w[2*i+1] * high[xh];
+          values[i] = wy * Il + (1 - wy) * Ih;
         }
-        break;
       }
     }
-
-    // convert the lbp code according to the requested setup (uniform, rotation invariant, ...)
-    return m_lut(lbp_code);
   }
 
 } }
@@ -24,12 +24,10 @@
 #ifndef BOB_IP_LBPHS_FEATURES_H
 #define BOB_IP_LBPHS_FEATURES_H
 
-#include "bob/core/cast.h"
+#include "bob/core/assert.h"
 #include "bob/ip/Exception.h"
 #include "bob/ip/block.h"
-#include "bob/ip/histo.h"
 #include "bob/ip/LBP.h"
-#include <list>
 
 namespace bob {
 /**
@@ -85,7 +83,21 @@ namespace bob {
         *   of 1D uint32_t blitz arrays.
         */
       template <typename T, typename U>
-      void operator()(const blitz::Array<T,2>& src, U& dst);
+      void operator()(const blitz::Array<T,2>& src, U& dst) const;
+
+      /**
+        * @brief Process a 2D blitz Array/Image by extracting LBPHS features,
+        *   writing the histogram of block i into row i of dst.
+        *   The LBP codes of the whole image are computed only once, and
+        *   the block histograms are derived from them, so that the codes of
+        *   overlapping blocks are not recomputed.
+        * @param src The 2D input blitz array
+        * @param dst The 2D output array of histograms, which must have the
+        *   shape returned by getOutputShape()
+        */
+      template <typename T>
+      void operator()(const blitz::Array<T,2>& src,
+        blitz::Array<uint64_t,2>& dst) const;
 
       /**
         * @brief Function which returns the number of blocks when applying
@@ -95,14 +107,36 @@ namespace bob {
         * @param src The input blitz array
         */
       template<typename T>
-      const int getNBlocks(const blitz::Array<T,2>& src);
+      const int getNBlocks(const blitz::Array<T,2>& src) const;
+
+      /**
+        * @brief Returns the shape (N_blocks, N_bins) of the 2D array of
+        *   histograms when applying the LBPHSFeatures extractor on a 2D
+        *   blitz::array/image.
+        * @param src The input blitz array
+        */
+      template<typename T>
+      const blitz::TinyVector<int,2> getOutputShape(const blitz::Array<T,2>& src) const
+      { return blitz::TinyVector<int,2>(getNBlocks(src), getNBins()); }
 
       /**
         * @brief Returns the number of bins in each LBP histogram
         */
-      inline const uint64_t getNBins() { return m_lbp.getMaxLabel(); }
+      inline const uint64_t getNBins() const { return m_lbp.getMaxLabel(); }
 
     private:
+      /**
+        * @brief Computes the histograms of all blocks from the LBP codes of
+        *   the whole image.
+        *   Depending on the number of blocks and bins, the histograms are
+        *   either counted directly, or they are derived from an integral
+        *   histogram over the cells that the block borders cut the image
+        *   into, which needs four look-ups per bin and block.
+        */
+      void histograms(const int height, const int width,
+        const blitz::Array<uint16_t,2>& codes,
+        blitz::Array<uint64_t,2>& dst) const;
+
       /**
         * Attributes
         */
@@ -117,35 +151,33 @@ namespace bob {
 
   template <typename T, typename U>
   void LBPHSFeatures::operator()(const blitz::Array<T,2>& src,
-    U& dst)
+    U& dst) const
+  {
+    blitz::Array<uint64_t,2> histos(getOutputShape(src));
+    operator()(src, histos);
+
+    // Push the histogram of each block in the container
+    for (int i = 0; i < histos.extent(0); ++i)
+      dst.push_back(histos(i, blitz::Range::all()));
+  }
+
+  template <typename T>
+  void LBPHSFeatures::operator()(const blitz::Array<T,2>& src,
+    blitz::Array<uint64_t,2>& dst) const
   {
-    // cast to double
-    blitz::Array<double,2> double_version = bob::core::array::cast<double>(src);
+    bob::core::array::assertZeroBase(dst);
+    bob::core::array::assertSameShape(dst, getOutputShape(src));
 
-    // get all the blocks
-    std::list<blitz::Array<double,2> > blocks;
-    blockReference(double_version, blocks, m_block_h, m_block_w, m_overlap_h, m_overlap_w);
+    // extract the lbp codes of the whole image once
+    blitz::Array<uint16_t,2> codes(m_lbp.getLBPShape(src));
+    m_lbp(src, codes);
 
     // compute an lbp histogram for each block
-    for( std::list<blitz::Array<double,2> >::const_iterator it = blocks.begin();
-      it != blocks.end(); ++it)
-    {
-      // extract lbp using operator()
-      blitz::Array<uint16_t,2> lbp_tmp_block(m_lbp.getLBPShape(*it));
-      m_lbp(*it, lbp_tmp_block);
-
-      // Compute the LBP histogram
-      blitz::Array<uint64_t, 1> lbp_histo(m_lbp.getMaxLabel());
-      histogram<uint16_t>(lbp_tmp_block, lbp_histo, 0, m_lbp.getMaxLabel()-1,
-        m_lbp.getMaxLabel());
-
-      // Push the resulting processed block in the container
-      dst.push_back(lbp_histo);
-    }
+    histograms(src.extent(0), src.extent(1), codes, dst);
   }
 
   template<typename T>
-  const int LBPHSFeatures::getNBlocks(const blitz::Array<T,2>& src)
+  const int LBPHSFeatures::getNBlocks(const blitz::Array<T,2>& src) const
   {
     const blitz::TinyVector<int,3> res = getBlock3DOutputShape(src, m_block_h,
       m_block_w, m_overlap_h, m_overlap_w);
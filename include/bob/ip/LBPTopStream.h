@@ -0,0 +1,197 @@
+/**
+ * @file bob/ip/LBPTopStream.h
+ * @date Fri Jun 14 10:12:36 2013 +0200
+ * @author Manuel Guenther <Manuel.Guenther@idiap.ch>
+ *
+ * @brief Computes LBP-Top planes incrementally over a stream of video frames
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_IP_LBPTOP_STREAM_H
+#define BOB_IP_LBPTOP_STREAM_H
+
+#include <blitz/array.h>
+#include <stdint.h>
+#include "bob/core/assert.h"
+#include "bob/ip/LBP.h"
+#include "bob/ip/LBPTop.h"
+
+namespace bob { namespace ip {
+
+  /**
+   * The LBPTopStream class computes the LBP-Top planes of a video that is
+   * given frame by frame, e.g., while reading it with a
+   * bob::io::VideoReader, instead of as a whole 3D array.
+   *
+   * The workflow is as follows:
+   * 1. You initialize the class with the three LBP operators of the XY, XT
+   * and YT planes, or with an LBPTop object.
+   * 2. You push() the frames of the video one after the other. An internal
+   * ring buffer keeps the last 2*R_t+1 frames, where R_t is the (rounded up)
+   * radius in time direction.
+   * 3. Each time push() returns true, a new time step has been completed:
+   * the LBP codes of the three planes of the frame() that lies R_t frames in
+   * the past are available through xyPlane(), xtPlane() and ytPlane(), and their histograms
+   * can be computed with histograms().
+   *
+   * The XY codes of each frame are computed only once when the frame is
+   * pushed, and the XT and YT codes are computed only for the central frame
+   * of the buffer. Spatially, the planes are cropped by the largest radius
+   * in X or Y direction. When all radii are identical, the planes are
+   * identical to the ones that LBPTop computes for the same frames.
+   */
+  class LBPTopStream {
+
+    public:
+
+      /**
+       * Constructs a new stream from the three LBP operators. The XT plane
+       * has time as first and X as second dimension, the YT plane has time as
+       * first and Y as second dimension. The XT and YT planes are computed
+       * by the given number of threads (0: all cores).
+       */
+      LBPTopStream(const bob::ip::LBP& lbp_xy, const bob::ip::LBP& lbp_xt,
+          const bob::ip::LBP& lbp_yt, const size_t number_of_threads = 1);
+
+      /**
+       * Constructs a new stream using the operators of the given LBPTop
+       */
+      LBPTopStream(const bob::ip::LBPTop& lbp_top,
+          const size_t number_of_threads = 1);
+
+      /**
+       * Forgets all frames that have been pushed so far; afterwards, frames
+       * of a different size can be pushed.
+       */
+      void reset();
+
+      /**
+       * Pushes the next <b>grayscale</b> frame of the video. Returns true if
+       * a new time step has been completed, i.e., if the planes of a new
+       * frame are available.
+       */
+      template <typename T>
+      bool push(const blitz::Array<T,2>& frame);
+
+      /**
+       * Pushes the next color frame of the video, as read by
+       * bob::io::VideoReader, i.e., with shape (3, height, width). The frame
+       * is converted to grayscale before processing.
+       */
+      bool push(const blitz::Array<uint8_t,3>& frame);
+
+      /**
+       * The number of frames that have been pushed so far
+       */
+      size_t numberOfFrames() const { return m_count; }
+
+      /**
+       * The index of the frame of which the planes are currently available,
+       * or -1 if no time step has been completed yet
+       */
+      int frame() const
+      { return m_count < (size_t)m_buffer_size ? -1 : (int)m_count - 1 - m_r_t; }
+
+      /**
+       * The radius in time direction, i.e., the number of frames that the
+       * completed time step lags behind the last pushed frame
+       */
+      int timeRadius() const { return m_r_t; }
+
+      /**
+       * The LBP codes of the XY, XT and YT planes of frame()
+       */
+      const blitz::Array<uint16_t,2>& xyPlane() const { return m_xy; }
+      const blitz::Array<uint16_t,2>& xtPlane() const { return m_xt; }
+      const blitz::Array<uint16_t,2>& ytPlane() const { return m_yt; }
+
+      /**
+       * Computes the histograms of the LBP codes of the three planes of
+       * frame(); each histogram needs to have as many bins as the maximum
+       * label of the according LBP operator.
+       */
+      void histograms(blitz::Array<uint64_t,1>& xy, blitz::Array<uint64_t,1>& xt,
+          blitz::Array<uint64_t,1>& yt) const;
+
+      /**
+       * The LBP operators of the three planes
+       */
+      const bob::ip::LBP& getXY() const { return m_lbp_xy; }
+      const bob::ip::LBP& getXT() const { return m_lbp_xt; }
+      const bob::ip::LBP& getYT() const { return m_lbp_yt; }
+
+    private:
+
+      /**
+       * Determines the radii in time and space from the LBP operators
+       */
+      void init();
+
+      /**
+       * Allocates the buffers for frames of the given size
+       */
+      void resize(const int height, const int width);
+
+      /**
+       * Computes the XY codes of the frame that has just been written to the
+       * given slot of the ring buffer, and the planes of the central frame
+       * if the buffer is full.
+       */
+      bool update(const int slot);
+
+      /**
+       * Computes the XT codes of the rows [begin, end) or the YT codes of
+       * the columns [begin, end) of the central frame
+       */
+      void xt_rows(size_t, size_t begin, size_t end, const int first_slot);
+      void yt_columns(size_t, size_t begin, size_t end, const int first_slot);
+
+      bob::ip::LBP m_lbp_xy;
+      bob::ip::LBP m_lbp_xt;
+      bob::ip::LBP m_lbp_yt;
+      size_t m_number_of_threads;
+
+      int m_r_t; ///< The radius in time direction
+      int m_border; ///< The spatial border that is cropped from the planes
+      int m_buffer_size; ///< 2*m_r_t+1
+
+      size_t m_count; ///< The number of frames pushed so far
+      blitz::Array<double,3> m_frames; ///< Each frame is stored twice, so that the last frames are contiguous
+      blitz::Array<uint16_t,3> m_xy_codes; ///< The XY codes of the buffered frames
+      blitz::Array<uint16_t,2> m_xy;
+      blitz::Array<uint16_t,2> m_xt;
+      blitz::Array<uint16_t,2> m_yt;
+  };
+
+  template <typename T>
+  bool LBPTopStream::push(const blitz::Array<T,2>& frame)
+  {
+    bob::core::array::assertZeroBase(frame);
+    if (!m_count) resize(frame.extent(0), frame.extent(1));
+    bob::core::array::assertSameDimensionLength(frame.extent(0), m_frames.extent(1));
+    bob::core::array::assertSameDimensionLength(frame.extent(1), m_frames.extent(2));
+
+    // write the frame to both of its slots of the ring buffer
+    const int slot = m_count % m_buffer_size;
+    blitz::Range all = blitz::Range::all();
+    m_frames(slot, all, all) = blitz::cast<double>(frame);
+    m_frames(slot + m_buffer_size, all, all) = m_frames(slot, all, all);
+    return update(slot);
+  }
+
+}}
+
+#endif /* BOB_IP_LBPTOP_STREAM_H */
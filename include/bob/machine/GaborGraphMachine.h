@@ -99,6 +99,22 @@ namespace bob{ namespace machine {
         blitz::Array<double,2>& graph_jets
       ) const;
 
+      //! computes the Gabor jets of the graph directly from the image, without computing a full jet image
+      void extract(
+        bob::ip::GaborWaveletTransform& gwt,
+        const blitz::Array<std::complex<double>,2>& gray_image,
+        blitz::Array<double,3>& graph_jets,
+        bool do_normalize = true
+      ) const;
+
+      //! computes the Gabor jets (abs part only) of the graph directly from the image, without computing a full jet image
+      void extract(
+        bob::ip::GaborWaveletTransform& gwt,
+        const blitz::Array<std::complex<double>,2>& gray_image,
+        blitz::Array<double,2>& graph_jets,
+        bool do_normalize = true
+      ) const;
+
       //! averages multiple Gabor graphs into one
       void average(
         const blitz::Array<double,4>& many_graph_jets,
@@ -133,6 +149,26 @@ namespace bob{ namespace machine {
         const bob::machine::GaborJetSimilarity& jet_similarity_function
       ) const;
 
+      //! \brief computes the similarities of the probe graph to each of the graphs in the gallery.
+      //! This function is reentrant and distributes the gallery graphs over the given number of threads (0: all cores).
+      void similarities(
+        const blitz::Array<double,3>& gallery_graph_jets,
+        const blitz::Array<double,2>& probe_graph_jets,
+        const bob::machine::GaborJetSimilarity& jet_similarity_function,
+        blitz::Array<double,1>& scores,
+        unsigned number_of_threads = 1
+      ) const;
+
+      //! \brief computes the similarities of the probe graph to each of the graphs in the gallery.
+      //! This function is reentrant and distributes the gallery graphs over the given number of threads (0: all cores).
+      void similarities(
+        const blitz::Array<double,4>& gallery_graph_jets,
+        const blitz::Array<double,3>& probe_graph_jets,
+        const bob::machine::GaborJetSimilarity& jet_similarity_function,
+        blitz::Array<double,1>& scores,
+        unsigned number_of_threads = 1
+      ) const;
+
       //! saves this machine to file
       void save(bob::io::HDF5File& file) const;
 
@@ -59,6 +59,19 @@ namespace bob { namespace machine {
       //! The similarity between two Gabor jets, including absolute values only
       double operator()(const blitz::Array<double,1>& jet1, const blitz::Array<double,1>& jet2) const;
 
+      //! \brief The similarity between two Gabor jets, including absolute values and phases.
+      //! The estimated disparity is written to the given vector instead of this object,
+      //! so that this function can be called concurrently from several threads.
+      double operator()(const blitz::Array<double,2>& jet1, const blitz::Array<double,2>& jet2, blitz::TinyVector<double,2>& disparity) const;
+
+      //! \brief The similarity between two Gabor jets with the given length, each stored contiguously as absolute values followed by phases.
+      //! This function is reentrant; the estimated disparity is written to the given vector.
+      double similarity(const double* jet1, const double* jet2, int length, blitz::TinyVector<double,2>& disparity) const;
+
+      //! \brief The similarity between two Gabor jets with the given length, containing contiguous absolute values only.
+      //! This function is reentrant.
+      double similarity(const double* jet1, const double* jet2, int length) const;
+
       //! returns the disparity vector estimated during the last call of similarity; only valid for disparity types
       blitz::TinyVector<double,2> disparity() const {return m_disparity;}
 
@@ -77,15 +90,15 @@ namespace bob { namespace machine {
 
       // initializes the internal memory to be used for disparity-like Gabor jet similarities
       void init();
-      // computes confidences from the given Gabor jets
-      void compute_confidences(const blitz::Array<double,2>& jet1, const blitz::Array<double,2>& jet2) const;
-      // computes the disparity using the m_confidences and m_phase_differences values
-      void compute_disparity() const;
+      // computes the disparity from the confidences and phase differences of the given Gabor jets
+      void compute_disparity(const double* abs1, const double* phase1, const double* abs2, const double* phase2, blitz::TinyVector<double,2>& disparity) const;
 
+      // the disparity estimated during the last call of the non-reentrant operator()
       mutable blitz::TinyVector<double,2> m_disparity;
 
-      mutable std::vector<double> m_confidences;
-      mutable std::vector<double> m_phase_differences;
+      // the kernel frequencies, stored contiguously
+      std::vector<double> m_kernels_x;
+      std::vector<double> m_kernels_y;
       std::vector<double> m_wavelet_extends;
 
   }; // class GaborJetSimilarity
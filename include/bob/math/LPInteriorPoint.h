@@ -25,6 +25,8 @@
 #define BOB_MATH_INTERIOR_POINT_LP_H
 
 #include <blitz/array.h>
+#include <bob/math/SparseMatrix.h>
+#include <bob/math/solvers.h>
 
 namespace bob { namespace math {
 /**
@@ -43,6 +45,17 @@ namespace bob { namespace math {
  *     min transpose(c)*x, s.t. A*x=b, x>=0
  *   The dual formulation is:
  *     min transpose(b)*lambda, s.t. transpose(A)*lambda+mu=c
+ *
+ *   By default, the Newton direction of each iteration is computed by
+ *   solving the large (M+2N)x(M+2N) system
+ *     [A 0 0; 0 A^T I; S 0 X]*[Dx Dlambda Dmu] = [0 0 -x.*mu+nu.sigma]
+ *   with a dense solver, which requires O((M+2N)^3) operations. When the
+ *   normal equations are enabled (or when A is given as a SparseMatrix),
+ *   the diagonal blocks are eliminated instead, and only the MxM system
+ *     A*D*A^T*Dlambda = -A*S^-1*(-x.*mu+nu.sigma), with D=X*S^-1
+ *   is solved using a Cholesky decomposition. This requires A to have full
+ *   row rank, and its cost is dominated by the computation of A*D*A^T,
+ *   i.e., O(M^2.N) for a dense A.
  */
 class LPInteriorPoint
 {
@@ -91,6 +104,7 @@ class LPInteriorPoint
     const size_t getDimM() const { return m_M; }
     const size_t getDimN() const { return m_N; }
     const double getEpsilon() const { return m_epsilon; }
+    const bool getNormalEquations() const { return m_normal_equations; }
     const blitz::Array<double,1>& getLambda() const { return m_lambda; }
     const blitz::Array<double,1>& getMu() const { return m_mu; }
 
@@ -102,6 +116,13 @@ class LPInteriorPoint
     void setDimN(const size_t N)
     { m_N = N; reset(m_M, m_N); }
     void setEpsilon(const double epsilon) { m_epsilon = epsilon; }
+    /**
+     * @brief Selects whether the Newton directions are computed using the
+     *   normal equations (true) or the large dense system (false). With a
+     *   sparse A, the normal equations are always used.
+     */
+    void setNormalEquations(const bool normal_equations)
+    { m_normal_equations = normal_equations; }
 
     /**
      * @brief Solve the linear program
@@ -111,6 +132,9 @@ class LPInteriorPoint
     virtual void solve(const blitz::Array<double,2>& A,
       const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
       blitz::Array<double,1>& x) = 0;
+    virtual void solve(const bob::math::SparseMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x) = 0;
 
     /**
      * @brief Solve the linear program using the dual variables lambda and mu
@@ -121,6 +145,10 @@ class LPInteriorPoint
       const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
       blitz::Array<double,1>& x, 
       const blitz::Array<double,1>& lambda, const blitz::Array<double,1>& mu) = 0;
+    virtual void solve(const bob::math::SparseMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x,
+      const blitz::Array<double,1>& lambda, const blitz::Array<double,1>& mu) = 0;
 
     /**
      * @brief Check if a primal-dual point (x,lambda,mu) belongs to the set
@@ -138,6 +166,10 @@ class LPInteriorPoint
       const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
       const blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
       const blitz::Array<double,1>& mu) const;
+    virtual bool isFeasible(const bob::math::SparseMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      const blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
+      const blitz::Array<double,1>& mu) const;
 
     /**
      * @brief Check if a primal-dual point (x,lambda,mu) belongs to the
@@ -171,6 +203,10 @@ class LPInteriorPoint
       const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
       const blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
       const blitz::Array<double,1>& mu, const double theta) const;
+    virtual bool isInVS(const bob::math::SparseMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      const blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
+      const blitz::Array<double,1>& mu, const double theta) const;
 
     /**
      * @brief Look for an initial solution (lambda,mu) of the dual problem
@@ -181,6 +217,8 @@ class LPInteriorPoint
      */
     virtual void initializeDualLambdaMu(const blitz::Array<double,2>& A,
       const blitz::Array<double,1>& c);
+    virtual void initializeDualLambdaMu(const bob::math::SparseMatrix& A,
+      const blitz::Array<double,1>& c);
 
   protected:
     /**
@@ -193,6 +231,56 @@ class LPInteriorPoint
      */
     virtual void centeringV(const blitz::Array<double,2>& A,
       const double theta, blitz::Array<double,1>& x);
+    virtual void centeringV(const bob::math::SparseMatrix& A,
+      const double theta, blitz::Array<double,1>& x);
+
+    /**
+     * @brief Prepare the computation of the Newton directions, i.e.,
+     *   initialize the large system if it is used.
+     *
+     * @param A The A matrix of the linear equalities
+     */
+    void initializeDirection(const blitz::Array<double,2>& A) const;
+    void initializeDirection(const bob::math::SparseMatrix& A) const;
+
+    /**
+     * @brief Compute the Newton direction [Dx Dlambda Dmu] for the current
+     *   primal-dual point and store it in m_cache_x_large, either by
+     *   solving the large system or the normal equations.
+     *
+     * @param A The A matrix of the linear equalities
+     * @param x The current x primal solution of the linear program
+     * @param sigma The coefficient sigma which quantifies how close we
+     *   want to stay from the central path.
+     */
+    void computeDirection(const blitz::Array<double,2>& A,
+      const blitz::Array<double,1>& x, const double sigma) const;
+    void computeDirection(const bob::math::SparseMatrix& A,
+      const blitz::Array<double,1>& x, const double sigma) const;
+
+    /**
+     * @brief Compute the Newton direction by solving the normal equations
+     *   A*D*A^T*Dlambda = -A*S^-1*r using a Cholesky decomposition.
+     */
+    template <typename TMatrix>
+    void normalDirection(const TMatrix& A, const blitz::Array<double,1>& x,
+      const double sigma) const;
+
+    /**
+     * @brief Implementations of the functions above for dense and sparse
+     *   matrices.
+     */
+    template <typename TMatrix>
+    bool isFeasibleImpl(const TMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      const blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
+      const blitz::Array<double,1>& mu) const;
+    template <typename TMatrix>
+    void initializeDualLambdaMuImpl(const TMatrix& A,
+      const blitz::Array<double,1>& c);
+    template <typename TMatrix>
+    void centeringVImpl(const TMatrix& A, const double theta,
+      blitz::Array<double,1>& x);
 
     /**
      * @brief Initialize the large system: 
@@ -228,10 +316,11 @@ class LPInteriorPoint
      *   given dual variable lambda. This function is called by the method
      *   which looks for an initial solution in S. 
      *
-     * @param A_t The (transposed) A matrix of the linear equalities
+     * @param A The A matrix of the linear equalities
      * @param c The c vector which defines the linear objective function
      */
-    double logBarrierLP(const blitz::Array<double,2>& A_t,
+    template <typename TMatrix>
+    double logBarrierLP(const TMatrix& A,
       const blitz::Array<double,1>& c) const;
 
     /**
@@ -242,7 +331,8 @@ class LPInteriorPoint
      * @param A The A matrix of the linear equalities
      * @param c The c vector which defines the linear objective function
      */
-    void gradientLogBarrierLP(const blitz::Array<double,2>& A,
+    template <typename TMatrix>
+    void gradientLogBarrierLP(const TMatrix& A,
       const blitz::Array<double,1>& c);
 
     /**
@@ -254,6 +344,7 @@ class LPInteriorPoint
     size_t m_M;
     size_t m_N;
     double m_epsilon;
+    bool m_normal_equations;
     blitz::Array<double,1> m_lambda;
     blitz::Array<double,1> m_mu;
 
@@ -267,6 +358,11 @@ class LPInteriorPoint
     mutable blitz::Array<double,2> m_cache_A_large;
     mutable blitz::Array<double,1> m_cache_b_large;
     mutable blitz::Array<double,1> m_cache_x_large;
+    mutable blitz::Array<double,2> m_cache_A_normal;
+    mutable blitz::Array<double,1> m_cache_D;
+    mutable blitz::Array<double,1> m_cache_r;
+    mutable blitz::Array<double,1> m_cache_work;
+    mutable bob::math::SymposSolver m_cache_solver;
 };
 
 /**
@@ -356,7 +452,32 @@ class LPInteriorPointShortstep: public LPInteriorPoint
       blitz::Array<double,1>& x, 
       const blitz::Array<double,1>& lambda, const blitz::Array<double,1>& mu);
 
+    /*
+     * @brief Solve the linear program with a sparse A matrix, using the
+     *   normal equations
+     */
+    virtual void solve(const bob::math::SparseMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x);
+    virtual void solve(const bob::math::SparseMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x,
+      const blitz::Array<double,1>& lambda, const blitz::Array<double,1>& mu);
+
   protected:
+    /**
+     * @brief Implementation of the solvers for dense and sparse matrices
+     */
+    template <typename TMatrix>
+    void solveImpl(const TMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x);
+    template <typename TMatrix>
+    void solveImpl(const TMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x,
+      const blitz::Array<double,1>& lambda, const blitz::Array<double,1>& mu);
+
     // Attributes
     double m_theta;
 };
@@ -451,7 +572,32 @@ class LPInteriorPointPredictorCorrector: public LPInteriorPoint
       blitz::Array<double,1>& x, 
       const blitz::Array<double,1>& lambda, const blitz::Array<double,1>& mu);
 
+    /*
+     * @brief Solve the linear program with a sparse A matrix, using the
+     *   normal equations
+     */
+    virtual void solve(const bob::math::SparseMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x);
+    virtual void solve(const bob::math::SparseMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x,
+      const blitz::Array<double,1>& lambda, const blitz::Array<double,1>& mu);
+
   protected:
+    /**
+     * @brief Implementation of the solvers for dense and sparse matrices
+     */
+    template <typename TMatrix>
+    void solveImpl(const TMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x);
+    template <typename TMatrix>
+    void solveImpl(const TMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x,
+      const blitz::Array<double,1>& lambda, const blitz::Array<double,1>& mu);
+
     // Attributes
     double m_theta_pred;
     double m_theta_corr;
@@ -547,6 +693,18 @@ class LPInteriorPointLongstep: public LPInteriorPoint
       blitz::Array<double,1>& x, 
       const blitz::Array<double,1>& lambda, const blitz::Array<double,1>& mu);
 
+    /*
+     * @brief Solve the linear program with a sparse A matrix, using the
+     *   normal equations
+     */
+    virtual void solve(const bob::math::SparseMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x);
+    virtual void solve(const bob::math::SparseMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x,
+      const blitz::Array<double,1>& lambda, const blitz::Array<double,1>& mu);
+
     /**
      * @brief Check if a primal-dual point (x,lambda,mu) belongs to the
      *   V-inf(gamma) neighborhood of the central path.
@@ -562,6 +720,19 @@ class LPInteriorPointLongstep: public LPInteriorPoint
       const blitz::Array<double,1>& mu, const double gamma) const;
 
   protected:
+    /**
+     * @brief Implementation of the solvers for dense and sparse matrices
+     */
+    template <typename TMatrix>
+    void solveImpl(const TMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x);
+    template <typename TMatrix>
+    void solveImpl(const TMatrix& A,
+      const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+      blitz::Array<double,1>& x,
+      const blitz::Array<double,1>& lambda, const blitz::Array<double,1>& mu);
+
     // Attributes
     double m_gamma;
     double m_sigma;
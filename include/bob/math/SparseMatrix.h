@@ -0,0 +1,116 @@
+/**
+ * @file bob/math/SparseMatrix.h
+ * @date Tue Jun 18 10:27:51 2013 +0200
+ * @author Laurent El Shafey <Laurent.El-Shafey@idiap.ch>
+ *
+ * @brief This file defines a sparse matrix in compressed sparse row (CSR)
+ *   format, which provides the matrix-vector products that are required by
+ *   the iterative solvers.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_MATH_SPARSE_MATRIX_H
+#define BOB_MATH_SPARSE_MATRIX_H
+
+#include <blitz/array.h>
+
+namespace bob { namespace math {
+/**
+ * @ingroup MATH
+ * @{
+ */
+
+/**
+ * @brief A real matrix stored in compressed sparse row (CSR) format: the
+ *   non-zero values of row i are values()(offsets()(i) ... offsets()(i+1)-1),
+ *   and their column indices are stored at the same positions in columns().
+ *   Hence, the offset array has one element more than there are rows.
+ */
+class SparseMatrix
+{
+  public:
+    /**
+     * @brief Creates an empty matrix
+     */
+    SparseMatrix();
+
+    /**
+     * @brief Creates the sparse representation of the given dense matrix,
+     *   keeping only the elements that are not 0.
+     */
+    explicit SparseMatrix(const blitz::Array<double,2>& A);
+
+    /**
+     * @brief Creates the matrix from the given CSR arrays, which are copied.
+     *   Throws an InvalidArgumentException if the offsets or column indices
+     *   are not consistent with the given number of columns.
+     */
+    SparseMatrix(const blitz::Array<double,1>& values,
+      const blitz::Array<int,1>& columns, const blitz::Array<int,1>& offsets,
+      const int cols);
+
+    /**
+     * @brief Getters
+     */
+    int rows() const { return m_offsets.extent(0) - 1; }
+    int cols() const { return m_cols; }
+    int nonZeros() const { return m_values.extent(0); }
+    const blitz::Array<double,1>& values() const { return m_values; }
+    const blitz::Array<int,1>& columns() const { return m_columns; }
+    const blitz::Array<int,1>& offsets() const { return m_offsets; }
+
+    /**
+     * @brief Computes y = A*x
+     * @param x The x vector (size cols())
+     * @param y The y vector (size rows())
+     */
+    void prod(const blitz::Array<double,1>& x, blitz::Array<double,1>& y) const;
+
+    /**
+     * @brief Computes y = transpose(A)*x
+     * @param x The x vector (size rows())
+     * @param y The y vector (size cols())
+     */
+    void prodTrans(const blitz::Array<double,1>& x,
+      blitz::Array<double,1>& y) const;
+
+    /**
+     * @brief Computes the dense matrix A*diag(d)*transpose(A)
+     * @param d The diagonal elements (size cols())
+     * @param C The symmetric output matrix (size rows() x rows())
+     * @param work A working array, which is resized if required
+     */
+    void prodDiagTrans(const blitz::Array<double,1>& d,
+      blitz::Array<double,2>& C, blitz::Array<double,1>& work) const;
+
+    /**
+     * @brief Returns the dense representation of this matrix
+     */
+    blitz::Array<double,2> toDense() const;
+
+  private:
+    blitz::Array<double,1> m_values;
+    blitz::Array<int,1> m_columns;
+    blitz::Array<int,1> m_offsets;
+    int m_cols;
+};
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_MATH_SPARSE_MATRIX_H */
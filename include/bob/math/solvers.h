@@ -0,0 +1,256 @@
+/**
+ * @file bob/math/solvers.h
+ * @date Mon Jun 17 09:41:25 2013 +0200
+ * @author Laurent El Shafey <Laurent.El-Shafey@idiap.ch>
+ *
+ * @brief This file defines solver objects that keep their LAPACK workspace
+ *   across calls, as well as batched versions of the Cholesky
+ *   decomposition, of the symmetric positive definite linear solver and of
+ *   the matrix inversion.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_MATH_SOLVERS_H
+#define BOB_MATH_SOLVERS_H
+
+#include <blitz/array.h>
+#include <cstddef>
+
+namespace bob { namespace math {
+/**
+ * @ingroup MATH
+ * @{
+ */
+
+/**
+ * The classes below compute the same results as the according functions
+ * (linsolve_, linsolveSympos_, chol_, inv_, eigSym_ and svd_), but they are
+ * meant to be called many times on matrices of the same size: the LAPACK
+ * workspaces (including the optimal size of the working arrays) are kept
+ * from one call to the next and are only reallocated when the size of the
+ * matrices changes. Blitz++ arrays are row-major, whereas LAPACK expects
+ * column-major matrices; instead of transposing the input, the transposed
+ * problem is solved, whenever this is possible.
+ *
+ * A solver object must not be shared between threads; use one object per
+ * thread instead.
+ */
+
+/**
+ * @brief Solves general linear systems of equations A*x=b, using the
+ *   dgetrf and dgetrs LAPACK functions.
+ */
+class LinearSolver
+{
+  public:
+    LinearSolver() {}
+
+    /**
+     * @brief Solves A*x=b
+     * @param A The A squared-matrix of the system A*x=b (size NxN)
+     * @param x The x vector of the system A*x=b which will be updated
+     *   at the end of the function (size N)
+     * @param b The b vector of the system A*x=b (size N)
+     */
+    void solve(const blitz::Array<double,2>& A, blitz::Array<double,1>& x,
+      const blitz::Array<double,1>& b);
+
+    /**
+     * @brief Solves A*X=B
+     * @param A The A squared-matrix of the system A*X=B (size NxN)
+     * @param X The X matrix of the system A*X=B which will be updated
+     *   at the end of the function (size NxP)
+     * @param B The B matrix of the system A*X=B (size NxP)
+     */
+    void solve(const blitz::Array<double,2>& A, blitz::Array<double,2>& X,
+      const blitz::Array<double,2>& B);
+
+  private:
+    void factorize(const blitz::Array<double,2>& A);
+
+    blitz::Array<double,2> m_lu; ///< The LU decomposition of A^T
+    blitz::Array<int,1> m_ipiv;
+    blitz::Array<double,1> m_x;
+    blitz::Array<double,2> m_X;
+};
+
+/**
+ * @brief Computes Cholesky decompositions and solves symmetric positive
+ *   definite linear systems of equations, using the dpotrf and dpotrs
+ *   LAPACK functions. As the matrices are symmetric, they do not need to
+ *   be transposed at all.
+ * @warning No check is performed wrt. to the fact that A should be
+ *   symmetric positive definite.
+ */
+class SymposSolver
+{
+  public:
+    SymposSolver() {}
+
+    /**
+     * @brief Computes the lower triangular matrix L, such that A=L*L^T
+     * @param A The A squared-matrix, symmetric definite positive (size NxN)
+     * @param L The lower triangular matrix L (size NxN)
+     */
+    void chol(const blitz::Array<double,2>& A, blitz::Array<double,2>& L);
+
+    /**
+     * @brief Solves A*x=b
+     * @param A The A squared-matrix, symmetric definite positive, of the
+     *   system A*x=b (size NxN)
+     * @param x The x vector of the system A*x=b which will be updated
+     *   at the end of the function (size N)
+     * @param b The b vector of the system A*x=b (size N)
+     */
+    void solve(const blitz::Array<double,2>& A, blitz::Array<double,1>& x,
+      const blitz::Array<double,1>& b);
+
+    /**
+     * @brief Solves A*X=B
+     * @param A The A squared-matrix, symmetric definite positive, of the
+     *   system A*X=B (size NxN)
+     * @param X The X matrix of the system A*X=B which will be updated
+     *   at the end of the function (size NxP)
+     * @param B The B matrix of the system A*X=B (size NxP)
+     */
+    void solve(const blitz::Array<double,2>& A, blitz::Array<double,2>& X,
+      const blitz::Array<double,2>& B);
+
+  private:
+    void factorize(const blitz::Array<double,2>& A);
+
+    blitz::Array<double,2> m_chol; ///< The Cholesky factor, L in row-major
+    blitz::Array<double,1> m_x;
+    blitz::Array<double,2> m_X;
+};
+
+/**
+ * @brief Computes inverses of matrices, using the dgetrf and dgetri LAPACK
+ *   functions. As inverse(A^T) = inverse(A)^T, the matrices do not need to
+ *   be transposed at all.
+ */
+class Inverter
+{
+  public:
+    Inverter(): m_n(0) {}
+
+    /**
+     * @brief Computes B=inverse(A)
+     * @param A The A matrix to invert (size NxN)
+     * @param B The B=inverse(A) matrix (size NxN)
+     */
+    void inv(const blitz::Array<double,2>& A, blitz::Array<double,2>& B);
+
+  private:
+    blitz::Array<double,2> m_A;
+    blitz::Array<int,1> m_ipiv;
+    blitz::Array<double,1> m_work;
+    int m_n; ///< The size of the matrices the workspace was queried for
+};
+
+/**
+ * @brief Computes eigenvalue decompositions of real symmetric matrices,
+ *   using the dsyevd LAPACK function.
+ */
+class EigSymSolver
+{
+  public:
+    EigSymSolver(): m_n(0) {}
+
+    /**
+     * @brief Computes the eigenvalues and eigenvectors of A
+     * @param A The A matrix to decompose (size NxN)
+     * @param V The V matrix of eigenvectors, stored in columns (size NxN)
+     * @param D The vector of eigenvalues, in ascending order (size N)
+     */
+    void eigSym(const blitz::Array<double,2>& A, blitz::Array<double,2>& V,
+      blitz::Array<double,1>& D);
+
+  private:
+    blitz::Array<double,2> m_A;
+    blitz::Array<double,1> m_D;
+    blitz::Array<double,1> m_work;
+    blitz::Array<int,1> m_iwork;
+    int m_n; ///< The size of the matrices the workspace was queried for
+};
+
+/**
+ * @brief Computes singular value decompositions, using the dgesdd LAPACK
+ *   function. As for svd_, the decomposition of A^T is computed instead of
+ *   the one of A.
+ */
+class SVDSolver
+{
+  public:
+    SVDSolver(): m_m(0), m_n(0) {}
+
+    /**
+     * @brief Computes the SVD A=U*S*V^T
+     * @param A The A matrix to decompose (size MxN)
+     * @param U The U matrix of left singular vectors (size MxM)
+     * @param sigma The vector of singular values (size min(M,N))
+     * @param Vt The V^T matrix of right singular vectors (size NxN)
+     */
+    void svd(const blitz::Array<double,2>& A, blitz::Array<double,2>& U,
+      blitz::Array<double,1>& sigma, blitz::Array<double,2>& Vt);
+
+  private:
+    blitz::Array<double,2> m_A;
+    blitz::Array<double,1> m_S;
+    blitz::Array<double,2> m_U;
+    blitz::Array<double,2> m_VT;
+    blitz::Array<double,1> m_work;
+    blitz::Array<int,1> m_iwork;
+    int m_m, m_n; ///< The shape of the matrices the workspace was queried for
+};
+
+/**
+ * @brief Computes the Cholesky decompositions of a batch of symmetric
+ *   definite-positive matrices. The matrices are distributed over the given
+ *   number of threads (0: all cores), each of which reuses its workspace.
+ * @param A The batch of K matrices to decompose (size KxNxN)
+ * @param L The batch of lower triangular matrices L (size KxNxN)
+ */
+void cholBatch(const blitz::Array<double,3>& A, blitz::Array<double,3>& L,
+  const size_t number_of_threads = 0);
+
+/**
+ * @brief Solves a batch of symmetric positive definite linear systems of
+ *   equations A_k*x_k=b_k. The systems are distributed over the given
+ *   number of threads (0: all cores).
+ * @param A The batch of K matrices A_k (size KxNxN)
+ * @param X The solutions x_k, stored in rows (size KxN)
+ * @param B The vectors b_k, stored in rows (size KxN)
+ */
+void linsolveSymposBatch(const blitz::Array<double,3>& A,
+  blitz::Array<double,2>& X, const blitz::Array<double,2>& B,
+  const size_t number_of_threads = 0);
+
+/**
+ * @brief Computes the inverses of a batch of matrices. The matrices are
+ *   distributed over the given number of threads (0: all cores).
+ * @param A The batch of K matrices to invert (size KxNxN)
+ * @param B The batch of inverses (size KxNxN)
+ */
+void invBatch(const blitz::Array<double,3>& A, blitz::Array<double,3>& B,
+  const size_t number_of_threads = 0);
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_MATH_SOLVERS_H */
@@ -0,0 +1,119 @@
+/**
+ * @file bob/measure/cmc.h
+ * @date Tue Jun 11 14:32:08 2013 +0200
+ * @author Manuel Guenther <Manuel.Guenther@idiap.ch>
+ *
+ * @brief Methods to compute the cumulative match characteristic (CMC) of
+ * identification experiments
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_MEASURE_CMC_H
+#define BOB_MEASURE_CMC_H
+
+#include <blitz/array.h>
+#include <string>
+#include <vector>
+
+namespace bob { namespace measure {
+
+  /**
+   * The negative and positive scores of a set of probes, stored in
+   * compressed sparse row (CSR) format. The negative scores of probe p are
+   * stored contiguously in negatives()(negativeOffsets()(p) ...
+   * negativeOffsets()(p+1)-1), and the same holds for the positive scores.
+   * Hence, the offset arrays have one element more than there are probes.
+   *
+   * Each probe needs to have at least one positive score. Optionally, the
+   * probe labels (e.g., the test file names) can be stored as well.
+   */
+  class CMCScores {
+
+    public:
+
+      /**
+       * Creates an empty set of scores, i.e., without any probe
+       */
+      CMCScores();
+
+      /**
+       * Creates the set of scores from the given CSR arrays; the arrays are
+       * copied. Throws an InvalidArgumentException if the offsets are not
+       * consistent with the scores, or if a probe has no positive score.
+       */
+      CMCScores(const blitz::Array<double,1>& negatives,
+          const blitz::Array<int,1>& negative_offsets,
+          const blitz::Array<double,1>& positives,
+          const blitz::Array<int,1>& positive_offsets,
+          const std::vector<std::string>& probes = std::vector<std::string>());
+
+      /**
+       * The number of probes
+       */
+      size_t size() const { return m_negative_offsets.extent(0) - 1; }
+
+      /**
+       * The CSR arrays of negative and positive scores
+       */
+      const blitz::Array<double,1>& negatives() const { return m_negatives; }
+      const blitz::Array<int,1>& negativeOffsets() const { return m_negative_offsets; }
+      const blitz::Array<double,1>& positives() const { return m_positives; }
+      const blitz::Array<int,1>& positiveOffsets() const { return m_positive_offsets; }
+
+      /**
+       * The labels of the probes; might be empty
+       */
+      const std::vector<std::string>& probes() const { return m_probes; }
+
+    private:
+
+      blitz::Array<double,1> m_negatives;
+      blitz::Array<int,1> m_negative_offsets;
+      blitz::Array<double,1> m_positives;
+      blitz::Array<int,1> m_positive_offsets;
+      std::vector<std::string> m_probes;
+  };
+
+  /**
+   * Computes the rank of each probe, which is the number of negative scores
+   * that are strictly greater than the highest positive score of the probe.
+   * The probes are distributed over the given number of threads (0: all
+   * cores).
+   */
+  blitz::Array<int,1> ranks(const CMCScores& scores,
+      size_t number_of_threads = 1);
+
+  /**
+   * Calculates the recognition rate of the given scores, which is the
+   * relative number of probes for which the highest positive score is
+   * greater than or equal to all negative scores. This is identical to the
+   * rank 1 value of the CMC.
+   */
+  double recognitionRate(const CMCScores& scores,
+      size_t number_of_threads = 1);
+
+  /**
+   * Calculates the cumulative match characteristic (CMC) of the given
+   * scores. Element r of the returned array is the relative number of
+   * probes with a rank of at most r; the array has one element more than
+   * the largest number of negative scores of a single probe.
+   */
+  blitz::Array<double,1> cmc(const CMCScores& scores,
+      size_t number_of_threads = 1);
+
+}}
+
+#endif /* BOB_MEASURE_CMC_H */
@@ -0,0 +1,122 @@
+/**
+ * @file bob/measure/load.h
+ * @date Tue Jun 11 14:32:08 2013 +0200
+ * @author Manuel Guenther <Manuel.Guenther@idiap.ch>
+ *
+ * @brief Fast loading of score files in four or five column format
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_MEASURE_LOAD_H
+#define BOB_MEASURE_LOAD_H
+
+#include <blitz/array.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include <bob/measure/cmc.h>
+
+namespace bob { namespace measure {
+
+  /**
+   * A score file in four or five column format, loaded to memory.
+   *
+   * In the four column format, each line contains the claimed identity, the
+   * real identity, the test label and the score. In the five column format,
+   * each line contains the claimed identity, the model label, the real
+   * identity, the test label and the score. Empty lines and lines starting
+   * with '#' are ignored; further columns are ignored as well.
+   *
+   * The file is memory-mapped and parsed in parallel by several threads,
+   * each of which handles a consecutive block of lines. All string labels
+   * are interned: the claimed and real identities are stored as indices into
+   * the identities() table, the test labels as indices into the
+   * probeLabels() table. Labels are numbered in order of first occurrence.
+   */
+  class ScoreFile {
+
+    public:
+
+      /**
+       * Loads the given score file with the given number of columns (4 or 5)
+       * using the given number of threads (0: all cores). Each thread parses
+       * at least chunk_size bytes, so that small files are parsed by a single
+       * thread. Throws an InvalidArgumentException if the file cannot be read
+       * or contains an invalid line.
+       */
+      ScoreFile(const std::string& filename, int columns = 4,
+          size_t number_of_threads = 0, size_t chunk_size = 1 << 20);
+
+      /**
+       * The number of scores in the file
+       */
+      size_t size() const { return m_scores.extent(0); }
+
+      /**
+       * The number of columns of the score file
+       */
+      int columns() const { return m_columns; }
+
+      /**
+       * All scores in the order of the file
+       */
+      const blitz::Array<double,1>& scores() const { return m_scores; }
+
+      /**
+       * The indices of the claimed and the real identities of each score
+       * into identities()
+       */
+      const blitz::Array<int,1>& claimedIds() const { return m_claimed_ids; }
+      const blitz::Array<int,1>& realIds() const { return m_real_ids; }
+
+      /**
+       * The indices of the test label of each score into probeLabels()
+       */
+      const blitz::Array<int,1>& probeIds() const { return m_probe_ids; }
+
+      /**
+       * The interned identities and test labels
+       */
+      const std::vector<std::string>& identities() const { return m_identities; }
+      const std::vector<std::string>& probeLabels() const { return m_probe_labels; }
+
+      /**
+       * Splits the scores into negatives (first) and positives (second). A
+       * score is positive if the claimed identity equals the real identity.
+       */
+      std::pair<blitz::Array<double,1>, blitz::Array<double,1> > split() const;
+
+      /**
+       * Groups the scores by test label, sorted by label name, to be used
+       * for CMC computation. Test labels that have only positive or only
+       * negative scores are ignored, and a warning is issued.
+       */
+      CMCScores cmcScores() const;
+
+    private:
+
+      int m_columns;
+      blitz::Array<double,1> m_scores;
+      blitz::Array<int,1> m_claimed_ids;
+      blitz::Array<int,1> m_real_ids;
+      blitz::Array<int,1> m_probe_ids;
+      std::vector<std::string> m_identities;
+      std::vector<std::string> m_probe_labels;
+  };
+
+}}
+
+#endif /* BOB_MEASURE_LOAD_H */
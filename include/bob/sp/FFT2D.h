@@ -26,6 +26,7 @@
 
 #include <complex>
 #include <blitz/array.h>
+#include <boost/shared_ptr.hpp>
 
 namespace bob { namespace sp {
 /**
@@ -99,11 +100,23 @@ class FFT2DAbstract
     void setWidth(const size_t width);
 
   protected:
+    /**
+     * @brief Returns the FFTW plan for the current shape and the given
+     * direction (FFTW_FORWARD or FFTW_BACKWARD). The plan is created on the
+     * first request and reused afterwards. The returned plan can be executed
+     * concurrently on arbitrary arrays of the current shape.
+     */
+    boost::shared_ptr<void> getPlan(const int sign, const bool inplace) const;
+
     /**
      * Private attributes
      */
     size_t m_height;
     size_t m_width;
+
+    // cached FFTW plans for the out-of-place and in-place transforms
+    mutable boost::shared_ptr<void> m_plan;
+    mutable boost::shared_ptr<void> m_plan_inplace;
 };
 
 
@@ -186,6 +199,75 @@ class IFFT2D: public FFT2DAbstract
     virtual void operator()(blitz::Array<std::complex<double>,2>& src_dst) const;
 };
 
+
+/**
+ * @brief This class implements a direct 2D Discrete Fourier Transform of
+ * real-valued signals based on the FFTW library. It uses the real-to-complex
+ * transform of FFTW, which is about twice as fast as the complex transform.
+ * The full (Hermitian symmetric) spectrum is returned, so that the result is
+ * identical to the one of FFT2D.
+ */
+class RealFFT2D
+{
+  public:
+    /**
+     * @brief Constructor: Initialize working arrays
+     */
+    RealFFT2D(const size_t height=0, const size_t width=0);
+
+    /**
+     * @brief Copy constructor
+     */
+    RealFFT2D(const RealFFT2D& other);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~RealFFT2D();
+
+    /**
+     * @brief Assignment operator
+     */
+    RealFFT2D& operator=(const RealFFT2D& other);
+
+    /**
+     * @brief Equal operator
+     */
+    bool operator==(const RealFFT2D& other) const;
+
+    /**
+     * @brief Not equal operator
+     */
+    bool operator!=(const RealFFT2D& other) const;
+
+    /**
+     * @brief process a real array by applying the direct FFT
+     */
+    void operator()(const blitz::Array<double,2>& src,
+      blitz::Array<std::complex<double>,2>& dst) const;
+
+    /**
+     * @brief Reset the RealFFT2D object for the given 2D shape
+     */
+    void reset(const size_t height, const size_t width);
+
+    /**
+     * @brief Getters
+     */
+    size_t getHeight() const { return m_height; }
+    size_t getWidth() const { return m_width; }
+
+  private:
+    /**
+     * Private attributes
+     */
+    size_t m_height;
+    size_t m_width;
+
+    // cached FFTW plan
+    mutable boost::shared_ptr<void> m_plan;
+};
+
 /**
  * @}
  */
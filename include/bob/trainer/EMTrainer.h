@@ -28,8 +28,11 @@
 #include "Trainer.h"
 
 #include <limits>
+#include <vector>
 #include <bob/core/check.h>
 #include <bob/core/logging.h>
+#include <bob/core/instrument.h>
+#include <bob/core/parallel.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/random.hpp>
 
@@ -44,6 +47,16 @@ namespace bob { namespace trainer {
    * @brief This class implements the general Expectation-maximization algorithm.
    * @details See Section 9.3 of Bishop, "Pattern recognition and machine learning", 2006
    * Derived classes must implement the initialization(), eStep(), mStep() and finalization() methods.
+   *
+   * The E-step of a derived class may be run on several threads with
+   * accumulate(). It needs an accumulator type holding the statistics of a
+   * subset of the samples, which provides the following methods:
+   *   - reset(): sets the statistics to zero
+   *   - accumulate(begin, end): adds the statistics of samples [begin, end)
+   *   - merge(other): adds the statistics of another accumulator
+   * accumulate() must only read the machine and the samples, and must not
+   * copy or slice blitz arrays shared with other threads, as their reference
+   * counts are not thread-safe.
    */
   template<class T_machine, class T_sampler>
   class EMTrainer: virtual public Trainer<T_machine, T_sampler>
@@ -65,6 +78,7 @@ namespace bob { namespace trainer {
         m_convergence_threshold = other.m_convergence_threshold;
         m_max_iterations = other.m_max_iterations;
         m_rng = other.m_rng;
+        m_number_of_threads = other.m_number_of_threads;
       }
       return *this;
     }
@@ -102,6 +116,7 @@ namespace bob { namespace trainer {
      */
     virtual void train(T_machine& machine, const T_sampler& sampler) 
     {
+      BOB_TIME_SCOPE("trainer.em.train");
       bob::core::info << "# EMTrainer:" << std::endl;
       
       /*
@@ -127,6 +142,7 @@ namespace bob { namespace trainer {
 
       // - iterates...
       for(size_t iter=0; ; ++iter) {
+        BOB_TIME_SCOPE("trainer.em.iteration");
         
         // - saves average output from last iteration
         average_output_previous = average_output;
@@ -243,11 +259,53 @@ namespace bob { namespace trainer {
     const boost::shared_ptr<boost::mt19937> getRng() const
     { return m_rng; }
 
+    /**
+     * @brief Sets the number of threads used by the E-step, if the derived
+     * class supports it (0 means: all cores)
+     */
+    void setNumberOfThreads(size_t number_of_threads)
+    { m_number_of_threads = number_of_threads; }
+
+    /**
+     * @brief Gets the number of threads used by the E-step
+     */
+    size_t getNumberOfThreads() const
+    { return m_number_of_threads; }
+
   protected:
     bool m_compute_likelihood; ///< whether lilelihood is computed during the EM loop or not
     double m_convergence_threshold; ///< convergence threshold
     size_t m_max_iterations; ///< maximum number of EM iterations
     boost::shared_ptr<boost::mt19937> m_rng; ///< The random number generator for the inialization
+    size_t m_number_of_threads; ///< number of threads of the E-step (0: all cores)
+
+    /**
+     * @brief The number of accumulators a derived class should create for
+     * accumulate(), one per thread
+     */
+    size_t numberOfAccumulators() const
+    { return bob::core::number_of_threads(m_number_of_threads); }
+
+    /**
+     * @brief Resets the accumulators and accumulates the statistics of
+     * n_samples samples, split into consecutive chunks, one per accumulator,
+     * each processed by its own thread. The statistics are then merged into
+     * the first accumulator, in the order of the chunks, so that the result
+     * only depends on the number of accumulators, and not on the scheduling
+     * of the threads.
+     */
+    template <typename T_accumulator>
+    void accumulate(std::vector<boost::shared_ptr<T_accumulator> >& accumulators,
+        size_t n_samples) const
+    {
+      for (size_t k=0; k<accumulators.size(); ++k) accumulators[k]->reset();
+      bob::core::parallel_for(n_samples,
+        boost::bind(&EMTrainer::accumulateChunk<T_accumulator>, _1, _2, _3,
+          boost::ref(accumulators)),
+        accumulators.size());
+      for (size_t k=1; k<accumulators.size(); ++k)
+        accumulators[0]->merge(*accumulators[k]);
+    }
 
     /**
      * @brief Protected constructor to be called in the constructor of derived
@@ -258,8 +316,17 @@ namespace bob { namespace trainer {
       m_compute_likelihood(compute_likelihood), 
       m_convergence_threshold(convergence_threshold), 
       m_max_iterations(max_iterations),
-      m_rng(new boost::mt19937())
+      m_rng(new boost::mt19937()),
+      m_number_of_threads(1)
+    {
+    }
+
+  private:
+    template <typename T_accumulator>
+    static void accumulateChunk(size_t thread, size_t begin, size_t end,
+        std::vector<boost::shared_ptr<T_accumulator> >& accumulators)
     {
+      accumulators[thread]->accumulate(begin, end);
     }
   };
 
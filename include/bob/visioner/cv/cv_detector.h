@@ -135,6 +135,9 @@ namespace bob { namespace visioner {
       void set_scan_levels(uint64_t levels);
       uint64_t get_scan_levels() const { return m_levels; }
 
+      void set_pyramid_threads(size_t threads) { m_ipyramid.set_threads(threads); }
+      size_t get_pyramid_threads() const { return m_ipyramid.threads(); }
+
       // Process detections
       static void sort_asc(std::vector<detection_t>& detections);
       static void sort_desc(std::vector<detection_t>& detections);
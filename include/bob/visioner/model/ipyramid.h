@@ -85,8 +85,9 @@ namespace bob { namespace visioner {
 
     public:
 
-      // Constructor
-      ipyramid_t(const param_t& param = param_t());
+      // Constructor: the scaled images are built using the given number of
+      //  threads (zero builds them in the current thread)
+      ipyramid_t(const param_t& param = param_t(), size_t threads = 0);
 
       // Destructor
       virtual ~ipyramid_t() {}
@@ -95,10 +96,15 @@ namespace bob { namespace visioner {
       virtual void reset(const param_t& param);
 
       // Load scaled versions of an image and its ground truth	
+      //  NB: the images of the previous call are reused as buffers
       bool load(const std::string& ifile, const std::string& gfile);		
       bool load(const ipscale_t& ipscale);
       bool load(const uint8_t* image, uint64_t rows, uint64_t cols);
 
+      // Number of threads used to build the scaled images
+      size_t threads() const { return m_threads; }
+      void set_threads(size_t threads) { m_threads = threads; }
+
       // Map regions (at the original scale) to sub-windows
       subwindow_t map(const QRectF& reg, const param_t& param) const;
       QRectF map(const subwindow_t& sw) const;
@@ -120,6 +126,13 @@ namespace bob { namespace visioner {
 
     private:
 
+      // Build the scaled versions of the top of the pyramid
+      void build(const std::vector<double>& scales);
+
+      // Build the scaled images <1 + ith>, <1 + ith + step>, ... (worker thread)
+      void build_mt(const std::vector<double>& scales, uint64_t step,
+          uint64_t ith, std::pair<uint64_t, uint64_t> range);
+
       // Project a sub-window to another scale
       subwindow_t map(const subwindow_t& sw, int s, const param_t& param) const;
 
@@ -129,6 +142,7 @@ namespace bob { namespace visioner {
     private: // representation
 
       std::vector<ipscale_t>  m_ipscales; // Images at different scales        
+      size_t                  m_threads;  // Threads used to build the scales
   };
 
 }}
@@ -52,11 +52,17 @@ namespace bob { namespace visioner {
       /**
        * Builds a new sampler for either training or validation. Also specify
        * the maximum number of threads this sampler should be able to work with.
-       * This parameter will be used to initialize N random generators (one for
-       * each thread). A value of zero will initialize a single random number
-       * generator.
+       * The images listed in the parameters are loaded using this number of
+       * threads (zero loads them in the current thread).
+       *
+       * If compact is set, only the original (grayscale) image of each file
+       * is kept in memory, instead of all its scaled versions. The scaled
+       * images are then re-built on demand, whenever the features of their
+       * samples need to be computed (error-based sampling and mapping). This
+       * trades some computation time for a much smaller memory footprint.
        */
-      Sampler(const param_t& param, SamplerType type, size_t max_threads=0);
+      Sampler(const param_t& param, SamplerType type, size_t max_threads=0,
+          bool compact=false);
 
       /**
        * Samples, approximately, the given number of samples (uniformly). The
@@ -74,14 +80,12 @@ namespace bob { namespace visioner {
        * replacement each of the subsets. The subsets are then merged before
        * this method returns.
        *
-       * Because of the way it is coded, this method cannot guarantee (even if
-       * the seed is set on the constructor), that it responds the same way
-       * independently of the number of threads that it uses to run. The reason
-       * being that number of threads used to sample will determine the number
-       * of sampling subsets and, therefore, how samples will be picked. If you
-       * call this method with the same number of threads though, given the
-       * same initial conditions (e.g., first time in the program), it should
-       * reply in the same manner.
+       * The random decisions are drawn from a generator that is re-seeded for
+       * each scaled image using the seed in the parameters, the index of the
+       * image and the number of previous calls to the sampling methods.
+       * Hence, given the same initial conditions (e.g., first time in the
+       * program), the selected samples do not depend on the number of threads
+       * used to run this method.
        *
        * Also note that, because of the way this method is implemented, it
        * cannot guarantee that the exact number of samples requested will be
@@ -128,13 +132,22 @@ namespace bob { namespace visioner {
       uint64_t n_types() const { return m_n_types; }
 
       /**
-       * Grabs all images.
+       * Grabs all images. Note that, in compact mode, the scaled images only
+       * hold the ground truth and the scanning parameters, but no pixels.
        */
       const std::vector<ipscale_t>& images() const { return m_ipscales; }
 
       /**
-       * Resets to a list of images and (matching) ground truth files. Note:
-       * This method is buggy and will only work after object initialization.
+       * Returns if only the original images are kept in memory.
+       */
+      bool compact() const { return m_compact; }
+
+      /**
+       * Resets to a list of images and (matching) ground truth files. The
+       * files are split among the maximum number of threads given at
+       * construction time, each using its own pyramid of scaled images. The
+       * loaded samples are always stored in the order of the input files,
+       * independently of the number of threads.
        */
       void load(const std::vector<std::string>& ifiles, 
           const std::vector<std::string>& gfiles);
@@ -173,6 +186,13 @@ namespace bob { namespace visioner {
       // Map the given sample to image
       uint64_t sample2image(uint64_t s) const;
 
+      // Access the given scaled image, re-building its pixels in the given
+      // buffer if running in compact mode
+      const ipscale_t& ipscale(uint64_t i, ipscale_t& buffer) const;
+
+      // Seed the random number generator for sampling the given image
+      void seed(uint64_t i, boost::mt19937& gen) const;
+
       // Compute the error of the given sample
       double error(uint64_t x, uint64_t y, const std::vector<double>& targets, 
           const Model& model, std::vector<double>& scores) const;
@@ -183,19 +203,37 @@ namespace bob { namespace visioner {
 
     private:
 
-      // Reset to a set of listfiles
-      void load(const std::vector<std::string>& listfiles);
+      /**
+       * The scaled images (with at least one sample) of a single input file
+       */
+      struct ifile_t {
+        ifile_t(): m_loaded(false) {}
+
+        bool m_loaded; ///< If the file was loaded successfully
+        Matrix<uint8_t> m_image; ///< Original image (compact mode only)
+        std::vector<ipscale_t> m_ipscales; ///< Scaled images
+        std::vector<uint64_t> m_n_samples; ///< # of samples / scaled image
+        std::vector<uint64_t> m_tcounts; ///< # of samples / distinct target type
+      };
+
+      /**
+       * Loading thread (each input file is written to its own slot)
+       */
+      void th_load(std::pair<uint64_t, uint64_t> frange,
+          const std::vector<std::string>& ifiles,
+          const std::vector<std::string>& gfiles,
+          std::vector<ifile_t>& files) const;
 
       /**
        * Uniform sampling worker thread
        */
-      void th_usample(uint64_t ith, std::pair<uint64_t, uint64_t> srange, 
+      void th_usample(std::pair<uint64_t, uint64_t> srange, 
           std::vector<uint64_t>& samples) const;
 
       /**
        * Error-based sampling worker thread
        */
-      void th_esample(uint64_t ith, std::pair<uint64_t, uint64_t> srange, 
+      void th_esample(std::pair<uint64_t, uint64_t> srange, 
           const Model& model, std::vector<uint64_t>& samples) const;
 
       /**
@@ -215,6 +253,8 @@ namespace bob { namespace visioner {
 
       param_t	m_param; ///< Model parameters
       SamplerType	m_type; ///< Training or Validation mode
+      size_t m_max_threads; ///< Maximum number of threads
+      bool m_compact; ///< Keep only the original images in memory
 
       boost::shared_ptr<Tagger> m_tagger; ///< Sample labelling
       boost::shared_ptr<Loss> m_loss; ///< Loss
@@ -226,10 +266,12 @@ namespace bob { namespace visioner {
       std::vector<ipscale_t> m_ipscales; ///< Input: image + annotations @ all scales
       std::vector<uint64_t> m_ipsbegins; ///< Sample interval [begin, end)
       std::vector<uint64_t> m_ipsends;   ///< for each scaled image
+      std::vector<Matrix<uint8_t> > m_images; ///< Original images (compact mode only)
+      std::vector<uint64_t> m_ipsimages; ///< Original image / scaled image (compact mode only)
 
       std::vector<uint64_t> m_tcounts; ///< # of times / distinct target type
       mutable std::vector<double> m_sprobs; ///< base sampling probability / distinct target type
-      mutable std::vector<boost::mt19937> m_rgens; ///< Random number generators (per thread)
+      mutable uint64_t m_n_calls; ///< # of calls to the sampling methods
 
   };
 
@@ -66,6 +66,7 @@ namespace bob { namespace visioner {
       uint64_t n_outputs() const { return m_data.n_outputs(); }
 
       uint16_t fvalue(uint64_t f, uint64_t s) const { return m_data.value(f, s); }
+      const uint16_t* fvalues(uint64_t f) const { return m_data.values()[f]; }
       const double* target(uint64_t s) const { return m_data.targets()[s]; }
       double cost(uint64_t s) const { return m_data.cost(s); }
 
@@ -80,6 +81,9 @@ namespace bob { namespace visioner {
 
     private: //multi-threading
 
+      // Mask the entries that are not frequent enough for a range of features
+      void mask_mt(const std::pair<uint64_t,uint64_t>& range);
+
       // Update predictions
       void update_scores_mt(const std::vector<LUT>& luts, 
           const std::pair<uint64_t,uint64_t>& range);
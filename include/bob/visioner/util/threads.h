@@ -26,6 +26,7 @@
 #define BOB_VISIONER_UTIL_THREADS_H
 
 #include <vector>
+#include <exception>
 
 #include <boost/thread.hpp>
 #include <boost/lambda/bind.hpp>
@@ -33,11 +34,45 @@
 
 namespace bob { namespace visioner {
 
+  namespace detail {
+
+    // Runs a thread function and keeps the exception it throws, if any, so
+    // that it can be re-thrown in the calling thread
+    template <typename TOp> struct guarded_op {
+      TOp op;
+      std::exception_ptr* error;
+      void operator()() {
+        try {
+          op();
+        }
+        catch (...) {
+          *error = std::current_exception();
+        }
+      }
+    };
+
+    template <typename TOp>
+      guarded_op<TOp> guard(TOp op, std::exception_ptr& error) {
+        guarded_op<TOp> retval = {op, &error};
+        return retval;
+      }
+
+    // Re-throws the exception of the first thread that failed, if any
+    inline void rethrow(const std::vector<std::exception_ptr>& errors) {
+      for (uint64_t ith = 0; ith < errors.size(); ith ++) {
+        if (errors[ith]) std::rethrow_exception(errors[ith]);
+      }
+    }
+
+  }
+
   // Split some objects to process using multiple threads
   void thread_split(uint64_t n_objects, std::vector<uint64_t>& sbegins, 
       std::vector<uint64_t>& sends, size_t num_of_threads);
 
   // Split a loop computation of the given size using multiple threads
+  // NB: The first exception thrown by the threads is re-thrown after all
+  //     threads have finished
   // NB: Stateless threads: op(<begin, end>)
   template <typename TOp> void thread_loop(TOp op, uint64_t size,
       size_t num_of_threads=boost::thread::hardware_concurrency()) {
@@ -46,11 +81,13 @@ namespace bob { namespace visioner {
     std::vector<uint64_t> th_begins; th_begins.reserve(num_of_threads);
     std::vector<uint64_t> th_ends; th_ends.reserve(num_of_threads);
 
+    std::vector<std::exception_ptr> errors(num_of_threads);
+
     thread_split(size, th_begins, th_ends, num_of_threads);		
 
     for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
       std::pair<uint64_t, uint64_t> range(th_begins[ith], th_ends[ith]);
-      boost::thread t(boost::bind(op, range));
+      boost::thread t(detail::guard(boost::bind(op, range), errors[ith]));
       threads[ith] = boost::move(t);
     }
 
@@ -58,6 +95,8 @@ namespace bob { namespace visioner {
       threads[ith].join();
     }
 
+    detail::rethrow(errors);
+
   }
 
   // Split a loop computation of the given size using multiple threads
@@ -69,11 +108,13 @@ namespace bob { namespace visioner {
     std::vector<uint64_t> th_begins; th_begins.reserve(num_of_threads);
     std::vector<uint64_t> th_ends; th_ends.reserve(num_of_threads);
 
+    std::vector<std::exception_ptr> errors(num_of_threads);
+
     thread_split(size, th_begins, th_ends, num_of_threads);		
 
     for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
       std::pair<uint64_t, uint64_t> range(th_begins[ith], th_ends[ith]);
-      boost::thread t(boost::bind(op, ith, range));
+      boost::thread t(detail::guard(boost::bind(op, ith, range), errors[ith]));
       threads[ith] = boost::move(t);
     }
 
@@ -81,6 +122,8 @@ namespace bob { namespace visioner {
       threads[ith].join();
     }
 
+    detail::rethrow(errors);
+
   }
 
   // Split a loop computation of the given size using multiple threads
@@ -91,13 +134,15 @@ namespace bob { namespace visioner {
     std::vector<uint64_t> th_begins; th_begins.reserve(num_of_threads);
     std::vector<uint64_t> th_ends; th_ends.reserve(num_of_threads);
 
+    std::vector<std::exception_ptr> errors(num_of_threads);
+
     thread_split(size, th_begins, th_ends, num_of_threads);		
 
     results.resize(num_of_threads);
 
     for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
       std::pair<uint64_t, uint64_t> range(th_begins[ith], th_ends[ith]);
-      boost::thread t(boost::bind(op, range, boost::ref(results[ith])));
+      boost::thread t(detail::guard(boost::bind(op, range, boost::ref(results[ith])), errors[ith]));
       threads[ith] = boost::move(t);
     }
 
@@ -105,6 +150,8 @@ namespace bob { namespace visioner {
       threads[ith].join();
     }
 
+    detail::rethrow(errors);
+
   }
 
   // Split a loop computation of the given size using multiple threads
@@ -115,13 +162,15 @@ namespace bob { namespace visioner {
     std::vector<uint64_t> th_begins; th_begins.reserve(num_of_threads);
     std::vector<uint64_t> th_ends; th_ends.reserve(num_of_threads);
 
+    std::vector<std::exception_ptr> errors(num_of_threads);
+
     thread_split(size, th_begins, th_ends, num_of_threads);		
 
     results.resize(num_of_threads);
 
     for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
       std::pair<uint64_t, uint64_t> range(th_begins[ith], th_ends[ith]);
-      boost::thread t(boost::bind(op, ith, range, boost::ref(results[ith])));
+      boost::thread t(detail::guard(boost::bind(op, ith, range, boost::ref(results[ith])), errors[ith]));
       threads[ith] = boost::move(t);
     }
 
@@ -129,6 +178,8 @@ namespace bob { namespace visioner {
       threads[ith].join();
     }
 
+    detail::rethrow(errors);
+
   }
 
 }}
@@ -40,7 +40,12 @@ namespace bob { namespace visioner {
   bool load(const QImage& qimage, Matrix<uint8_t>& grays);
   bool load(const std::string& filename, Matrix<uint8_t>& grays);
 
-  // Scale the image to a specific <scale> of the <src> source image
+  // Size of the image scaled to a specific <scale> of the original size
+  void scale_size(uint64_t rows, uint64_t cols, double scale,
+      uint64_t& new_rows, uint64_t& new_cols);
+
+  // Scale the image to a specific <scale> of the <src> source image (by
+  // averaging the source pixels covered by each output pixel)
   bool scale(const Matrix<uint8_t>& src, double scale, Matrix<uint8_t>& dst);
 
   // Convert from <Matrix<uint8_t>> to <QImage>
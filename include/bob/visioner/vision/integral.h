@@ -68,6 +68,14 @@ namespace bob { namespace visioner {
       }
     }
 
+  /////////////////////////////////////////////////////////////////////////////////////////
+  // Compute the integral image of a grayscale image: the prefix sums of each
+  // row are computed 4 pixels at a time with SSE2 instructions (if
+  // available) and added to the previous row of the output.
+  /////////////////////////////////////////////////////////////////////////////////////////
+
+  void integral(const Matrix<uint8_t>& in, Matrix<uint32_t>& out);
+
 }}
 
 #endif // BOB_VISIONER_INTEGRAL_H
@@ -356,3 +356,35 @@ class FileTest(unittest.TestCase):
     self.arrayset_readwrite(".bin", a2)
     self.arrayset_readwrite('.bin', a3)
     self.arrayset_readwrite(".bin", a4)
+
+  @extension_available('.csv')
+  def test07_csv_large(self):
+
+    # a file that is large enough to be scanned and converted in parallel
+    tmpname = tempname('.csv')
+    try:
+      data = numpy.random.normal(size=(20000,20)).astype('float64')
+      numpy.savetxt(tmpname, data, delimiter=',', fmt='%.17e')
+      self.assertTrue(numpy.array_equal(data, bob.io.load(tmpname)))
+
+      f = bob.io.File(tmpname, 'r')
+      self.assertEqual(len(f), data.shape[0])
+      for k in (0, 1, 9999, 19999):
+        self.assertTrue(numpy.array_equal(data[k], f.read(k)))
+      del f
+
+      # appended lines can be read back without reopening the file
+      f = bob.io.File(tmpname, 'a')
+      extra = numpy.random.normal(size=(20,)).astype('float64')
+      f.append(extra)
+      self.assertTrue(numpy.allclose(extra, f.read(data.shape[0])))
+      del f
+
+      # all lines must have the same number of entries
+      out = open(tmpname, 'at')
+      out.write('\n1,2,3')
+      out.close()
+      self.assertRaises(RuntimeError, bob.io.load, tmpname)
+
+    finally:
+      if os.path.exists(tmpname): os.unlink(tmpname)
@@ -332,6 +332,7 @@ class HDF5FileTest(unittest.TestCase):
       outfile.set('string', attribute)
       recovered = outfile.read('string')
       self.assertEqual(attribute, recovered)
+      self.assertEqual([attribute], outfile.lread('string'))
 
     finally:
       os.unlink(tmpname)
@@ -433,3 +434,34 @@ class HDF5FileTest(unittest.TestCase):
     finally:
 
       os.unlink(tmpname)
+
+  def test17_append_read_range(self):
+
+    try:
+
+      tmpname = get_tempfilename()
+      outfile = bob.io.HDF5File(tmpname, 'w', cache_size=1<<22)
+      self.assertEqual(outfile.cache_size, 1<<22)
+      data = numpy.random.random((1000,60))
+      outfile.append_range('data', data[:400], chunk_size=128)
+      for k in range(400, 500): outfile.append('data', data[k])
+      outfile.append_range('data', data[500:])
+      self.assertEqual(outfile.describe('data')[0][1], 1000)
+      self.assertTrue( numpy.array_equal(data, outfile.read('data')) )
+      self.assertTrue( numpy.array_equal(data[250:750],
+        outfile.read_range('data', 250, 500)) )
+      recovered = outfile.lread('data')
+      self.assertEqual(len(recovered), 1000)
+      self.assertTrue( numpy.array_equal(data[999], recovered[999]) )
+      self.assertRaises(IndexError, outfile.read_range, 'data', 900, 101)
+
+      scalars = numpy.arange(10, dtype='int32')
+      outfile.append_range('scalars', scalars)
+      outfile.append('scalars', numpy.int32(10))
+      self.assertTrue( numpy.array_equal(numpy.arange(11, dtype='int32'),
+        outfile.read_range('scalars', 0, 11)) )
+      del outfile
+
+    finally:
+
+      os.unlink(tmpname)
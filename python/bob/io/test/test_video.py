@@ -27,6 +27,7 @@ import numpy
 from .. import supported_videowriter_formats
 from ..utils import color_distortion, frameskip_detection, quality_degradation
 from nose.tools import nottest
+from nose.plugins.skip import SkipTest
 
 # These are some global parameters for the test.
 INPUT_VIDEO = utils.datafile('test.mov', sys.modules[__name__])
@@ -65,7 +66,134 @@ class VideoTest(unittest.TestCase):
     
     self.assertEqual(counter, len(video)) #we have gone through all frames
 
-TEST_NUMBER = 3
+  @utils.ffmpeg_found()
+  def test003_canPrefetchAndReadGray(self):
+
+    # Decoding frames ahead with several threads yields the same frames
+    from .. import VideoReader
+    video = VideoReader(INPUT_VIDEO)
+    ahead = VideoReader(INPUT_VIDEO, threads=2, prefetch=4)
+    self.assertEqual(ahead.threads, 2)
+    self.assertEqual(ahead.prefetch, 4)
+    counter = 0
+    for frame, prefetched in zip(video, ahead):
+      self.assertTrue(numpy.array_equal(frame, prefetched))
+      counter += 1
+    self.assertEqual(counter, len(video))
+    self.assertTrue(numpy.array_equal(video[5], ahead[5]))
+
+    # Grayscale frames only contain the luminance
+    gray = VideoReader(INPUT_VIDEO, gray=True)
+    gray_ahead = VideoReader(INPUT_VIDEO, gray=True, prefetch=4)
+    self.assertTrue(gray.gray)
+    self.assertEqual(gray.frame_type.shape, (240, 320))
+    counter = 0
+    for frame, prefetched in zip(gray, gray_ahead):
+      self.assertEqual(frame.shape, (240, 320))
+      self.assertTrue(numpy.array_equal(frame, prefetched))
+      counter += 1
+    self.assertEqual(counter, len(gray))
+    self.assertEqual(gray.load().shape, (len(gray), 240, 320))
+
+  @utils.ffmpeg_found()
+  def test004_canSeekKeyframes(self):
+
+    # Frames reached through the keyframe index are the ones decoded in order
+    from .. import VideoReader
+    video = VideoReader(INPUT_VIDEO)
+    self.assertFalse(video.indexed)
+    self.assertEqual(video.keyframes, ())
+    frames = video.load()
+    subset = video.read([10, 3, 10, len(video)-1])
+    self.assertTrue(video.indexed)
+    self.assertEqual(video.keyframes[0], 0)
+    self.assertEqual(subset.shape, (4, 3, 240, 320))
+    self.assertTrue(numpy.array_equal(subset[0], frames[10]))
+    self.assertTrue(numpy.array_equal(subset[1], frames[3]))
+    self.assertTrue(numpy.array_equal(subset[2], frames[10]))
+    self.assertTrue(numpy.array_equal(subset[3], frames[-1]))
+    self.assertTrue(numpy.array_equal(video[len(video)-2], frames[-2]))
+    self.assertRaises(IndexError, video.read, [len(video)])
+
+  @utils.ffmpeg_found()
+  def test005_canSeekReorderedKeyframes(self):
+
+    # Seeked frames are numbered in display order, even if the codec stores
+    # frames in another order. The QuickTime container keeps the presentation
+    # timestamps of the re-ordered frames, which AVI does not.
+    from .. import VideoReader, VideoWriter
+    if 'mpeg2video' not in SUPPORTED.get('mov', {}).get('supported_codecs', {}):
+      raise SkipTest("mpeg2video encoding is not supported")
+
+    frames = VideoReader(INPUT_VIDEO).load()[:40]
+    fname = utils.temporary_filename(suffix='.mov')
+
+    try:
+      # B-frames are stored after the frames they precede in display order,
+      # in closed groups of pictures that start at every intra frame
+      writer = VideoWriter(fname, frames.shape[2], frames.shape[3], gop=6,
+          codec='mpeg2video')
+      for frame in frames: writer.append(frame)
+      writer.close()
+
+      video = VideoReader(fname)
+      decoded = video.load()
+      video.index()
+
+      # there must be a keyframe to seek, after the one at the start
+      self.assertTrue(len(video.keyframes) > 1)
+      last = video.keyframes[-1]
+      self.assertTrue(last > 0)
+      self.assertTrue(last < len(video))
+
+      wanted = [last, len(video)-1]
+      if last + 1 < len(video): wanted.append(last + 1)
+      subset = video.read(wanted)
+      for k, frame in enumerate(wanted):
+        self.assertTrue(numpy.array_equal(subset[k], decoded[frame]))
+      self.assertTrue(numpy.array_equal(video[last], decoded[last]))
+
+    finally:
+      if os.path.exists(fname): os.unlink(fname)
+
+  @utils.ffmpeg_found()
+  def test006_canEncodeAsynchronously(self):
+
+    # Frames encoded in the background yield the same file
+    from .. import VideoReader, VideoWriter
+    frames = VideoReader(INPUT_VIDEO).load()[:10]
+    sync_name = utils.temporary_filename(suffix='.avi')
+    async_name = utils.temporary_filename(suffix='.avi')
+
+    try:
+      writer = VideoWriter(sync_name, frames.shape[2], frames.shape[3])
+      for frame in frames: writer.append(frame)
+      writer.close()
+
+      writer = VideoWriter(async_name, frames.shape[2], frames.shape[3],
+          queue=4)
+      self.assertEqual(writer.queue, 4)
+      for frame in frames: writer.append(frame)
+      self.assertEqual(len(writer), len(frames))
+      writer.close()
+
+      self.assertTrue(numpy.array_equal(VideoReader(sync_name).load(),
+        VideoReader(async_name).load()))
+
+      # Frames in the pixel format of the encoder skip the color conversion
+      writer = VideoWriter(async_name, frames.shape[2], frames.shape[3],
+          queue=4)
+      native = numpy.zeros(writer.native_frame_type.shape, 'uint8')
+      for k in range(5): writer.append_native(native)
+      self.assertRaises(RuntimeError, writer.append_native, native[:-1])
+      writer.close()
+      self.assertEqual(len(VideoReader(async_name)), 5)
+
+    finally:
+      for name in (sync_name, async_name):
+        if os.path.exists(name): os.unlink(name)
+
+TEST_NUMBER = 7
 
 @utils.ffmpeg_found()
 def check_format_codec(function, shape, framerate, format, codec, maxdist):
@@ -400,3 +400,100 @@ class HOGTest(unittest.TestCase):
     hog3 = bob.ip.HOG(hog2)
     self.assertTrue(  hog3 == hog2 )
     self.assertFalse( hog3 != hog2 )
+
+  def test05_DenseHOG(self):
+    #"""Test the dense HOG extractor, which uses integral histograms"""
+
+    numpy.random.seed(17)
+    image = numpy.random.randint(0, 256, size=(37,45)).astype('float64')
+
+    # HOG extractor for 16x20 windows with overlapping cells and blocks
+    hog = bob.ip.HOG(16, 20, 9, False, 4, 4, 0, 1, 2, 2, 1, 1)
+    hog.block_norm = bob.ip.BlockNorm.L2Hys
+    dense = bob.ip.DenseHOG(hog)
+    dense.set_image(image)
+    self.assertEqual(dense.image_height, 37)
+    self.assertEqual(dense.image_width, 45)
+    self.assertTrue( numpy.array_equal( dense.get_output_shape(), hog.get_output_shape() ))
+
+    # Reference: gradients on the full image, histograms of the cropped maps
+    gm = bob.ip.GradientMaps(37, 45)
+    mag, ori = gm.forward(image)
+    shape = hog.get_output_shape()
+    def reference(y, x):
+      cells = numpy.ndarray((4, 6, 9), 'float64')
+      for cy in range(cells.shape[0]):
+        for cx in range(cells.shape[1]):
+          oy, ox = y + cy*4, x + cx*3
+          cells[cy,cx] = bob.ip.hog_compute_histogram_(mag[oy:oy+4,ox:ox+4].copy(), ori[oy:oy+4,ox:ox+4].copy(), 9)
+      descr = numpy.ndarray(shape, 'float64')
+      for by in range(shape[0]):
+        for bx in range(shape[1]):
+          descr[by,bx] = bob.ip.normalize_block(cells[by:by+2,bx:bx+2].copy(), bob.ip.BlockNorm.L2Hys)
+      return descr
+
+    self.assertTrue( numpy.allclose(dense.histogram(3, 5, 4, 4), bob.ip.hog_compute_histogram_(mag[3:7,5:9].copy(), ori[3:7,5:9].copy(), 9)) )
+    for (y, x) in ((0,0), (5,7), (21,25)):
+      self.assertTrue( numpy.allclose(dense.descriptor(y, x), reference(y, x)) )
+
+    # The window at (0,0) of an image of the window size is the HOG descriptor
+    dense.set_image(image[:16,:20].copy())
+    self.assertTrue( numpy.allclose(dense.descriptor(0, 0), hog.forward(image[:16,:20].copy())) )
+
+    # Grid extraction
+    dense.set_image(image)
+    self.assertTrue( numpy.array_equal( dense.get_grid_shape(4, 5), numpy.array([6,6,shape[0]*shape[1]*shape[2]]) ))
+    for threads in (1, 3):
+      grid = dense.descriptors(4, 5, threads)
+      self.assertEqual(grid.shape, (6, 6, shape[0]*shape[1]*shape[2]))
+      for i in (0, 2, 5):
+        for j in (0, 3, 5):
+          self.assertTrue( numpy.allclose(grid[i,j], dense.descriptor(i*4, j*5).flatten()) )
+
+  def test06_DenseHOGBlockOverlapAndOrientation(self):
+    #"""Test the dense HOG extractor with several block overlaps and
+    #  orientation ranges"""
+
+    # The orientation range must follow the flag of each call
+    mag = numpy.ones((4,4), 'float64')
+    ori = numpy.ndarray((4,4), 'float64')
+    ori.fill(PIH)
+    half = numpy.array([0, 0, 0, 0, 16, 0, 0, 0], 'float64')
+    full = numpy.array([0, 0, 16, 0, 0, 0, 0, 0], 'float64')
+    for full_orientation in (True, False, True, False):
+      hist = bob.ip.hog_compute_histogram_(mag, ori, 8, full_orientation)
+      self.assertTrue( numpy.allclose(hist, full if full_orientation else half) )
+
+    numpy.random.seed(23)
+    image = numpy.random.randint(0, 256, size=(37,45)).astype('float64')
+    gm = bob.ip.GradientMaps(37, 45)
+    mag, ori = gm.forward(image)
+
+    # Reference: 24x24 windows with 6x6 non-overlapping cells grouped in 3x3
+    # blocks, with a block step of 3 (no overlap) or 1 (overlap of 2 cells)
+    def reference(y, x, shape, block_ov, full_orientation):
+      cells = numpy.ndarray((6, 6, 9), 'float64')
+      for cy in range(cells.shape[0]):
+        for cx in range(cells.shape[1]):
+          oy, ox = y + cy*4, x + cx*4
+          cells[cy,cx] = bob.ip.hog_compute_histogram_(mag[oy:oy+4,ox:ox+4].copy(), ori[oy:oy+4,ox:ox+4].copy(), 9, full_orientation)
+      descr = numpy.ndarray(shape, 'float64')
+      step = 3 - block_ov
+      for by in range(shape[0]):
+        for bx in range(shape[1]):
+          descr[by,bx] = bob.ip.normalize_block(cells[by*step:by*step+3,bx*step:bx*step+3].copy(), bob.ip.BlockNorm.L2Hys)
+      return descr
+
+    for (block_ov, full_orientation, nb_blocks) in ((0, False, 2), (2, True, 4), (0, True, 2), (2, False, 4)):
+      hog = bob.ip.HOG(24, 24, 9, full_orientation, 4, 4, 0, 0, 3, 3, block_ov, block_ov)
+      hog.block_norm = bob.ip.BlockNorm.L2Hys
+      shape = hog.get_output_shape()
+      self.assertTrue( numpy.array_equal( shape, numpy.array([nb_blocks, nb_blocks, 81]) ))
+      dense = bob.ip.DenseHOG(hog)
+      dense.set_image(image)
+      for (y, x) in ((0,0), (6,11), (13,21)):
+        self.assertTrue( numpy.allclose(dense.descriptor(y, x), reference(y, x, shape, block_ov, full_orientation)) )
+      grid = dense.descriptors(6, 7, 2)
+      for i in range(grid.shape[0]):
+        for j in range(grid.shape[1]):
+          self.assertTrue( numpy.allclose(grid[i,j], dense.descriptor(i*6, j*7).flatten()) )
@@ -627,3 +627,40 @@ class LBPTest(unittest.TestCase):
     self.assertEqual(proc2(values_5x5,plane_index=2,operator_coordinates=(0,0,0)),0x7)
 
 
+
+  def test20_lbptop_stream(self):
+    # the planes of the stream must be identical to the ones of LBPTop
+    numpy.random.seed(42)
+    video = numpy.random.randint(0, 256, size=(9,12,15)).astype('uint8')
+    for radius, points in ((1., 4), (2., 8)):
+      lbp = bob.ip.LBP(points, radius=radius, circular=True)
+      op = bob.ip.LBPTop(lbp, lbp, lbp)
+      r = int(radius)
+      shape = (video.shape[0]-2*r, video.shape[1]-2*r, video.shape[2]-2*r)
+      xy = numpy.ndarray(shape, 'uint16')
+      xt = numpy.ndarray(shape, 'uint16')
+      yt = numpy.ndarray(shape, 'uint16')
+      op(video, xy, xt, yt)
+
+      for threads in (1, 2):
+        stream = bob.ip.LBPTopStream(op, threads)
+        self.assertEqual(stream.time_radius, r)
+        completed = 0
+        for t in range(video.shape[0]):
+          if stream.push(video[t]):
+            self.assertEqual(stream.frame, t-r)
+            self.assertTrue((stream.xy_plane == xy[t-2*r]).all())
+            self.assertTrue((stream.xt_plane == xt[t-2*r]).all())
+            self.assertTrue((stream.yt_plane == yt[t-2*r]).all())
+            h_xy, h_xt, h_yt = stream.histograms()
+            self.assertEqual(h_xy.sum(), shape[1]*shape[2])
+            self.assertTrue((h_xt == numpy.bincount(xt[t-2*r].flatten(), minlength=lbp.max_label)).all())
+            completed += 1
+          else:
+            self.assertEqual(stream.frame, -1)
+        self.assertEqual(completed, shape[0])
+        self.assertEqual(stream.number_of_frames, video.shape[0])
+
+        # after a reset, frames of a different size can be pushed
+        stream.reset()
+        self.assertFalse(stream.push(numpy.zeros((7,8), 'uint8')))
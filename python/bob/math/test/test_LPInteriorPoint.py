@@ -86,8 +86,12 @@ class InteriorpointLPTest(unittest.TestCase):
     self.assertEqual( op1.n, 4)
     self.assertEqual( op1.theta, 0.4)
     self.assertEqual( op1.epsilon, 1e-6)
+    self.assertFalse( op1.normal_equations)
     op1b = bob.math.LPInteriorPointShortstep(op1)
     self.assertTrue( op1 == op1b)
+    op1b.normal_equations = True
+    self.assertFalse( op1 == op1b)
+    op1b.normal_equations = False
     self.assertFalse( op1 != op1b)
     op1b.theta = 0.5
     self.assertFalse( op1 == op1b)
@@ -162,3 +166,30 @@ class InteriorpointLPTest(unittest.TestCase):
     At = A.transpose(1,0)
     ref = numpy.dot(At, lambda_) + mu
     self.assertTrue( numpy.all( numpy.fabs( ref - c) <= eps))
+
+  def test04_normal_equations(self):
+    # The normal equations lead to the same solutions, and to the same primal
+    # and dual variables as the dense system
+    eps = 1e-4
+    acc = 1e-7
+    def close(a, b):
+      return (abs(a-b) <= eps * (1. + abs(b))).all()
+
+    for N in range(1,10):
+      A, b, c, x0, sol = generateProblem(N)
+
+      ops = (
+        lambda: bob.math.LPInteriorPointShortstep(A.shape[0], A.shape[1], 0.4, acc),
+        lambda: bob.math.LPInteriorPointPredictorCorrector(A.shape[0], A.shape[1], 0.5, 0.25, acc),
+        lambda: bob.math.LPInteriorPointLongstep(A.shape[0], A.shape[1], 1e-3, 0.1, acc),
+      )
+      for make in ops:
+        dense = make()
+        x_dense = dense.solve(A, b, c, x0)
+        normal = make()
+        normal.normal_equations = True
+        x = normal.solve(A, b, c, x0)
+        self.assertEqual( (abs(x-sol) < eps).all(), True )
+        self.assertTrue( close(x, x_dense) )
+        self.assertTrue( close(normal.lambda_, dense.lambda_) )
+        self.assertTrue( close(normal.mu, dense.mu) )
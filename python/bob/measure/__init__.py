@@ -76,6 +76,9 @@ def recognition_rate(cmc_scores):
   divided by the number of all test items.
   If several positive scores for one test item exist, the *highest* score is taken.
   """
+  if isinstance(cmc_scores, CMCScores):
+    return cmc_scores.recognition_rate()
+
   correct = 0.
   for neg, pos in cmc_scores:
     # get the maximum positive score for the current probe item
@@ -99,6 +102,9 @@ def cmc(cmc_scores):
   If several positive scores for one test item exist, the *highest* positive score is taken.
   The CMC finally computes, how many test items have rank r or higher.
   """
+  if isinstance(cmc_scores, CMCScores):
+    return cmc_scores.cmc()
+
   # compute MC
   match_characteristic = numpy.zeros((max([len(neg) for (neg,pos) in cmc_scores])+1,), numpy.int)
   for neg, pos in cmc_scores:
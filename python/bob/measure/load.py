@@ -7,6 +7,7 @@
 """
 
 import numpy
+from . import ScoreFile
 
 def four_column(filename):
   """Loads a score set from a single file to memory.
@@ -47,30 +48,15 @@ def split_four_column(filename):
   between positives and negatives. The score file has to respect the 4 column
   format as defined in the method four_column().
 
-  This method avoids loading and allocating memory for the strings present in
-  the file. We only keep the scores.
+  The file is parsed in C++ by several threads (see ScoreFile). This method
+  avoids allocating memory for the strings present in the file. We only keep
+  the scores.
 
   Returns a python tuple (negatives, positives). The values are 1-D blitz
   arrays of float64.
   """
 
-  # read four column list
-  scores_list = four_column(filename)
-
-  # split in positives and negatives
-  neg = []
-  pos = []
-  for (client_id, probe_id, _, score_str) in scores_list:
-    try:
-      score = float(score_str)
-      if client_id == probe_id:
-        pos.append(score)
-      else:
-        neg.append(score)
-    except:
-      raise SyntaxError, 'Cannot convert score "%s" to float' % score_str
-
-  return (numpy.array(neg, numpy.float64), numpy.array(pos, numpy.float64))
+  return ScoreFile(filename, 4).split()
 
 def cmc_four_column(filename):
   """Loads scores to compute CMC curves from a file in four column format.
@@ -78,47 +64,13 @@ def cmc_four_column(filename):
   and the "test label" (column 3) has to contain the test/probe file name.
 
   This function returns a list of tuples.
-  For each probe file, the tuple consists of a list of negative scores and a list of positive scores.
-  Usually, the list of positive scores should contain only one element, but more are allowed.
+  For each probe file, the tuple consists of an array of negative scores and an array of positive scores.
+  Usually, the array of positive scores should contain only one element, but more are allowed.
+  To keep the scores stored contiguously, so that the CMC can be computed efficiently in C++, use ScoreFile(filename, 4).cmc_scores() instead.
 
   The result of this function can directly be passed to, e.g., the bob.measure.cmc function.
   """
-  # read four column list
-  all_list = four_column(filename)
-  # extract positives and negatives
-  pos_dict = {}
-  neg_dict = {}
-  for (client_id, probe_id, probe_name, score_str) in all_list:
-    try:
-      score = float(score_str)
-      # check in which dict we have to put the score
-      if client_id == probe_id:
-        correct_dict = pos_dict
-      else:
-        correct_dict = neg_dict
-      # append score
-      if probe_name in correct_dict:
-        correct_dict[probe_name].append(score)
-      else:
-        correct_dict[probe_name] = [score]
-    except:
-      raise SyntaxError, "Cannot convert score '%s' to float" % score_str
-
-  # convert to lists of tuples of ndarrays
-  retval = []
-  import logging
-  logger = logging.getLogger('bob')
-  for probe_name in sorted(pos_dict.keys()):
-    if probe_name in neg_dict:
-      retval.append((numpy.array(neg_dict[probe_name], numpy.float64), numpy.array(pos_dict[probe_name], numpy.float64)))
-    else:
-      logger.warn('For probe name "%s" there are only positive scores. This probe name is ignored.' % probe_name)
-  # test if there are probes for which only negatives exist
-  for probe_name in sorted(neg_dict.keys()):
-    if not probe_name in pos_dict.keys():
-       logger.warn('For probe name "%s" there are only negative scores. This probe name is ignored.' % probe_name)
-
-  return retval
+  return list(ScoreFile(filename, 4).cmc_scores())
 
 def five_column(filename):
   """Loads a score set from a single file to memory.
@@ -161,30 +113,15 @@ def split_five_column(filename):
   between positives and negatives. The score file has to respect the 5 column
   format as defined in the method five_column().
 
-  This method avoids loading and allocating memory for the strings present in
-  the file. We only keep the scores.
+  The file is parsed in C++ by several threads (see ScoreFile). This method
+  avoids allocating memory for the strings present in the file. We only keep
+  the scores.
 
   Returns a python tuple (negatives, positives). The values are 1-D blitz
   arrays of float64.
   """
 
-  # read five column list
-  scores_list = five_column(filename)
-
-  # split in positives and negatives
-  neg = []
-  pos = []
-  for (client_id, _, probe_id, _, score_str) in scores_list:
-    try:
-      score = float(score_str)
-      if client_id == probe_id:
-        pos.append(score)
-      else:
-        neg.append(score)
-    except:
-      raise SyntaxError, 'Cannot convert score "%s" to float' % score_str
-
-  return (numpy.array(neg, numpy.float64), numpy.array(pos, numpy.float64))
+  return ScoreFile(filename, 5).split()
 
 def cmc_five_column(filename):
   """Loads scores to compute CMC curves from a file in five column format.
@@ -192,43 +129,10 @@ def cmc_five_column(filename):
   and the "test label" (column 4) has to contain the test/probe file name.
 
   This function returns a list of tuples.
-  For each probe file, the tuple consists of a list of negative scores and a list of positive scores.
-  Usually, the list of positive scores should contain only one element, but more are allowed.
+  For each probe file, the tuple consists of an array of negative scores and an array of positive scores.
+  Usually, the array of positive scores should contain only one element, but more are allowed.
+  To keep the scores stored contiguously, so that the CMC can be computed efficiently in C++, use ScoreFile(filename, 5).cmc_scores() instead.
 
   The result of this function can directly be passed to, e.g., the bob.measure.cmc function.
   """
-  # read four column list
-  all_list = five_column(filename)
-
-  pos_dict = {}
-  neg_dict = {}
-  for (client_id, _, probe_id, probe_name, score_str) in all_list:
-    try:
-      score = float(score_str)
-      # check in which dict we have to put the score
-      if client_id == probe_id:
-        correct_dict = pos_dict
-      else:
-        correct_dict = neg_dict
-      # append score
-      if probe_name in correct_dict:
-        correct_dict[probe_name].append(score)
-      else:
-        correct_dict[probe_name] = [score]
-    except:
-      raise SyntaxError, 'Cannot convert score "%s" to float' % score_str
-
-  # convert to lists of tuples of ndarrays
-  retval = []
-  import logging
-  logger = logging.getLogger('bob')
-  for probe_name in sorted(pos_dict.keys()):
-    if probe_name in neg_dict:
-      retval.append((numpy.array(neg_dict[probe_name], numpy.float64), numpy.array(pos_dict[probe_name], numpy.float64)))
-    else:
-      logger.warn('For probe name "%s" there are only positive scores. This probe name is ignored.' % probe_name)
-  # test if there are probes for which only negatives exist
-  for probe_name in sorted(neg_dict.keys()):
-    if not probe_name in pos_dict.keys():
-       logger.warn('For probe name "%s" there are only negative scores. This probe name is ignored.' % probe_name)
-  return retval
+  return list(ScoreFile(filename, 5).cmc_scores())
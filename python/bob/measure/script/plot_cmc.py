@@ -60,8 +60,8 @@ def main(command_line_options = None):
 
   # read data
   if not os.path.isfile(args.score_file): raise IOError("The given score file does not exist")
-  # pythonic way: create inline dictionary "{...}", index with desired value "[...]", execute function "(...)"
-  data = {'4column' : bob.measure.load.cmc_four_column, '5column' : bob.measure.load.cmc_five_column}[args.parser](args.score_file)
+  # the scores are kept contiguous, so that the CMC is computed in C++
+  data = bob.measure.ScoreFile(args.score_file, {'4column' : 4, '5column' : 5}[args.parser]).cmc_scores()
 
   # compute recognition rate
   rr = bob.measure.recognition_rate(data)
@@ -237,12 +237,14 @@ class ErrorTest(unittest.TestCase):
     desired_rr = 0.76
     desired_cmc = [0.76, 0.89, 0.96, 0.98, 1., 1., 1., 1., 1., 1., 1., 1., 1., 1., 1., 1., 1., 1., 1., 1.]
     data = bob.measure.load.cmc_four_column(pkg_resources.resource_filename(__name__, os.path.join('data','scores-cmc-4col.txt')))
+    self.assertTrue(isinstance(data, list))
     rr = bob.measure.recognition_rate(data)
     self.assertEqual(rr, desired_rr)
     cmc = bob.measure.cmc(data)
     self.assertTrue((cmc == desired_cmc).all())
 
     data = bob.measure.load.cmc_five_column(pkg_resources.resource_filename(__name__, os.path.join('data','scores-cmc-5col.txt')))
+    self.assertTrue(isinstance(data, list))
     rr = bob.measure.recognition_rate(data)
     self.assertEqual(rr, desired_rr)
     cmc = bob.measure.cmc(data)
@@ -274,3 +276,78 @@ class ErrorTest(unittest.TestCase):
     self.assertAlmostEqual(min_cllr, 0.337364136)
 
 
+
+  def test08_score_file(self):
+    # Tests that the C++ score file loader is consistent with the python one
+    for columns, filename in ((4, 'scores-cmc-4col.txt'), (5, 'scores-cmc-5col.txt')):
+      lines = bob.measure.load.four_column(F(filename)) if columns == 4 else bob.measure.load.five_column(F(filename))
+      positives = [l[-1] for l in lines if l[0] == l[columns-3]]
+      negatives = [l[-1] for l in lines if l[0] != l[columns-3]]
+
+      for threads in (1, 3):
+        score_file = bob.measure.ScoreFile(F(filename), columns, threads)
+        self.assertEqual(len(score_file), len(lines))
+        self.assertTrue((score_file.scores == [l[-1] for l in lines]).all())
+        self.assertEqual([score_file.probe_labels[p] for p in score_file.probe_ids], [l[-2] for l in lines])
+        neg, pos = score_file.split()
+        self.assertTrue((neg == negatives).all())
+        self.assertTrue((pos == positives).all())
+
+        # the CSR structure must be iterable like a list of tuples
+        cmc_scores = score_file.cmc_scores()
+        self.assertEqual(len(cmc_scores), len(cmc_scores.probes))
+        self.assertEqual(cmc_scores.probes, sorted(cmc_scores.probes))
+        for i, (neg, pos) in enumerate(cmc_scores):
+          self.assertEqual(len(neg), cmc_scores.negative_offsets[i+1] - cmc_scores.negative_offsets[i])
+          self.assertTrue(len(pos) >= 1)
+        self.assertTrue((cmc_scores.cmc(threads) == bob.measure.cmc(list(cmc_scores))).all())
+        self.assertEqual(cmc_scores.recognition_rate(threads), bob.measure.recognition_rate(list(cmc_scores)))
+
+  def test09_score_file_chunks(self):
+    # Tests that files parsed in several chunks give the same result as the
+    # parse of a single thread, with labels repeating across chunks
+    import tempfile
+    numpy.random.seed(7)
+    fd, fname = tempfile.mkstemp(suffix='.txt')
+    os.close(fd)
+    try:
+      f = open(fname, 'wt')
+      f.write('# a comment before the first score\n')
+      for i in range(3000):
+        claimed, real = numpy.random.randint(0, 20, size=2)
+        f.write('client%d client%d probe%d_%d %.6f\n' % (claimed, real, real, numpy.random.randint(0, 30), numpy.random.randn()))
+        if i % 500 == 0: f.write('\n# another comment\n')
+      f.close()
+
+      reference = bob.measure.ScoreFile(fname, 4, 1)
+      self.assertEqual(len(reference), 3000)
+      for threads in (2, 3, 7):
+        for chunk_size in (1, 97, 4096):
+          score_file = bob.measure.ScoreFile(fname, 4, threads, chunk_size)
+          self.assertEqual(len(score_file), len(reference))
+          self.assertTrue((score_file.scores == reference.scores).all())
+          self.assertEqual(score_file.identities, reference.identities)
+          self.assertEqual(score_file.probe_labels, reference.probe_labels)
+          self.assertTrue((score_file.claimed_ids == reference.claimed_ids).all())
+          self.assertTrue((score_file.real_ids == reference.real_ids).all())
+          self.assertTrue((score_file.probe_ids == reference.probe_ids).all())
+          cmc_scores = score_file.cmc_scores()
+          self.assertEqual(cmc_scores.probes, reference.cmc_scores().probes)
+          self.assertTrue((cmc_scores.cmc() == reference.cmc_scores().cmc()).all())
+      self.assertEqual([(list(n), list(p)) for n, p in bob.measure.load.cmc_four_column(fname)],
+          [(list(n), list(p)) for n, p in reference.cmc_scores()])
+
+      # errors report the line number in the complete file
+      lines = open(fname, 'rt').readlines()
+      lines[2500] = 'client1 client2 probe3\n'
+      f = open(fname, 'wt')
+      f.writelines(lines)
+      f.close()
+      for threads, chunk_size in ((1, 1<<20), (3, 97)):
+        try:
+          bob.measure.ScoreFile(fname, 4, threads, chunk_size)
+          self.fail("the invalid line was not detected")
+        except ValueError, e:
+          self.assertTrue('Line 2500 ' in str(e))
+    finally:
+      os.unlink(fname)
@@ -197,3 +197,20 @@ class KMeansTest(unittest.TestCase):
     trainer.train(machine, data)
     self.assertFalse( numpy.isnan(machine.means).any())
 
+
+  def test04_kmeans_threads(self):
+
+    # Trains the same KMeansMachine on several threads
+    (arStd,std) = NormalizeStdArray(F("faithful.torch3.hdf5"))
+
+    machines = []
+    for n_threads in (1, 3):
+      machine = bob.machine.KMeansMachine(2, 2)
+      trainer = bob.trainer.KMeansTrainer()
+      trainer.number_of_threads = n_threads
+      self.assertEqual(trainer.number_of_threads, n_threads)
+      trainer.rng = bob.core.random.mt19937(1337)
+      trainer.train(machine, arStd)
+      machines.append(machine)
+
+    self.assertTrue(equals(machines[0].means, machines[1].means, 1e-10))
@@ -302,3 +302,19 @@ class GMMTest(unittest.TestCase):
     trainer.max_iterations = 1;
     trainer.train(machine, data) # After the initialization the means are still [0.,0.] (at the C++ level)
     self.assertFalse( numpy.isnan(machine.means).any())
+
+  def test10_gmm_ML_threads(self):
+
+    # The statistics accumulated on several threads are the ones of a single
+    # thread, up to the order of the sums
+    ar = bob.io.load(F("faithful.torch3_f64.hdf5"))
+
+    gmms = []
+    for n_threads in (1, 4):
+      gmm = loadGMM()
+      ml_gmmtrainer = bob.trainer.ML_GMMTrainer(True, True, True)
+      ml_gmmtrainer.number_of_threads = n_threads
+      ml_gmmtrainer.train(gmm, ar)
+      gmms.append(gmm)
+
+    self.assertTrue(gmms[0].is_similar_to(gmms[1]))
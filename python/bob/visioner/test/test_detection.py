@@ -83,3 +83,25 @@ class DetectionTest(unittest.TestCase):
     for image in self.images:
       locdata = self.processor(image)
       self.assertTrue(locdata is not None)
+
+  @utils.visioner_available
+  def test04_Eyes(self):
+
+    # the most face-like detection contains both annotated eyes
+    from .. import MaxDetector
+    self.processor = MaxDetector()
+    x, y, width, height, score = self.processor(ip.rgb_to_gray(io.load(IMAGE)))
+    for eye_y, eye_x in ((209, 379), (181, 440)):
+      self.assertTrue(x < eye_x < x + width)
+      self.assertTrue(y < eye_y < y + height)
+
+  @utils.visioner_available
+  def test05_PyramidThreads(self):
+
+    # building the scaled images in parallel does not change the detections
+    from .. import Detector
+    image = ip.rgb_to_gray(io.load(IMAGE))
+    self.processor = Detector(scanning_levels=5)
+    reference = self.processor(image)
+    self.processor.pyramid_threads = 3
+    self.assertEqual(self.processor(image), reference)
@@ -0,0 +1,118 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# Andre Anjos <andre.anjos@idiap.ch>
+# Fri 05 Jul 2013 11:02:16 CEST
+#
+# Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+# 
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+# 
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# 
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Tests the multi-threaded loading and sampling of the Visioner.
+"""
+
+import os
+import numpy
+import shutil
+import tempfile
+import unittest
+from ...test import utils
+from ...ip import test as iptest
+
+IMAGE = utils.datafile('test-faces.jpg', iptest, os.path.join('data', 'faceextract'))
+
+class SamplerTest(unittest.TestCase):
+
+  def setUp(self):
+
+    self.tmpdir = tempfile.mkdtemp(prefix='bobtest_')
+
+    # one ground-truth file with a face, one with background only
+    self.gt = [os.path.join(self.tmpdir, 'face.gt'),
+        os.path.join(self.tmpdir, 'background.gt')]
+    f = open(self.gt[0], 'wt')
+    f.write('1\nface frontal 0 100 100 80 80\n')
+    f.close()
+    f = open(self.gt[1], 'wt')
+    f.write('0\n')
+    f.close()
+
+  def tearDown(self):
+
+    shutil.rmtree(self.tmpdir)
+
+  def sampler(self, threads):
+
+    from .. import param, Sampler, SamplerType
+    p = param()
+    p.labels = ['face']
+    images = [IMAGE] * 4
+    gts = [self.gt[0], self.gt[1]] * 2
+    return Sampler(p, SamplerType.Train, images, gts, threads)
+
+  @utils.visioner_available
+  def test01_LoadThreads(self):
+
+    single = self.sampler(0)
+    multi = self.sampler(3)
+    self.assertEqual(single.num_of_images, multi.num_of_images)
+    self.assertEqual(single.num_of_samples, multi.num_of_samples)
+    self.assertTrue(single.num_of_samples > 0)
+
+  @utils.visioner_available
+  def test02_SampleThreads(self):
+
+    # the selection must not depend on the number of threads
+    reference = self.sampler(3).sample(1000, 0)
+    self.assertTrue(len(reference) > 0)
+    for threads in (1, 2, 3):
+      self.assertEqual(self.sampler(3).sample(1000, threads), reference)
+
+  @utils.visioner_available
+  def test03_WorkerException(self):
+
+    # errors raised in the worker threads are reported to the caller
+    self.gt[1] = os.path.join(self.tmpdir, 'missing.gt')
+    self.assertRaises(RuntimeError, self.sampler, 3)
+    self.assertRaises(RuntimeError, self.sampler, 0)
+
+  @utils.visioner_available
+  def test04_Compact(self):
+
+    # the scaled images re-built by a compact sampler give the same samples
+    # and feature values as the ones kept in memory
+    from .. import param, Sampler, SamplerType, Model
+    p = param()
+    p.labels = ['face']
+    images = [IMAGE] * 4
+    gts = [self.gt[0], self.gt[1]] * 2
+    full = Sampler(p, SamplerType.Train, 3, False)
+    full.load(images, gts)
+    compact = Sampler(p, SamplerType.Train, 3, True)
+    compact.load(images, gts)
+    self.assertFalse(full.compact)
+    self.assertTrue(compact.compact)
+    self.assertEqual(compact.num_of_images, full.num_of_images)
+    self.assertEqual(compact.num_of_samples, full.num_of_samples)
+
+    samples = full.sample(1000, 2)
+    self.assertTrue(len(samples) > 0)
+    self.assertEqual(compact.sample(1000, 2), samples)
+
+    model = Model(p)
+    targets, values = full.map(samples, model, 0)
+    self.assertEqual(targets.shape[0], len(samples))
+    self.assertEqual(values.shape[1], len(samples))
+    for threads in (0, 1, 3):
+      compact_targets, compact_values = compact.map(samples, model, threads)
+      self.assertTrue(numpy.array_equal(compact_targets, targets))
+      self.assertTrue(numpy.array_equal(compact_values, values))
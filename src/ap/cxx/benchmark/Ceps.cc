@@ -0,0 +1,66 @@
+/**
+ * @file ap/cxx/benchmark/Ceps.cc
+ * @date 2013-07-04
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Measures the extraction of cepstral features from random signals,
+ * with and without energy and delta coefficients.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/random.hpp>
+#include <blitz/array.h>
+
+#include "bob/core/benchmark.h"
+#include "bob/ap/Ceps.h"
+
+using bob::core::benchmark::param;
+
+struct Extract {
+  bob::ap::Ceps& ceps;
+  const blitz::Array<double,1>& signal;
+  blitz::Array<double,2>& features;
+  void operator()() const { ceps(signal, features); }
+};
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("ap_Ceps", argc, argv);
+  const double rate = 16000.;
+  const int seconds[] = {1, 10, 60};
+  const int n_durations = suite.quick() ? 2 : 3;
+
+  boost::mt19937 rng;
+  boost::uniform_real<> uniform(-32768., 32767.);
+
+  for (int s = 0; s < n_durations; ++s){
+    blitz::Array<double,1> signal(static_cast<int>(seconds[s] * rate));
+    for (int i = 0; i < signal.extent(0); ++i) signal(i) = uniform(rng);
+
+    for (int deltas = 0; deltas < 2; ++deltas){
+      bob::ap::Ceps ceps(rate);
+      ceps.setWithEnergy(deltas);
+      ceps.setWithDelta(deltas);
+      ceps.setWithDeltaDelta(deltas);
+      blitz::Array<double,2> features(ceps.getShape(signal));
+
+      Extract extract = {ceps, signal, features};
+      suite.run(deltas ? "ceps_energy_deltas" : "ceps",
+          param("seconds", seconds[s]), extract);
+    }
+  }
+
+  return suite.finish();
+}
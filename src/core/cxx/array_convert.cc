@@ -0,0 +1,313 @@
+/**
+ * @file core/cxx/array_convert.cc
+ * @date 2013-07-05
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief SSE2 and multi-threaded conversions and casts of contiguous arrays
+ * between uint8_t/uint16_t and float/double.
+ *
+ * The SSE2 loops process 8 elements at a time, as 4 pairs of doubles. All
+ * source types are represented exactly as doubles, and the arithmetic is
+ * done in the same order as in the scalar versions, so both give the same
+ * results. Conversions from uint8_t go through a table of the 256 possible
+ * values instead.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <bob/core/array_convert.h>
+#include <bob/core/cast.h>
+#include <bob/core/parallel.h>
+
+/**
+ * Arrays with at least PARALLEL_SIZE elements are split over several
+ * threads, with at least PARALLEL_CHUNK elements per thread
+ */
+static const size_t PARALLEL_SIZE = 1 << 20;
+static const size_t PARALLEL_CHUNK = 1 << 18;
+
+static size_t threads_for(size_t n) {
+  if (n < PARALLEL_SIZE) return 1;
+  return std::min(bob::core::number_of_threads(), n / PARALLEL_CHUNK);
+}
+
+#if defined(__SSE2__)
+
+/**
+ * Groups of 8 elements, as 4 pairs of doubles. These are kept in separate
+ * variables rather than in an array, which the compiler would keep in memory.
+ */
+struct Pairs {
+  __m128d v0, v1, v2, v3;
+};
+
+/**
+ * Widens 8 uint16_t to 4 pairs of doubles
+ */
+static inline Pairs widen(__m128i x) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i lo = _mm_unpacklo_epi16(x, zero);
+  __m128i hi = _mm_unpackhi_epi16(x, zero);
+  Pairs r;
+  r.v0 = _mm_cvtepi32_pd(lo);
+  r.v1 = _mm_cvtepi32_pd(_mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)));
+  r.v2 = _mm_cvtepi32_pd(hi);
+  r.v3 = _mm_cvtepi32_pd(_mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)));
+  return r;
+}
+
+static inline Pairs load8(const uint8_t* p) {
+  __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+  return widen(_mm_unpacklo_epi8(x, _mm_setzero_si128()));
+}
+
+static inline Pairs load8(const uint16_t* p) {
+  return widen(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+static inline Pairs load8(const float* p) {
+  __m128 a = _mm_loadu_ps(p);
+  __m128 b = _mm_loadu_ps(p + 4);
+  Pairs r;
+  r.v0 = _mm_cvtps_pd(a);
+  r.v1 = _mm_cvtps_pd(_mm_movehl_ps(a, a));
+  r.v2 = _mm_cvtps_pd(b);
+  r.v3 = _mm_cvtps_pd(_mm_movehl_ps(b, b));
+  return r;
+}
+
+static inline Pairs load8(const double* p) {
+  Pairs r;
+  r.v0 = _mm_loadu_pd(p);
+  r.v1 = _mm_loadu_pd(p + 2);
+  r.v2 = _mm_loadu_pd(p + 4);
+  r.v3 = _mm_loadu_pd(p + 6);
+  return r;
+}
+
+/**
+ * Truncates a pair of doubles to 2 int32 (in the lower half), saturated to
+ * [0, max]. _mm_max_pd returns its second operand for NaNs, which become 0.
+ */
+static inline __m128i truncate(__m128d v, __m128d max) {
+  return _mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(v, _mm_setzero_pd()), max));
+}
+
+/**
+ * Truncates 4 pairs of doubles to 2 x 4 int32, saturated to [0, max]
+ */
+static inline void truncate(const Pairs& v, double max, __m128i& lo,
+    __m128i& hi) {
+  const __m128d top = _mm_set1_pd(max);
+  lo = _mm_unpacklo_epi64(truncate(v.v0, top), truncate(v.v1, top));
+  hi = _mm_unpacklo_epi64(truncate(v.v2, top), truncate(v.v3, top));
+}
+
+static inline void store8(uint8_t* p, const Pairs& v) {
+  __m128i lo, hi;
+  truncate(v, 255., lo, hi);
+  __m128i w = _mm_packs_epi32(lo, hi);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(w, w));
+}
+
+static inline void store8(uint16_t* p, const Pairs& v) {
+  __m128i lo, hi;
+  truncate(v, 65535., lo, hi);
+  // SSE2 only packs to signed 16 bits: shift the range by 2^15 and back
+  const __m128i bias = _mm_set1_epi32(32768);
+  __m128i w = _mm_packs_epi32(_mm_sub_epi32(lo, bias), _mm_sub_epi32(hi, bias));
+  w = _mm_xor_si128(w, _mm_set1_epi16(-32768));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), w);
+}
+
+static inline void store8(float* p, const Pairs& v) {
+  _mm_storeu_ps(p, _mm_movelh_ps(_mm_cvtpd_ps(v.v0), _mm_cvtpd_ps(v.v1)));
+  _mm_storeu_ps(p + 4, _mm_movelh_ps(_mm_cvtpd_ps(v.v2), _mm_cvtpd_ps(v.v3)));
+}
+
+static inline void store8(double* p, const Pairs& v) {
+  _mm_storeu_pd(p, v.v0);
+  _mm_storeu_pd(p + 2, v.v1);
+  _mm_storeu_pd(p + 4, v.v2);
+  _mm_storeu_pd(p + 6, v.v3);
+}
+
+/**
+ * The difference of two source values, as computed by the scalar version:
+ * exact for integers, rounded to float for floats (rounding the exact
+ * double difference gives the same float)
+ */
+template <typename U> static inline __m128d source_diff(__m128d v) {
+  return v;
+}
+
+template <> inline __m128d source_diff<float>(__m128d v) {
+  return _mm_cvtps_pd(_mm_cvtpd_ps(v));
+}
+
+/**
+ * The affine mapping of a pair of source values, with the operations in the
+ * same order as in the scalar version
+ */
+template <typename U> struct Mapping {
+  __m128d src_min, ratio, diff, half, dst_min;
+  inline __m128d operator()(__m128d v) const {
+    v = source_diff<U>(_mm_sub_pd(v, src_min));
+    return _mm_add_pd(dst_min,
+        _mm_add_pd(_mm_mul_pd(_mm_mul_pd(v, ratio), diff), half));
+  }
+};
+
+#endif
+
+template <typename T, typename U>
+static void convert_range(const U* src, T* dst, size_t n,
+    T dst_min, T dst_max, U src_min, U src_max) {
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  const double src_ratio = 1. / ( src_max - src_min);
+  const T dst_diff = dst_max - dst_min;
+  const __m128d lo = _mm_set1_pd(src_min);
+  const __m128d hi = _mm_set1_pd(src_max);
+  const Mapping<U> map = {lo, _mm_set1_pd(src_ratio), _mm_set1_pd(dst_diff),
+    _mm_set1_pd(std::numeric_limits<T>::is_integer?0.5:0),
+    _mm_set1_pd(dst_min)};
+  // _mm_min_pd and _mm_max_pd return their second operand for NaNs, which
+  // are thus ignored, as in the scalar version
+  __m128d smallest = lo, largest = hi;
+  for (; i + 8 <= n; i += 8) {
+    Pairs v = load8(src + i);
+    smallest = _mm_min_pd(_mm_min_pd(v.v0, v.v1), smallest);
+    smallest = _mm_min_pd(_mm_min_pd(v.v2, v.v3), smallest);
+    largest = _mm_max_pd(_mm_max_pd(v.v0, v.v1), largest);
+    largest = _mm_max_pd(_mm_max_pd(v.v2, v.v3), largest);
+    v.v0 = map(v.v0);
+    v.v1 = map(v.v1);
+    v.v2 = map(v.v2);
+    v.v3 = map(v.v3);
+    store8(dst + i, v);
+  }
+  // the scalar version finds and reports the first value out of range
+  if (_mm_movemask_pd(_mm_or_pd(_mm_cmplt_pd(smallest, lo),
+          _mm_cmpgt_pd(largest, hi)))) i = 0;
+#endif
+
+  bob::core::array::detail::convertScalar(src + i, dst + i, n - i,
+      dst_min, dst_max, src_min, src_max);
+}
+
+/**
+ * uint8_t sources only have 256 values, which are converted once into a
+ * table by the scalar version
+ */
+template <typename T>
+static void convert_range(const uint8_t* src, T* dst, size_t n,
+    T dst_min, T dst_max, uint8_t src_min, uint8_t src_max) {
+  uint8_t smallest = src_min, largest = src_max;
+  size_t i = 0;
+#if defined(__SSE2__)
+  __m128i vmin = _mm_set1_epi8(src_min), vmax = _mm_set1_epi8(src_max);
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    vmin = _mm_min_epu8(vmin, v);
+    vmax = _mm_max_epu8(vmax, v);
+  }
+  uint8_t lanes[16];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), vmin);
+  smallest = *std::min_element(lanes, lanes + 16);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), vmax);
+  largest = *std::max_element(lanes, lanes + 16);
+#endif
+  for (; i < n; ++i) {
+    smallest = std::min(smallest, src[i]);
+    largest = std::max(largest, src[i]);
+  }
+  if (smallest < src_min || largest > src_max) {
+    // the scalar version finds and reports the first value out of range
+    bob::core::array::detail::convertScalar(src, dst, n,
+        dst_min, dst_max, src_min, src_max);
+    return;
+  }
+
+  uint8_t values[256];
+  T table[256];
+  const size_t n_values = src_max - src_min + 1;
+  for (size_t k = 0; k < n_values; ++k) values[k] = src_min + k;
+  bob::core::array::detail::convertScalar(values, table + src_min, n_values,
+      dst_min, dst_max, src_min, src_max);
+  for (i = 0; i < n; ++i) dst[i] = table[src[i]];
+}
+
+template <typename T, typename U>
+static void cast_range(const U* in, T* out, size_t n) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 8 <= n; i += 8) store8(out + i, load8(in + i));
+#endif
+  for (; i < n; ++i) out[i] = bob::core::cast<T>(in[i]);
+}
+
+template <typename T, typename U> struct ConvertChunk {
+  const U* src;
+  T* dst;
+  T dst_min, dst_max;
+  U src_min, src_max;
+  void operator()(size_t, size_t begin, size_t end) const {
+    convert_range(src + begin, dst + begin, end - begin,
+        dst_min, dst_max, src_min, src_max);
+  }
+};
+
+template <typename T, typename U> struct CastChunk {
+  const U* in;
+  T* out;
+  void operator()(size_t, size_t begin, size_t end) const {
+    cast_range(in + begin, out + begin, end - begin);
+  }
+};
+
+#define CONVERT_CONTIGUOUS(T, U) template<> \
+  void bob::core::array::detail::convert<T, U>(const U* src, T* dst, \
+    size_t n, T dst_min, T dst_max, U src_min, U src_max) \
+  { \
+    ConvertChunk<T, U> op = {src, dst, dst_min, dst_max, src_min, src_max}; \
+    bob::core::parallel_for(n, op, threads_for(n)); \
+  }
+
+#define CAST_CONTIGUOUS(T, U) template<> \
+  void bob::core::array::detail::cast<T, U>(const U* in, T* out, size_t n) \
+  { \
+    CastChunk<T, U> op = {in, out}; \
+    bob::core::parallel_for(n, op, threads_for(n)); \
+  }
+
+#define CONTIGUOUS(T, U) CONVERT_CONTIGUOUS(T, U) CAST_CONTIGUOUS(T, U)
+
+CONTIGUOUS(float, uint8_t)
+CONTIGUOUS(double, uint8_t)
+CONTIGUOUS(float, uint16_t)
+CONTIGUOUS(double, uint16_t)
+CONTIGUOUS(uint8_t, float)
+CONTIGUOUS(uint8_t, double)
+CONTIGUOUS(uint16_t, float)
+CONTIGUOUS(uint16_t, double)
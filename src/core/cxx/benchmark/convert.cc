@@ -0,0 +1,126 @@
+/**
+ * @file core/cxx/benchmark/convert.cc
+ * @date 2013-07-05
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Measures the conversions and casts between uint8_t/uint16_t and
+ * float/double images, against the equivalent blitz expressions.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <limits>
+#include <boost/random.hpp>
+#include <blitz/array.h>
+
+#include "bob/core/benchmark.h"
+#include "bob/core/array_convert.h"
+#include "bob/core/cast.h"
+
+using bob::core::benchmark::param;
+
+/**
+ * Converts with bob::core::array::convert()
+ */
+template <typename T, typename U> struct Convert {
+  const blitz::Array<U,2>& src;
+  T dst_min, dst_max;
+  U src_min, src_max;
+  void operator()() const {
+    bob::core::array::convert(src, dst_min, dst_max, src_min, src_max);
+  }
+};
+
+/**
+ * The same conversion, as a blitz expression (without the range checks)
+ */
+template <typename T, typename U> struct ConvertExpression {
+  const blitz::Array<U,2>& src;
+  T dst_min, dst_max;
+  U src_min, src_max;
+  blitz::Array<T,2>& dst;
+  void operator()() const {
+    const double ratio = 1. / (src_max - src_min);
+    const T diff = dst_max - dst_min;
+    const double half = std::numeric_limits<T>::is_integer ? 0.5 : 0;
+    dst = blitz::cast<T>(dst_min + ((src - src_min) * ratio) * diff + half);
+  }
+};
+
+template <typename T, typename U> struct Cast {
+  const blitz::Array<U,2>& src;
+  void operator()() const { bob::core::array::cast<T>(src); }
+};
+
+template <typename T, typename U> struct CastExpression {
+  const blitz::Array<U,2>& src;
+  blitz::Array<T,2>& dst;
+  void operator()() const { dst = blitz::cast<T>(src); }
+};
+
+/**
+ * Measures the conversion of src from [src_min, src_max] to [dst_min,
+ * dst_max], and its cast
+ */
+template <typename T, typename U>
+static void run(bob::core::benchmark::Suite& suite, const std::string& name,
+    const blitz::Array<U,2>& src, T dst_min, T dst_max, U src_min, U src_max) {
+  const std::string size = param("size", src.extent(0));
+  blitz::Array<T,2> dst(src.shape());
+
+  Convert<T,U> convert = {src, dst_min, dst_max, src_min, src_max};
+  suite.run("convert_" + name, size, convert);
+  ConvertExpression<T,U> convert_expression = {src, dst_min, dst_max,
+    src_min, src_max, dst};
+  suite.run("convert_" + name + "_expression", size, convert_expression);
+
+  Cast<T,U> cast = {src};
+  suite.run("cast_" + name, size, cast);
+  CastExpression<T,U> cast_expression = {src, dst};
+  suite.run("cast_" + name + "_expression", size, cast_expression);
+}
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("core_convert", argc, argv);
+  // the largest size is split over several threads
+  const int sizes[] = {256, 1024, 4096};
+  const int n_sizes = suite.quick() ? 2 : 3;
+
+  boost::mt19937 rng;
+  boost::uniform_int<> pixel(0, 255);
+
+  for (int s = 0; s < n_sizes; ++s){
+    const int n = sizes[s];
+    blitz::Array<uint8_t,2> u8(n, n);
+    for (int i = 0; i < n; ++i)
+      for (int j = 0; j < n; ++j)
+        u8(i,j) = pixel(rng);
+    blitz::Array<uint16_t,2> u16(n, n);
+    u16 = u8 * 257;
+    blitz::Array<float,2> f32(n, n);
+    f32 = u8;
+    blitz::Array<double,2> f64(n, n);
+    f64 = u8;
+
+    run<double,uint8_t>(suite, "uint8_double", u8, 0., 1., 0, 255);
+    run<float,uint8_t>(suite, "uint8_float", u8, 0.f, 1.f, 0, 255);
+    run<double,uint16_t>(suite, "uint16_double", u16, 0., 1., 0, 65535);
+    run<uint8_t,double>(suite, "double_uint8", f64, 0, 255, 0., 255.);
+    run<uint8_t,float>(suite, "float_uint8", f32, 0, 255, 0.f, 255.f);
+    run<uint16_t,double>(suite, "double_uint16", f64, 0, 65535, 0., 255.);
+  }
+
+  return suite.finish();
+}
@@ -0,0 +1,465 @@
+/**
+ * @file core/cxx/instrument.cc
+ * @date 2013-07-02
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Implements the registry of probes and their per-thread slots
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <boost/format.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#if defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+#include <unistd.h>
+
+#include <bob/core/instrument.h>
+#include <bob/core/logging.h>
+
+namespace instrument = bob::core::instrument;
+
+std::atomic<bool> instrument::detail::enabled(false);
+std::atomic<bool> instrument::detail::tracing(false);
+
+namespace {
+
+  /**
+   * What one thread accumulated on one probe. Only the owning thread writes
+   * it, so updates need no read-modify-write instruction.
+   */
+  struct Slot {
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> total;
+  };
+
+  /**
+   * A scope timed while tracing
+   */
+  struct Event {
+    size_t probe;
+    uint64_t start;
+    uint64_t duration;
+  };
+
+  /**
+   * The slots and trace events of one thread
+   */
+  struct ThreadData {
+
+    ThreadData(size_t index_): index(index_) {
+      for (size_t k=0; k<instrument::MAX_PROBES; ++k) {
+        slots[k].calls.store(0);
+        slots[k].total.store(0);
+      }
+    }
+
+    size_t index; ///< in the order threads first hit a probe
+    Slot slots[instrument::MAX_PROBES];
+    boost::mutex mutex; ///< protects events
+    std::vector<Event> events;
+
+  };
+
+  /**
+   * The trace events of a thread that exited
+   */
+  struct RetiredEvents {
+    size_t index;
+    std::vector<Event> events;
+  };
+
+  /**
+   * Folds the data of an exiting thread into the registry. The registry is
+   * never destroyed before the threads that use it.
+   */
+  void retire_thread_data(ThreadData* data);
+
+  class Registry {
+
+    public:
+
+      static Registry& instance() {
+        static Registry registry;
+        return registry;
+      }
+
+      ~Registry() {
+        m_current.release(); ///< the data of this thread is in m_threads
+        if (m_trace_file.empty()) return;
+        std::ofstream os(m_trace_file.c_str());
+        write_trace(os);
+        if (!os) {
+          bob::core::warn << "could not write the instrumentation trace to `"
+            << m_trace_file << "'" << std::endl;
+        }
+      }
+
+      size_t probe(const std::string& name, instrument::ProbeType type) {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        for (size_t k=0; k<m_names.size(); ++k) {
+          if (m_names[k] != name) continue;
+          if (m_types[k] != type) {
+            boost::format m("instrumentation probe `%s' is already registered with another type");
+            m % name;
+            throw std::invalid_argument(m.str());
+          }
+          return k;
+        }
+        if (m_names.size() >= instrument::MAX_PROBES) {
+          boost::format m("cannot register instrumentation probe `%s': there are already %d probes");
+          m % name % instrument::MAX_PROBES;
+          throw std::length_error(m.str());
+        }
+        m_names.push_back(name);
+        m_types.push_back(type);
+        return m_names.size() - 1;
+      }
+
+      ThreadData& thread() {
+        ThreadData* retval = m_current.get();
+        if (!retval) {
+          boost::lock_guard<boost::mutex> lock(m_mutex);
+          m_threads.push_back(boost::shared_ptr<ThreadData>(new ThreadData(m_next_index++)));
+          retval = m_threads.back().get();
+          m_current.reset(retval);
+        }
+        return *retval;
+      }
+
+      /**
+       * Adds the counts of a thread that exits to those of the threads that
+       * exited before, keeps its trace events and frees the rest
+       */
+      void retire(ThreadData* data) {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        for (size_t k=0; k<m_names.size(); ++k) {
+          uint64_t calls = data->slots[k].calls.load(std::memory_order_relaxed);
+          if (!calls) continue;
+          m_retired.slots[k].calls.store(calls +
+              m_retired.slots[k].calls.load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
+          m_retired.slots[k].total.store(
+              data->slots[k].total.load(std::memory_order_relaxed) +
+              m_retired.slots[k].total.load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
+          ++m_retired_threads[k];
+        }
+        if (!data->events.empty()) {
+          m_retired_events.push_back(RetiredEvents());
+          m_retired_events.back().index = data->index;
+          m_retired_events.back().events.swap(data->events);
+        }
+        for (size_t t=0; t<m_threads.size(); ++t) {
+          if (m_threads[t].get() != data) continue;
+          m_threads.erase(m_threads.begin() + t);
+          break;
+        }
+      }
+
+      const std::string& name(size_t id) {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        return m_names[id];
+      }
+
+      void sum(size_t id, uint64_t& calls, uint64_t& total, size_t& threads) {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        sum_locked(id, calls, total, threads);
+      }
+
+      std::vector<instrument::Statistics> statistics() {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        std::vector<instrument::Statistics> retval(m_names.size());
+        for (size_t k=0; k<m_names.size(); ++k) {
+          retval[k].name = m_names[k];
+          retval[k].type = m_types[k];
+          sum_locked(k, retval[k].calls, retval[k].total, retval[k].threads);
+        }
+        return retval;
+      }
+
+      void reset() {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        for (size_t t=0; t<m_threads.size(); ++t) {
+          for (size_t k=0; k<m_names.size(); ++k) {
+            m_threads[t]->slots[k].calls.store(0, std::memory_order_relaxed);
+            m_threads[t]->slots[k].total.store(0, std::memory_order_relaxed);
+          }
+          boost::lock_guard<boost::mutex> events_lock(m_threads[t]->mutex);
+          m_threads[t]->events.clear();
+        }
+        for (size_t k=0; k<m_names.size(); ++k) {
+          m_retired.slots[k].calls.store(0, std::memory_order_relaxed);
+          m_retired.slots[k].total.store(0, std::memory_order_relaxed);
+          m_retired_threads[k] = 0;
+        }
+        m_retired_events.clear();
+        m_trace_start = instrument::now();
+      }
+
+      void start_trace() {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        m_trace_start = instrument::now();
+      }
+
+      void trace_to(const std::string& filename) {
+        m_trace_file = filename;
+      }
+
+      void write_trace(std::ostream& os);
+
+    private:
+
+      /**
+       * Writes the trace events of one thread
+       */
+      void write_events(std::ostream& os, pid_t pid, size_t index,
+          const std::vector<Event>& events, const char*& separator,
+          uint64_t& last);
+
+      Registry():
+        m_next_index(0),
+        m_retired(0),
+        m_retired_threads(instrument::MAX_PROBES, 0),
+        m_current(retire_thread_data),
+        m_trace_start(instrument::now()) { }
+
+      void sum_locked(size_t id, uint64_t& calls, uint64_t& total,
+          size_t& threads) {
+        calls = m_retired.slots[id].calls.load(std::memory_order_relaxed);
+        total = m_retired.slots[id].total.load(std::memory_order_relaxed);
+        threads = m_retired_threads[id];
+        for (size_t t=0; t<m_threads.size(); ++t) {
+          const Slot& slot = m_threads[t]->slots[id];
+          uint64_t c = slot.calls.load(std::memory_order_relaxed);
+          if (!c) continue;
+          calls += c;
+          total += slot.total.load(std::memory_order_relaxed);
+          ++threads;
+        }
+      }
+
+      boost::mutex m_mutex; ///< protects everything but the slots
+      std::deque<std::string> m_names; ///< references to names stay valid
+      std::vector<instrument::ProbeType> m_types;
+      std::vector<boost::shared_ptr<ThreadData> > m_threads; ///< running
+      size_t m_next_index; ///< of the next thread to hit a probe
+      ThreadData m_retired; ///< sums of the threads that exited
+      std::vector<size_t> m_retired_threads; ///< exited threads, per probe
+      std::vector<RetiredEvents> m_retired_events; ///< of exited threads
+      boost::thread_specific_ptr<ThreadData> m_current; ///< this thread's
+      uint64_t m_trace_start; ///< trace timestamps are relative to this
+      std::string m_trace_file; ///< where to write the trace at exit
+
+  };
+
+  void retire_thread_data(ThreadData* data) {
+    Registry::instance().retire(data);
+  }
+
+  /**
+   * Escapes a string so it can be written as a JSON string
+   */
+  std::string json_string(const std::string& s) {
+    std::string retval("\"");
+    for (size_t k=0; k<s.size(); ++k) {
+      if (s[k] == '"' || s[k] == '\\') retval += '\\';
+      if ((unsigned char)s[k] < 0x20) retval += ' ';
+      else retval += s[k];
+    }
+    retval += '"';
+    return retval;
+  }
+
+  const char* type_name(instrument::ProbeType type) {
+    return (type == instrument::Timer) ? "timer" : "counter";
+  }
+
+  /**
+   * Microseconds, as expected by the trace format
+   */
+  std::string microseconds(uint64_t ns) {
+    boost::format f("%d.%03d");
+    f % (ns / 1000) % (ns % 1000);
+    return f.str();
+  }
+
+  /**
+   * Configures the instrumentation from the environment, before main() runs
+   */
+  bool configure_from_environment() {
+    const char* value = getenv("BOB_INSTRUMENT");
+    if (!value || !*value || std::string(value) == "0") return false;
+    if (std::string(value) != "1") {
+      Registry::instance().trace_to(value);
+      instrument::trace(true);
+    }
+    else instrument::enable(true);
+    return true;
+  }
+
+  const bool configured_from_environment = configure_from_environment();
+
+}
+
+void Registry::write_events(std::ostream& os, pid_t pid, size_t index,
+    const std::vector<Event>& events, const char*& separator,
+    uint64_t& last) {
+  for (size_t e=0; e<events.size(); ++e) {
+    if (events[e].start < m_trace_start) continue; ///< before a reset()
+    os << separator << "{\"name\": " << json_string(m_names[events[e].probe])
+      << ", \"cat\": \"bob\", \"ph\": \"X\", \"pid\": " << pid
+      << ", \"tid\": " << index
+      << ", \"ts\": " << microseconds(events[e].start - m_trace_start)
+      << ", \"dur\": " << microseconds(events[e].duration) << "}";
+    separator = ",\n";
+    last = std::max(last, events[e].start + events[e].duration);
+  }
+}
+
+void Registry::write_trace(std::ostream& os) {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  pid_t pid = getpid();
+  uint64_t last = m_trace_start;
+  const char* separator = "\n";
+
+  os << "{\"traceEvents\": [";
+  for (size_t t=0; t<m_retired_events.size(); ++t) {
+    write_events(os, pid, m_retired_events[t].index,
+        m_retired_events[t].events, separator, last);
+  }
+  for (size_t t=0; t<m_threads.size(); ++t) {
+    boost::lock_guard<boost::mutex> events_lock(m_threads[t]->mutex);
+    write_events(os, pid, m_threads[t]->index, m_threads[t]->events,
+        separator, last);
+  }
+
+  //counters are shown with their final value, at the end of the trace
+  for (size_t k=0; k<m_names.size(); ++k) {
+    if (m_types[k] != instrument::Counter) continue;
+    uint64_t calls, total;
+    size_t threads;
+    sum_locked(k, calls, total, threads);
+    os << separator << "{\"name\": " << json_string(m_names[k])
+      << ", \"cat\": \"bob\", \"ph\": \"C\", \"pid\": " << pid
+      << ", \"tid\": 0, \"ts\": " << microseconds(last - m_trace_start)
+      << ", \"args\": {\"total\": " << total << "}}";
+    separator = ",\n";
+  }
+
+  os << "\n], \"displayTimeUnit\": \"ns\"}" << std::endl;
+}
+
+void instrument::enable(bool on) {
+  detail::enabled.store(on);
+  if (!on) detail::tracing.store(false);
+}
+
+void instrument::trace(bool on) {
+  if (on) {
+    Registry::instance().start_trace();
+    detail::enabled.store(true);
+  }
+  detail::tracing.store(on);
+}
+
+uint64_t instrument::now() {
+#if defined(__APPLE__)
+  static mach_timebase_info_data_t info = {0, 0};
+  if (!info.denom) mach_timebase_info(&info);
+  return mach_absolute_time() * info.numer / info.denom;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+instrument::Probe::Probe(const std::string& name, ProbeType type):
+  m_id(Registry::instance().probe(name, type))
+{
+}
+
+void instrument::Probe::add(uint64_t amount) const {
+  Slot& slot = Registry::instance().thread().slots[m_id];
+  slot.calls.store(slot.calls.load(std::memory_order_relaxed) + 1,
+      std::memory_order_relaxed);
+  slot.total.store(slot.total.load(std::memory_order_relaxed) + amount,
+      std::memory_order_relaxed);
+}
+
+const std::string& instrument::Probe::name() const {
+  return Registry::instance().name(m_id);
+}
+
+uint64_t instrument::Probe::calls() const {
+  uint64_t calls, total;
+  size_t threads;
+  Registry::instance().sum(m_id, calls, total, threads);
+  return calls;
+}
+
+uint64_t instrument::Probe::total() const {
+  uint64_t calls, total;
+  size_t threads;
+  Registry::instance().sum(m_id, calls, total, threads);
+  return total;
+}
+
+void instrument::ScopedTimer::stop() {
+  uint64_t duration = now() - m_start;
+  m_probe.add(duration);
+  if (tracing()) {
+    ThreadData& thread = Registry::instance().thread();
+    Event event = {m_probe.id(), m_start, duration};
+    boost::lock_guard<boost::mutex> lock(thread.mutex);
+    thread.events.push_back(event);
+  }
+}
+
+std::vector<instrument::Statistics> instrument::statistics() {
+  return Registry::instance().statistics();
+}
+
+void instrument::reset() {
+  Registry::instance().reset();
+}
+
+void instrument::write_json(std::ostream& os) {
+  std::vector<Statistics> stats = statistics();
+  os << "{\"probes\": [";
+  for (size_t k=0; k<stats.size(); ++k) {
+    os << (k ? ",\n" : "\n") << "{\"name\": " << json_string(stats[k].name)
+      << ", \"type\": \"" << type_name(stats[k].type) << "\""
+      << ", \"calls\": " << stats[k].calls
+      << ", \"total\": " << stats[k].total
+      << ", \"threads\": " << stats[k].threads << "}";
+  }
+  os << "\n]}" << std::endl;
+}
+
+void instrument::write_trace(std::ostream& os) {
+  Registry::instance().write_trace(os);
+}
@@ -25,6 +25,7 @@
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 #include <blitz/array.h>
+#include <limits>
 #include <stdint.h>
 #include <iostream>
 #include <bob/core/logging.h>
@@ -111,5 +112,113 @@ BOOST_AUTO_TEST_CASE( test_convert_uint8_to_uint16 )
   checkBlitzEqual( f, f64);
 }
 
+/**
+ * Converts and casts a contiguous array and a strided view of the same
+ * values, which go through different implementations
+ */
+template<typename T, typename U>
+void checkContiguous(const blitz::Array<U,2>& src, T dst_min, T dst_max,
+  U src_min, U src_max)
+{
+  blitz::Array<U,2> strided(src.extent(0), 2*src.extent(1));
+  blitz::Array<U,2> view = strided(blitz::Range::all(),
+    blitz::Range(0, 2*src.extent(1)-1, 2));
+  view = src;
+  BOOST_REQUIRE(!bob::core::array::isCContiguous(view));
+
+  blitz::Array<T,2> a = bob::core::array::convert(src, dst_min, dst_max,
+    src_min, src_max);
+  blitz::Array<T,2> b = bob::core::array::convert(view, dst_min, dst_max,
+    src_min, src_max);
+  BOOST_CHECK(blitz::all(a == b));
+
+  blitz::Array<T,2> c = bob::core::array::cast<T>(src);
+  blitz::Array<T,2> d = bob::core::array::cast<T>(view);
+  BOOST_CHECK(blitz::all(c == d));
+}
+
+BOOST_AUTO_TEST_CASE( test_convert_contiguous )
+{
+  // enough values for the vectorized loops and their remainders
+  blitz::Array<uint8_t,2> u8(7, 37);
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+  u8 = (i * 37 + j) % 256;
+  blitz::Array<uint16_t,2> u16(u8.shape());
+  u16 = u8 * 257;
+  blitz::Array<double,2> f64(u8.shape());
+  f64 = u8 / 255.;
+  blitz::Array<float,2> f32(u8.shape());
+  f32 = u8 / 255.f;
+
+  checkContiguous<double,uint8_t>(u8, 0., 1., 0, 255);
+  checkContiguous<float,uint8_t>(u8, -1.f, 1.f, 0, 255);
+  checkContiguous<double,uint16_t>(u16, 0., 1., 0, 65535);
+  checkContiguous<float,uint16_t>(u16, 0.f, 255.f, 0, 65535);
+  checkContiguous<uint8_t,double>(f64, 0, 255, 0., 1.);
+  checkContiguous<uint8_t,float>(f32, 0, 255, 0.f, 1.f);
+  checkContiguous<uint16_t,double>(f64, 0, 65535, 0., 1.);
+  checkContiguous<uint16_t,float>(f32, 0, 65535, 0.f, 1.f);
+
+  // the first value out of range is reported
+  f64(5,30) = 1.5;
+  f64(6,2) = -1.;
+  BOOST_CHECK_THROW(bob::core::array::convert(f64, (uint8_t)0, (uint8_t)255,
+      0., 1.), bob::core::array::ConvertInputAboveMaxRange);
+  BOOST_CHECK_THROW(bob::core::array::convert(u8, 0., 1., (uint8_t)10,
+      (uint8_t)255), bob::core::array::ConvertInputBelowMinRange);
+}
+
+BOOST_AUTO_TEST_CASE( test_convert_parallel )
+{
+  // large enough to be split over several threads (if there are cores)
+  blitz::Array<double,2> f64(1024, 1031);
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+  f64 = ((i * 1031 + j) % 256) / 255.;
+  checkContiguous<uint8_t,double>(f64, 0, 255, 0., 1.);
+  checkContiguous<uint16_t,double>(f64, 0, 65535, 0., 1.);
+
+  // errors raised in the last chunks are reported, the first one first
+  f64(1023,1030) = 1.5;
+  BOOST_CHECK_THROW(bob::core::array::convert(f64, (uint8_t)0, (uint8_t)255,
+      0., 1.), bob::core::array::ConvertInputAboveMaxRange);
+  f64(300,0) = -1.;
+  BOOST_CHECK_THROW(bob::core::array::convert(f64, (uint8_t)0, (uint8_t)255,
+      0., 1.), bob::core::array::ConvertInputBelowMinRange);
+}
+
+BOOST_AUTO_TEST_CASE( test_cast_saturates )
+{
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  blitz::Array<double,1> a(11);
+  a = -5., 300., 255.9, 70000., 1e20, -1e20, 3.7, 0., 65535., 1., nan;
+  blitz::Array<uint8_t,1> b = bob::core::array::cast<uint8_t>(a);
+  blitz::Array<uint8_t,1> b_ref(11);
+  b_ref = 0, 255, 255, 255, 255, 0, 3, 0, 255, 1, 0;
+  BOOST_CHECK(blitz::all(b == b_ref));
+  blitz::Array<uint16_t,1> c = bob::core::array::cast<uint16_t>(a);
+  blitz::Array<uint16_t,1> c_ref(11);
+  c_ref = 0, 300, 255, 65535, 65535, 0, 3, 0, 65535, 1, 0;
+  BOOST_CHECK(blitz::all(c == c_ref));
+
+  // strided arrays and other types use the scalar cast, which saturates too
+  blitz::Array<double,1> strided(22);
+  blitz::Array<double,1> view = strided(blitz::Range(0, 21, 2));
+  view = a;
+  BOOST_REQUIRE(!bob::core::array::isCContiguous(view));
+  BOOST_CHECK(blitz::all(bob::core::array::cast<uint8_t>(view) == b_ref));
+  BOOST_CHECK(blitz::all(bob::core::array::cast<uint16_t>(view) == c_ref));
+
+  blitz::Array<int8_t,1> d = bob::core::array::cast<int8_t>(a);
+  blitz::Array<int8_t,1> d_ref(11);
+  d_ref = -5, 127, 127, 127, 127, -128, 3, 0, 127, 1, 0;
+  BOOST_CHECK(blitz::all(d == d_ref));
+  BOOST_CHECK_EQUAL(bob::core::cast<int32_t>(3e9f), 2147483647);
+  BOOST_CHECK_EQUAL(bob::core::cast<int64_t>(-1e30), std::numeric_limits<int64_t>::min());
+  BOOST_CHECK_EQUAL(bob::core::cast<uint32_t>(-2.5L), 0u);
+  BOOST_CHECK_EQUAL(bob::core::cast<int16_t>(-3.9), -3);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,156 @@
+/**
+ * @file core/cxx/test/instrument.cc
+ * @date 2013-07-02
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Tests the instrumentation counters and timers
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Core-instrument Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <bob/core/instrument.h>
+#include <bob/core/parallel.h>
+
+namespace instrument = bob::core::instrument;
+
+static void count_samples(size_t n) {
+  BOB_COUNT("test.samples", n);
+}
+
+struct TimeSamples {
+  void operator()(size_t thread, size_t begin, size_t end) const;
+};
+
+struct CountSamples {
+  void operator()(size_t thread, size_t begin, size_t end) const {
+    for (size_t i = begin; i < end; ++i) count_samples(1);
+  }
+};
+
+static void timed() {
+  BOB_TIME_SCOPE("test.timed");
+  count_samples(0);
+}
+
+void TimeSamples::operator()(size_t thread, size_t begin,
+    size_t end) const {
+  for (size_t i = begin; i < end; ++i) timed();
+}
+
+static const instrument::Statistics& find(
+    const std::vector<instrument::Statistics>& stats, const std::string& name) {
+  for (size_t k = 0; k < stats.size(); ++k)
+    if (stats[k].name == name) return stats[k];
+  throw std::runtime_error("probe not found");
+}
+
+BOOST_AUTO_TEST_CASE( test_disabled_probes_do_not_record )
+{
+  instrument::enable(false);
+  instrument::Probe probe("test.disabled");
+  probe(10);
+  BOOST_CHECK_EQUAL(probe.calls(), 0);
+  BOOST_CHECK_EQUAL(probe.total(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_counters_aggregate_threads )
+{
+  instrument::enable();
+  instrument::reset();
+  bob::core::parallel_for(1000, CountSamples(), 4);
+  count_samples(24);
+
+  instrument::Probe probe("test.samples");
+  BOOST_CHECK_EQUAL(probe.calls(), 1001);
+  BOOST_CHECK_EQUAL(probe.total(), 1024);
+  BOOST_CHECK_EQUAL(find(instrument::statistics(), "test.samples").threads, 5);
+
+  instrument::reset();
+  BOOST_CHECK_EQUAL(probe.total(), 0);
+  instrument::enable(false);
+}
+
+BOOST_AUTO_TEST_CASE( test_probes_are_typed )
+{
+  instrument::Probe counter("test.typed");
+  BOOST_CHECK_EQUAL(counter.name(), "test.typed");
+  BOOST_CHECK_EQUAL(counter.id(), instrument::Probe("test.typed").id());
+  BOOST_CHECK_THROW(instrument::Probe("test.typed", instrument::Timer),
+      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( test_timers_and_traces )
+{
+  instrument::trace();
+  BOOST_CHECK(instrument::enabled());
+  for (size_t i = 0; i < 3; ++i) timed();
+  instrument::trace(false);
+
+  const instrument::Statistics& stats = find(instrument::statistics(),
+      "test.timed");
+  BOOST_CHECK_EQUAL(stats.type, instrument::Timer);
+  BOOST_CHECK_EQUAL(stats.calls, 3);
+  BOOST_CHECK(stats.total > 0);
+
+  std::ostringstream trace;
+  instrument::write_trace(trace);
+  BOOST_CHECK(trace.str().find("\"name\": \"test.timed\", \"cat\": \"bob\", \"ph\": \"X\"") != std::string::npos);
+  BOOST_CHECK(trace.str().find("\"ph\": \"C\"") != std::string::npos);
+
+  std::ostringstream json;
+  instrument::write_json(json);
+  BOOST_CHECK(json.str().find("{\"name\": \"test.timed\", \"type\": \"timer\", \"calls\": 3") != std::string::npos);
+
+  instrument::enable(false);
+  instrument::reset();
+}
+
+BOOST_AUTO_TEST_CASE( test_exited_threads_are_kept )
+{
+  // threads that exit leave their counts and trace events behind
+  instrument::trace();
+  instrument::reset();
+  for (size_t round = 0; round < 50; ++round) {
+    bob::core::parallel_for(8, CountSamples(), 4);
+    bob::core::parallel_for(4, TimeSamples(), 2);
+  }
+  instrument::trace(false);
+
+  const instrument::Statistics& samples = find(instrument::statistics(),
+      "test.samples");
+  BOOST_CHECK_EQUAL(samples.calls, 50 * 12);
+  BOOST_CHECK_EQUAL(samples.total, 50 * 8);
+  BOOST_CHECK_EQUAL(samples.threads, 50 * 6);
+  BOOST_CHECK_EQUAL(find(instrument::statistics(), "test.timed").calls,
+      50 * 4);
+
+  std::ostringstream trace;
+  instrument::write_trace(trace);
+  size_t events = 0;
+  for (size_t pos = trace.str().find("\"ph\": \"X\"");
+      pos != std::string::npos;
+      pos = trace.str().find("\"ph\": \"X\"", pos + 1)) ++events;
+  BOOST_CHECK_EQUAL(events, 50 * 4);
+
+  instrument::reset();
+  BOOST_CHECK_EQUAL(find(instrument::statistics(), "test.samples").threads, 0);
+  instrument::enable(false);
+}
@@ -0,0 +1,123 @@
+/**
+ * @file core/cxx/test/parallel.cc
+ * @date Mon Jun 10 10:12:27 2013 +0200
+ * @author Manuel Guenther <Manuel.Guenther@idiap.ch>
+ *
+ * @brief Test the splitting of loops into several threads
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Core-parallel Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <stdexcept>
+#include <vector>
+#include <bob/core/parallel.h>
+
+struct Fill {
+  std::vector<size_t>& values;
+  std::vector<size_t>& threads;
+  Fill(std::vector<size_t>& v, std::vector<size_t>& t): values(v), threads(t) {}
+  void operator()(size_t thread, size_t begin, size_t end) const {
+    for (size_t i = begin; i < end; ++i) {
+      values[i] += i;
+      threads[i] = thread;
+    }
+  }
+};
+
+struct Throw {
+  void operator()(size_t thread, size_t begin, size_t end) const {
+    if (thread == 1) throw std::runtime_error("thread 1 failed");
+  }
+};
+
+static void sum_chunk(size_t thread, size_t begin, size_t end,
+    std::vector<size_t>& sums) {
+  for (size_t i = begin; i < end; ++i) sums[thread] += i;
+}
+
+static void produce(bob::core::bounded_queue<size_t>* queue, size_t count) {
+  for (size_t i = 0; i < count; ++i)
+    if (!queue->push(i)) return;
+  queue->close();
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_for )
+{
+  for (size_t n_threads = 1; n_threads < 6; ++n_threads) {
+    std::vector<size_t> values(103, 0), threads(103, 0);
+    bob::core::parallel_for(values.size(), Fill(values, threads), n_threads);
+    for (size_t i = 0; i < values.size(); ++i) {
+      // each index is processed exactly once
+      BOOST_CHECK_EQUAL(values[i], i);
+      // the chunks are consecutive
+      if (i) BOOST_CHECK(threads[i] >= threads[i-1]);
+    }
+    BOOST_CHECK_EQUAL(threads.back(), n_threads - 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_for_bind )
+{
+  // the op may be a bind expression, as long as it is not evaluated early
+  std::vector<size_t> sums(4, 0);
+  bob::core::parallel_for(100,
+      boost::bind(&sum_chunk, _1, _2, _3, boost::ref(sums)), sums.size());
+  BOOST_CHECK_EQUAL(sums[0] + sums[1] + sums[2] + sums[3], 4950);
+  BOOST_CHECK_EQUAL(sums[0], 300);
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_for_small )
+{
+  // more threads than elements
+  std::vector<size_t> values(3, 0), threads(3, 0);
+  bob::core::parallel_for(values.size(), Fill(values, threads), 8);
+  for (size_t i = 0; i < values.size(); ++i) BOOST_CHECK_EQUAL(values[i], i);
+
+  // no elements at all
+  std::vector<size_t> empty;
+  bob::core::parallel_for(0, Fill(empty, empty), 4);
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_for_exception )
+{
+  BOOST_CHECK_THROW(bob::core::parallel_for(10, Throw(), 3), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_bounded_queue )
+{
+  // items arrive in order, and never more than the capacity is queued
+  bob::core::bounded_queue<size_t> queue(4);
+  boost::thread producer(boost::bind(&produce, &queue, 100));
+  size_t item, expected = 0;
+  while (queue.pop(item)) {
+    BOOST_CHECK_EQUAL(item, expected++);
+    BOOST_CHECK(queue.size() <= queue.capacity());
+  }
+  producer.join();
+  BOOST_CHECK_EQUAL(expected, 100);
+
+  // closing the queue stops a blocked producer
+  bob::core::bounded_queue<size_t> stopped(2);
+  boost::thread blocked(boost::bind(&produce, &stopped, 100));
+  BOOST_CHECK(stopped.pop(item));
+  stopped.close();
+  blocked.join();
+  while (stopped.pop(item)) BOOST_CHECK(item < 4);
+  BOOST_CHECK(!stopped.push(0));
+}
@@ -0,0 +1,79 @@
+/**
+ * @file core/python/instrument.cc
+ * @date 2013-07-02
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Binds the instrumentation counters and timers into python
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <stdexcept>
+#include <boost/format.hpp>
+#include <boost/python.hpp>
+#include <bob/core/instrument.h>
+
+using namespace boost::python;
+
+namespace instrument = bob::core::instrument;
+
+static void enable(bool on) { instrument::enable(on); }
+static void trace(bool on) { instrument::trace(on); }
+
+static dict statistics() {
+  dict retval;
+  std::vector<instrument::Statistics> stats = instrument::statistics();
+  for (size_t k=0; k<stats.size(); ++k) {
+    dict probe;
+    probe["type"] = (stats[k].type == instrument::Timer) ? "timer" : "counter";
+    probe["calls"] = stats[k].calls;
+    probe["total"] = stats[k].total;
+    probe["threads"] = stats[k].threads;
+    retval[stats[k].name] = probe;
+  }
+  return retval;
+}
+
+static std::ofstream& open(std::ofstream& os, const std::string& filename) {
+  os.open(filename.c_str());
+  if (!os) {
+    boost::format m("cannot open file `%s' for writing");
+    m % filename;
+    throw std::runtime_error(m.str());
+  }
+  return os;
+}
+
+static void write_json(const std::string& filename) {
+  std::ofstream os;
+  instrument::write_json(open(os, filename));
+}
+
+static void write_trace(const std::string& filename) {
+  std::ofstream os;
+  instrument::write_trace(open(os, filename));
+}
+
+void bind_core_instrument() {
+  def("enable_instrumentation", &enable, (arg("on")=true), "Starts (or stops) recording on the instrumentation probes of Bob's C++ code, which count quantities (samples processed, bytes read, ...) and time hot code paths. You can also set the environment variable ``BOB_INSTRUMENT`` to ``1`` to enable them from the start.");
+  def("instrumentation_enabled", &instrument::enabled, "Tells if the instrumentation probes are recording");
+  def("enable_tracing", &trace, (arg("on")=true), "Starts (or stops) recording a trace event each time a timed code path is run, which you can save with write_trace(). Starting a trace also enables instrumentation. If the environment variable ``BOB_INSTRUMENT`` contains a file name, a trace is recorded from the start and saved to that file when the program exits.");
+  def("tracing_enabled", &instrument::tracing, "Tells if trace events are being recorded");
+  def("instrumentation_statistics", &statistics, "Returns a dictionary with the statistics of each probe, indexed by name: its ``type`` (``'counter'`` or ``'timer'``), the number of ``calls``, the ``total`` amount counted (in nanoseconds for timers) and the number of ``threads`` that hit it");
+  def("reset_instrumentation", &instrument::reset, "Zeroes all probes and discards the recorded trace events");
+  def("write_instrumentation", &write_json, (arg("filename")), "Writes the statistics of all probes to a JSON file");
+  def("write_trace", &write_trace, (arg("filename")), "Writes the recorded trace events to a file in the Chrome trace event format (JSON), which can be loaded in chrome://tracing");
+}
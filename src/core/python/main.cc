@@ -33,6 +33,7 @@ void bind_core_typeinfo();
 void bind_core_convert();
 void bind_core_tinyvector();
 void bind_core_numpy_scalars();
+void bind_core_instrument();
 
 #if WITH_PERFTOOLS
 void bind_core_profiler();
@@ -50,6 +51,7 @@ BOOST_PYTHON_MODULE(_core) {
   bind_core_convert();
   bind_core_tinyvector();
   bind_core_numpy_scalars();
+  bind_core_instrument();
 
 #if WITH_PERFTOOLS
   bind_core_profiler();
@@ -20,8 +20,11 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
+
 #include <bob/core/logging.h>
 #include <bob/core/array_type.h>
+#include <bob/core/blitz_array.h>
 
 #include <bob/io/BinFile.h>
 
@@ -69,6 +72,16 @@ bob::io::BinFile::BinFile(const std::string& filename, bob::io::BinFile::openmod
         bob::core::error << "Cannot append data in read only mode." << std::endl;
         throw bob::core::Exception();
       }
+
+      if (flag & bob::io::BinFile::map) {
+        try {
+          m_map.reset(new bob::io::detail::MappedFile(filename));
+        }
+        catch (std::exception& e) {
+          TDEBUG1("cannot map file `" << filename << "' into memory, " <<
+              "reading through a stream instead: " << e.what());
+        }
+      }
     }
   }
   else
@@ -88,6 +101,7 @@ void bob::io::BinFile::close() {
   if(m_openmode & bob::io::BinFile::out) m_header.write(m_stream);
 
   m_stream.close();
+  m_map.reset();
 }
 
 void bob::io::BinFile::initHeader(const bob::core::array::ElementType type, 
@@ -144,7 +158,13 @@ void bob::io::BinFile::read (bob::core::array::interface& a) {
   
   if(!a.type().is_compatible(compat)) a.set(compat);
 
-  m_stream.read((char*)a.ptr(), a.type().buffer_size());
+  if (m_map) {
+    endOfFile();
+    const char* data = m_map->fetch(m_header.getArrayIndex(m_current_array),
+        a.type().buffer_size());
+    std::memcpy(a.ptr(), data, a.type().buffer_size());
+  }
+  else m_stream.read((char*)a.ptr(), a.type().buffer_size());
   ++m_current_array;
 }
 
@@ -156,7 +176,7 @@ void bob::io::BinFile::read (size_t index, bob::core::array::interface& a) {
 
   // Set the stream pointer at the correct position
   size_t old_index = m_current_array;
-  m_stream.seekg( m_header.getArrayIndex(index) );
+  if (!m_map) m_stream.seekg( m_header.getArrayIndex(index) );
   m_current_array = index;
 
   // Put the content of the stream in the blitz array.
@@ -164,8 +184,32 @@ void bob::io::BinFile::read (size_t index, bob::core::array::interface& a) {
     return read(a);
   }
   catch (std::invalid_argument& e) {
-    m_stream.seekg( m_header.getArrayIndex(old_index) );
+    if (!m_map) m_stream.seekg( m_header.getArrayIndex(old_index) );
     m_current_array = old_index;
     throw e;
   }
 }
+
+boost::shared_ptr<bob::core::array::interface> 
+bob::io::BinFile::view (size_t index) {
+  // Check that we are reaching an existing array
+  if( index >= m_header.m_n_samples ) {
+    throw IndexError(index);
+  }
+
+  bob::core::array::typeinfo info(getElementType(), m_header.getNDim(),
+      m_header.getShape());
+
+  if (!m_map) {
+    boost::shared_ptr<bob::core::array::interface> retval(new
+        bob::core::array::blitz_array(info));
+    read(index, *retval);
+    return retval;
+  }
+
+  // Data is stored in the native byte order and layout: no copy needed
+  boost::shared_ptr<bob::core::array::interface> retval =
+    m_map->view(m_header.getArrayIndex(index), info);
+  m_current_array = index + 1;
+  return retval;
+}
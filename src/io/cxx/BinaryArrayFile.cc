@@ -135,7 +135,7 @@ static boost::shared_ptr<bob::io::File>
 make_file (const std::string& path, char mode) {
 
   bob::io::BinFile::openmode _mode;
-  if (mode == 'r') _mode = bob::io::BinFile::in;
+  if (mode == 'r') _mode = bob::io::BinFile::in | bob::io::BinFile::map;
   else if (mode == 'w') _mode = bob::io::BinFile::out;
   else if (mode == 'a') _mode = bob::io::BinFile::append;
   else throw std::invalid_argument("unsupported binary (.bin) file opening mode");
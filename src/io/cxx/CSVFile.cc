@@ -24,20 +24,128 @@
 #include <sstream>
 #include <fstream>
 #include <string>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
-#include <boost/filesystem.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/tokenizer.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
 #include <boost/shared_array.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <bob/core/parallel.h>
 #include <bob/io/CodecRegistry.h>
 #include <bob/io/Exception.h>
 
 typedef boost::tokenizer<boost::escaped_list_separator<char> > Tokenizer;
 
+/**
+ * The minimum number of bytes that are scanned or converted by a single
+ * thread
+ */
+static const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+/**
+ * Lines containing quotes or escapes are handled by the (slow) tokenizer,
+ * all other lines are split at the commas
+ */
+static bool is_plain(const char* begin, const char* end) {
+  return !std::memchr(begin, '"', end - begin) &&
+    !std::memchr(begin, '\\', end - begin);
+}
+
+/**
+ * Returns the end of the line starting at begin (the position of the new
+ * line character or end)
+ */
+static const char* end_of_line(const char* begin, const char* end) {
+  const char* eol = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+  return eol ? eol : end;
+}
+
+/**
+ * Counts the entries of a line
+ */
+static size_t count_entries(const char* begin, const char* end) {
+  if (is_plain(begin, end)) return std::count(begin, end, ',') + 1;
+  std::string line(begin, end);
+  Tokenizer tok(line);
+  return std::distance(tok.begin(), tok.end());
+}
+
+/**
+ * Converts a single field, which is not null-terminated. Like the stream
+ * extraction this replaces, leading white space and trailing characters are
+ * ignored and fields that are not numbers are read as 0.
+ */
+static double parse_field(const char* begin, const char* end) {
+  char buffer[64];
+  size_t length = end - begin;
+  if (length < sizeof(buffer)) {
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+    return std::strtod(buffer, 0);
+  }
+  return std::strtod(std::string(begin, end).c_str(), 0);
+}
+
+/**
+ * Converts a line with the given number of entries into p
+ */
+static void parse_line(const char* begin, const char* end, size_t entries,
+    double* p) {
+  if (is_plain(begin, end)) {
+    for (size_t k = 0; k < entries; ++k) {
+      const char* comma = static_cast<const char*>(std::memchr(begin, ',', end - begin));
+      if (!comma) comma = end;
+      p[k] = parse_field(begin, comma);
+      begin = comma + 1;
+    }
+    return;
+  }
+  std::string line(begin, end);
+  Tokenizer tok(line);
+  for(Tokenizer::iterator k=tok.begin(); k!=tok.end(); ++k) {
+    *(p++) = parse_field(k->data(), k->data() + k->size());
+  }
+}
+
+/**
+ * The line offsets and number of entries of a consecutive block of lines
+ */
+struct CSVChunk {
+  const char* begin;
+  const char* end;
+  std::vector<uint64_t> offsets;
+  size_t entries; ///< entries of the first line in the chunk
+  size_t error_line; ///< first line with a different number of entries
+  size_t error_entries; ///< number of entries found in that line
+};
+
+static void scan_chunks(size_t, size_t begin, size_t end,
+    std::vector<CSVChunk>& chunks, const char* data) {
+  for (size_t i = begin; i < end; ++i) {
+    CSVChunk& chunk = chunks[i];
+    chunk.entries = 0;
+    chunk.error_line = 0;
+    for (const char* line = chunk.begin; line < chunk.end; ) {
+      const char* eol = end_of_line(line, chunk.end);
+      size_t size = count_entries(line, eol);
+      chunk.offsets.push_back(line - data);
+      if (!chunk.entries) chunk.entries = size;
+      else if (chunk.entries != size) {
+        chunk.error_line = chunk.offsets.size();
+        chunk.error_entries = size;
+        break;
+      }
+      line = eol + 1;
+    }
+  }
+}
+
 class CSVFile: public bob::io::File {
 
   public: //api
@@ -45,34 +153,64 @@ class CSVFile: public bob::io::File {
     /**
      * Peeks the file contents for a type. We assume the element type to be
      * always doubles. This method, effectively, only peaks for the total
-     * number of lines and the number of columns in the file.
+     * number of lines and the number of columns in the file. The memory
+     * mapped file is scanned in blocks of lines, in parallel.
      */
     void peek() {
 
-      std::string line;
-      size_t line_number = 0;
+      m_offsets.clear();
+
+      const char* data = map();
+      if (!data) { //empty file
+        m_newfile = true;
+        return;
+      }
+      const char* data_end = data + m_map.size();
+
+      // split the file into chunks of consecutive lines, one per thread
+      size_t threads = bob::core::number_of_threads();
+      size_t chunk_count = std::max<size_t>(1, std::min(threads, m_map.size() / MIN_CHUNK_SIZE));
+      std::vector<CSVChunk> chunks(chunk_count);
+      const char* begin = data;
+      for (size_t i = 0; i < chunk_count; ++i) {
+        const char* end = data_end;
+        if (i + 1 < chunk_count) {
+          end = data + m_map.size() * (i+1) / chunk_count;
+          if (end < begin) end = begin;
+          // move the chunk end behind the next line break
+          const char* eol = end_of_line(end, data_end);
+          end = eol < data_end ? eol + 1 : data_end;
+        }
+        chunks[i].begin = begin;
+        chunks[i].end = end;
+        begin = end;
+      }
+
+      bob::core::parallel_for(chunk_count, boost::bind(&scan_chunks, _1, _2,
+            _3, boost::ref(chunks), data), chunk_count);
+
+      // merge the line offsets and check that all lines have the same number
+      // of entries as the first one
       size_t entries = 0;
-      std::streampos cur_pos = 0;
-
-      m_file.seekg(0); //< returns to the begin of file and start reading...
-
-      while (std::getline(m_file,line)) {
-        ++line_number;
-        m_pos.push_back(cur_pos);
-        cur_pos = m_file.tellg();
-        Tokenizer tok(line);
-        size_t size = std::distance(tok.begin(), tok.end());
-        if (!entries) entries = size;
-        else if (entries != size) {
+      for (size_t i = 0; i < chunk_count; ++i) {
+        const CSVChunk& chunk = chunks[i];
+        if (chunk.offsets.empty()) continue;
+        size_t line_number = m_offsets.size() + 1, size = chunk.entries;
+        if (!entries) entries = chunk.entries;
+        if (chunk.entries == entries && chunk.error_line) {
+          line_number = m_offsets.size() + chunk.error_line;
+          size = chunk.error_entries;
+        }
+        if (size != entries) {
           boost::format m("line %d at file '%s' contains %d entries instead of %d (expected)");
           m % line_number % m_filename % size % entries;
           throw std::runtime_error(m.str());
         }
+        m_offsets.insert(m_offsets.end(), chunk.offsets.begin(), chunk.offsets.end());
       }
 
-      if (!line_number) {
+      if (m_offsets.empty()) {
         m_newfile = true;
-        m_pos.clear();
         return;
       }
 
@@ -83,14 +221,15 @@ class CSVFile: public bob::io::File {
 
       m_array_type = m_arrayset_type;
       m_array_type.nd = 2;
-      m_array_type.shape[0] = m_pos.size();
+      m_array_type.shape[0] = m_offsets.size();
       m_array_type.shape[1] = entries;
       m_array_type.update_strides();
     }
 
     CSVFile(const std::string& path, char mode):
       m_filename(path),
-      m_newfile(false) {
+      m_newfile(false),
+      m_dirty(true) {
 
         if (mode == 'r' || (mode == 'a' && boost::filesystem::exists(path))) { //try peeking
           
@@ -139,7 +278,7 @@ class CSVFile: public bob::io::File {
     }
 
     virtual size_t size() const {
-      return m_pos.size();
+      return m_offsets.size();
     }
 
     virtual const std::string& name() const {
@@ -152,17 +291,13 @@ class CSVFile: public bob::io::File {
 
       if (!buffer.type().is_compatible(m_array_type)) buffer.set(m_array_type);
 
-      //read contents
-      std::string line;
-      if (m_file.eof()) m_file.clear(); ///< clear current "end" state.
-      m_file.seekg(0);
+      //converts the lines in parallel, straight into the buffer
+      map();
+      size_t threads = std::max<size_t>(1, std::min(bob::core::number_of_threads(),
+            m_map.size() / MIN_CHUNK_SIZE));
       double* p = static_cast<double*>(buffer.ptr());
-      while (std::getline(m_file, line)) {
-        Tokenizer tok(line);
-        for(Tokenizer::iterator k=tok.begin(); k!=tok.end(); ++k) {
-          std::istringstream(*k) >> *(p++);
-        }
-      }
+      bob::core::parallel_for(m_offsets.size(), boost::bind(&CSVFile::read_rows,
+            this, _2, _3, p), threads);
     }
 
     virtual void read(bob::core::array::interface& buffer, size_t index) {
@@ -173,26 +308,15 @@ class CSVFile: public bob::io::File {
       if (!buffer.type().is_compatible(m_arrayset_type)) 
         buffer.set(m_arrayset_type);
 
-      if (index >= m_pos.size()) {
+      if (index >= m_offsets.size()) {
         boost::format m("cannot array at position %d -- there is only %d entries at file '%s'");
-        m % index % m_pos.size() % m_filename;
+        m % index % m_offsets.size() % m_filename;
         throw std::runtime_error(m.str());
       }
 
       //reads a specific line from the file.
-      std::string line;
-      if (m_file.eof()) m_file.clear(); ///< clear current "end" state.
-      m_file.seekg(m_pos[index]);
-      if (!std::getline(m_file, line)) {
-        boost::format m("could not seek to line %u (offset %u) while reading file '%s'");
-        m % index % m_pos[index] % m_filename;
-        throw std::runtime_error(m.str());
-      }
-      Tokenizer tok(line);
-      double* p = static_cast<double*>(buffer.ptr());
-      for(Tokenizer::iterator k=tok.begin(); k!=tok.end(); ++k) {
-        std::istringstream(*k) >> *(p++);
-      }
+      map();
+      read_lines(index, index+1, static_cast<double*>(buffer.ptr()));
 
     }
 
@@ -206,7 +330,7 @@ class CSVFile: public bob::io::File {
           m % type.str() % m_filename;
           throw std::runtime_error(m.str());
         }
-        m_pos.clear();
+        m_offsets.clear();
         m_arrayset_type = m_array_type = type;
         m_array_type.shape[1] = m_arrayset_type.shape[0];
         m_newfile = false;
@@ -224,13 +348,14 @@ class CSVFile: public bob::io::File {
       }
 
       const double* p = static_cast<const double*>(buffer.ptr());
-      if (m_pos.size()) m_file << std::endl; ///< adds a new line
-      m_pos.push_back(m_file.tellp()); ///< register start of line
+      if (m_offsets.size()) m_file << std::endl; ///< adds a new line
+      m_offsets.push_back(m_file.tellp()); ///< register start of line
       for (size_t k=1; k<type.shape[0]; ++k) m_file << *(p++) << ",";
       m_file << *(p++);
-      m_array_type.shape[0] = m_pos.size();
+      m_array_type.shape[0] = m_offsets.size();
       m_array_type.update_strides();
-      return (m_pos.size()-1);
+      m_dirty = true;
+      return (m_offsets.size()-1);
 
     }
 
@@ -246,10 +371,11 @@ class CSVFile: public bob::io::File {
         }
         const double* p = static_cast<const double*>(buffer.ptr());
         for (size_t l=1; l<type.shape[0]; ++l) {
-          m_pos.push_back(m_file.tellp());
+          m_offsets.push_back(m_file.tellp());
           for (size_t k=1; k<type.shape[1]; ++k) m_file << *(p++) << ",";
           m_file << *(p++) << std::endl;
         }
+        m_offsets.push_back(m_file.tellp());
         for (size_t k=1; k<type.shape[1]; ++k) m_file << *(p++) << ",";
         m_file << *(p++);
         m_arrayset_type = type;
@@ -258,6 +384,7 @@ class CSVFile: public bob::io::File {
         m_arrayset_type.update_strides();
         m_array_type = type;
         m_newfile = false;
+        m_dirty = true;
         return;
       }
 
@@ -266,13 +393,61 @@ class CSVFile: public bob::io::File {
 
     }
 
+  private: //methods
+
+    /**
+     * (Re-)maps the file to memory, if it changed since it was last mapped,
+     * and returns the start of the mapped region
+     */
+    const char* map() {
+      if (m_dirty) {
+        m_file.flush();
+        if (m_map.is_open()) m_map.close();
+        // empty files cannot be memory mapped
+        if (boost::filesystem::file_size(m_filename)) {
+          try {
+            m_map.open(m_filename);
+          }
+          catch (std::exception&) {
+            boost::format m("cannot memory map file '%s'");
+            m % m_filename;
+            throw std::runtime_error(m.str());
+          }
+        }
+        m_dirty = false;
+      }
+      return m_map.is_open() ? m_map.data() : 0;
+    }
+
+    /**
+     * Converts the lines [begin, end) into the same rows of the 2D array p
+     */
+    void read_rows(size_t begin, size_t end, double* p) const {
+      read_lines(begin, end, p + begin*m_arrayset_type.shape[0]);
+    }
+
+    /**
+     * Converts the lines [begin, end) into consecutive rows of p
+     */
+    void read_lines(size_t begin, size_t end, double* p) const {
+      const char* data = m_map.data();
+      const char* data_end = data + m_map.size();
+      const size_t entries = m_arrayset_type.shape[0];
+      for (size_t i = begin; i < end; ++i) {
+        const char* line = data + m_offsets[i];
+        parse_line(line, end_of_line(line, data_end), entries, p + (i-begin)*entries);
+      }
+    }
+
   private: //representation
     std::fstream m_file;
     std::string m_filename;
     bool m_newfile;
     bob::core::array::typeinfo m_array_type;
     bob::core::array::typeinfo m_arrayset_type;
-    std::vector<std::streampos> m_pos; ///< dictionary of line starts
+    std::vector<uint64_t> m_offsets; ///< dictionary of line starts
+    boost::iostreams::mapped_file_source m_map; ///< the file contents
+    bool m_dirty; ///< if the file changed since it was last mapped
 
     static std::string s_codecname;
 
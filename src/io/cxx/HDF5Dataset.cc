@@ -20,6 +20,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <boost/format.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/shared_array.hpp>
@@ -27,6 +28,7 @@
 #include <bob/io/HDF5Group.h>
 #include <bob/io/HDF5Dataset.h>
 #include <bob/core/logging.h>
+#include <bob/core/instrument.h>
 
 /**
  * Opens an "auto-destructible" HDF5 dataset
@@ -232,12 +234,36 @@ bob::io::detail::hdf5::Dataset::Dataset(boost::shared_ptr<Group> parent,
   }
 }
 
+/**
+ * Approximate number of bytes in a chunk when the number of entries per chunk
+ * is not set by the user. Appending one entry per chunk makes the B-tree
+ * indexing the chunks as large as the data itself.
+ */
+static const size_t CHUNK_BYTES = 1 << 16;
+
+/**
+ * Returns the number of entries to keep in each chunk along the first
+ * dimension of a dataset, so that a chunk holds about CHUNK_BYTES.
+ */
+static hsize_t chunk_entries(const bob::io::HDF5Type& type,
+    const bob::io::HDF5Shape& xshape, bool list, size_t chunk_size) {
+  hsize_t retval = chunk_size;
+  if (!retval) {
+    hsize_t entry_bytes = H5Tget_size(*type.htype());
+    for (size_t i=1; i<xshape.n(); ++i) entry_bytes *= xshape[i];
+    retval = std::max<hsize_t>(1, CHUNK_BYTES / std::max<hsize_t>(1, entry_bytes));
+  }
+  //chunks of fixed-size datasets cannot be larger than the dataset itself
+  if (!list) retval = std::min(retval, xshape[0]);
+  return std::max<hsize_t>(1, retval);
+}
+
 /**
  * Creates and writes an "empty" Dataset in an existing file.
  */
 static void create_dataset (boost::shared_ptr<bob::io::detail::hdf5::Group> par,
  const std::string& name, const bob::io::HDF5Type& type, bool list,
- size_t compression) {
+ size_t compression, size_t chunk_size) {
 
   if (!name.size() || name == "." || name == "..") {
     boost::format m("Cannot create dataset with illegal name `%s' at `%s:%s'");
@@ -267,9 +293,9 @@ static void create_dataset (boost::shared_ptr<bob::io::detail::hdf5::Group> par,
   boost::shared_ptr<hid_t> dcpl = open_plist(H5P_DATASET_CREATE);
 
   //according to the HDF5 manual, chunks have to have the same rank as the
-  //array shape.
+  //array shape. We group several entries along the first dimension.
   bob::io::HDF5Shape chunking(xshape);
-  chunking[0] = 1;
+  chunking[0] = chunk_entries(type, xshape, list, chunk_size);
   if (list || compression) { ///< note: compression requires chunking
     herr_t status = H5Pset_chunk(*dcpl, chunking.n(), chunking.get());
     if (status < 0) throw bob::io::HDF5StatusError("H5Pset_chunk", status);
@@ -357,7 +383,7 @@ static void create_string_dataset (boost::shared_ptr<bob::io::detail::hdf5::Grou
 
 bob::io::detail::hdf5::Dataset::Dataset(boost::shared_ptr<Group> parent,
     const std::string& name, const bob::io::HDF5Type& type,
-    bool list, size_t compression):
+    bool list, size_t compression, size_t chunk_size):
   m_parent(parent),
   m_name(name),
   m_id(),
@@ -375,7 +401,7 @@ bob::io::detail::hdf5::Dataset::Dataset(boost::shared_ptr<Group> parent,
     if (type.type() == bob::io::s) 
       create_string_dataset(parent, m_name, type, compression);
     else 
-      create_dataset(parent, m_name, type, list, compression);
+      create_dataset(parent, m_name, type, list, compression, chunk_size);
   }
   else H5Dclose(set_id); //close it, will re-open it properly
 
@@ -475,7 +501,17 @@ bob::io::detail::hdf5::Dataset::select (size_t index, const bob::io::HDF5Type& d
   return it;
 }
 
+/**
+ * The number of bytes in a buffer of the given type
+ */
+static size_t buffer_bytes(const bob::io::HDF5Type& type) {
+  size_t retval = H5Tget_size(*type.htype());
+  for (size_t k=0; k<type.shape().n(); ++k) retval *= type.shape()[k];
+  return retval;
+}
+
 void bob::io::detail::hdf5::Dataset::read_buffer (size_t index, const bob::io::HDF5Type& dest, void* buffer) {
+  BOB_TIME_SCOPE("io.hdf5.read");
 
   std::vector<bob::io::HDF5Descriptor>::iterator it = select(index, dest);
 
@@ -483,10 +519,12 @@ void bob::io::detail::hdf5::Dataset::read_buffer (size_t index, const bob::io::H
       *m_memspace, *m_filespace, H5P_DEFAULT, buffer);
 
   if (status < 0) throw bob::io::HDF5StatusError("H5Dread", status);
+  BOB_COUNT("io.hdf5.bytes_read", buffer_bytes(dest));
 }
 
 void bob::io::detail::hdf5::Dataset::write_buffer (size_t index, const bob::io::HDF5Type& dest,
     const void* buffer) {
+  BOB_TIME_SCOPE("io.hdf5.write");
 
   std::vector<bob::io::HDF5Descriptor>::iterator it = select(index, dest);
 
@@ -494,10 +532,18 @@ void bob::io::detail::hdf5::Dataset::write_buffer (size_t index, const bob::io::
       *m_memspace, *m_filespace, H5P_DEFAULT, buffer);
 
   if (status < 0) throw bob::io::HDF5StatusError("H5Dwrite", status);
+  BOB_COUNT("io.hdf5.bytes_written", buffer_bytes(dest));
 }
 
 void bob::io::detail::hdf5::Dataset::extend_buffer (const bob::io::HDF5Type& dest, const void* buffer) {
 
+  size_t index = extend(1, dest);
+  write_buffer(index, dest, buffer);
+}
+
+size_t bob::io::detail::hdf5::Dataset::extend (size_t count,
+    const bob::io::HDF5Type& dest) {
+
   //finds compatibility type
   std::vector<bob::io::HDF5Descriptor>::iterator it = find_type_index(m_descr, dest);
 
@@ -509,26 +555,115 @@ void bob::io::detail::hdf5::Dataset::extend_buffer (const bob::io::HDF5Type& des
     throw bob::io::HDF5NotExpandible(url());
 
   //if it is expandible, try expansion
+  size_t index = it->size;
   bob::io::HDF5Shape tmp(it->type.shape());
   tmp >>= 1;
-  tmp[0] = it->size + 1;
+  tmp[0] = it->size + count;
   herr_t status = H5Dset_extent(*m_id, tmp.get());
   if (status < 0) throw bob::io::HDF5StatusError("H5Dset_extent", status);
 
   //if expansion succeeded, update all compatible types
   for (size_t k=0; k<m_descr.size(); ++k) {
     if (m_descr[k].expandable) { //updated only the length
-      m_descr[k].size += 1;
+      m_descr[k].size += count;
     }
     else { //not expandable, update the shape/count for a straight read/write
-      m_descr[k].type.shape()[0] += 1;
-      m_descr[k].hyperslab_count[0] += 1;
+      m_descr[k].type.shape()[0] += count;
+      m_descr[k].hyperslab_count[0] += count;
     }
   }
 
   m_filespace = open_filespace(m_id); //update filespace
 
-  write_buffer(tmp[0]-1, dest, buffer);
+  return index;
+}
+
+bob::io::HDF5Type bob::io::detail::hdf5::range_entry_type
+(const bob::io::HDF5Type& range) {
+  bob::io::HDF5Type retval(range);
+  if (retval.shape().n() == 1) retval.shape()[0] = 1; ///< scalars
+  else retval.shape() <<= 1;
+  return retval;
+}
+
+std::vector<bob::io::HDF5Descriptor>::iterator
+bob::io::detail::hdf5::Dataset::select_range (size_t start,
+    const bob::io::HDF5Type& range, boost::shared_ptr<hid_t>& memspace) {
+
+  if (!range.shape())
+    throw std::length_error("empty range of HDF5 entries");
+
+  bob::io::HDF5Type entry = bob::io::detail::hdf5::range_entry_type(range);
+  size_t count = range.shape()[0];
+
+  //finds compatibility type
+  std::vector<bob::io::HDF5Descriptor>::iterator it = find_type_index(m_descr, entry);
+
+  //if we cannot find a compatible type, we throw
+  if (it == m_descr.end()) 
+    throw bob::io::HDF5IncompatibleIO(url(), m_descr[0].type.str(), entry.str());
+
+  if (!count) return it; ///< nothing to select
+
+  //checks indexing: the last entry of the range has to exist
+  if ((start + count) > it->size)
+    throw bob::io::HDF5IndexError(url(), it->size, start + count - 1);
+
+  bob::io::HDF5Shape offset(it->hyperslab_start);
+  bob::io::HDF5Shape extent(it->hyperslab_count);
+  offset[0] = start * it->hyperslab_count[0];
+  extent[0] = count * it->hyperslab_count[0];
+
+  herr_t status = H5Sselect_hyperslab(*m_filespace, H5S_SELECT_SET,
+      offset.get(), 0, extent.get(), 0);
+  if (status < 0) throw bob::io::HDF5StatusError("H5Sselect_hyperslab", status);
+
+  memspace = open_memspace(range.shape());
+
+  return it;
+}
+
+void bob::io::detail::hdf5::Dataset::read_range_buffer (size_t start,
+    const bob::io::HDF5Type& range, void* buffer) {
+  BOB_TIME_SCOPE("io.hdf5.read");
+
+  boost::shared_ptr<hid_t> memspace;
+  std::vector<bob::io::HDF5Descriptor>::iterator it =
+    select_range(start, range, memspace);
+  if (!range.shape()[0]) return; ///< nothing to read
+
+  herr_t status = H5Dread(*m_id, *it->type.htype(),
+      *memspace, *m_filespace, H5P_DEFAULT, buffer);
+
+  if (status < 0) throw bob::io::HDF5StatusError("H5Dread", status);
+  BOB_COUNT("io.hdf5.bytes_read", buffer_bytes(range));
+}
+
+void bob::io::detail::hdf5::Dataset::write_range_buffer (size_t start,
+    const bob::io::HDF5Type& range, const void* buffer) {
+  BOB_TIME_SCOPE("io.hdf5.write");
+
+  boost::shared_ptr<hid_t> memspace;
+  std::vector<bob::io::HDF5Descriptor>::iterator it =
+    select_range(start, range, memspace);
+  if (!range.shape()[0]) return; ///< nothing to write
+
+  herr_t status = H5Dwrite(*m_id, *it->type.htype(),
+      *memspace, *m_filespace, H5P_DEFAULT, buffer);
+
+  if (status < 0) throw bob::io::HDF5StatusError("H5Dwrite", status);
+  BOB_COUNT("io.hdf5.bytes_written", buffer_bytes(range));
+}
+
+void bob::io::detail::hdf5::Dataset::extend_range_buffer
+(const bob::io::HDF5Type& range, const void* buffer) {
+
+  if (!range.shape()) throw std::length_error("empty range of HDF5 entries");
+  if (!range.shape()[0]) return; ///< nothing to append
+
+  size_t start = extend(range.shape()[0],
+      bob::io::detail::hdf5::range_entry_type(range));
+  write_range_buffer(start, range, buffer);
 }
 
 void bob::io::detail::hdf5::Dataset::gettype_attribute(const std::string& name,
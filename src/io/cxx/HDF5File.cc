@@ -34,8 +34,10 @@ static unsigned int getH5Access (bob::io::HDF5File::mode_t v) {
   }
 }
 
-bob::io::HDF5File::HDF5File(const std::string& filename, mode_t mode):
-  m_file(new bob::io::detail::hdf5::File(filename, getH5Access(mode))),
+bob::io::HDF5File::HDF5File(const std::string& filename, mode_t mode,
+    size_t cache_size):
+  m_file(new bob::io::detail::hdf5::File(filename, getH5Access(mode), 0,
+        cache_size)),
   m_cwd(m_file->root()) ///< we start by looking at the root directory
 {
 }
@@ -133,13 +135,14 @@ void bob::io::HDF5File::copy (HDF5File& other) {
 }
 
 void bob::io::HDF5File::create (const std::string& path, const bob::io::HDF5Type& type,
-    bool list, size_t compression) {
+    bool list, size_t compression, size_t chunk_size) {
   if (!m_file->writeable()) {
     boost::format m("cannot create dataset '%s' at path '%s' of file '%s' because it is not writeable");
     m % path % m_cwd->path() % m_file->filename();
     throw std::runtime_error(m.str());
   }
-  if (!contains(path)) m_cwd->create_dataset(path, type, list, compression);
+  if (!contains(path)) m_cwd->create_dataset(path, type, list, compression,
+      chunk_size);
   else (*m_cwd)[path]->size(type);
 }
 
@@ -168,6 +171,21 @@ void bob::io::HDF5File::extend_buffer(const std::string& path,
   (*m_cwd)[path]->extend_buffer(type, buffer);
 }
 
+void bob::io::HDF5File::read_range_buffer (const std::string& path,
+    size_t pos, const bob::io::HDF5Type& type, void* buffer) const {
+  (*m_cwd)[path]->read_range_buffer(pos, type, buffer);
+}
+
+void bob::io::HDF5File::extend_range_buffer(const std::string& path,
+    const bob::io::HDF5Type& type, const void* buffer) {
+  if (!m_file->writeable()) {
+    boost::format m("cannot extend object '%s' at path '%s' of file '%s' because the file is not writeable");
+    m % path % m_cwd->path() % m_file->filename();
+    throw std::runtime_error(m.str());
+  }
+  (*m_cwd)[path]->extend_range_buffer(type, buffer);
+}
+
 bool bob::io::HDF5File::hasAttribute(const std::string& path,
     const std::string& name) const {
   if (m_cwd->has_dataset(path)) {
@@ -63,10 +63,48 @@ static boost::shared_ptr<hid_t> open_group(boost::shared_ptr<hid_t> g,
 bob::io::detail::hdf5::Group::Group(boost::shared_ptr<Group> parent, const std::string& name):
   m_name(name),
   m_id(create_new_group(parent->location(), name)),
-  m_parent(parent)
+  m_parent(parent),
+  m_groups(),
+  m_datasets(),
+  m_listed(true) ///< a new group is empty
 {
 }
 
+/**
+ * Returns the type of the object a link in the given group points to, or
+ * H5O_TYPE_UNKNOWN if there is no such link or if it is not a hard link.
+ */
+static H5O_type_t link_type(hid_t group, const char* name,
+    const H5L_info_t& info) {
+
+  // If we are not looking at a hard link to the data, just ignore
+  if (info.type != H5L_TYPE_HARD) {
+    TDEBUG1("Ignoring soft-link `" << name << "' in HDF5 file");
+    return H5O_TYPE_UNKNOWN;
+  }
+
+  // Get information about the HDF5 object
+  H5O_info_t obj_info;
+  herr_t status = H5Oget_info_by_name(group, name, &obj_info, H5P_DEFAULT);
+  if (status < 0) throw bob::io::HDF5StatusError("H5Oget_info_by_name", status);
+
+  return obj_info.type;
+}
+
+static H5O_type_t link_type(hid_t group, const std::string& name) {
+  if (!name.size() || name == "." || name == "..") return H5O_TYPE_UNKNOWN;
+
+  htri_t exists = H5Lexists(group, name.c_str(), H5P_DEFAULT);
+  if (exists < 0) throw bob::io::HDF5StatusError("H5Lexists", exists);
+  if (!exists) return H5O_TYPE_UNKNOWN;
+
+  H5L_info_t info;
+  herr_t status = H5Lget_info(group, name.c_str(), &info, H5P_DEFAULT);
+  if (status < 0) throw bob::io::HDF5StatusError("H5Lget_info", status);
+
+  return link_type(group, name.c_str(), info);
+}
+
 /**
  * Simple wrapper to call internal bob::io::detail::hdf5::Group::iterate_callback, that can call
  * Group and Dataset constructors. Note that those are private or protected for
@@ -80,27 +118,15 @@ static herr_t group_iterate_callback(hid_t self, const char *name,
 herr_t bob::io::detail::hdf5::Group::iterate_callback(hid_t self, const char *name,
     const H5L_info_t *info) {
 
-  // If we are not looking at a hard link to the data, just ignore
-  if (info->type != H5L_TYPE_HARD) {
-    TDEBUG1("Ignoring soft-link `" << name << "' in HDF5 file");
-    return 0;
-  }
-
-  // Get information about the HDF5 object
-  H5O_info_t obj_info;
-  herr_t status = H5Oget_info_by_name(self, name, &obj_info, H5P_DEFAULT);
-  if (status < 0) throw bob::io::HDF5StatusError("H5Oget_info_by_name", status);
-
-  switch(obj_info.type) {
+  //objects are only recorded here, they are opened when first accessed
+  switch(link_type(self, name, *info)) {
     case H5O_TYPE_GROUP:
-      //creates with recursion
-      m_groups[name] = boost::make_shared<bob::io::detail::hdf5::Group>(shared_from_this(),
-          name, true);
-      m_groups[name]->open_recursively();
+      m_groups.insert(std::make_pair(std::string(name),
+            boost::shared_ptr<bob::io::detail::hdf5::Group>()));
       break;
     case H5O_TYPE_DATASET:
-      m_datasets[name] = boost::make_shared<bob::io::detail::hdf5::Dataset>(shared_from_this(),
-          std::string(name));
+      m_datasets.insert(std::make_pair(std::string(name),
+            boost::shared_ptr<bob::io::detail::hdf5::Dataset>()));
       break;
     default:
       break;
@@ -113,7 +139,10 @@ bob::io::detail::hdf5::Group::Group(boost::shared_ptr<Group> parent,
     const std::string& name, bool):
   m_name(name),
   m_id(open_group(parent->location(), name.c_str())),
-  m_parent(parent)
+  m_parent(parent),
+  m_groups(),
+  m_datasets(),
+  m_listed(false)
 {
   //checks name
   if (!m_name.size() || m_name == "." || m_name == "..") {
@@ -123,17 +152,91 @@ bob::io::detail::hdf5::Group::Group(boost::shared_ptr<Group> parent,
   }
 }
 
-void bob::io::detail::hdf5::Group::open_recursively() {
-  //iterates over this group only and instantiates what needs to be instantiated
-  herr_t status = H5Literate(*m_id, H5_INDEX_NAME,
-      H5_ITER_NATIVE, 0, group_iterate_callback, static_cast<void*>(this));
+void bob::io::detail::hdf5::Group::list_contents() const {
+  if (m_listed) return;
+  //iterates over this group only and records what it contains
+  herr_t status = H5Literate(*m_id, H5_INDEX_NAME, H5_ITER_NATIVE, 0,
+      group_iterate_callback,
+      static_cast<void*>(const_cast<bob::io::detail::hdf5::Group*>(this)));
   if (status < 0) throw bob::io::HDF5StatusError("H5Literate", status);
+  m_listed = true;
+}
+
+void bob::io::detail::hdf5::Group::probe(const std::string& name) const {
+  if (m_listed || m_groups.count(name) || m_datasets.count(name)) return;
+  switch(link_type(*m_id, name)) {
+    case H5O_TYPE_GROUP:
+      m_groups[name].reset();
+      break;
+    case H5O_TYPE_DATASET:
+      m_datasets[name].reset();
+      break;
+    default:
+      break;
+  }
+}
+
+boost::shared_ptr<bob::io::detail::hdf5::Group>
+bob::io::detail::hdf5::Group::child_group(const std::string& name) const {
+  probe(name);
+  typedef std::map<std::string, boost::shared_ptr<bob::io::detail::hdf5::Group> > map_type;
+  map_type::iterator it = m_groups.find(name);
+  if (it == m_groups.end()) return boost::shared_ptr<bob::io::detail::hdf5::Group>();
+  if (!it->second) {
+    boost::shared_ptr<bob::io::detail::hdf5::Group> self =
+      const_cast<bob::io::detail::hdf5::Group*>(this)->shared_from_this();
+    it->second = boost::make_shared<bob::io::detail::hdf5::Group>(self, name, true);
+  }
+  return it->second;
+}
+
+boost::shared_ptr<bob::io::detail::hdf5::Dataset>
+bob::io::detail::hdf5::Group::child_dataset(const std::string& name) const {
+  probe(name);
+  typedef std::map<std::string, boost::shared_ptr<bob::io::detail::hdf5::Dataset> > map_type;
+  map_type::iterator it = m_datasets.find(name);
+  if (it == m_datasets.end()) return boost::shared_ptr<bob::io::detail::hdf5::Dataset>();
+  if (!it->second) {
+    boost::shared_ptr<bob::io::detail::hdf5::Group> self =
+      const_cast<bob::io::detail::hdf5::Group*>(this)->shared_from_this();
+    it->second = boost::make_shared<bob::io::detail::hdf5::Dataset>(self, name);
+  }
+  return it->second;
+}
+
+void bob::io::detail::hdf5::Group::forget(const std::string& name) {
+  std::string::size_type pos = name.find_first_of('/');
+  std::string child = name.substr(0, pos);
+  m_groups.erase(child);
+  m_datasets.erase(child);
+  m_listed = false;
+}
+
+const std::map<std::string, boost::shared_ptr<bob::io::detail::hdf5::Group> >&
+bob::io::detail::hdf5::Group::groups() const {
+  list_contents();
+  typedef std::map<std::string, boost::shared_ptr<bob::io::detail::hdf5::Group> > map_type;
+  for (map_type::iterator it = m_groups.begin(); it != m_groups.end(); ++it)
+    child_group(it->first);
+  return m_groups;
+}
+
+const std::map<std::string, boost::shared_ptr<bob::io::detail::hdf5::Dataset> >&
+bob::io::detail::hdf5::Group::datasets() const {
+  list_contents();
+  typedef std::map<std::string, boost::shared_ptr<bob::io::detail::hdf5::Dataset> > map_type;
+  for (map_type::iterator it = m_datasets.begin(); it != m_datasets.end(); ++it)
+    child_dataset(it->first);
+  return m_datasets;
 }
 
 bob::io::detail::hdf5::Group::Group(boost::shared_ptr<File> parent):
   m_name(""),
   m_id(open_group(parent->location(), "/")),
-  m_parent()
+  m_parent(),
+  m_groups(),
+  m_datasets(),
+  m_listed(false)
 {
 }
 
@@ -194,7 +297,7 @@ boost::shared_ptr<bob::io::detail::hdf5::Group> bob::io::detail::hdf5::Group::cd
       throw std::runtime_error(m.str());
     }
     //else, just return the named group
-    return m_groups[dir];
+    return child_group(dir);
   }
 
   //if you get to this point, we are just traversing
@@ -208,7 +311,7 @@ boost::shared_ptr<bob::io::detail::hdf5::Group> bob::io::detail::hdf5::Group::cd
   }
 
   //else, just recurse to the next group
-  return m_groups[mydir]->cd(dir.substr(pos+1));
+  return child_group(mydir)->cd(dir.substr(pos+1));
 }
 
 const boost::shared_ptr<bob::io::detail::hdf5::Group> bob::io::detail::hdf5::Group::cd(const std::string& dir) const {
@@ -223,7 +326,7 @@ boost::shared_ptr<bob::io::detail::hdf5::Dataset> bob::io::detail::hdf5::Group::
       m % dir % url();
       throw std::runtime_error(m.str());
     }
-    return m_datasets[dir];
+    return child_dataset(dir);
   }
 
   //if you get to this point, the search routine needs to be performed on
@@ -241,16 +344,21 @@ const boost::shared_ptr<bob::io::detail::hdf5::Dataset> bob::io::detail::hdf5::G
 }
 
 void bob::io::detail::hdf5::Group::reset() {
+  list_contents();
+
+  //removing a child invalidates its iterator, so we go through copies
   typedef std::map<std::string, boost::shared_ptr<bob::io::detail::hdf5::Group> > group_map_type;
-  for (group_map_type::const_iterator it = m_groups.begin();
-      it != m_groups.end(); ++it) {
+  group_map_type groups(m_groups);
+  for (group_map_type::const_iterator it = groups.begin();
+      it != groups.end(); ++it) {
     remove_group(it->first);
   }
 
   typedef std::map<std::string, boost::shared_ptr<bob::io::detail::hdf5::Dataset> >
     dataset_map_type;
-  for (dataset_map_type::const_iterator it = m_datasets.begin();
-      it != m_datasets.end(); ++it) {
+  dataset_map_type datasets(m_datasets);
+  for (dataset_map_type::const_iterator it = datasets.begin();
+      it != datasets.end(); ++it) {
     remove_dataset(it->first);
   }
 }
@@ -279,9 +387,7 @@ void bob::io::detail::hdf5::Group::remove_group(const std::string& dir) {
   if (pos == std::string::npos) { //copy on the current group
     herr_t status = H5Ldelete(*m_id, dir.c_str(), H5P_DEFAULT);
     if (status < 0) throw bob::io::HDF5StatusError("H5Ldelete", status);
-    typedef std::map<std::string, boost::shared_ptr<bob::io::detail::hdf5::Group> > map_type;
-    map_type::iterator it = m_groups.find(dir);
-    m_groups.erase(it);
+    m_groups.erase(dir);
     return;
   }
 
@@ -324,6 +430,8 @@ void bob::io::detail::hdf5::Group::rename_group(const std::string& from, const s
   herr_t status = H5Lmove(*m_id, from.c_str(), H5L_SAME_LOC, to.c_str(),
       *create_props, H5P_DEFAULT);
   if (status < 0) throw bob::io::HDF5StatusError("H5Lmove", status);
+  forget(from);
+  forget(to);
 }
 
 void bob::io::detail::hdf5::Group::copy_group(const boost::shared_ptr<Group> other,
@@ -335,13 +443,10 @@ void bob::io::detail::hdf5::Group::copy_group(const boost::shared_ptr<Group> oth
         other->name().c_str(), *m_id, use_name, H5P_DEFAULT, H5P_DEFAULT);
     if (status < 0) throw bob::io::HDF5StatusError("H5Ocopy", status);
 
-    //read new group contents
-    boost::shared_ptr<bob::io::detail::hdf5::Group> copied =
-      boost::make_shared<bob::io::detail::hdf5::Group>(shared_from_this(), use_name);
-    copied->open_recursively();
-
-    //index it
-    m_groups[use_name] = copied;
+    //bind to the new group, its contents are read when accessed
+    m_groups[use_name] =
+      boost::make_shared<bob::io::detail::hdf5::Group>(shared_from_this(),
+          use_name, true);
 
     return;
   }
@@ -360,9 +465,8 @@ bool bob::io::detail::hdf5::Group::has_group(const std::string& dir) const {
   std::string::size_type pos = dir.find_last_of('/');
   if (pos == std::string::npos) { //search on the current group
     if (dir == "." || dir == "..") return true; //special case
-    typedef std::map<std::string, boost::shared_ptr<bob::io::detail::hdf5::Group> > map_type;
-    map_type::const_iterator it = m_groups.find(dir);
-    return (it != m_groups.end());
+    probe(dir);
+    return m_groups.count(dir) != 0;
   }
 
   //if you get to this point, the search routine needs to be performed on
@@ -377,12 +481,12 @@ bool bob::io::detail::hdf5::Group::has_group(const std::string& dir) const {
 
 boost::shared_ptr<bob::io::detail::hdf5::Dataset> bob::io::detail::hdf5::Group::create_dataset
 (const std::string& dir, const bob::io::HDF5Type& type, bool list,
- size_t compression) {
+ size_t compression, size_t chunk_size) {
   std::string::size_type pos = dir.find_last_of('/');
   if (pos == std::string::npos) { //creates on the current group
     boost::shared_ptr<bob::io::detail::hdf5::Dataset> d =
       boost::make_shared<bob::io::detail::hdf5::Dataset>(shared_from_this(), dir, type,
-          list, compression);
+          list, compression, chunk_size);
     m_datasets[dir] = d;
     return d;
   }
@@ -399,7 +503,8 @@ boost::shared_ptr<bob::io::detail::hdf5::Dataset> bob::io::detail::hdf5::Group::
     if (!has_group(dest)) g = create_group(dest);
     else g = cd(dest);
   }
-  return g->create_dataset(dir.substr(pos+1), type, list, compression);
+  return g->create_dataset(dir.substr(pos+1), type, list, compression,
+      chunk_size);
 }
 
 void bob::io::detail::hdf5::Group::remove_dataset(const std::string& dir) {
@@ -407,9 +512,7 @@ void bob::io::detail::hdf5::Group::remove_dataset(const std::string& dir) {
   if (pos == std::string::npos) { //removes on the current group
     herr_t status = H5Ldelete(*m_id, dir.c_str(), H5P_DEFAULT);
     if (status < 0) throw bob::io::HDF5StatusError("H5Ldelete", status);
-    typedef std::map<std::string, boost::shared_ptr<bob::io::detail::hdf5::Dataset> > map_type;
-    map_type::iterator it = m_datasets.find(dir);
-    m_datasets.erase(it);
+    m_datasets.erase(dir);
     return;
   }
 
@@ -429,6 +532,8 @@ void bob::io::detail::hdf5::Group::rename_dataset(const std::string& from, const
   herr_t status = H5Lmove(*m_id, from.c_str(), H5L_SAME_LOC, to.c_str(),
       *create_props, H5P_DEFAULT);
   if (status < 0) throw bob::io::HDF5StatusError("H5Ldelete", status);
+  forget(from);
+  forget(to);
 }
 
 void bob::io::detail::hdf5::Group::copy_dataset(const boost::shared_ptr<Dataset> other,
@@ -458,9 +563,8 @@ void bob::io::detail::hdf5::Group::copy_dataset(const boost::shared_ptr<Dataset>
 bool bob::io::detail::hdf5::Group::has_dataset(const std::string& dir) const {
   std::string::size_type pos = dir.find_last_of('/');
   if (pos == std::string::npos) { //search on the current group
-    typedef std::map<std::string, boost::shared_ptr<bob::io::detail::hdf5::Dataset> > map_type;
-    map_type::const_iterator it = m_datasets.find(dir);
-    return (it != m_datasets.end());
+    probe(dir);
+    return m_datasets.count(dir) != 0;
   }
 
   //if you get to this point, the search routine needs to be performed on
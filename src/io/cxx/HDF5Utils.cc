@@ -20,6 +20,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <boost/make_shared.hpp>
 #include <bob/io/HDF5Utils.h>
 #include <bob/core/logging.h>
@@ -54,7 +55,8 @@ static void delete_h5p (hid_t* p) {
 }
 
 static boost::shared_ptr<hid_t> open_file(const boost::filesystem::path& path,
-    unsigned int flags, boost::shared_ptr<hid_t>& fcpl) {
+    unsigned int flags, boost::shared_ptr<hid_t>& fcpl,
+    const boost::shared_ptr<hid_t>& fapl) {
 
   boost::shared_ptr<hid_t> retval(new hid_t(-1), std::ptr_fun(delete_h5file));
 
@@ -64,7 +66,7 @@ static boost::shared_ptr<hid_t> open_file(const boost::filesystem::path& path,
   }
 
   if (boost::filesystem::exists(path) && flags != H5F_ACC_TRUNC) { //open
-    *retval = H5Fopen(path.string().c_str(), flags, H5P_DEFAULT);
+    *retval = H5Fopen(path.string().c_str(), flags, *fapl);
     if (*retval < 0) throw bob::io::HDF5StatusError("H5Fopen", *retval);
     //replaces the file create list properties with the one from the file
     fcpl = boost::shared_ptr<hid_t>(new hid_t(-1), std::ptr_fun(delete_h5p));
@@ -73,7 +75,7 @@ static boost::shared_ptr<hid_t> open_file(const boost::filesystem::path& path,
   }
   else { //file needs to be created or truncated (can set user block)
     *retval = H5Fcreate(path.string().c_str(), H5F_ACC_TRUNC,
-        *fcpl, H5P_DEFAULT);
+        *fcpl, *fapl);
     if (*retval < 0) throw bob::io::HDF5StatusError("H5Fcreate", *retval);
   }
   return retval;
@@ -90,12 +92,43 @@ static boost::shared_ptr<hid_t> create_fcpl(hsize_t userblock_size) {
   return retval;
 }
 
+/**
+ * Returns the smallest prime number not smaller than n. HDF5 recommends a
+ * prime number of hash slots for the chunk cache.
+ */
+static size_t next_prime(size_t n) {
+  for (;; ++n) {
+    bool prime = (n > 1);
+    for (size_t d=2; prime && d*d<=n; ++d) prime = (n % d != 0);
+    if (prime) return n;
+  }
+}
+
+static boost::shared_ptr<hid_t> create_fapl(size_t cache_size) {
+  if (!cache_size) return boost::make_shared<hid_t>(H5P_DEFAULT);
+  //otherwise we have to go through the settings
+  boost::shared_ptr<hid_t> retval(new hid_t(-1), std::ptr_fun(delete_h5p));
+  *retval = H5Pcreate(H5P_FILE_ACCESS);
+  if (*retval < 0) throw bob::io::HDF5StatusError("H5Pcreate", *retval);
+  int mdc_nelmts;
+  size_t nslots, nbytes;
+  double w0;
+  herr_t err = H5Pget_cache(*retval, &mdc_nelmts, &nslots, &nbytes, &w0);
+  if (err < 0) throw bob::io::HDF5StatusError("H5Pget_cache", err);
+  //scales the number of slots with the cache, assuming 1 KiB chunks or more
+  nslots = next_prime(std::max(nslots, cache_size / 1024));
+  err = H5Pset_cache(*retval, mdc_nelmts, nslots, cache_size, w0);
+  if (err < 0) throw bob::io::HDF5StatusError("H5Pset_cache", err);
+  return retval;
+}
+
 bob::io::detail::hdf5::File::File(const boost::filesystem::path& path, unsigned int flags,
-    size_t userblock_size):
+    size_t userblock_size, size_t cache_size):
   m_path(path),
   m_flags(flags),
   m_fcpl(create_fcpl(userblock_size)),
-  m_id(open_file(m_path, m_flags, m_fcpl))
+  m_fapl(create_fapl(cache_size)),
+  m_id(open_file(m_path, m_flags, m_fcpl, m_fapl))
 {
 }
 
@@ -105,7 +138,6 @@ bob::io::detail::hdf5::File::~File() {
 boost::shared_ptr<bob::io::detail::hdf5::RootGroup> bob::io::detail::hdf5::File::root() {
   if (!m_root) {
     m_root = boost::make_shared<bob::io::detail::hdf5::RootGroup>(shared_from_this());
-    m_root->open_recursively();
   }
   return m_root;
 }
@@ -125,6 +157,18 @@ size_t bob::io::detail::hdf5::File::userblock_size() const {
   return retval;
 }
 
+size_t bob::io::detail::hdf5::File::cache_size() const {
+  boost::shared_ptr<hid_t> fapl(new hid_t(-1), std::ptr_fun(delete_h5p));
+  *fapl = H5Fget_access_plist(*m_id);
+  if (*fapl < 0) throw bob::io::HDF5StatusError("H5Fget_access_plist", *fapl);
+  int mdc_nelmts;
+  size_t nslots, nbytes;
+  double w0;
+  herr_t err = H5Pget_cache(*fapl, &mdc_nelmts, &nslots, &nbytes, &w0);
+  if (err < 0) throw bob::io::HDF5StatusError("H5Pget_cache", err);
+  return nbytes;
+}
+
 void bob::io::detail::hdf5::File::get_userblock(std::string& data) const {
   //TODO
 }
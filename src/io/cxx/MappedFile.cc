@@ -0,0 +1,151 @@
+/**
+ * @file io/cxx/MappedFile.cc
+ * @date 2013-06-26
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Implements a private memory map of array files
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/format.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+#include <bob/core/blitz_array.h>
+#include <bob/io/MappedFile.h>
+
+/**
+ * How much of the file is read ahead of sequential fetches
+ */
+static const size_t PREFETCH_BYTES = 1 << 22;
+
+/**
+ * An array that points into a private mapping of some pages of a file, which
+ * it keeps alive. If the array is re-allocated with another type, it stops
+ * referring to the file and owns its own memory, like any other blitz_array
+ * would.
+ */
+class MappedArray: public bob::core::array::interface {
+
+  public:
+
+    MappedArray(boost::shared_ptr<void> owner, void* ptr,
+        const bob::core::array::typeinfo& info):
+      m_type(info),
+      m_ptr(ptr),
+      m_owner(owner) {
+    }
+
+    virtual ~MappedArray() { }
+
+    virtual void set(const bob::core::array::interface& other) {
+      set(other.type());
+      std::memcpy(m_ptr, other.ptr(), m_type.buffer_size());
+    }
+
+    virtual void set(boost::shared_ptr<bob::core::array::interface> other) {
+      m_type = other->type();
+      m_ptr = other->ptr();
+      m_owner = other;
+    }
+
+    virtual void set(const bob::core::array::typeinfo& req) {
+      if (m_type.is_compatible(req)) return; ///< nothing to do!
+      boost::shared_ptr<bob::core::array::blitz_array> mine(new
+          bob::core::array::blitz_array(req));
+      m_type = req;
+      m_ptr = mine->ptr();
+      m_owner = mine;
+    }
+
+    virtual const bob::core::array::typeinfo& type() const { return m_type; }
+
+    virtual void* ptr() { return m_ptr; }
+    virtual const void* ptr() const { return m_ptr; }
+
+    virtual boost::shared_ptr<void> owner() { return m_owner; }
+    virtual boost::shared_ptr<const void> owner() const { return m_owner; }
+
+  private: //representation
+
+    bob::core::array::typeinfo m_type;
+    void* m_ptr;
+    boost::shared_ptr<void> m_owner;
+
+};
+
+bob::io::detail::MappedFile::MappedFile(const std::string& path):
+  m_path(path),
+  m_map(path),
+  m_next(0),
+  m_prefetched(0)
+{
+}
+
+bob::io::detail::MappedFile::~MappedFile() { }
+
+const char* bob::io::detail::MappedFile::fetch(size_t offset, size_t length) {
+  if (offset > size() || length > size() - offset) {
+    boost::format m("cannot read %d bytes at offset %d of mapped file of size %d - the file may be truncated");
+    m % length % offset % size();
+    throw std::runtime_error(m.str());
+  }
+
+#if defined(__unix__) || defined(__APPLE__)
+  if (offset == m_next && offset + length > m_prefetched &&
+      m_prefetched < size()) {
+    //sequential scan reaching the end of what we asked for: read ahead
+    size_t start = std::max(offset, m_prefetched);
+    start -= start % boost::iostreams::mapped_file::alignment();
+    size_t end = std::min(size(), offset + length + PREFETCH_BYTES);
+    madvise(const_cast<char*>(m_map.data()) + start, end - start,
+        MADV_WILLNEED);
+    m_prefetched = end;
+  }
+#endif
+
+  m_next = offset + length;
+  return m_map.data() + offset;
+}
+
+boost::shared_ptr<bob::core::array::interface>
+bob::io::detail::MappedFile::view(size_t offset,
+    const bob::core::array::typeinfo& info) {
+  fetch(offset, info.buffer_size()); //checks the range and reads ahead
+
+  if (!info.buffer_size()) //nothing to map
+    return boost::shared_ptr<bob::core::array::interface>(new
+        bob::core::array::blitz_array(info));
+
+  //maps the pages of this view in private (copy-on-write) mode, so it can
+  //be modified without changing the file or what is read afterwards
+  const size_t start = offset - offset %
+    boost::iostreams::mapped_file::alignment();
+  boost::iostreams::mapped_file_params params(m_path);
+  params.flags = boost::iostreams::mapped_file::priv;
+  params.offset = start;
+  params.length = offset - start + info.buffer_size();
+  boost::shared_ptr<boost::iostreams::mapped_file> pages(new
+      boost::iostreams::mapped_file(params));
+
+  return boost::shared_ptr<bob::core::array::interface>(new
+      MappedArray(pages, pages->data() + (offset - start), info));
+}
@@ -132,7 +132,7 @@ static boost::shared_ptr<bob::io::File>
 make_file (const std::string& path, char mode) {
 
   bob::io::TensorFile::openmode _mode;
-  if (mode == 'r') _mode = bob::io::TensorFile::in;
+  if (mode == 'r') _mode = bob::io::TensorFile::in | bob::io::TensorFile::map;
   else if (mode == 'w') _mode = bob::io::TensorFile::out;
   else if (mode == 'a') _mode = bob::io::TensorFile::append;
   else throw std::invalid_argument("unsupported tensor file opening mode");
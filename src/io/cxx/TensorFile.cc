@@ -75,6 +75,16 @@ bob::io::TensorFile::TensorFile(const std::string& filename,
         bob::core::error << "Cannot append data in read only mode." << std::endl;
         throw bob::core::Exception();
       }
+
+      if (flag & bob::io::TensorFile::map) {
+        try {
+          m_map.reset(new bob::io::detail::MappedFile(filename));
+        }
+        catch (std::exception& e) {
+          TDEBUG1("cannot map file `" << filename << "' into memory, " <<
+              "reading through a stream instead: " << e.what());
+        }
+      }
     }
   }
   else
@@ -98,6 +108,7 @@ void bob::io::TensorFile::close() {
   if(m_openmode & bob::io::TensorFile::out) m_header.write(m_stream);
 
   m_stream.close();
+  m_map.reset();
 }
 
 void bob::io::TensorFile::initHeader(const bob::core::array::typeinfo& info) {
@@ -143,10 +154,19 @@ void bob::io::TensorFile::read (bob::core::array::interface& buf) {
   if(!m_header_init) throw Uninitialized();
   if(!buf.type().is_compatible(m_header.m_type)) buf.set(m_header.m_type);
 
-  m_stream.read(reinterpret_cast<char*>(m_buffer.get()), 
-      m_header.m_type.buffer_size());
+  if (m_map) {
+    //re-orders straight from the mapped pages
+    endOfFile();
+    const char* data = m_map->fetch(m_header.getArrayIndex(m_current_array),
+        m_header.m_type.buffer_size());
+    bob::io::col_to_row_order(data, buf.ptr(), m_header.m_type);
+  }
+  else {
+    m_stream.read(reinterpret_cast<char*>(m_buffer.get()), 
+        m_header.m_type.buffer_size());
   
-  bob::io::col_to_row_order(m_buffer.get(), buf.ptr(), m_header.m_type);
+    bob::io::col_to_row_order(m_buffer.get(), buf.ptr(), m_header.m_type);
+  }
 
   ++m_current_array;
 }
@@ -154,14 +174,45 @@ void bob::io::TensorFile::read (bob::core::array::interface& buf) {
 void bob::io::TensorFile::read (size_t index, bob::core::array::interface& buf) {
   
   // Check that we are reaching an existing array
-  if( index > m_header.m_n_samples ) {
+  if( index >= m_header.m_n_samples ) {
     throw IndexError(index);
   }
 
   // Set the stream pointer at the correct position
-  m_stream.seekg( m_header.getArrayIndex(index) );
+  if (!m_map) m_stream.seekg( m_header.getArrayIndex(index) );
   m_current_array = index;
 
   // Put the content of the stream in the blitz array.
   read(buf);
 }
+
+/**
+ * Column- and row-major orders only coincide if there is at most one
+ * dimension with more than one element
+ */
+static bool same_order(const bob::core::array::typeinfo& info) {
+  size_t non_trivial = 0;
+  for (size_t k=0; k<info.nd; ++k) if (info.shape[k] > 1) ++non_trivial;
+  return non_trivial <= 1;
+}
+
+boost::shared_ptr<bob::core::array::interface> 
+bob::io::TensorFile::view (size_t index) {
+
+  // Check that we are reaching an existing array
+  if( index >= m_header.m_n_samples ) {
+    throw IndexError(index);
+  }
+
+  if (!m_map || !same_order(m_header.m_type)) {
+    boost::shared_ptr<bob::core::array::interface> retval(new
+        bob::core::array::blitz_array(m_header.m_type));
+    read(index, *retval);
+    return retval;
+  }
+
+  boost::shared_ptr<bob::core::array::interface> retval =
+    m_map->view(m_header.getArrayIndex(index), m_header.m_type);
+  m_current_array = index + 1;
+  return retval;
+}
@@ -24,20 +24,27 @@
 #include <bob/io/VideoReader.h>
 
 #include <stdexcept>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
 #include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/preprocessor.hpp>
 #include <limits>
 
 #include <bob/core/check.h>
 #include <bob/core/blitz_array.h>
 #include <bob/core/logging.h>
+#include <bob/core/instrument.h>
 
 #ifndef AV_PIX_FMT_RGB24
 #define AV_PIX_FMT_RGB24 PIX_FMT_RGB24
 #endif
 
-bob::io::VideoReader::VideoReader(const std::string& filename, bool check) {
-  open(filename, check);
+bob::io::VideoReader::VideoReader(const std::string& filename, bool check,
+    bool gray, size_t threads, size_t prefetch) {
+  open(filename, check, gray, threads, prefetch);
 }
 
 bob::io::VideoReader::VideoReader(const bob::io::VideoReader& other) {
@@ -45,12 +52,24 @@ bob::io::VideoReader::VideoReader(const bob::io::VideoReader& other) {
 }
 
 bob::io::VideoReader& bob::io::VideoReader::operator= (const bob::io::VideoReader& other) {
-  open(other.filename(), other.m_check);
+  open(other.filename(), other.m_check, other.m_gray, other.m_threads,
+      other.m_prefetch);
+  m_indexed = other.m_indexed;
+  m_keyframes = other.m_keyframes;
+  m_keyframe_timestamps = other.m_keyframe_timestamps;
   return *this;
 }
 
-void bob::io::VideoReader::open(const std::string& filename, bool check) {
+void bob::io::VideoReader::open(const std::string& filename, bool check,
+    bool gray, size_t threads, size_t prefetch) {
   m_filepath = filename;
+  m_check = check;
+  m_gray = gray;
+  m_threads = bob::core::number_of_threads(threads);
+  m_prefetch = prefetch;
+  m_indexed = false;
+  m_keyframes.clear();
+  m_keyframe_timestamps.clear();
 
   boost::shared_ptr<AVFormatContext> format_ctxt =
     bob::io::detail::ffmpeg::make_input_format_context(m_filepath);
@@ -127,12 +146,21 @@ void bob::io::VideoReader::open(const std::string& filename, bool check) {
    * This will make sure we can interface with the io subsystem
    */
   m_typeinfo_video.dtype = m_typeinfo_frame.dtype = bob::core::array::t_uint8;
-  m_typeinfo_video.nd = 4;
-  m_typeinfo_frame.nd = 3;
-  m_typeinfo_video.shape[0] = m_nframes;
-  m_typeinfo_video.shape[1] = m_typeinfo_frame.shape[0] = 3;
-  m_typeinfo_video.shape[2] = m_typeinfo_frame.shape[1] = m_height;
-  m_typeinfo_video.shape[3] = m_typeinfo_frame.shape[2] = m_width;
+  if (m_gray) {
+    m_typeinfo_video.nd = 3;
+    m_typeinfo_frame.nd = 2;
+    m_typeinfo_video.shape[0] = m_nframes;
+    m_typeinfo_video.shape[1] = m_typeinfo_frame.shape[0] = m_height;
+    m_typeinfo_video.shape[2] = m_typeinfo_frame.shape[1] = m_width;
+  }
+  else {
+    m_typeinfo_video.nd = 4;
+    m_typeinfo_frame.nd = 3;
+    m_typeinfo_video.shape[0] = m_nframes;
+    m_typeinfo_video.shape[1] = m_typeinfo_frame.shape[0] = 3;
+    m_typeinfo_video.shape[2] = m_typeinfo_frame.shape[1] = m_height;
+    m_typeinfo_video.shape[3] = m_typeinfo_frame.shape[2] = m_width;
+  }
   m_typeinfo_frame.update_strides();
   m_typeinfo_video.update_strides();
 
@@ -147,6 +175,12 @@ size_t bob::io::VideoReader::load(blitz::Array<uint8_t,4>& data,
   return load(tmp, throw_on_error, check);
 }
 
+size_t bob::io::VideoReader::load(blitz::Array<uint8_t,3>& data, 
+  bool throw_on_error, void (*check)(void)) const {
+  bob::core::array::blitz_array tmp(data);
+  return load(tmp, throw_on_error, check);
+}
+
 size_t bob::io::VideoReader::load(bob::core::array::interface& b, 
   bool throw_on_error, void (*check)(void)) const {
 
@@ -175,6 +209,149 @@ size_t bob::io::VideoReader::load(bob::core::array::interface& b,
   return frames_read;
 }
 
+static const std::string KEYFRAME_INDEX_HEADER("# bob keyframe index 2");
+
+/**
+ * Reads the keyframe index cached for a video file, if it is still valid for
+ * a video of the given size and modification time
+ */
+static bool load_keyframe_index(const std::string& path, uintmax_t size,
+    std::time_t mtime, std::vector<size_t>& frames,
+    std::vector<int64_t>& timestamps) {
+
+  std::ifstream in(path.c_str());
+  if (!in) return false;
+
+  std::string header;
+  std::getline(in, header);
+  uintmax_t cached_size = 0;
+  std::time_t cached_mtime = 0;
+  size_t count = 0;
+  in >> cached_size >> cached_mtime >> count;
+  if (!in || header != KEYFRAME_INDEX_HEADER || cached_size != size ||
+      cached_mtime != mtime) return false;
+
+  frames.resize(count);
+  timestamps.resize(count);
+  for (size_t k=0; k<count; ++k) in >> frames[k] >> timestamps[k];
+  if (!in) {
+    frames.clear();
+    timestamps.clear();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Caches the keyframe index for a video file of the given size and
+ * modification time
+ */
+static void save_keyframe_index(const std::string& path, uintmax_t size,
+    std::time_t mtime, const std::vector<size_t>& frames,
+    const std::vector<int64_t>& timestamps) {
+
+  std::ofstream out(path.c_str());
+  out << KEYFRAME_INDEX_HEADER << std::endl;
+  out << size << " " << mtime << " " << frames.size() << std::endl;
+  for (size_t k=0; k<frames.size(); ++k)
+    out << frames[k] << " " << timestamps[k] << std::endl;
+
+  if (!out) {
+    bob::core::warn << "could not save the keyframe index of video file `"
+      << path << "'" << std::endl;
+  }
+}
+
+void bob::io::VideoReader::index(bool cache) const {
+  std::string cache_path = m_filepath + ".keyframes";
+  uintmax_t size = boost::filesystem::file_size(m_filepath);
+  std::time_t mtime = boost::filesystem::last_write_time(m_filepath);
+
+  if (cache && load_keyframe_index(cache_path, size, mtime, m_keyframes,
+        m_keyframe_timestamps)) {
+    m_indexed = true;
+    return;
+  }
+
+  boost::shared_ptr<AVFormatContext> format_ctxt =
+    bob::io::detail::ffmpeg::make_input_format_context(m_filepath);
+  int stream_index = 
+    bob::io::detail::ffmpeg::find_video_stream(m_filepath, format_ctxt);
+  bob::io::detail::ffmpeg::index_keyframes(m_filepath, stream_index,
+      format_ctxt, m_keyframes, m_keyframe_timestamps);
+  m_indexed = true;
+
+  if (cache) save_keyframe_index(cache_path, size, mtime, m_keyframes,
+      m_keyframe_timestamps);
+}
+
+size_t bob::io::VideoReader::read(const std::vector<size_t>& frames,
+    blitz::Array<uint8_t,4>& data, bool throw_on_error) const {
+  bob::core::array::blitz_array tmp(data);
+  return read(frames, tmp, throw_on_error);
+}
+
+size_t bob::io::VideoReader::read(const std::vector<size_t>& frames,
+    blitz::Array<uint8_t,3>& data, bool throw_on_error) const {
+  bob::core::array::blitz_array tmp(data);
+  return read(frames, tmp, throw_on_error);
+}
+
+size_t bob::io::VideoReader::read(const std::vector<size_t>& frames,
+    bob::core::array::interface& b, bool throw_on_error) const {
+
+  //checks if the output array shape conforms to the number of frames and
+  //to the video specifications, otherwise, throw.
+  bob::core::array::typeinfo info(m_typeinfo_video);
+  info.shape[0] = frames.size();
+  info.update_strides();
+  if (!info.is_compatible(b.type())) {
+    boost::format s("input buffer (%s) does not conform to the size specifications (%s) for reading %d frames of this video");
+    s % b.type().str() % info.str() % frames.size();
+    throw std::invalid_argument(s.str());
+  }
+
+  for (size_t i=0; i<frames.size(); ++i) {
+    if (frames[i] >= m_nframes) {
+      boost::format s("cannot read frame no. %d on file %s, which contains only %d frames");
+      s % frames[i] % m_filepath % m_nframes;
+      throw std::out_of_range(s.str());
+    }
+  }
+
+  if (!m_indexed) index();
+
+  //we read the frames in increasing order, remembering where they go
+  std::vector<std::pair<size_t, size_t> > order(frames.size());
+  for (size_t i=0; i<frames.size(); ++i) order[i] = std::make_pair(frames[i], i);
+  std::sort(order.begin(), order.end());
+
+  unsigned long int frame_size = m_typeinfo_frame.buffer_size();
+  uint8_t* ptr = static_cast<uint8_t*>(b.ptr());
+  size_t frames_read = 0;
+
+  const_iterator it = begin();
+  for (size_t i=0; i<order.size(); ++i) {
+    uint8_t* dst = ptr + order[i].second * frame_size;
+
+    if (i && order[i].first == order[i-1].first) {
+      //the same frame was requested twice
+      std::memcpy(dst, ptr + order[i-1].second * frame_size, frame_size);
+      ++frames_read;
+      continue;
+    }
+
+    if (it.parent()) it += order[i].first - it.cur();
+    if (!it.parent()) break; ///< we could not get there
+
+    bob::core::array::blitz_array ref(static_cast<void*>(dst), m_typeinfo_frame);
+    if (!it.read(ref, throw_on_error)) break;
+    ++frames_read;
+  }
+
+  return frames_read;
+}
+
 bob::io::VideoReader::const_iterator bob::io::VideoReader::begin() const {
   return bob::io::VideoReader::const_iterator(this);
 }
@@ -225,12 +402,20 @@ void bob::io::VideoReader::const_iterator::init() {
   m_stream_index = bob::io::detail::ffmpeg::find_video_stream(filename, m_format_context);
   m_codec = bob::io::detail::ffmpeg::find_decoder(filename, m_format_context, m_stream_index);
   m_codec_context = bob::io::detail::ffmpeg::make_codec_context(filename, 
-        m_format_context->streams[m_stream_index], m_codec);
-  m_swscaler = bob::io::detail::ffmpeg::make_scaler(filename, m_codec_context,
-      m_codec_context->pix_fmt, PIX_FMT_RGB24);
+        m_format_context->streams[m_stream_index], m_codec,
+        m_parent->m_threads);
+  if (!m_parent->m_gray) {
+    m_swscaler = bob::io::detail::ffmpeg::make_scaler(filename,
+        m_codec_context, m_codec_context->pix_fmt, PIX_FMT_RGB24);
+  }
+  else if (!bob::io::detail::ffmpeg::luma_is_gray(m_codec_context->pix_fmt)) {
+    //only the luminance range needs to be converted
+    m_swscaler = bob::io::detail::ffmpeg::make_scaler(filename,
+        m_codec_context, m_codec_context->pix_fmt, PIX_FMT_GRAY8);
+  }
   m_context_frame = bob::io::detail::ffmpeg::make_empty_frame(filename);
   m_rgb_array.reference(blitz::Array<uint8_t,3>(m_codec_context->height, 
-      m_codec_context->width, 3));
+      m_codec_context->width, m_parent->m_gray ? 1 : 3));
 
   //at this point we are ready to start reading out frames.
   m_current_frame = 0;
@@ -239,11 +424,33 @@ void bob::io::VideoReader::const_iterator::init() {
   if (m_current_frame >= m_parent->numberOfFrames()) {
     //transforms the current iterator in "end"
     reset();
+    return;
   }
 
+  start_prefetch();
+
+}
+
+void bob::io::VideoReader::const_iterator::start_prefetch() {
+  if (!m_parent->m_prefetch) return;
+
+  //from now on, only the prefetching thread touches the decoder
+  m_queue.reset(new bob::core::bounded_queue<prefetched_frame>(m_parent->m_prefetch));
+  m_prefetcher.reset(new boost::thread(boost::bind(&bob::io::VideoReader::const_iterator::prefetch, this, m_current_frame)));
+}
+
+void bob::io::VideoReader::const_iterator::stop_prefetch() {
+  if (m_prefetcher) {
+    //stops the prefetching thread before anyone else uses the decoder
+    m_queue->close();
+    m_prefetcher->join();
+    m_prefetcher.reset();
+  }
+  m_queue.reset();
 }
 
 void bob::io::VideoReader::const_iterator::reset() {
+  stop_prefetch();
   m_context_frame.reset();
   m_swscaler.reset();
   m_codec_context.reset();
@@ -259,6 +466,111 @@ bool bob::io::VideoReader::const_iterator::read(blitz::Array<uint8_t,3>& data,
   return read(tmp, throw_on_error);
 }
 
+bool bob::io::VideoReader::const_iterator::read(blitz::Array<uint8_t,2>& data,
+  bool throw_on_error) {
+  bob::core::array::blitz_array tmp(data);
+  return read(tmp, throw_on_error);
+}
+
+bool bob::io::VideoReader::const_iterator::decode(uint8_t* data,
+    const bob::core::array::typeinfo& info, size_t frame,
+    bool throw_on_error) {
+  BOB_TIME_SCOPE("io.video.decode");
+  BOB_COUNT("io.video.frames_decoded", 1);
+
+  bool gray = m_parent->m_gray;
+
+  //grayscale frames are decoded in place if they are contiguous
+  if (gray && info.stride[0] == info.shape[1] && info.stride[1] == 1) {
+    return bob::io::detail::ffmpeg::read_video_frame(m_parent->m_filepath,
+        frame, m_stream_index, m_format_context, m_codec_context, m_swscaler,
+        m_context_frame, data, throw_on_error, true);
+  }
+
+  //we are going to need another copy step - use our internal array
+  bool ok = bob::io::detail::ffmpeg::read_video_frame(m_parent->m_filepath,
+      frame, m_stream_index, m_format_context, m_codec_context, m_swscaler,
+      m_context_frame, m_rgb_array.data(), throw_on_error, gray);
+
+  if (!ok) return false;
+
+  //now we copy from one container to the other, using our Blitz++ technique
+  if (gray) {
+    blitz::TinyVector<int,2> shape(info.shape[0], info.shape[1]);
+    blitz::TinyVector<int,2> stride(info.stride[0], info.stride[1]);
+    blitz::Array<uint8_t,2> dst(data, shape, stride, blitz::neverDeleteData);
+    dst = m_rgb_array(blitz::Range::all(), blitz::Range::all(), 0);
+  }
+  else {
+    blitz::TinyVector<int,3> shape;
+    blitz::TinyVector<int,3> stride;
+
+    shape = info.shape[0], info.shape[1], info.shape[2];
+    stride = info.stride[0], info.stride[1], info.stride[2];
+    blitz::Array<uint8_t,3> dst(data, shape, stride, blitz::neverDeleteData);
+
+    dst = m_rgb_array.transpose(2,0,1);
+  }
+
+  return true;
+}
+
+void bob::io::VideoReader::const_iterator::prefetch(size_t frame) {
+  const bob::core::array::typeinfo& info = m_parent->m_typeinfo_frame;
+  for (; frame < m_parent->numberOfFrames(); ++frame) {
+    prefetched_frame next;
+    next.data.reset(new uint8_t[info.buffer_size()]);
+    next.ok = false;
+    try {
+      //decodes as leniently as read() does by default
+      next.ok = decode(next.data.get(), info, frame, false);
+    }
+    catch (...) {
+      next.error = std::current_exception();
+    }
+    if (!m_queue->push(next) || !next.ok) break;
+  }
+  m_queue->close();
+}
+
+/**
+ * Copies a contiguous frame into an array that may have other strides
+ */
+template <int N> static void copy_frame(const uint8_t* src,
+    bob::core::array::interface& dst) {
+  const bob::core::array::typeinfo& info = dst.type();
+  blitz::TinyVector<int,N> shape;
+  blitz::TinyVector<int,N> stride;
+  for (int k=0; k<N; ++k) {
+    shape(k) = info.shape[k];
+    stride(k) = info.stride[k];
+  }
+  blitz::Array<uint8_t,N> to(static_cast<uint8_t*>(dst.ptr()), shape,
+      stride, blitz::neverDeleteData);
+  to = blitz::Array<uint8_t,N>(const_cast<uint8_t*>(src), shape,
+      blitz::neverDeleteData);
+}
+
+bool bob::io::VideoReader::const_iterator::next_prefetched
+(bob::core::array::interface* data, bool throw_on_error) {
+  prefetched_frame next;
+  if (!m_queue->pop(next)) return false;
+  if (next.error && throw_on_error) std::rethrow_exception(next.error);
+  if (!next.ok) {
+    if (throw_on_error && !next.error) {
+      boost::format m("could not decode frame no. %d on file %s, which should contain %d frames");
+      m % m_current_frame % m_parent->m_filepath % m_parent->m_nframes;
+      throw std::runtime_error(m.str());
+    }
+    return false;
+  }
+  if (data) {
+    if (m_parent->m_gray) copy_frame<2>(next.data.get(), *data);
+    else copy_frame<3>(next.data.get(), *data);
+  }
+  return true;
+}
+
 bool bob::io::VideoReader::const_iterator::read(bob::core::array::interface& data,
   bool throw_on_error) {
 
@@ -290,27 +602,18 @@ bool bob::io::VideoReader::const_iterator::read(bob::core::array::interface& dat
     throw std::invalid_argument(s.str());
   }
 
-  //we are going to need another copy step - use our internal array
-  bool ok = bob::io::detail::ffmpeg::read_video_frame(m_parent->m_filepath, m_current_frame,
-      m_stream_index, m_format_context, m_codec_context, m_swscaler,
-      m_context_frame, m_rgb_array.data(), throw_on_error);
-
-  if (ok) {
-
-    //now we copy from one container to the other, using our Blitz++ technique
-    blitz::TinyVector<int,3> shape;
-    blitz::TinyVector<int,3> stride;
-
-    shape = info.shape[0], info.shape[1], info.shape[2];
-    stride = info.stride[0], info.stride[1], info.stride[2];
-    blitz::Array<uint8_t,3> dst(static_cast<uint8_t*>(data.ptr()), 
-        shape, stride, blitz::neverDeleteData);
-
-    dst = m_rgb_array.transpose(2,0,1);
-    ++m_current_frame;
-
+  if (m_queue) {
+    //the frame has been decoded ahead: if it could not, we stop here
+    bool ok = next_prefetched(&data, throw_on_error);
+    if (ok) ++m_current_frame;
+    else reset();
+    return ok;
   }
 
+  bool ok = decode(static_cast<uint8_t*>(data.ptr()), info, m_current_frame,
+      throw_on_error);
+  if (ok) ++m_current_frame;
+
   return ok;
 }
 
@@ -330,6 +633,18 @@ bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::oper
     return *this;
   }
 
+  if (m_queue) {
+    //the frame has been decoded already, we only drop it
+    try {
+      if (next_prefetched(0, true)) ++m_current_frame;
+      else reset();
+    }
+    catch (std::exception& e) {
+      reset();
+    }
+    return *this;
+  }
+
   //we are going to need another copy step - use our internal array
   try {
     bool ok = bob::io::detail::ffmpeg::skip_video_frame(m_parent->m_filepath, m_current_frame,
@@ -345,6 +660,41 @@ bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::oper
 }
 
 bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::operator+= (size_t frames) {
+
+  if (m_parent && frames && m_parent->m_indexed) {
+    size_t target = m_current_frame + frames;
+
+    if (target >= m_parent->numberOfFrames()) {
+      //we are past the end of the video sequence
+      reset();
+      return *this;
+    }
+
+    //finds the last keyframe before the target frame
+    const std::vector<size_t>& keyframes = m_parent->m_keyframes;
+    std::vector<size_t>::const_iterator k = 
+      std::upper_bound(keyframes.begin(), keyframes.end(), target);
+
+    if (k != keyframes.begin() && *(k-1) > m_current_frame) {
+      --k;
+      try {
+        //frames decoded ahead are useless from here on
+        stop_prefetch();
+        bob::io::detail::ffmpeg::seek_keyframe(m_parent->m_filepath,
+            m_stream_index, m_format_context, m_codec_context,
+            m_parent->m_keyframe_timestamps[k - keyframes.begin()]);
+        m_current_frame = *k;
+        start_prefetch();
+      }
+      catch (std::runtime_error& e) {
+        reset();
+        return *this;
+      }
+    }
+
+    frames = target - m_current_frame;
+  }
+
   for (size_t i=0; i<frames; ++i) ++(*this);
   return *this;
 }
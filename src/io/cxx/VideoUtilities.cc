@@ -20,6 +20,9 @@
  */
 
 #include <set>
+#include <cstring>
+#include <algorithm>
+#include <limits>
 #include <boost/token_iterator.hpp>
 #include <boost/format.hpp>
 
@@ -740,6 +743,9 @@ boost::shared_ptr<AVStream> bob::io::detail::ffmpeg::make_stream(
   if (retval->codec->codec_id == AV_CODEC_ID_MPEG2VIDEO) {
     /* just for testing, we also add B frames */
     retval->codec->max_b_frames = 2;
+    /* B frames must not refer to the previous group of pictures, so that
+     * decoding can start at every intra frame after a seek */
+    retval->codec->flags |= CODEC_FLAG_CLOSED_GOP;
   }
 
   if (retval->codec->codec_id == AV_CODEC_ID_MPEG1VIDEO) {
@@ -960,7 +966,8 @@ static void deallocate_codec_context(AVCodecContext* c) {
 }
 
 boost::shared_ptr<AVCodecContext> bob::io::detail::ffmpeg::make_codec_context(
-    const std::string& filename, AVStream* stream, AVCodec* codec) {
+    const std::string& filename, AVStream* stream, AVCodec* codec,
+    size_t threads) {
 
   AVCodecContext* retval = stream->codec;
 
@@ -969,6 +976,14 @@ boost::shared_ptr<AVCodecContext> bob::io::detail::ffmpeg::make_codec_context(
     retval->time_base.den = 1000;
   }
 
+  // Lets the codec split its work over several threads, if it can
+  if (threads > 1) {
+    retval->thread_count = threads;
+#ifdef FF_THREAD_FRAME
+    retval->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#endif
+  }
+
 # if LIBAVCODEC_VERSION_INT < 0x347a00 //52.122.0 @ ffmpeg-0.7
 
   int ok = avcodec_open(retval, codec);
@@ -1178,21 +1193,17 @@ void bob::io::detail::ffmpeg::flush_encoder (const std::string& filename,
 
 }
 
-void bob::io::detail::ffmpeg::write_video_frame (const blitz::Array<uint8_t,3>& data,
-    const std::string& filename,
+/**
+ * Encodes the contents of the context frame and writes the resulting packet,
+ * if any, to the output file.
+ */
+static void encode_video_frame (const std::string& filename,
     boost::shared_ptr<AVFormatContext> format_context,
     boost::shared_ptr<AVStream> stream,
     boost::shared_ptr<AVFrame> context_frame,
-    boost::shared_ptr<AVFrame> tmp_frame,
-    boost::shared_ptr<SwsContext> swscaler,
     boost::shared_array<uint8_t> buffer,
     size_t buffer_size) {
 
-  if (tmp_frame) 
-    image_to_context(data, stream, swscaler, context_frame, tmp_frame);
-  else 
-    image_to_context(data, stream, swscaler, context_frame);
-
   if (format_context->oformat->flags & AVFMT_RAWPICTURE) {
     
     /* Raw video case - directly store the picture in the packet */
@@ -1303,12 +1314,75 @@ void bob::io::detail::ffmpeg::write_video_frame (const blitz::Array<uint8_t,3>&
 #endif // FFmpeg version >= 0.11.0
 }
 
+void bob::io::detail::ffmpeg::write_video_frame (const blitz::Array<uint8_t,3>& data,
+    const std::string& filename,
+    boost::shared_ptr<AVFormatContext> format_context,
+    boost::shared_ptr<AVStream> stream,
+    boost::shared_ptr<AVFrame> context_frame,
+    boost::shared_ptr<AVFrame> tmp_frame,
+    boost::shared_ptr<SwsContext> swscaler,
+    boost::shared_array<uint8_t> buffer,
+    size_t buffer_size) {
+
+  if (tmp_frame) 
+    image_to_context(data, stream, swscaler, context_frame, tmp_frame);
+  else 
+    image_to_context(data, stream, swscaler, context_frame);
+
+  encode_video_frame(filename, format_context, stream, context_frame,
+      buffer, buffer_size);
+}
+
+std::string bob::io::detail::ffmpeg::pixel_format_name (PixelFormat pixel_format) {
+#if LIBAVUTIL_VERSION_INT >= 0x320f01 //50.15.1 @ ffmpeg-0.6
+  const char* retval = av_get_pix_fmt_name(pixel_format);
+#else
+  const char* retval = avcodec_get_pix_fmt_name(pixel_format);
+#endif
+  return retval ? retval : "unknown";
+}
+
+size_t bob::io::detail::ffmpeg::native_frame_size (PixelFormat pixel_format,
+    size_t height, size_t width) {
+  return avpicture_get_size(pixel_format, width, height);
+}
+
+void bob::io::detail::ffmpeg::write_native_video_frame (const uint8_t* data,
+    const std::string& filename,
+    boost::shared_ptr<AVFormatContext> format_context,
+    boost::shared_ptr<AVStream> stream,
+    boost::shared_ptr<AVFrame> context_frame,
+    boost::shared_array<uint8_t> buffer,
+    size_t buffer_size) {
+
+  // make_frame() lays the planes of the context frame out one after the
+  // other, in a single buffer, so the data can be copied in one go
+  std::memcpy(context_frame->data[0], data, native_frame_size(
+        stream->codec->pix_fmt, stream->codec->height, stream->codec->width));
+
+  encode_video_frame(filename, format_context, stream, context_frame,
+      buffer, buffer_size);
+}
+
+bool bob::io::detail::ffmpeg::luma_is_gray (PixelFormat pixel_format) {
+  switch (pixel_format) {
+    case PIX_FMT_GRAY8:
+    case PIX_FMT_YUVJ420P:
+    case PIX_FMT_YUVJ422P:
+    case PIX_FMT_YUVJ444P:
+    case PIX_FMT_YUVJ440P:
+      return true;
+    default:
+      return false;
+  }
+}
+
 static int decode_frame (const std::string& filename, int current_frame,
     boost::shared_ptr<AVCodecContext> codec_context,
     boost::shared_ptr<SwsContext> scaler,
     boost::shared_ptr<AVFrame> context_frame, uint8_t* data,
     boost::shared_ptr<AVPacket> pkt, 
-    int& got_frame, bool throw_on_error) {
+    int& got_frame, bool throw_on_error, bool gray) {
 
   // In this call, 3 things can happen:
   //
@@ -1336,13 +1410,26 @@ static int decode_frame (const std::string& filename, int current_frame,
     throw std::runtime_error(m.str());
   }
 
-  if (got_frame) {
+  if (got_frame && gray && !scaler) {
+
+    // The luminance plane is already what we want: copy it line by line
+
+    for (int y=0; y<codec_context->height; ++y) {
+      std::memcpy(data + y*codec_context->width,
+          context_frame->data[0] + y*context_frame->linesize[0],
+          codec_context->width);
+    }
+
+  }
+
+  else if (got_frame) {
 
     // In this case, we call the software scaler to decode the frame data.
-    // Normally, this means converting from planar YUV420 into packed RGB.
+    // Normally, this means converting from planar YUV420 into packed RGB,
+    // or only rescaling the luminance range for grayscale output.
 
     uint8_t* planes[] = {data, 0};
-    int linesize[] = {3*codec_context->width, 0};
+    int linesize[] = {(gray ? 1 : 3)*codec_context->width, 0};
 
     int conv_height = sws_scale(scaler.get(), context_frame->data,
         context_frame->linesize, 0, codec_context->height, planes, linesize);
@@ -1369,7 +1456,7 @@ bool bob::io::detail::ffmpeg::read_video_frame (const std::string& filename,
     boost::shared_ptr<AVCodecContext> codec_context,
     boost::shared_ptr<SwsContext> swscaler,
     boost::shared_ptr<AVFrame> context_frame, uint8_t* data,
-    bool throw_on_error) {
+    bool throw_on_error, bool gray) {
 
   boost::shared_ptr<AVPacket> pkt = make_packet();
 
@@ -1380,7 +1467,7 @@ bool bob::io::detail::ffmpeg::read_video_frame (const std::string& filename,
     if (pkt->stream_index == stream_index) {
       decode_frame(filename, current_frame, codec_context,
           swscaler, context_frame, data, pkt, got_frame,
-          throw_on_error);
+          throw_on_error, gray);
     }
     av_free_packet(pkt.get());
     if (got_frame) return true; //break loop
@@ -1407,7 +1494,7 @@ bool bob::io::detail::ffmpeg::read_video_frame (const std::string& filename,
     if (pkt->stream_index == stream_index) {
       decode_frame(filename, current_frame, codec_context,
           swscaler, context_frame, data, pkt, got_frame,
-          throw_on_error);
+          throw_on_error, gray);
       --iteration_counter;
       if (iteration_counter == 0) {
         if (throw_on_error) {
@@ -1516,3 +1603,83 @@ bool bob::io::detail::ffmpeg::skip_video_frame (const std::string& filename,
 
   return true;
 }
+
+void bob::io::detail::ffmpeg::index_keyframes (const std::string& filename,
+    int stream_index, boost::shared_ptr<AVFormatContext> format_context,
+    std::vector<size_t>& frames, std::vector<int64_t>& timestamps) {
+
+  frames.clear();
+  timestamps.clear();
+
+  boost::shared_ptr<AVPacket> pkt = make_packet();
+
+  // Only demuxes the file: every packet of the video stream is one frame
+  std::vector<int64_t> pts; ///< presentation timestamp of each packet
+  std::vector<int64_t> dts; ///< decoding timestamp of each packet
+  std::vector<bool> key; ///< is each packet a keyframe?
+  bool has_pts = true;
+  int ok = 0;
+  while ((ok = av_read_frame(format_context.get(), pkt.get())) >= 0) {
+    if (pkt->stream_index == stream_index) {
+      pts.push_back(pkt->pts);
+      dts.push_back(pkt->dts);
+      key.push_back(pkt->flags & AV_PKT_FLAG_KEY);
+      if (pkt->pts == (int64_t)AV_NOPTS_VALUE) has_pts = false;
+    }
+    av_free_packet(pkt.get());
+  }
+
+#if LIBAVCODEC_VERSION_INT >= 0x344802 //52.72.2 @ ffmpeg-0.6
+  if (ok != (int)AVERROR_EOF) {
+    boost::format m("bob::io::detail::ffmpeg::av_read_frame() failed: on file `%s' while indexing its keyframes - ffmpeg reports error %d == `%s'");
+    m % filename % ok % ffmpeg_error(ok);
+    throw std::runtime_error(m.str());
+  }
+#endif
+
+  // Frames are numbered in display order, as the decoder outputs them. If
+  // the presentation timestamps are missing, this is also the decoding order
+  // unless the codec re-orders frames: we cannot number them in that case.
+  if (!has_pts) {
+    if (format_context->streams[stream_index]->codec->has_b_frames) return;
+    for (size_t k=0; k<dts.size(); ++k) {
+      if (dts[k] == (int64_t)AV_NOPTS_VALUE) return;
+    }
+    pts = dts;
+  }
+
+  std::vector<int64_t> display(pts);
+  std::sort(display.begin(), display.end());
+
+  // After seeking a keyframe, the decoder outputs the frames from that
+  // keyframe on, in display order, only if no frame decoded after it is
+  // displayed before it: other keyframes are not usable
+  int64_t earliest = std::numeric_limits<int64_t>::max();
+  for (size_t k=pts.size(); k-->0;) {
+    earliest = std::min(earliest, pts[k]);
+    if (key[k] && pts[k] == earliest) {
+      frames.push_back(std::lower_bound(display.begin(), display.end(),
+            pts[k]) - display.begin());
+      timestamps.push_back(dts[k] != (int64_t)AV_NOPTS_VALUE ? dts[k] : pts[k]);
+    }
+  }
+  std::reverse(frames.begin(), frames.end());
+  std::reverse(timestamps.begin(), timestamps.end());
+}
+
+void bob::io::detail::ffmpeg::seek_keyframe (const std::string& filename,
+    int stream_index, boost::shared_ptr<AVFormatContext> format_context,
+    boost::shared_ptr<AVCodecContext> codec_context, int64_t timestamp) {
+
+  int ok = av_seek_frame(format_context.get(), stream_index, timestamp,
+      AVSEEK_FLAG_BACKWARD);
+
+  if (ok < 0) {
+    boost::format m("bob::io::detail::ffmpeg::av_seek_frame(timestamp=%d) failed: cannot seek keyframe on file `%s' - ffmpeg reports error %d == `%s'");
+    m % timestamp % filename % ok % ffmpeg_error(ok);
+    throw std::runtime_error(m.str());
+  }
+
+  // drops the frames the decoder still holds from before the seek
+  avcodec_flush_buffers(codec_context.get());
+}
@@ -21,9 +21,13 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
 #include <boost/format.hpp>
+#include <boost/bind.hpp>
 #include <boost/preprocessor.hpp>
 #include <bob/io/VideoWriter.h>
+#include <bob/core/logging.h>
+#include <bob/core/instrument.h>
 
 #if LIBAVFORMAT_VERSION_INT < 0x361764 /* 54.23.100 @ ffmpeg-0.11 */
 #define FFMPEG_VIDEO_BUFFER_SIZE 200000
@@ -44,14 +48,17 @@ bob::io::VideoWriter::VideoWriter(
     size_t gop,
     const std::string& codec,
     const std::string& format,
-    bool check) :
+    bool check,
+    size_t threads,
+    size_t queue) :
   m_filename(filename),
   m_opened(false),
   m_format_context(bob::io::detail::ffmpeg::make_output_format_context(filename, format)),
   m_codec(bob::io::detail::ffmpeg::find_encoder(filename, m_format_context, codec)),
   m_stream(bob::io::detail::ffmpeg::make_stream(filename, m_format_context, codec, height,
         width, framerate, bitrate, gop, m_codec)),
-  m_codec_context(bob::io::detail::ffmpeg::make_codec_context(filename, m_stream.get(), m_codec)),
+  m_codec_context(bob::io::detail::ffmpeg::make_codec_context(filename,
+        m_stream.get(), m_codec, bob::core::number_of_threads(threads))),
   m_context_frame(bob::io::detail::ffmpeg::make_frame(filename, m_codec_context, m_stream->codec->pix_fmt)),
 #if LIBAVCODEC_VERSION_INT >= 0x352a00 //53.42.0 @ ffmpeg-0.9
   m_swscaler(bob::io::detail::ffmpeg::make_scaler(filename, m_codec_context, PIX_FMT_GBRP, m_stream->codec->pix_fmt)),
@@ -67,7 +74,9 @@ bob::io::VideoWriter::VideoWriter(
   m_gop(gop),
   m_codecname(codec),
   m_formatname(format),
-  m_current_frame(0)
+  m_current_frame(0),
+  m_threads(bob::core::number_of_threads(threads)),
+  m_queue_size(queue)
 {
   //runs a codec/format check if the user asked so
   if (check) {
@@ -100,6 +109,11 @@ bob::io::VideoWriter::VideoWriter(
   m_typeinfo_video.shape[3] = m_typeinfo_frame.shape[2] = width;
   m_typeinfo_frame.update_strides();
   m_typeinfo_video.update_strides();
+  m_typeinfo_native.dtype = bob::core::array::t_uint8;
+  m_typeinfo_native.nd = 1;
+  m_typeinfo_native.shape[0] = bob::io::detail::ffmpeg::native_frame_size(
+      m_stream->codec->pix_fmt, height, width);
+  m_typeinfo_native.update_strides();
 
   //resets the output frame PTS [Note: presentation timestamp in time_base
   //units (time when frame should be shown to user) If AV_NOPTS_VALUE then
@@ -107,18 +121,43 @@ bob::io::VideoWriter::VideoWriter(
   m_context_frame->pts = 0;
 
   m_opened = true; ///< file is now considered opened for bussiness
+
+  //from now on, only the encoding thread touches the encoder
+  if (m_queue_size) {
+    m_queue.reset(new bob::core::bounded_queue<queued_frame>(m_queue_size));
+    m_encoder.reset(new boost::thread(boost::bind(&bob::io::VideoWriter::encode_queued, this)));
+  }
 }
 
 bob::io::VideoWriter::~VideoWriter() {
-  close();
+  try {
+    close();
+  }
+  catch (std::exception& e) {
+    bob::core::warn << "error while closing video file `" << m_filename
+      << "': " << e.what() << std::endl;
+  }
 }
 
 void bob::io::VideoWriter::close() {
 
   if (!m_opened) return;
 
-  bob::io::detail::ffmpeg::flush_encoder(m_filename, m_format_context, m_stream, m_codec,
-      m_buffer, FFMPEG_VIDEO_BUFFER_SIZE);
+  std::exception_ptr error;
+  if (m_encoder) {
+    //the encoding thread drains the queue before it returns
+    m_queue->close();
+    m_encoder->join();
+    m_encoder.reset();
+    m_queue.reset();
+    boost::lock_guard<boost::mutex> lock(m_error_mutex);
+    error = m_error;
+  }
+
+  if (!error) {
+    bob::io::detail::ffmpeg::flush_encoder(m_filename, m_format_context, m_stream, m_codec,
+        m_buffer, FFMPEG_VIDEO_BUFFER_SIZE);
+  }
   bob::io::detail::ffmpeg::close_output_file(m_filename, m_format_context);
 
   /* Destroyes resources in an orderly fashion */
@@ -131,6 +170,83 @@ void bob::io::VideoWriter::close() {
   m_format_context.reset();
 
   m_opened = false; ///< file is now considered closed
+
+  if (error) std::rethrow_exception(error);
+}
+
+std::string bob::io::VideoWriter::pixelFormat() const {
+  return bob::io::detail::ffmpeg::pixel_format_name(m_stream->codec->pix_fmt);
+}
+
+void bob::io::VideoWriter::check_writable() const {
+  if (!m_opened) {
+    boost::format m("video writer for file `%s' is closed and cannot be written to");
+    m % m_filename;
+    throw std::runtime_error(m.str());
+  }
+
+  boost::lock_guard<boost::mutex> lock(m_error_mutex);
+  if (m_error) std::rethrow_exception(m_error);
+}
+
+void bob::io::VideoWriter::encode(const uint8_t* data, bool native) {
+  BOB_TIME_SCOPE("io.video.encode");
+  BOB_COUNT("io.video.frames_encoded", 1);
+  if (native) {
+    bob::io::detail::ffmpeg::write_native_video_frame(data, m_filename,
+        m_format_context, m_stream, m_context_frame, m_buffer,
+        FFMPEG_VIDEO_BUFFER_SIZE);
+  }
+  else {
+    blitz::TinyVector<int,3> shape;
+    shape = 3, m_height, m_width;
+    blitz::Array<uint8_t,3> tmp(const_cast<uint8_t*>(data), shape,
+        blitz::neverDeleteData);
+    bob::io::detail::ffmpeg::write_video_frame(tmp, m_filename,
+        m_format_context, m_stream, m_context_frame, m_rgb24_frame,
+        m_swscaler, m_buffer, FFMPEG_VIDEO_BUFFER_SIZE);
+  }
+}
+
+void bob::io::VideoWriter::encode_queued() {
+  queued_frame frame;
+  while (m_queue->pop(frame)) {
+    try {
+      encode(frame.data.get(), frame.native);
+    }
+    catch (...) {
+      {
+        boost::lock_guard<boost::mutex> lock(m_error_mutex);
+        m_error = std::current_exception();
+      }
+      //wakes up append(), which will report the error
+      m_queue->close();
+      return;
+    }
+  }
+}
+
+void bob::io::VideoWriter::write(const uint8_t* data, bool native) {
+  if (!m_queue) encode(data, native);
+
+  else {
+    //the caller may reuse its buffer as soon as we return
+    size_t size = native ? m_typeinfo_native.buffer_size() : 
+      m_typeinfo_frame.buffer_size();
+    queued_frame frame;
+    frame.data.reset(new uint8_t[size]);
+    std::memcpy(frame.data.get(), data, size);
+    frame.native = native;
+    if (!m_queue->push(frame)) {
+      check_writable(); //raises the error of the encoding thread
+      boost::format m("the encoding thread of video file `%s' stopped unexpectedly");
+      m % m_filename;
+      throw std::runtime_error(m.str());
+    }
+  }
+
+  ++m_current_frame;
+  m_typeinfo_video.shape[0] += 1;
 }
 
 std::string bob::io::VideoWriter::info() const {
@@ -157,11 +273,7 @@ std::string bob::io::VideoWriter::info() const {
 }
 
 void bob::io::VideoWriter::append(const blitz::Array<uint8_t,4>& data) {
-  if (!m_opened) {
-    boost::format m("video writer for file `%s' is closed and cannot be written to");
-    m % m_filename;
-    throw std::runtime_error(m.str());
-  }
+  check_writable();
 
   //checks data specifications
   if (data.extent(1) != 3 || (size_t)data.extent(2) != m_height || 
@@ -174,20 +286,12 @@ void bob::io::VideoWriter::append(const blitz::Array<uint8_t,4>& data) {
 
   blitz::Range a = blitz::Range::all();
   for(int i=data.lbound(0); i<(data.extent(0)+data.lbound(0)); ++i) {
-    bob::io::detail::ffmpeg::write_video_frame(data(i, a, a, a), m_filename, m_format_context,
-        m_stream, m_context_frame, m_rgb24_frame, m_swscaler, m_buffer,
-        FFMPEG_VIDEO_BUFFER_SIZE);
-    ++m_current_frame;
-    m_typeinfo_video.shape[0] += 1;
+    write(data(i, a, a, a).data(), false);
   }
 }
 
 void bob::io::VideoWriter::append(const blitz::Array<uint8_t,3>& data) {
-  if (!m_opened) {
-    boost::format m("video writer for file `%s' is closed and cannot be written to");
-    m % m_filename;
-    throw std::runtime_error(m.str());
-  }
+  check_writable();
 
   //checks data specifications
   if (data.extent(0) != 3 || (size_t)data.extent(1) != m_height || 
@@ -198,19 +302,11 @@ void bob::io::VideoWriter::append(const blitz::Array<uint8_t,3>& data) {
     throw std::runtime_error(m.str());
   }
 
-  bob::io::detail::ffmpeg::write_video_frame(data, m_filename, m_format_context,
-      m_stream, m_context_frame, m_rgb24_frame, m_swscaler, m_buffer,
-      FFMPEG_VIDEO_BUFFER_SIZE);
-  ++m_current_frame;
-  m_typeinfo_video.shape[0] += 1;
+  write(data.data(), false);
 }
 
 void bob::io::VideoWriter::append(const bob::core::array::interface& data) {
-  if (!m_opened) {
-    boost::format m("video writer for file `%s' is closed and cannot be written to");
-    m % m_filename;
-    throw std::runtime_error(m.str());
-  }
+  check_writable();
 
   const bob::core::array::typeinfo& type = data.type();
 
@@ -230,15 +326,7 @@ void bob::io::VideoWriter::append(const bob::core::array::interface& data) {
       throw std::runtime_error(m.str());
     }
 
-    blitz::TinyVector<int,3> shape;
-    shape = 3, m_height, m_width;
-    blitz::Array<uint8_t,3> tmp(const_cast<uint8_t*>(static_cast<const uint8_t*>(data.ptr())), shape,
-        blitz::neverDeleteData);
-    bob::io::detail::ffmpeg::write_video_frame(tmp, m_filename, m_format_context,
-        m_stream, m_context_frame, m_rgb24_frame, m_swscaler, m_buffer,
-        FFMPEG_VIDEO_BUFFER_SIZE);
-    ++m_current_frame;
-    m_typeinfo_video.shape[0] += 1;
+    write(static_cast<const uint8_t*>(data.ptr()), false);
   }
   
   else if ( type.nd == 4 ) { //appends a sequence of frames
@@ -251,18 +339,11 @@ void bob::io::VideoWriter::append(const bob::core::array::interface& data) {
       throw std::runtime_error(m.str());
     }
     
-    blitz::TinyVector<int,3> shape;
-    shape = 3, m_height, m_width;
     unsigned long int frame_size = 3 * m_height * m_width;
-    uint8_t* ptr = const_cast<uint8_t*>(static_cast<const uint8_t*>(data.ptr()));
+    const uint8_t* ptr = static_cast<const uint8_t*>(data.ptr());
 
     for(size_t i=0; i<type.shape[0]; ++i) {
-      blitz::Array<uint8_t,3> tmp(ptr, shape, blitz::neverDeleteData);
-      bob::io::detail::ffmpeg::write_video_frame(tmp, m_filename, m_format_context,
-          m_stream, m_context_frame, m_rgb24_frame, m_swscaler, m_buffer,
-          FFMPEG_VIDEO_BUFFER_SIZE);
-      ++m_current_frame;
-      m_typeinfo_video.shape[0] += 1;
+      write(ptr, false);
       ptr += frame_size;
     }
   }
@@ -274,3 +355,17 @@ void bob::io::VideoWriter::append(const bob::core::array::interface& data) {
   }
 
 }
+
+void bob::io::VideoWriter::appendNative(const bob::core::array::interface& data) {
+  check_writable();
+
+  const bob::core::array::typeinfo& type = data.type();
+
+  if (!m_typeinfo_native.is_compatible(type)) {
+    boost::format m("input data type information = `%s' does not conform to the native frame specifications (`%s', pixel format `%s') of the encoder, while writing data to file `%s'");
+    m % type.str() % m_typeinfo_native.str() % pixelFormat() % m_filename;
+    throw std::runtime_error(m.str());
+  }
+
+  write(static_cast<const uint8_t*>(data.ptr()), true);
+}
@@ -0,0 +1,106 @@
+/**
+ * @file io/cxx/benchmark/HDF5Append.cc
+ * @date 2013-07-04
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Measures appending feature vectors to an HDF5 dataset and reading
+ * them back, one entry at a time or as a single range.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/filesystem.hpp>
+#include <boost/random.hpp>
+#include <blitz/array.h>
+
+#include "bob/core/benchmark.h"
+#include "bob/core/logging.h"
+#include "bob/io/HDF5File.h"
+
+using bob::core::benchmark::param;
+
+/**
+ * Writes all rows of data into a new file, one entry at a time or as a range
+ */
+struct Append {
+  const std::string& filename;
+  const blitz::Array<double,2>& data;
+  bool range;
+  void operator()() const {
+    bob::io::HDF5File file(filename, bob::io::HDF5File::trunc);
+    if (range) {
+      file.appendRange("/data", data);
+      return;
+    }
+    for (int i = 0; i < data.extent(0); ++i)
+      file.appendArray("/data", data(i, blitz::Range::all()));
+  }
+};
+
+/**
+ * Reads all rows of the file back, one entry at a time or as a range
+ */
+struct Read {
+  const std::string& filename;
+  blitz::Array<double,2>& data;
+  bool range;
+  void operator()() const {
+    bob::io::HDF5File file(filename, bob::io::HDF5File::in);
+    if (range) {
+      file.readRange("/data", 0, data);
+      return;
+    }
+    for (int i = 0; i < data.extent(0); ++i) {
+      blitz::Array<double,1> row(data(i, blitz::Range::all()));
+      file.readArray("/data", i, row);
+    }
+  }
+};
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("io_hdf5_append", argc, argv);
+  const int entries[] = {1000, 10000, 100000};
+  const int n_entries = suite.quick() ? 2 : 3;
+  const int dimension = 60;
+
+  const std::string filename = bob::core::tmpfile(".hdf5");
+
+  boost::mt19937 rng;
+  boost::normal_distribution<> normal;
+
+  for (int e = 0; e < n_entries; ++e){
+    const int n = entries[e];
+    blitz::Array<double,2> data(n, dimension), readback(n, dimension);
+    for (int i = 0; i < n; ++i)
+      for (int j = 0; j < dimension; ++j)
+        data(i,j) = normal(rng);
+    const std::string parameters = param("entries", n) + "," +
+      param("dim", dimension);
+
+    // entry by entry, as feature extraction loops do
+    Append append = {filename, data, false};
+    suite.run("append", parameters, append);
+    Read read = {filename, readback, false};
+    suite.run("read", parameters, read);
+
+    Append append_range = {filename, data, true};
+    suite.run("append_range", parameters, append_range);
+    Read read_range = {filename, readback, true};
+    suite.run("read_range", parameters, read_range);
+  }
+
+  boost::filesystem::remove(filename);
+  return suite.finish();
+}
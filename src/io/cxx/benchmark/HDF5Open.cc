@@ -0,0 +1,128 @@
+/**
+ * @file io/cxx/benchmark/HDF5Open.cc
+ * @date 2013-06-25
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Measures the time to open HDF5 files with many datasets, either in
+ * a single group (wide) or spread over nested groups (deep), and to access a
+ * single dataset or to list all of them.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <blitz/array.h>
+
+#include "bob/core/benchmark.h"
+#include "bob/core/logging.h"
+#include "bob/io/HDF5File.h"
+
+using bob::core::benchmark::param;
+
+/**
+ * Returns the path of the given dataset, placing 'fanout' datasets in each
+ * group of a hierarchy 'depth' levels deep (or all of them in the root
+ * group, if depth is 0).
+ */
+static std::string dataset_path(int index, int depth, int fanout){
+  std::string path;
+  int group = index / fanout;
+  for (int d = 0; d < depth; ++d){
+    path += (boost::format("/g%d") % (group % fanout)).str();
+    group /= fanout;
+  }
+  return path + (boost::format("/d%d") % (index % fanout)).str();
+}
+
+static void generate(const std::string& filename, int datasets, int depth,
+    int fanout){
+  bob::io::HDF5File file(filename, bob::io::HDF5File::trunc);
+  blitz::Array<double,1> data(60);
+  data = 1.;
+  for (int i = 0; i < datasets; ++i)
+    file.setArray(dataset_path(i, depth, fanout), data);
+}
+
+struct Open {
+  const std::string& filename;
+  void operator()() const {
+    bob::io::HDF5File file(filename, bob::io::HDF5File::in);
+  }
+};
+
+/**
+ * Groups and datasets are only opened when they are first accessed, so the
+ * other benchmarks also open the file each time
+ */
+struct OpenReadOne {
+  const std::string& filename;
+  const std::string& path;
+  void operator()() const {
+    bob::io::HDF5File file(filename, bob::io::HDF5File::in);
+    file.readArray<double,1>(path);
+  }
+};
+
+struct OpenList {
+  const std::string& filename;
+  void operator()() const {
+    bob::io::HDF5File file(filename, bob::io::HDF5File::in);
+    std::vector<std::string> paths;
+    file.paths(paths);
+  }
+};
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("io_hdf5_open", argc, argv);
+  const int sizes[] = {1000, 10000, 100000};
+  const int n_sizes = suite.quick() ? 2 : 3;
+  const int depths[] = {0, 2};
+
+  const std::string filename = bob::core::tmpfile(".hdf5");
+
+  for (int s = 0; s < n_sizes; ++s){
+    for (int d = 0; d < 2; ++d){
+      const int datasets = sizes[s], depth = depths[d];
+      // with 2 levels, each group holds the cubic root of the datasets
+      const int fanout = depth ?
+        (int)std::ceil(std::pow((double)datasets, 1./(depth+1))) : datasets;
+      generate(filename, datasets, depth, fanout);
+      const std::string parameters = param("datasets", datasets) + "," +
+        param("depth", depth);
+
+      std::vector<std::string> paths;
+      bob::io::HDF5File(filename, bob::io::HDF5File::in).paths(paths);
+      if ((int)paths.size() != datasets){
+        std::cerr << "found " << paths.size() << " datasets instead of " << datasets << std::endl;
+        return 1;
+      }
+
+      Open open = {filename};
+      suite.run("open", parameters, open);
+      const std::string path = dataset_path(datasets/2, depth, fanout);
+      OpenReadOne read = {filename, path};
+      suite.run("open_read_one", parameters, read);
+      OpenList list = {filename};
+      suite.run("open_list", parameters, list);
+    }
+  }
+
+  boost::filesystem::remove(filename);
+  return suite.finish();
+}
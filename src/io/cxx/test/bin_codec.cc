@@ -0,0 +1,157 @@
+/**
+ * @file io/cxx/test/bin_codec.cc
+ * @date Fri Jul  5 14:37:12 2013 +0200
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief BinFile memory map tests
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE BinaryArrayCodec Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <vector>
+
+#include <blitz/array.h>
+#include "bob/core/logging.h"
+#include "bob/core/blitz_array.h"
+#include "bob/core/array_utils.h"
+#include "bob/io/utils.h"
+#include "bob/io/BinFile.h"
+
+struct T {
+  blitz::Array<int8_t,2> a;
+  blitz::Array<double,2> c;
+
+  T() {
+    a.resize(3,4);
+    a = 0, 1, 2, 3,
+        4, 5, 6, 7,
+        8, 9, 10, 11;
+    // rows that are not a multiple of the page size, so that most arrays
+    // start at an unaligned offset of the file
+    c.resize(5,700);
+    for (int i=0; i<c.extent(0); ++i)
+      for (int j=0; j<c.extent(1); ++j)
+        c(i,j) = i * 1000. + j / 8.;
+  }
+
+  ~T() { }
+
+};
+
+template<typename T, typename U> 
+void check_equal(const blitz::Array<T,2>& a, const blitz::Array<U,2>& b) 
+{
+  BOOST_REQUIRE_EQUAL(a.extent(0), b.extent(0));
+  BOOST_REQUIRE_EQUAL(a.extent(1), b.extent(1));
+  for (int i=0; i<a.extent(0); ++i) {
+    for (int j=0; j<a.extent(1); ++j) {
+      BOOST_CHECK_EQUAL(a(i,j), bob::core::cast<T>(b(i,j)));
+    }
+  }
+}
+
+/**
+ * Writes each row of the given array as a separate 1xN array
+ */
+template<typename T>
+void write_rows(const std::string& filename, const blitz::Array<T,2>& x)
+{
+  bob::io::BinFile out(filename, bob::io::BinFile::out);
+  for (int i=0; i<x.extent(0); ++i) {
+    blitz::Array<T,2> row(x(blitz::Range(i,i), blitz::Range::all()).copy());
+    out.write(bob::core::array::blitz_array(row));
+  }
+}
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( bin_2d )
+{
+  std::string filename = bob::core::tmpfile(".bin");
+  bob::io::save(filename, a);
+  check_equal( bob::io::load<int8_t,2>(filename), a );
+  boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE( bin_mapped_view )
+{
+  std::string filename = bob::core::tmpfile(".bin");
+  write_rows(filename, a);
+
+  bob::io::BinFile in(filename, bob::io::BinFile::in | bob::io::BinFile::map);
+  BOOST_CHECK(in.isMapped());
+  BOOST_REQUIRE_EQUAL(in.size(), 3);
+
+  for (size_t i=0; i<in.size(); ++i) {
+    boost::shared_ptr<bob::core::array::interface> v = in.view(i);
+    check_equal(bob::core::array::wrap<int8_t,2>(*v),
+        a(blitz::Range(i,i), blitz::Range::all()));
+  }
+
+  // modifying a view changes neither the file, nor other reads or views
+  boost::shared_ptr<bob::core::array::interface> v = in.view(1);
+  static_cast<int8_t*>(v->ptr())[0] = 42;
+  BOOST_CHECK_EQUAL(static_cast<int8_t*>(v->ptr())[0], 42);
+  bob::core::array::blitz_array row(v->type());
+  in.read(1, row);
+  check_equal(bob::core::array::wrap<int8_t,2>(row),
+      a(blitz::Range(1,1), blitz::Range::all()));
+  check_equal(bob::core::array::wrap<int8_t,2>(*in.view(1)),
+      a(blitz::Range(1,1), blitz::Range::all()));
+  check_equal(bob::io::load<int8_t,2>(filename, 1),
+      a(blitz::Range(1,1), blitz::Range::all()));
+
+  // reading past the end is an error
+  BOOST_CHECK_THROW(in.view(3), bob::io::IndexError);
+  BOOST_CHECK_THROW(in.read(3, row), bob::io::IndexError);
+
+  in.close();
+  boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE( bin_mapped_view_unaligned )
+{
+  std::string filename = bob::core::tmpfile(".bin");
+  write_rows(filename, c);
+
+  bob::io::BinFile in(filename, bob::io::BinFile::in | bob::io::BinFile::map);
+  BOOST_CHECK(in.isMapped());
+  BOOST_REQUIRE_EQUAL(in.size(), 5);
+
+  // views are independent from each other and from the file object
+  std::vector<boost::shared_ptr<bob::core::array::interface> > views;
+  for (size_t i=0; i<in.size(); ++i) views.push_back(in.view(i));
+  in.close();
+  for (size_t i=0; i<views.size(); ++i) {
+    static_cast<double*>(views[i]->ptr())[0] = -1.;
+    blitz::Array<double,2> expected(c(blitz::Range(i,i), blitz::Range::all()).copy());
+    expected(0,0) = -1.;
+    check_equal(bob::core::array::wrap<double,2>(*views[i]), expected);
+  }
+  views.clear();
+
+  // the codec reads from the map as well
+  for (int i=0; i<c.extent(0); ++i)
+    check_equal(bob::io::load<double,2>(filename, i),
+        c(blitz::Range(i,i), blitz::Range::all()));
+  boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -31,6 +31,7 @@
 #include <blitz/array.h>
 #include <complex>
 #include <string>
+#include <vector>
 #include "bob/core/logging.h" // for bob::core::tmpdir()
 #include "bob/core/cast.h"
 #include "bob/io/HDF5File.h"
@@ -146,4 +147,84 @@ BOOST_AUTO_TEST_CASE( hdf5_write_on_readonly )
   boost::filesystem::remove(filename);
 }
 
+BOOST_AUTO_TEST_CASE( hdf5_range_append_read )
+{
+  const std::string filename = bob::core::tmpfile();
+  bob::io::HDF5File config(filename, bob::io::HDF5File::trunc, 1 << 22);
+  BOOST_CHECK_EQUAL(config.cacheSize(), (size_t)(1 << 22));
+
+  // Appends the rows of 'a' in two ranges and a single array
+  config.appendRange("a", a(blitz::Range(0,1), blitz::Range::all()), 0, 3);
+  blitz::Array<double,1> row = a(2, blitz::Range::all());
+  config.appendArray("a", row);
+  config.appendRange("a", a(blitz::Range(3,3), blitz::Range::all()));
+  BOOST_CHECK_EQUAL(config.describe("a")[0].size, (size_t)4);
+
+  // Reads all rows in a single shot and some in the middle
+  check_equal(a, config.readRange<double,2>("a", 0, 4));
+  blitz::Array<double,2> middle(2,2);
+  config.readRange("a", 1, middle);
+  blitz::Array<double,2> a_middle = a(blitz::Range(1,2), blitz::Range::all());
+  check_equal(a_middle, middle);
+  BOOST_CHECK_THROW(config.readRange<double,2>("a", 3, 2), std::exception);
+
+  // Scalars are handled with 1D arrays
+  config.appendRange("c", c);
+  config.append("c", 0.);
+  blitz::Array<double,1> c_read = config.readRange<double,1>("c", 0, 5);
+  check_equal(c, c_read);
+  BOOST_CHECK_EQUAL(config.read<double>("c", 5), 0.);
+
+  // Clean-up
+  boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE( hdf5_lazy_open )
+{
+  const std::string filename = bob::core::tmpfile();
+  {
+    bob::io::HDF5File config(filename, bob::io::HDF5File::trunc);
+    config.createGroup("/g1");
+    config.createGroup("/g1/g2");
+    config.createGroup("/g1/g2/g3");
+    config.setArray("/c", c);
+    config.setArray("/g1/a", a);
+    config.setArray("/g1/g2/c", c);
+    config.set("/g1/g2/g3/integer", 3);
+  }
+
+  // Accesses a dataset without listing anything first
+  bob::io::HDF5File config(filename, bob::io::HDF5File::inout);
+  check_equal(c, config.readArray<double,1>("/g1/g2/c"));
+  BOOST_CHECK(config.contains("/g1/a"));
+  BOOST_CHECK(!config.contains("/g1/b"));
+  BOOST_CHECK(!config.contains("g1"));
+  BOOST_CHECK(config.hasGroup("/g1/g2"));
+  BOOST_CHECK(!config.hasGroup("/g1/a"));
+
+  // Lists everything, including what was accessed before
+  std::vector<std::string> paths;
+  config.paths(paths);
+  BOOST_REQUIRE_EQUAL(paths.size(), (size_t)4);
+  BOOST_CHECK_EQUAL(paths[0], "/c");
+  BOOST_CHECK_EQUAL(paths[1], "/g1/a");
+  BOOST_CHECK_EQUAL(paths[2], "/g1/g2/c");
+  BOOST_CHECK_EQUAL(paths[3], "/g1/g2/g3/integer");
+
+  std::vector<std::string> groups;
+  config.cd("/g1");
+  config.sub_groups(groups, true, false);
+  BOOST_REQUIRE_EQUAL(groups.size(), (size_t)1);
+  BOOST_CHECK_EQUAL(groups[0], "g2");
+
+  // Renamed datasets are found at their new place
+  config.rename("a", "g2/b");
+  BOOST_CHECK(!config.contains("a"));
+  check_equal(a, config.readArray<double,2>("g2/b"));
+  BOOST_CHECK_EQUAL(config.read<int>("/g1/g2/g3/integer"), 3);
+
+  // Clean-up
+  boost::filesystem::remove(filename);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -30,6 +30,8 @@
 #include <blitz/array.h>
 #include "bob/core/logging.h"
 #include "bob/io/utils.h"
+#include "bob/io/TensorFile.h"
+#include "bob/core/array_utils.h"
 
 struct T {
   blitz::Array<int8_t,2> a, b;
@@ -84,4 +86,58 @@ BOOST_AUTO_TEST_CASE( tensor_2d_read_T5alpha )
   check_equal( bob::io::load<int8_t,2>(testdata_path.string()), b );
 }
 
+BOOST_AUTO_TEST_CASE( tensor_mapped_view )
+{
+  std::string filename = bob::core::tmpfile(".tensor");
+  {
+    bob::io::TensorFile out(filename, bob::io::TensorFile::out);
+    for (int i=0; i<3; ++i) {
+      blitz::Array<int8_t,2> row(b(blitz::Range(i,i), blitz::Range::all()).copy());
+      out.write(row);
+    }
+  }
+
+  bob::io::TensorFile in(filename,
+      bob::io::TensorFile::in | bob::io::TensorFile::map);
+  BOOST_CHECK(in.isMapped());
+  BOOST_REQUIRE_EQUAL(in.size(), 3);
+
+  // single rows have the same layout in memory and on disk
+  for (size_t i=0; i<in.size(); ++i) {
+    boost::shared_ptr<bob::core::array::interface> v = in.view(i);
+    check_equal(bob::core::array::wrap<int8_t,2>(*v),
+        b(blitz::Range(i,i), blitz::Range::all()));
+  }
+
+  // modifying a view changes neither the file, nor other reads or views
+  boost::shared_ptr<bob::core::array::interface> v = in.view(0);
+  static_cast<int8_t*>(v->ptr())[0] = 42;
+  BOOST_CHECK_EQUAL(static_cast<int8_t*>(v->ptr())[0], 42);
+  check_equal(in.read<int8_t,2>(0), b(blitz::Range(0,0), blitz::Range::all()));
+  check_equal(bob::core::array::wrap<int8_t,2>(*in.view(0)),
+      b(blitz::Range(0,0), blitz::Range::all()));
+  // loading the whole file only reads the first array
+  check_equal(bob::io::load<int8_t,2>(filename),
+      b(blitz::Range(0,0), blitz::Range::all()));
+  for (int i=0; i<3; ++i)
+    check_equal(bob::io::load<int8_t,2>(filename, i),
+        b(blitz::Range(i,i), blitz::Range::all()));
+
+  // reading past the end is an error
+  BOOST_CHECK_THROW(in.view(3), bob::io::IndexError);
+  BOOST_CHECK_THROW(in.read<int8_t,2>(3), bob::io::IndexError);
+
+  in.close();
+  boost::filesystem::remove(filename);
+
+  // other arrays are re-ordered, from the map as well
+  bob::io::save(filename, a);
+  bob::io::TensorFile in2(filename,
+      bob::io::TensorFile::in | bob::io::TensorFile::map);
+  check_equal(bob::core::array::wrap<int8_t,2>(*in2.view(0)), a);
+  check_equal(bob::io::load<int8_t,2>(filename), a);
+  in2.close();
+  boost::filesystem::remove(filename);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
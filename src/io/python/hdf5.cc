@@ -35,7 +35,8 @@ using namespace boost::python;
  * Allows us to write HDF5File("filename.hdf5", "r")
  */
 static boost::shared_ptr<bob::io::HDF5File>
-hdf5file_make_fromstr(const std::string& filename, const std::string& opmode) {
+hdf5file_make_fromstr(const std::string& filename, const std::string& opmode,
+    size_t cache_size) {
   if (opmode.size() > 1) PYTHON_ERROR(RuntimeError, "Supported flags are 'r' (read-only), 'a' (read/write/append), 'w' (read/write/truncate) or 'x' (read/write/exclusive), but you tried to use '%s'", opmode.c_str());
   bob::io::HDF5File::mode_t mode = bob::io::HDF5File::inout;
   if (opmode[0] == 'r') mode = bob::io::HDF5File::in;
@@ -45,7 +46,7 @@ hdf5file_make_fromstr(const std::string& filename, const std::string& opmode) {
   else { //anything else is just unsupported for the time being
     PYTHON_ERROR(RuntimeError, "Supported flags are 'r' (read-only), 'a' (read/write/append), 'w' (read/write/truncate) or 'x' (read/write/exclusive), but you tried to use '%s'", opmode.c_str());
   }
-  return boost::make_shared<bob::io::HDF5File>(filename, mode);
+  return boost::make_shared<bob::io::HDF5File>(filename, mode, cache_size);
 }
 
 /**
@@ -140,6 +141,32 @@ static object hdf5file_xread(bob::io::HDF5File& f, const std::string& p,
   return retval.pyobject();
 }
 
+/**
+ * Reads count consecutive entries, starting at pos, as a single numpy array
+ * with one dimension more than the entries.
+ */
+static object hdf5file_read_range(bob::io::HDF5File& f, const std::string& p,
+    size_t pos, size_t count) {
+
+  const std::vector<bob::io::HDF5Descriptor>& D = f.describe(p);
+
+  bob::io::HDF5Type type = D[0].type;
+  if (type.type() == bob::io::s)
+    PYTHON_ERROR(TypeError, "cannot read ranges of strings from dataset '%s'", p.c_str());
+
+  if (type.shape().n() == 1 && type.shape()[0] == 1) type.shape()[0] = count;
+  else {
+    type.shape() >>= 1;
+    type.shape()[0] = count;
+  }
+
+  bob::core::array::typeinfo atype;
+  type.copy_to(atype);
+  bob::python::py_array retval(atype);
+  f.read_range_buffer(p, pos, atype, retval.ptr());
+  return retval.pyobject();
+}
+
 static object hdf5file_lread(bob::io::HDF5File& f, const std::string& p,
     int64_t pos=-1) {
   if (pos >= 0) return hdf5file_xread(f, p, 0, pos);
@@ -147,8 +174,16 @@ static object hdf5file_lread(bob::io::HDF5File& f, const std::string& p,
   //otherwise returns as a list
   const std::vector<bob::io::HDF5Descriptor>& D = f.describe(p);
   list retval;
-  for (uint64_t k=0; k<D[0].size; ++k)
-    retval.append(hdf5file_xread(f, p, 0, k));
+  const bob::io::HDF5Shape& shape = D[0].type.shape();
+  if (D[0].type.type() == bob::io::s || (shape.n() == 1 && shape[0] == 1)) {
+    //strings and scalars are read one by one
+    for (uint64_t k=0; k<D[0].size; ++k)
+      retval.append(hdf5file_xread(f, p, 0, k));
+  }
+  else if (D[0].size) { //arrays are read in a single shot and split
+    object range = hdf5file_read_range(f, p, 0, D[0].size);
+    for (uint64_t k=0; k<D[0].size; ++k) retval.append(range[k]);
+  }
   return retval;
 }
 BOOST_PYTHON_FUNCTION_OVERLOADS(hdf5file_lread_overloads, hdf5file_lread, 2, 3)
@@ -375,6 +410,17 @@ static void hdf5file_append(bob::io::HDF5File& f, const std::string& path,
 
 BOOST_PYTHON_FUNCTION_OVERLOADS(hdf5file_append_overloads, hdf5file_append, 3, 4)
 
+static void hdf5file_append_range(bob::io::HDF5File& f, const std::string& path,
+    object obj, size_t compression=0, size_t chunk_size=0) {
+  bob::python::py_array tmp(obj, object());
+  if (!f.contains(path))
+    f.create(path, bob::io::detail::hdf5::range_entry_type(tmp.type()), true,
+        compression, chunk_size);
+  f.extend_range_buffer(path, tmp.type(), tmp.ptr());
+}
+
+BOOST_PYTHON_FUNCTION_OVERLOADS(hdf5file_append_range_overloads, hdf5file_append_range, 3, 5)
+
 template <typename T>
 static void inner_set_scalar(bob::io::HDF5File& f, const std::string& path,
     object obj) {
@@ -662,11 +708,12 @@ BOOST_PYTHON_FUNCTION_OVERLOADS(hdf5file_del_attributes_overloads, hdf5file_del_
 void bind_io_hdf5() {
   class_<bob::io::HDF5File, boost::shared_ptr<bob::io::HDF5File> >("HDF5File", "A HDF5File allows users to read and write data from and to files containing standard bob binary coded data in HDF5 format. For an introduction to HDF5, please visit http://www.hdfgroup.org/HDF5.", no_init)
     .def(boost::python::init<const bob::io::HDF5File&>(boost::python::args("other"), "Generates a shallow copy of the already opened file."))
-    .def("__init__", make_constructor(hdf5file_make_fromstr, default_call_policies(), (arg("filename"), arg("openmode_string") = "r")), "Opens a new file in one of these supported modes: 'r' (read-only), 'a' (read/write/append), 'w' (read/write/truncate) or 'x' (read/write/exclusive)")
+    .def("__init__", make_constructor(hdf5file_make_fromstr, default_call_policies(), (arg("filename"), arg("openmode_string") = "r", arg("cache_size") = 0)), "Opens a new file in one of these supported modes: 'r' (read-only), 'a' (read/write/append), 'w' (read/write/truncate) or 'x' (read/write/exclusive). The optional cache size sets the number of bytes of the raw data chunk cache kept for each dataset. The value of zero keeps the HDF5 default (1 MiB).")
     .def("cd", &bob::io::HDF5File::cd, (arg("self"), arg("path")), "Changes the current prefix path. When this object is started, the prefix path is empty, which means all following paths to data objects should be given using the full path. If you set this to a different value, it will be used as a prefix to any subsequent operation until you reset it. If path starts with '/', it is treated as an absolute path. '..' and '.' are supported. This object should be a std::string. If the value is relative, it is added to the current path. If it is absolute, it causes the prefix to be reset. Note all operations taking a relative path, following a cd(), will be considered relative to the value defined by the 'cwd' property of this object.")
     .def("has_group", &bob::io::HDF5File::hasGroup, (arg("self"), arg("path")), "Checks if a path exists inside a file - does not work for datasets, only for directories. If the given path is relative, it is take w.r.t. to the current working directory")
     .def("create_group", &bob::io::HDF5File::createGroup, (arg("self"), arg("path")), "Creates a new directory inside the file. A relative path is taken w.r.t. to the current directory. If the directory already exists (check it with hasGroup()), an exception will be raised.")
     .add_property("cwd", &bob::io::HDF5File::cwd)
+    .add_property("cache_size", &bob::io::HDF5File::cacheSize, "The size in bytes of the raw data chunk cache kept for each dataset of this file")
     .def("__contains__", &bob::io::HDF5File::contains, (arg("self"), arg("key")), "Returns True if the file contains an HDF5 dataset with a given path")
     .def("has_key", &bob::io::HDF5File::contains, (arg("self"), arg("key")), "Returns True if the file contains an HDF5 dataset with a given path")
     .def("describe", &hdf5file_describe, (arg("self"), arg("key")), "If a given path to an HDF5 dataset exists inside the file, return a type description of objects recorded in such a dataset, otherwise, raises an exception. The returned value type is a tuple of tuples (HDF5Type, number-of-objects, expandible) describing the capabilities if the file is read using theses formats.")
@@ -678,6 +725,7 @@ void bind_io_hdf5() {
     .def("copy", &bob::io::HDF5File::copy, (arg("self"), arg("file")), "Copies all accessible content to another HDF5 file")
     .def("read", &hdf5file_read, (arg("self"), arg("key")), "Reads the whole dataset in a single shot. Returns a single object with all contents.")
     .def("lread", (object(*)(bob::io::HDF5File&, const std::string&, int64_t))0, hdf5file_lread_overloads((arg("self"), arg("key"), arg("pos")=-1), "Reads a given position from the dataset. Returns a single object if 'pos' >= 0, otherwise a list by reading all objects in sequence."))
+    .def("read_range", &hdf5file_read_range, (arg("self"), arg("key"), arg("pos"), arg("count")), "Reads 'count' consecutive objects of the dataset, starting at position 'pos', in a single shot. Returns a numpy.ndarray with one dimension more than the objects in the dataset, which indexes them.")
     .def("replace", &hdf5file_replace, (arg("self"), arg("path"), arg("pos"), arg("data")), "Modifies the value of a scalar/array inside a dataset in the file.\n\n" \
   "Keyword Parameters:\n\n" \
   "path\n" \
@@ -694,6 +742,16 @@ void bind_io_hdf5() {
   "  This is the data that will be set on the position indicated. It may be a simple python or numpy scalar (such as :py:class:`numpy.uint8`) or a :py:class:`numpy.ndarray` of any of the supported data types. You can also, optionally, set this to a list or tuple of scalars or arrays. This will cause this method to iterate over the elements and add each individually.\n\n" \
   "compresssion\n" \
   "  This parameter is effective when appending arrays. Set this to a number betwen 0 (default) and 9 (maximum) to compress the contents of this dataset. This setting is only effective if the dataset does not yet exist, otherwise, the previous setting is respected."))
+    .def("append_range", &hdf5file_append_range, hdf5file_append_range_overloads((arg("self"), arg("path"), arg("data"), arg("compression")=0, arg("chunk_size")=0), "Appends all objects in a numpy.ndarray to a dataset in a single shot. The first dimension of the array indexes the objects to append (use a 1D array for scalars). If the dataset does not yet exist, one is created with the type characteristics.\n\n" \
+  "Keyword Parameters:\n\n" \
+  "path\n" \
+  "  This is the path to the HDF5 dataset to append data to\n\n" \
+  "data\n" \
+  "  A :py:class:`numpy.ndarray` containing the objects to append along its first dimension\n\n" \
+  "compression\n" \
+  "  Set this to a number betwen 0 (default) and 9 (maximum) to compress the contents of this dataset. This setting is only effective if the dataset does not yet exist, otherwise, the previous setting is respected.\n\n" \
+  "chunk_size\n" \
+  "  The number of objects stored together in each chunk on the file. If 0 (default), the chunk size is chosen so that each chunk takes about 64 kilobytes. This setting is only effective if the dataset does not yet exist."))
     .def("set", &hdf5file_set, hdf5file_set_overloads((arg("self"), arg("path"), arg("data"), arg("compression")=0), "Sets the scalar or array at position 0 to the given value. This method is equivalent to checking if the scalar or array at position 0 exists and then replacing it. If the path does not exist, we append the new scalar or array.\n\n" \
   "Keyword Parameters:\n\n" \
   "path\n" \
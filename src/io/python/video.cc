@@ -164,6 +164,47 @@ static object videoreader_load(bob::io::VideoReader& reader,
 
 BOOST_PYTHON_FUNCTION_OVERLOADS(videoreader_load_overloads, videoreader_load, 1, 2)
 
+/**
+ * Python wrapper to read an arbitrary set of frames from a video sequence,
+ * seeking to the closest keyframe before each of them.
+ */
+static object videoreader_read(bob::io::VideoReader& reader, object frames,
+    bool raise_on_error=false) {
+  stl_input_iterator<Py_ssize_t> it(frames), end;
+  std::vector<size_t> indexes;
+  for (; it != end; ++it) {
+    Py_ssize_t sframe = *it;
+    size_t frame = sframe;
+    if (sframe < 0) frame = reader.numberOfFrames() + sframe;
+    if (frame >= reader.numberOfFrames()) { //basic check
+      PYTHON_ERROR(IndexError, "invalid index (" SIZE_T_FMT ") >= number of frames (" SIZE_T_FMT ")", frame, reader.numberOfFrames());
+    }
+    indexes.push_back(frame);
+  }
+
+  bob::core::array::typeinfo info(reader.video_type());
+  info.shape[0] = indexes.size();
+  info.update_strides();
+  bob::python::py_array tmp(info);
+  reader.read(indexes, tmp, raise_on_error);
+  return tmp.pyobject();
+}
+
+BOOST_PYTHON_FUNCTION_OVERLOADS(videoreader_read_overloads, videoreader_read, 2, 3)
+
+static void videoreader_index(bob::io::VideoReader& reader, bool cache=false) {
+  reader.index(cache);
+}
+
+BOOST_PYTHON_FUNCTION_OVERLOADS(videoreader_index_overloads, videoreader_index, 1, 2)
+
+static tuple videoreader_keyframes(const bob::io::VideoReader& reader) {
+  list retval;
+  const std::vector<size_t>& keyframes = reader.keyframes();
+  for (size_t k=0; k<keyframes.size(); ++k) retval.append(keyframes[k]);
+  return tuple(retval);
+}
+
 static void videowriter_append(bob::io::VideoWriter& writer, object a) {
   bob::python::convert_t result = bob::python::convertible_to(a, writer.frame_type(),
       false, true);
@@ -179,6 +220,12 @@ static void videowriter_append(bob::io::VideoWriter& writer, object a) {
   }
 }
 
+static void videowriter_append_native(bob::io::VideoWriter& writer, object a) {
+  bob::python::dtype dtype(writer.native_frame_type().dtype);
+  bob::python::py_array tmp(a, dtype.self());
+  writer.appendNative(tmp);
+}
+
 /**
  * Describes a given codec or returns an empty dictionary, in case the codec
  * cannot be accessed
@@ -426,7 +473,7 @@ void bind_io_video() {
   iterator_wrapper().wrap(); //wraps bob::io::VideoReader::const_iterator
 
   class_<bob::io::VideoReader, boost::shared_ptr<bob::io::VideoReader> >("VideoReader",
-      "VideoReader objects can read data from video files. The current implementation uses `FFmpeg <http://ffmpeg.org>`_ (or `libav <http://libav.org>`_ if FFmpeg is not available) which is a stable freely available video encoding and decoding library, designed specifically for these tasks. You can read an entire video in memory by using the 'load()' method or use video iterators to read it frame by frame and avoid overloading your machine's memory. The maximum precision data `FFmpeg` will yield is a 24-bit (8-bit per band) representation of each pixel (32-bit depths are also supported by `FFmpeg`, but not by Bob presently). So, the input of data using this class uses ``uint8`` as base element type. Output will be colored using the RGB standard, with each band varying between 0 and 255, with zero meaning pure black and 255, pure white (color).", init<const std::string&, optional<bool> >((arg("self"), arg("filename"), arg("check")=true), "Initializes a new VideoReader object by giving the input file path to read. Format and codec will be extracted from the video metadata, automatically, by ``FFmpeg``. By default, if the format and/or the codec are not supported by this version of Bob, an exception will be raised. You can (at your own risk) set the ``check`` to ``False`` to avoid this check."))
+      "VideoReader objects can read data from video files. The current implementation uses `FFmpeg <http://ffmpeg.org>`_ (or `libav <http://libav.org>`_ if FFmpeg is not available) which is a stable freely available video encoding and decoding library, designed specifically for these tasks. You can read an entire video in memory by using the 'load()' method or use video iterators to read it frame by frame and avoid overloading your machine's memory. The maximum precision data `FFmpeg` will yield is a 24-bit (8-bit per band) representation of each pixel (32-bit depths are also supported by `FFmpeg`, but not by Bob presently). So, the input of data using this class uses ``uint8`` as base element type. Output will be colored using the RGB standard, with each band varying between 0 and 255, with zero meaning pure black and 255, pure white (color). Optionally, frames can be read as grayscale images taken from the luminance of the video, which skips the color conversion altogether.", init<const std::string&, optional<bool, bool, size_t, size_t> >((arg("self"), arg("filename"), arg("check")=true, arg("gray")=false, arg("threads")=1, arg("prefetch")=0), "Initializes a new VideoReader object by giving the input file path to read. Format and codec will be extracted from the video metadata, automatically, by ``FFmpeg``. By default, if the format and/or the codec are not supported by this version of Bob, an exception will be raised. You can (at your own risk) set the ``check`` to ``False`` to avoid this check. If ``gray`` is set to ``True``, frames are read as 2D arrays (height, width) containing the luminance of the video. The decoder may use up to ``threads`` threads (``0`` means one per core). If ``prefetch`` is not ``0``, iterators decode up to that number of frames ahead on a background thread, while you process the current one."))
     .add_property("filename", make_function(&bob::io::VideoReader::filename, return_value_policy<copy_const_reference>()), "The full path to the file that will be decoded by this object")
     .add_property("height", &bob::io::VideoReader::height, "The height of each frame in the video (a multiple of 2)")
     .add_property("width", &bob::io::VideoReader::width, "The width of each frame in the video (a multiple of 2)")
@@ -441,7 +488,14 @@ void bind_io_video() {
     .add_property("info", make_function(&bob::io::VideoReader::info, return_value_policy<copy_const_reference>()), "Informative string containing many details of this video and available ffmpeg bindings that will read it")
     .add_property("video_type", make_function(&bob::io::VideoReader::video_type, return_value_policy<copy_const_reference>()), "Typing information to load all of the file at once")
     .add_property("frame_type", make_function(&bob::io::VideoReader::frame_type, return_value_policy<copy_const_reference>()), "Typing information to load the file frame by frame.")
-    .def("__load__", &videoreader_load, videoreader_load_overloads((arg("self"), arg("raise_on_error")=false), "Loads all of the video stream in a numpy ndarray organized in this way: (frames, color-bands, height, width). I'll dynamically allocate the output array and return it to you. The flag ``raise_on_error``, which is set to ``False`` by default influences the error reporting in case problems are found with the video file. If you set it to ``True``, we will report problems raising exceptions. If you either don't set it or set it to ``False``, we will truncate the file at the frame with problems and will not report anything. It is your task to verify if the number of frames returned matches the expected number of frames as reported by the property ``number_of_frames`` in this object."))
+    .add_property("gray", &bob::io::VideoReader::isGray, "Tells if frames are read as grayscale images")
+    .add_property("threads", &bob::io::VideoReader::decoderThreads, "The number of threads the decoder may use")
+    .add_property("prefetch", &bob::io::VideoReader::prefetchFrames, "The number of frames iterators decode ahead on a background thread")
+    .def("__load__", &videoreader_load, videoreader_load_overloads((arg("self"), arg("raise_on_error")=false), "Loads all of the video stream in a numpy ndarray organized in this way: (frames, color-bands, height, width), or (frames, height, width) for grayscale readers. I'll dynamically allocate the output array and return it to you. The flag ``raise_on_error``, which is set to ``False`` by default influences the error reporting in case problems are found with the video file. If you set it to ``True``, we will report problems raising exceptions. If you either don't set it or set it to ``False``, we will truncate the file at the frame with problems and will not report anything. It is your task to verify if the number of frames returned matches the expected number of frames as reported by the property ``number_of_frames`` in this object."))
+    .def("index", &videoreader_index, videoreader_index_overloads((arg("self"), arg("cache")=false), "Scans the video stream (without decoding it) and records the position of its keyframes, so frames can be reached by seeking instead of decoding all frames before them. Indexing happens automatically the first time you call ``read()``. If ``cache`` is set to ``True``, the index is loaded from (or saved to) a file named after the video with the extension ``.keyframes`` appended, which is ignored when the video changes."))
+    .add_property("indexed", &bob::io::VideoReader::isIndexed, "Tells if the keyframes of this video were indexed already")
+    .add_property("keyframes", &videoreader_keyframes, "A tuple with the numbers of the keyframes that can be seeked in this video, in display order (the order in which frames are read), empty if it was not indexed yet")
+    .def("read", &videoreader_read, videoreader_read_overloads((arg("self"), arg("frames"), arg("raise_on_error")=false), "Reads the given frames (an iterable of frame numbers, in any order and possibly repeated) into a numpy ndarray organized like the output of ``load()``, with the frames in the order you asked for them. Frames are read in increasing order, seeking to the closest keyframe when that is faster than decoding the frames in between. The flag ``raise_on_error`` has the same meaning as in ``load()``: if not set, frames after a decoding problem are left as they are."))
     .def("__iter__", &bob::io::VideoReader::begin, with_custodian_and_ward_postcall<0,1>())
     .def("__getitem__", &videoreader_getitem)
     .def("__getitem__", &videoreader_getslice)
@@ -449,7 +503,7 @@ void bind_io_video() {
 
   class_<bob::io::VideoWriter, boost::shared_ptr<bob::io::VideoWriter>, boost::noncopyable>("VideoWriter",
      "Use objects of this class to create and write video files using `FFmpeg <http://ffmpeg.org>`_ (or `libav <http://libav.org>`_ if FFmpeg is not available).",
-     init<const std::string&, size_t, size_t, optional<float, float, size_t, const std::string&, const std::string&, bool> >((arg("self"), arg("filename"), arg("height"), arg("width"), arg("framerate")=25., arg("bitrate")=1500000., arg("gop")=12, arg("codec")="", arg("format")="", arg("check")=true), "Creates a new output file given the input parameters. The format and codec to be used will be derived from the filename extension unless you define them explicetly (you can set both or just one of these two optional parameters)")
+     init<const std::string&, size_t, size_t, optional<float, float, size_t, const std::string&, const std::string&, bool, size_t, size_t> >((arg("self"), arg("filename"), arg("height"), arg("width"), arg("framerate")=25., arg("bitrate")=1500000., arg("gop")=12, arg("codec")="", arg("format")="", arg("check")=true, arg("threads")=1, arg("queue")=0), "Creates a new output file given the input parameters. The format and codec to be used will be derived from the filename extension unless you define them explicetly (you can set both or just one of these two optional parameters). The encoder may use up to ``threads`` threads (``0`` means one per core). If ``queue`` is not ``0``, frames are encoded asynchronously: ``append()`` copies each frame into a queue holding up to that number of frames and returns immediately, while a background thread encodes them. Encoding errors are then raised by the next call to ``append()`` or ``close()``.")
      )
     .add_property("filename", make_function(&bob::io::VideoReader::filename, return_value_policy<copy_const_reference>()), "The full path to the file that will be encoded by this object")
     .add_property("height", &bob::io::VideoWriter::height, "The height of the output video file (must be a multiple of 2)")
@@ -466,9 +520,14 @@ void bind_io_video() {
     .add_property("gop", &bob::io::VideoWriter::gop, "Group of pictures setting (see the `Wikipedia entry <http://en.wikipedia.org/wiki/Group_of_pictures>`_ for details on this setting)")
     .add_property("info", &bob::io::VideoWriter::info, "Informative string containing many details of this video and available ffmpeg bindings that will read it")
     .add_property("is_opened", &bob::io::VideoWriter::is_opened, "A boolean flag, indicating if the video is still opened for writing (or has already been closed by the user using ``close()``)")
-    .def("close", &bob::io::VideoWriter::close, (arg("self")), "Closes the current video stream and forces writing the trailer. After this point the video is finalized and cannot be written to anymore.")
+    .def("close", &bob::io::VideoWriter::close, (arg("self")), "Closes the current video stream and forces writing the trailer. After this point the video is finalized and cannot be written to anymore. In asynchronous mode, this waits for all queued frames to be encoded first.")
     .add_property("video_type", make_function(&bob::io::VideoWriter::video_type, return_value_policy<copy_const_reference>()), "Typing information to load all of the file at once")
     .add_property("frame_type", make_function(&bob::io::VideoWriter::frame_type, return_value_policy<copy_const_reference>()), "Typing information to load the file frame by frame.")
+    .add_property("threads", &bob::io::VideoWriter::encoderThreads, "The number of threads the encoder may use")
+    .add_property("queue", &bob::io::VideoWriter::queueSize, "The number of frames that may wait to be encoded by the background thread, or 0 if frames are encoded as they are appended")
+    .add_property("pixel_format", &bob::io::VideoWriter::pixelFormat, "The name of the pixel format of the encoder, in which frames given to ``append_native()`` must be")
+    .add_property("native_frame_type", make_function(&bob::io::VideoWriter::native_frame_type, return_value_policy<copy_const_reference>()), "Typing information of the frames given to ``append_native()``: a 1D ``uint8`` array holding the planes of a frame in the pixel format of the encoder, one after the other")
+    .def("append_native", &videowriter_append_native, (arg("self"), arg("frame")), "Writes a new frame that is already in the pixel format of the encoder (see ``pixel_format`` and ``native_frame_type``), skipping the color conversion ``append()`` has to do")
     .def("append", &videowriter_append, (arg("self"), arg("frame")), "Writes a new frame or set of frames to the file. The frame should be setup as a array with 3 dimensions organized in this way (RGB color-bands, height, width). Sets of frames should be setup as a 4D array in this way: (frame-number, RGB color-bands, height, width).\n\n.. note::\n\n  At present time we only support arrays that have C-style storages (if you pass reversed arrays or arrays with Fortran-style storage, the result is undefined).")
     ;
 
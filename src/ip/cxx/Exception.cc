@@ -118,3 +118,26 @@ const char* bob::ip::LBPUnsupportedNNeighbours::what() const throw() {
     return emergency;
   }
 }
+
+bob::ip::PositionOutOfImage::PositionOutOfImage(const int y, const int x,
+  const int height, const int width) throw():
+    m_y(y), m_x(x), m_height(height), m_width(width)
+{
+}
+
+bob::ip::PositionOutOfImage::~PositionOutOfImage() throw() {
+}
+
+const char* bob::ip::PositionOutOfImage::what() const throw() {
+  try {
+    boost::format message(
+      "The position (%d, %d) is out of the image boundaries %d x %d.");
+    message % m_y % m_x % m_height % m_width;
+    m_message = message.str();
+    return m_message.c_str();
+  } catch (...) {
+    static const char* emergency = "bob::ip::PositionOutOfImage: cannot \
+      format, exception raised";
+    return emergency;
+  }
+}
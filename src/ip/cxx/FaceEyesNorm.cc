@@ -99,3 +99,14 @@ bob::ip::FaceEyesNorm::operator!=(const bob::ip::FaceEyesNorm& b) const
 }
 
 
+
+bob::ip::GeomNorm
+bob::ip::FaceEyesNorm::computeGeomNorm(const double e1_y, const double e1_x,
+  const double e2_y, const double e2_x) const
+{
+  // Get angle to horizontal
+  const double angle = getAngleToHorizontal(e1_y, e1_x, e2_y, e2_x) - m_eyes_angle;
+  // Get scaling factor
+  const double scale = m_eyes_distance / sqrt( (e1_y-e2_y)*(e1_y-e2_y) + (e1_x-e2_x)*(e1_x-e2_x) );
+  return GeomNorm(angle, scale, m_crop_height, m_crop_width, m_crop_offset_h, m_crop_offset_w);
+}
@@ -22,10 +22,14 @@
 
 #include "bob/core/assert.h"
 #include "bob/core/array_copy.h"
+#include "bob/core/cast.h"
+#include "bob/core/parallel.h"
 #include "bob/ip/GaborWaveletTransform.h"
+#include "bob/ip/Exception.h"
 #include <numeric>
 #include <sstream>
 #include <fstream>
+#include <boost/bind.hpp>
 
 static inline double sqr(double x){return x*x;}
 
@@ -223,8 +227,12 @@ bob::ip::GaborWaveletTransform::GaborWaveletTransform(
   m_dc_free(dc_free),
   m_fft(0,0),
   m_ifft(0,0),
+  m_rfft(0,0),
+  m_spatial_resolution(0,0),
+  m_spatial_epsilon(0.),
   m_number_of_scales(number_of_scales),
-  m_number_of_directions(number_of_directions)
+  m_number_of_directions(number_of_directions),
+  m_number_of_threads(1)
 {
   computeKernelFrequencies();
 }
@@ -240,8 +248,12 @@ bob::ip::GaborWaveletTransform::GaborWaveletTransform(
   m_dc_free(other.m_dc_free),
   m_fft(0,0),
   m_ifft(0,0),
+  m_rfft(0,0),
+  m_spatial_resolution(0,0),
+  m_spatial_epsilon(0.),
   m_number_of_scales(other.m_number_of_scales),
-  m_number_of_directions(other.m_number_of_directions)
+  m_number_of_directions(other.m_number_of_directions),
+  m_number_of_threads(other.m_number_of_threads)
 {
   computeKernelFrequencies();
 }
@@ -259,8 +271,12 @@ bob::ip::GaborWaveletTransform::operator =
   m_dc_free = other.m_dc_free;
   m_fft = bob::sp::FFT2D(0,0);
   m_ifft = bob::sp::IFFT2D(0,0);
+  m_rfft = bob::sp::RealFFT2D(0,0);
+  m_spatial_kernels.clear();
+  m_spatial_resolution = 0;
   m_number_of_scales = other.m_number_of_scales;
   m_number_of_directions = other.m_number_of_directions;
+  m_number_of_threads = other.m_number_of_threads;
 
   computeKernelFrequencies();
   
@@ -353,6 +369,7 @@ void bob::ip::GaborWaveletTransform::generateKernels(
 
     // reset fft sizes
     m_fft.reset(resolution[0], resolution[1]);
+    m_rfft.reset(resolution[0], resolution[1]);
     m_ifft.reset(resolution[0], resolution[1]);
     m_temp_array.resize(blitz::shape(resolution[0],resolution[1]));
     m_frequency_image.resize(m_temp_array.shape());
@@ -374,32 +391,252 @@ blitz::Array<double,3> bob::ip::GaborWaveletTransform::kernelImages() const{
 }
 
 /**
- * Computes the Gabor wavelet transformation for the given image (in spatial domain)
- * @param gray_image  The source image in spatial domain
- * @param trafo_image The convolution result, in spatial domain
+ * Private function that makes sure that each thread has its own temporary array in the current resolution.
+ * @return The number of threads to be used
  */
-void bob::ip::GaborWaveletTransform::performGWT(
-  const blitz::Array<std::complex<double>,2>& gray_image,
+unsigned bob::ip::GaborWaveletTransform::prepareThreads(){
+  unsigned number_of_threads = bob::core::number_of_threads(m_number_of_threads);
+  if (m_thread_arrays.size() != number_of_threads || !bob::core::array::hasSameShape(m_thread_arrays[0], m_frequency_image)){
+    m_thread_arrays.resize(number_of_threads);
+    for (unsigned t = 0; t < number_of_threads; ++t)
+      m_thread_arrays[t].resize(m_frequency_image.shape());
+  }
+  return number_of_threads;
+}
+
+/**
+ * Private function that applies the Gabor kernels with indices [begin, end) to the frequency image
+ * and writes the inverse Fourier transformed results directly into the according layers of the trafo image.
+ */
+void bob::ip::GaborWaveletTransform::transformLayers(
+  size_t thread,
+  size_t begin,
+  size_t end,
   blitz::Array<std::complex<double>,3>& trafo_image
 )
 {
+  blitz::Array<std::complex<double>,2>& temp_array = m_thread_arrays[thread];
+  for (size_t j = begin; j < end; ++j){
+    // get a reference to the current layer of the trafo image
+    m_gabor_kernels[j].transform(m_frequency_image, temp_array);
+    // perform ifft on the trafo image layer, which is wrapped from its data
+    // (slicing the shared trafo image is not thread-safe)
+    blitz::Array<std::complex<double>,2> layer(
+      trafo_image.data() + j * trafo_image.stride(0),
+      blitz::shape(trafo_image.extent(1), trafo_image.extent(2)),
+      blitz::shape(trafo_image.stride(1), trafo_image.stride(2)),
+      blitz::neverDeleteData);
+    m_ifft(temp_array, layer);
+  } // for j
+}
+
+/**
+ * Private function that applies the Gabor kernels with indices [begin, end) to the frequency image
+ * and writes the absolute values and the phases of the results into the jet image.
+ */
+void bob::ip::GaborWaveletTransform::transformJets(
+  size_t thread,
+  size_t begin,
+  size_t end,
+  blitz::Array<double,4>& jet_image
+)
+{
+  blitz::Array<std::complex<double>,2>& temp_array = m_thread_arrays[thread];
+  for (size_t j = begin; j < end; ++j){
+    // get a reference to the current layer of the trafo image
+    m_gabor_kernels[j].transform(m_frequency_image, temp_array);
+    // perform ifft of transformed image
+    m_ifft(temp_array);
+    // convert into absolute and phase part, wrapped from the jet image data
+    // (slicing the shared jet image is not thread-safe)
+    blitz::Array<double,2> abs_part(
+      jet_image.data() + j * jet_image.stride(3),
+      blitz::shape(jet_image.extent(0), jet_image.extent(1)),
+      blitz::shape(jet_image.stride(0), jet_image.stride(1)),
+      blitz::neverDeleteData);
+    abs_part = blitz::abs(temp_array);
+    blitz::Array<double,2> phase_part(
+      jet_image.data() + jet_image.stride(2) + j * jet_image.stride(3),
+      blitz::shape(jet_image.extent(0), jet_image.extent(1)),
+      blitz::shape(jet_image.stride(0), jet_image.stride(1)),
+      blitz::neverDeleteData);
+    phase_part = blitz::arg(temp_array);
+  } // for j
+}
+
+/**
+ * Private function that applies the Gabor kernels with indices [begin, end) to the frequency image
+ * and writes the absolute values of the results into the jet image.
+ */
+void bob::ip::GaborWaveletTransform::transformAbsJets(
+  size_t thread,
+  size_t begin,
+  size_t end,
+  blitz::Array<double,3>& jet_image
+)
+{
+  blitz::Array<std::complex<double>,2>& temp_array = m_thread_arrays[thread];
+  for (size_t j = begin; j < end; ++j){
+    // get a reference to the current layer of the trafo image
+    m_gabor_kernels[j].transform(m_frequency_image, temp_array);
+    // perform ifft of transformed image
+    m_ifft(temp_array);
+    // convert into absolute part, wrapped from the jet image data
+    // (slicing the shared jet image is not thread-safe)
+    blitz::Array<double,2> abs_part(
+      jet_image.data() + j * jet_image.stride(2),
+      blitz::shape(jet_image.extent(0), jet_image.extent(1)),
+      blitz::shape(jet_image.stride(0), jet_image.stride(1)),
+      blitz::neverDeleteData);
+    abs_part = blitz::abs(temp_array);
+  } // for j
+}
+
+/**
+ * Normalizes the Gabor jets in the rows [begin, end) of the given jet image.
+ * The jets are wrapped from the jet image data, since slicing the shared jet
+ * image is not thread-safe.
+ */
+static void normalizeJetRows(size_t, size_t begin, size_t end, blitz::Array<double,4>& jet_image){
+  for (int y = begin; y < (int)end; ++y){
+    for (int x = jet_image.extent(1); x--;){
+      // normalize jet
+      blitz::Array<double,2> jet(
+        jet_image.data() + y * jet_image.stride(0) + x * jet_image.stride(1),
+        blitz::shape(jet_image.extent(2), jet_image.extent(3)),
+        blitz::shape(jet_image.stride(2), jet_image.stride(3)),
+        blitz::neverDeleteData);
+      bob::ip::normalizeGaborJet(jet);
+    }
+  }
+}
+
+static void normalizeAbsJetRows(size_t, size_t begin, size_t end, blitz::Array<double,3>& jet_image){
+  for (int y = begin; y < (int)end; ++y){
+    for (int x = jet_image.extent(1); x--;){
+      // normalize jet
+      blitz::Array<double,1> jet(
+        jet_image.data() + y * jet_image.stride(0) + x * jet_image.stride(1),
+        blitz::shape(jet_image.extent(2)),
+        blitz::shape(jet_image.stride(2)),
+        blitz::neverDeleteData);
+      bob::ip::normalizeGaborJet(jet);
+    }
+  }
+}
+
+/**
+ * Private function that computes the Fourier transform of the given complex image.
+ */
+void bob::ip::GaborWaveletTransform::computeFrequencyImage(const blitz::Array<std::complex<double>,2>& gray_image){
   // first, check if we need to reset the kernels
   generateKernels(blitz::TinyVector<unsigned,2>(gray_image.extent(0),gray_image.extent(1)));
 
   // perform Fourier transformation to image
-  m_fft(gray_image, m_frequency_image);
+  if (bob::core::array::isCZeroBaseContiguous(gray_image))
+    m_fft(gray_image, m_frequency_image);
+  else
+    m_fft(bob::core::array::ccopy(gray_image), m_frequency_image);
+}
+
+/**
+ * Private function that computes the Fourier transform of the given real image.
+ * The real-to-complex Fourier transform is about twice as fast as the complex one.
+ */
+void bob::ip::GaborWaveletTransform::computeFrequencyImage(const blitz::Array<double,2>& gray_image){
+  // first, check if we need to reset the kernels
+  generateKernels(blitz::TinyVector<unsigned,2>(gray_image.extent(0),gray_image.extent(1)));
+
+  // perform Fourier transformation to image
+  if (bob::core::array::isCZeroBaseContiguous(gray_image))
+    m_rfft(gray_image, m_frequency_image);
+  else
+    m_rfft(bob::core::array::ccopy(gray_image), m_frequency_image);
+}
 
+/**
+ * Private function that computes the Gabor wavelet transform from the current frequency image.
+ */
+void bob::ip::GaborWaveletTransform::transformFrequencyImage(
+  blitz::Array<std::complex<double>,3>& trafo_image
+)
+{
   // check that the shape is correct
-  bob::core::array::assertSameShape(trafo_image, blitz::shape(m_kernel_frequencies.size(),gray_image.extent(0),gray_image.extent(1)));
+  bob::core::array::assertSameShape(trafo_image, blitz::shape(m_kernel_frequencies.size(),m_frequency_image.extent(0),m_frequency_image.extent(1)));
 
-  // now, let each kernel compute the transformation result
-  for (unsigned j = 0; j < m_gabor_kernels.size(); ++j){
-    // get a reference to the current layer of the trafo image
-    m_gabor_kernels[j].transform(m_frequency_image, m_temp_array);
-    // perform ifft on the trafo image layer
-    blitz::Array<std::complex<double>,2> layer(trafo_image(j, blitz::Range::all(), blitz::Range::all()));
-    m_ifft(m_temp_array, layer);
-  } // for j
+  // now, let each kernel compute the transformation result, distributed over the threads
+  unsigned number_of_threads = prepareThreads();
+  bob::core::parallel_for(m_gabor_kernels.size(), boost::bind(&bob::ip::GaborWaveletTransform::transformLayers, this, _1, _2, _3, boost::ref(trafo_image)), number_of_threads);
+}
+
+/**
+ * Private function that computes the Gabor jet image from the current frequency image.
+ */
+void bob::ip::GaborWaveletTransform::transformFrequencyImage(
+  blitz::Array<double,4>& jet_image,
+  bool do_normalize
+)
+{
+  // check that the shape is correct
+  bob::core::array::assertSameShape(jet_image, blitz::shape(m_frequency_image.extent(0), m_frequency_image.extent(1), 2, m_kernel_frequencies.size()));
+
+  // now, let each kernel compute the transformation result, distributed over the threads
+  unsigned number_of_threads = prepareThreads();
+  bob::core::parallel_for(m_gabor_kernels.size(), boost::bind(&bob::ip::GaborWaveletTransform::transformJets, this, _1, _2, _3, boost::ref(jet_image)), number_of_threads);
+
+  if (do_normalize){
+    // normalize the jets, distributing the rows over the threads
+    bob::core::parallel_for(jet_image.extent(0), boost::bind(&normalizeJetRows, _1, _2, _3, boost::ref(jet_image)), number_of_threads);
+  }
+}
+
+/**
+ * Private function that computes the Gabor jet image (absolute values only) from the current frequency image.
+ */
+void bob::ip::GaborWaveletTransform::transformFrequencyImage(
+  blitz::Array<double,3>& jet_image,
+  bool do_normalize
+)
+{
+  // check that the shape is correct
+  bob::core::array::assertSameShape(jet_image, blitz::shape(m_frequency_image.extent(0), m_frequency_image.extent(1), m_kernel_frequencies.size()));
+
+  // now, let each kernel compute the transformation result, distributed over the threads
+  unsigned number_of_threads = prepareThreads();
+  bob::core::parallel_for(m_gabor_kernels.size(), boost::bind(&bob::ip::GaborWaveletTransform::transformAbsJets, this, _1, _2, _3, boost::ref(jet_image)), number_of_threads);
+
+  if (do_normalize){
+    // normalize the jets, distributing the rows over the threads
+    bob::core::parallel_for(jet_image.extent(0), boost::bind(&normalizeAbsJetRows, _1, _2, _3, boost::ref(jet_image)), number_of_threads);
+  }
+}
+
+/**
+ * Computes the Gabor wavelet transformation for the given image (in spatial domain)
+ * @param gray_image  The source image in spatial domain
+ * @param trafo_image The convolution result, in spatial domain
+ */
+void bob::ip::GaborWaveletTransform::performGWT(
+  const blitz::Array<std::complex<double>,2>& gray_image,
+  blitz::Array<std::complex<double>,3>& trafo_image
+)
+{
+  computeFrequencyImage(gray_image);
+  transformFrequencyImage(trafo_image);
+}
+
+/**
+ * Computes the Gabor wavelet transformation for the given real-valued image (in spatial domain)
+ * @param gray_image  The source image in spatial domain
+ * @param trafo_image The convolution result, in spatial domain
+ */
+void bob::ip::GaborWaveletTransform::performGWT(
+  const blitz::Array<double,2>& gray_image,
+  blitz::Array<std::complex<double>,3>& trafo_image
+)
+{
+  computeFrequencyImage(gray_image);
+  transformFrequencyImage(trafo_image);
 }
 
 /**
@@ -414,81 +651,242 @@ void bob::ip::GaborWaveletTransform::computeJetImage(
   bool do_normalize
 )
 {
-  // first, check if we need to reset the kernels
-  generateKernels(blitz::TinyVector<unsigned,2>(gray_image.extent(0),gray_image.extent(1)));
+  computeFrequencyImage(gray_image);
+  transformFrequencyImage(jet_image, do_normalize);
+}
 
-  // perform Fourier transformation to image
-  m_fft(gray_image, m_frequency_image);
+/**
+ * Computes the Gabor jets including absolute values and phases for the given real-valued image (in spatial domain).
+ * @param gray_image  The source image in spatial domain
+ * @param jet_image   The resulting Gabor jet image, including absolute values and phases for each pixel
+ * @param do_normalize Shall the Gabor jets be normalized?
+ */
+void bob::ip::GaborWaveletTransform::computeJetImage(
+  const blitz::Array<double,2>& gray_image,
+  blitz::Array<double,4>& jet_image,
+  bool do_normalize
+)
+{
+  computeFrequencyImage(gray_image);
+  transformFrequencyImage(jet_image, do_normalize);
+}
 
-  // check that the shape is correct
-  bob::core::array::assertSameShape(jet_image, blitz::shape(gray_image.extent(0), gray_image.extent(1), 2, m_kernel_frequencies.size()));
+/**
+ * Computes the Gabor jets including absolute values only for the given image (in spatial domain).
+ * @param gray_image  The source image in spatial domain
+ * @param jet_image   The resulting Gabor jet image, including only absolute values for each pixel
+ * @param do_normalize Shall the Gabor jets be normalized?
+ */
+void bob::ip::GaborWaveletTransform::computeJetImage(
+  const blitz::Array<std::complex<double>,2>& gray_image,
+  blitz::Array<double,3>& jet_image,
+  bool do_normalize
+)
+{
+  computeFrequencyImage(gray_image);
+  transformFrequencyImage(jet_image, do_normalize);
+}
 
-  // now, let each kernel compute the transformation result
-  for (int j = 0; j < (int)m_gabor_kernels.size(); ++j){
-    // get a reference to the current layer of the trafo image
-    m_gabor_kernels[j].transform(m_frequency_image, m_temp_array);
-    // perform ifft of transformed image
+/**
+ * Computes the Gabor jets including absolute values only for the given real-valued image (in spatial domain).
+ * @param gray_image  The source image in spatial domain
+ * @param jet_image   The resulting Gabor jet image, including only absolute values for each pixel
+ * @param do_normalize Shall the Gabor jets be normalized?
+ */
+void bob::ip::GaborWaveletTransform::computeJetImage(
+  const blitz::Array<double,2>& gray_image,
+  blitz::Array<double,3>& jet_image,
+  bool do_normalize
+)
+{
+  computeFrequencyImage(gray_image);
+  transformFrequencyImage(jet_image, do_normalize);
+}
+
+/**
+ * Generates the Gabor wavelets in spatial domain for the given image resolution.
+ * The wavelets are obtained as the inverse Fourier transform of the frequency domain wavelets,
+ * so that the spatial convolution is identical to the (cyclic) convolution performed by performGWT.
+ * Each wavelet is truncated to the smallest centered rectangle that contains all values above
+ * epsilon times the maximum absolute value of the wavelet.
+ * This function dose not need to be called explicitly to be able to compute graph jets.
+ * @param resolution  The resolution of the image to generate the kernels for
+ * @param epsilon     The relative threshold below which wavelet values are considered as zero
+ */
+void bob::ip::GaborWaveletTransform::generateSpatialKernels(
+  blitz::TinyVector<unsigned,2> resolution,
+  double epsilon
+)
+{
+  if (resolution[0] == m_spatial_resolution[0] && resolution[1] == m_spatial_resolution[1] &&
+      epsilon == m_spatial_epsilon && m_spatial_kernels.size() == m_kernel_frequencies.size())
+    // nothing to do
+    return;
+
+  // we need the frequency domain kernels first
+  generateKernels(resolution);
+
+  const int height = resolution[0], width = resolution[1];
+  // the largest offsets that do not wrap around the image
+  const int max_dy = (height - 1) / 2, max_dx = (width - 1) / 2;
+
+  m_spatial_kernels.clear();
+  m_spatial_kernels.reserve(m_gabor_kernels.size());
+  for (unsigned j = 0; j < m_gabor_kernels.size(); ++j){
+    // transform the frequency domain kernel into spatial domain
+    m_temp_array = bob::core::array::cast<std::complex<double> >(m_gabor_kernels[j].kernelImage());
     m_ifft(m_temp_array);
-    // convert into absolute and phase part
-    blitz::Array<double,2> abs_part(jet_image(blitz::Range::all(), blitz::Range::all(), 0, j));
-    abs_part = blitz::abs(m_temp_array);
-    blitz::Array<double,2> phase_part(jet_image(blitz::Range::all(), blitz::Range::all(), 1, j));
-    phase_part = blitz::arg(m_temp_array);
-  } // for j
 
-  if (do_normalize){
-    // iterate the positions
-    for (int y = jet_image.extent(0); y--;){
-      for (int x = jet_image.extent(1); x--;){
-        // normalize jet
-        blitz::Array<double,2> jet(jet_image(y,x,blitz::Range::all(),blitz::Range::all()));
-        bob::ip::normalizeGaborJet(jet);
+    // compute the support of the kernel
+    double threshold = epsilon * blitz::max(blitz::abs(m_temp_array));
+    int radius_y = 0, radius_x = 0;
+    for (int y = 0; y < height; ++y){
+      // relative offset of the current row
+      int dy = y <= max_dy ? y : y - height;
+      for (int x = 0; x < width; ++x){
+        if (std::abs(m_temp_array(y,x)) > threshold){
+          int dx = x <= max_dx ? x : x - width;
+          radius_y = std::max(radius_y, std::abs(dy));
+          radius_x = std::max(radius_x, std::abs(dx));
+        }
+      }
+    }
+    radius_y = std::min(radius_y, max_dy);
+    radius_x = std::min(radius_x, max_dx);
+
+    // copy the kernel values into a centered array
+    blitz::Array<std::complex<double>,2> kernel(2 * radius_y + 1, 2 * radius_x + 1);
+    for (int dy = -radius_y; dy <= radius_y; ++dy){
+      for (int dx = -radius_x; dx <= radius_x; ++dx){
+        kernel(dy + radius_y, dx + radius_x) = m_temp_array((dy + height) % height, (dx + width) % width);
       }
     }
+    m_spatial_kernels.push_back(kernel);
   }
+
+  m_spatial_responses.resize(m_spatial_kernels.size());
+  m_spatial_resolution = resolution;
+  m_spatial_epsilon = epsilon;
 }
 
 /**
- * Computes the Gabor jets including absolute values only for the given image (in spatial domain).
+ * Private function that computes the responses of all spatial domain Gabor wavelets
+ * at the given position and stores them in m_spatial_responses.
+ * Image borders are handled cyclically, as it is done by the Fourier transform.
  * @param gray_image  The source image in spatial domain
- * @param jet_image   The resulting Gabor jet image, including only absolute values for each pixel
+ * @param y  The vertical position
+ * @param x  The horizontal position
+ */
+void bob::ip::GaborWaveletTransform::computeSpatialResponses(
+  const blitz::Array<std::complex<double>,2>& gray_image,
+  int y,
+  int x
+)
+{
+  const int height = gray_image.extent(0), width = gray_image.extent(1);
+  for (unsigned j = 0; j < m_spatial_kernels.size(); ++j){
+    const blitz::Array<std::complex<double>,2>& kernel = m_spatial_kernels[j];
+    const int radius_y = kernel.extent(0) / 2, radius_x = kernel.extent(1) / 2;
+    const bool inside = x - radius_x >= 0 && x + radius_x < width;
+
+    std::complex<double> response(0.);
+    for (int ky = 0; ky < kernel.extent(0); ++ky){
+      // image row that is hit by the current kernel row (the kernel is mirrored in the convolution)
+      int iy = y + radius_y - ky;
+      if (iy < 0) iy += height; else if (iy >= height) iy -= height;
+      if (inside){
+        // no cyclic border handling required in horizontal direction
+        for (int kx = 0, ix = x + radius_x; kx < kernel.extent(1); ++kx, --ix)
+          response += kernel(ky,kx) * gray_image(iy,ix);
+      } else {
+        for (int kx = 0; kx < kernel.extent(1); ++kx){
+          int ix = ((x + radius_x - kx) % width + width) % width;
+          response += kernel(ky,kx) * gray_image(iy,ix);
+        }
+      }
+    }
+    m_spatial_responses(j) = response;
+  }
+}
+
+/**
+ * Private function that checks that all (y,x) positions lie inside an image of the given size.
+ * @throws bob::ip::PositionOutOfImage for the first position outside of the image
+ */
+static void checkPositions(const blitz::Array<int,2>& positions, int height, int width){
+  for (int i = 0; i < positions.extent(0); ++i){
+    if (positions(i,0) < 0 || positions(i,0) >= height ||
+        positions(i,1) < 0 || positions(i,1) >= width)
+      throw bob::ip::PositionOutOfImage(positions(i,0), positions(i,1), height, width);
+  }
+}
+
+/**
+ * Computes the Gabor jets including absolute values and phases at the given positions only.
+ * Instead of transforming the whole image, the truncated spatial domain Gabor wavelets are
+ * applied at the given positions, which is much faster when only few positions are required.
+ * @param gray_image  The source image in spatial domain
+ * @param positions   The (y,x) positions to compute the Gabor jets for, one position per row
+ * @param graph_jets  The resulting Gabor jets, including absolute values and phases for each position
  * @param do_normalize Shall the Gabor jets be normalized?
  */
-void bob::ip::GaborWaveletTransform::computeJetImage(
+void bob::ip::GaborWaveletTransform::computeGraphJets(
   const blitz::Array<std::complex<double>,2>& gray_image,
-  blitz::Array<double,3>& jet_image,
+  const blitz::Array<int,2>& positions,
+  blitz::Array<double,3>& graph_jets,
   bool do_normalize
 )
 {
   // first, check if we need to reset the kernels
-  generateKernels(blitz::TinyVector<int,2>(gray_image.extent(0),gray_image.extent(1)));
+  generateSpatialKernels(blitz::TinyVector<unsigned,2>(gray_image.extent(0),gray_image.extent(1)), m_spatial_epsilon > 0. ? m_spatial_epsilon : 1e-6);
 
-  // perform Fourier transformation to image
-  m_fft(gray_image, m_frequency_image);
+  // check that the shape is correct
+  bob::core::array::assertSameDimensionLength(positions.extent(1), 2);
+  checkPositions(positions, gray_image.extent(0), gray_image.extent(1));
+  bob::core::array::assertSameShape(graph_jets, blitz::shape(positions.extent(0), 2, m_kernel_frequencies.size()));
+
+  for (int i = 0; i < positions.extent(0); ++i){
+    computeSpatialResponses(gray_image, positions(i,0), positions(i,1));
+    // convert into absolute and phase part
+    blitz::Array<double,2> jet(graph_jets(i, blitz::Range::all(), blitz::Range::all()));
+    jet(0, blitz::Range::all()) = blitz::abs(m_spatial_responses);
+    jet(1, blitz::Range::all()) = blitz::arg(m_spatial_responses);
+    if (do_normalize)
+      bob::ip::normalizeGaborJet(jet);
+  }
+}
+
+/**
+ * Computes the Gabor jets including absolute values only at the given positions.
+ * Instead of transforming the whole image, the truncated spatial domain Gabor wavelets are
+ * applied at the given positions, which is much faster when only few positions are required.
+ * @param gray_image  The source image in spatial domain
+ * @param positions   The (y,x) positions to compute the Gabor jets for, one position per row
+ * @param graph_jets  The resulting Gabor jets, including only absolute values for each position
+ * @param do_normalize Shall the Gabor jets be normalized?
+ */
+void bob::ip::GaborWaveletTransform::computeGraphJets(
+  const blitz::Array<std::complex<double>,2>& gray_image,
+  const blitz::Array<int,2>& positions,
+  blitz::Array<double,2>& graph_jets,
+  bool do_normalize
+)
+{
+  // first, check if we need to reset the kernels
+  generateSpatialKernels(blitz::TinyVector<unsigned,2>(gray_image.extent(0),gray_image.extent(1)), m_spatial_epsilon > 0. ? m_spatial_epsilon : 1e-6);
 
   // check that the shape is correct
-  bob::core::array::assertSameShape(jet_image, blitz::shape(gray_image.extent(0), gray_image.extent(1), m_kernel_frequencies.size()));
+  bob::core::array::assertSameDimensionLength(positions.extent(1), 2);
+  checkPositions(positions, gray_image.extent(0), gray_image.extent(1));
+  bob::core::array::assertSameShape(graph_jets, blitz::shape(positions.extent(0), m_kernel_frequencies.size()));
 
-  // now, let each kernel compute the transformation result
-  for (int j = 0; j < (int)m_gabor_kernels.size(); ++j){
-    // get a reference to the current layer of the trafo image
-    m_gabor_kernels[j].transform(m_frequency_image, m_temp_array);
-    // perform ifft of transformed image
-    m_ifft(m_temp_array);
+  for (int i = 0; i < positions.extent(0); ++i){
+    computeSpatialResponses(gray_image, positions(i,0), positions(i,1));
     // convert into absolute part
-    blitz::Array<double,2> abs_part(jet_image(blitz::Range::all(), blitz::Range::all(), j));
-    abs_part = blitz::abs(m_temp_array);
-  } // for j
-
-  if (do_normalize){
-    // iterate the positions
-    for (int y = jet_image.extent(0); y--;){
-      for (int x = jet_image.extent(1); x--;){
-        // normalize jet
-        blitz::Array<double,1> jet(jet_image(y,x,blitz::Range::all()));
-        bob::ip::normalizeGaborJet(jet);
-      }
-    }
+    blitz::Array<double,1> jet(graph_jets(i, blitz::Range::all()));
+    jet = blitz::abs(m_spatial_responses);
+    if (do_normalize)
+      bob::ip::normalizeGaborJet(jet);
   }
 }
 
@@ -512,6 +910,9 @@ void bob::ip::GaborWaveletTransform::load(bob::io::HDF5File& file){
   m_number_of_directions = file.read<unsigned>("NumberOfDirections");
 
   computeKernelFrequencies();
+  // make sure that the kernels are regenerated with the new parameters
+  m_fft.reset(0,0);
+  m_spatial_kernels.clear();
 }
 
 /**
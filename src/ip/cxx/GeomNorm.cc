@@ -63,7 +63,7 @@ bob::ip::GeomNorm::operator==(const bob::ip::GeomNorm& b) const
 {
   return (this->m_rotation_angle == b.m_rotation_angle && this->m_scaling_factor == b.m_scaling_factor && 
           this->m_crop_height == b.m_crop_height && this->m_crop_width == b.m_crop_width && 
-          this->m_crop_offset_h == b.m_crop_offset_w);
+          this->m_crop_offset_h == b.m_crop_offset_h && this->m_crop_offset_w == b.m_crop_offset_w);
 }
 
 bool 
@@ -21,6 +21,9 @@
 #include "bob/ip/HOG.h"
 #include "bob/ip/Exception.h"
 #include "bob/core/assert.h"
+#include "bob/core/parallel.h"
+#include <algorithm>
+#include <vector>
 
 void bob::ip::hogComputeHistogram(const blitz::Array<double,2>& mag, 
   const blitz::Array<double,2>& ori, blitz::Array<double,1>& hist, 
@@ -37,7 +40,7 @@ void bob::ip::hogComputeHistogram_(const blitz::Array<double,2>& mag,
   const blitz::Array<double,2>& ori, blitz::Array<double,1>& hist, 
   const bool init_hist, const bool full_orientation)
 {
-  static const double range_orientation = (full_orientation? 2*M_PI : M_PI);
+  const double range_orientation = (full_orientation? 2*M_PI : M_PI);
   const int nb_bins = hist.extent(0);
 
   // Initializes output to zero if required
@@ -47,22 +50,10 @@ void bob::ip::hogComputeHistogram_(const blitz::Array<double,2>& mag,
     for(int j=0; j<mag.extent(1); ++j)
     {
       double energy = mag(i,j);
-      double orientation = ori(i,j);
-
-      // Computes "real" value of the closest bin
-      double bin = orientation / range_orientation * nb_bins;
-      // Computes the value of the "inferior" bin 
-      // ("superior" bin corresponds to the one after the inferior bin)
-      int bin_index1 = floor(bin);
-      // Computes the weight for the "inferior" bin
-      double weight = 1.-(bin-bin_index1);
-
-      // Computes integer indices in the range [0,nb_bins-1]
-      bin_index1 = bin_index1 % nb_bins;
-      // Additional check, because bin can be negative (hence bin_index1 as well, as an integer remainder)
-      if(bin_index1<0) bin_index1+=nb_bins; 
-      // bin_index1 and nb_bins are positive. Thus, bin_index2 (integer remainder) as well!
-      int bin_index2 = (bin_index1+1) % nb_bins; 
+      int bin_index1, bin_index2;
+      double weight;
+      bob::ip::detail::hogBins(ori(i,j), nb_bins, range_orientation, 
+        bin_index1, bin_index2, weight);
 
       // Updates the histogram (bilinearly)
       hist(bin_index1) += weight * energy;
@@ -70,3 +61,153 @@ void bob::ip::hogComputeHistogram_(const blitz::Array<double,2>& mag,
     }
 }
 
+const blitz::TinyVector<int,3> bob::ip::DenseHOG::getOutputShape() const
+{
+  return blitz::TinyVector<int,3>(m_nb_blocks_y, m_nb_blocks_x, 
+    m_block_y * m_block_x * m_cell_dim);
+}
+
+const blitz::TinyVector<int,3> 
+bob::ip::DenseHOG::getGridShape(const size_t step_y, const size_t step_x) const
+{
+  if (!step_y || !step_x)
+    throw bob::core::InvalidArgumentException("The window steps must be positive");
+  if (getImageHeight() < m_height || getImageWidth() < m_width)
+    throw bob::core::InvalidArgumentException("No image has been set");
+  const blitz::TinyVector<int,3> shape = getOutputShape();
+  return blitz::TinyVector<int,3>(
+    (getImageHeight() - m_height) / step_y + 1,
+    (getImageWidth() - m_width) / step_x + 1,
+    shape(0) * shape(1) * shape(2));
+}
+
+void bob::ip::DenseHOG::computeIntegral()
+{
+  const int height = m_magnitude.extent(0);
+  const int width = m_magnitude.extent(1);
+  const int nb_bins = m_cell_dim;
+  const double range_orientation = (m_full_orientation? 2*M_PI : M_PI);
+
+  m_integral.resize(height + 1, width + 1, nb_bins);
+  m_integral(0, blitz::Range::all(), blitz::Range::all()) = 0.;
+
+  // The integral histograms are accumulated row by row, using the histogram
+  // of the current row up to the current pixel
+  std::vector<double> row(nb_bins);
+  for(int y=0; y<height; ++y)
+  {
+    std::fill(row.begin(), row.end(), 0.);
+    const double* above = &m_integral(y, 0, 0);
+    double* current = &m_integral(y+1, 0, 0);
+    std::fill(current, current + nb_bins, 0.);
+    for(int x=0; x<width; ++x)
+    {
+      double energy = m_magnitude(y,x);
+      int bin_index1, bin_index2;
+      double weight;
+      bob::ip::detail::hogBins(m_orientation(y,x), nb_bins, range_orientation,
+        bin_index1, bin_index2, weight);
+      row[bin_index1] += weight * energy;
+      row[bin_index2] += (1. - weight) * energy;
+
+      above += nb_bins;
+      current += nb_bins;
+      for(int b=0; b<nb_bins; ++b)
+        current[b] = above[b] + row[b];
+    }
+  }
+}
+
+void bob::ip::DenseHOG::histogram(const int y, const int x, const int height,
+  const int width, blitz::Array<double,1>& hist) const
+{
+  if (y < 0 || height < 0 || y + height > m_integral.extent(0) - 1)
+    throw bob::core::InvalidArgumentException("y", y, 0, m_integral.extent(0) - 1 - height);
+  if (x < 0 || width < 0 || x + width > m_integral.extent(1) - 1)
+    throw bob::core::InvalidArgumentException("x", x, 0, m_integral.extent(1) - 1 - width);
+  bob::core::array::assertSameDimensionLength(hist.extent(0), m_cell_dim);
+
+  const double* top_left = &m_integral(y, x, 0);
+  const double* top_right = &m_integral(y, x + width, 0);
+  const double* bottom_left = &m_integral(y + height, x, 0);
+  const double* bottom_right = &m_integral(y + height, x + width, 0);
+  for(size_t b=0; b<m_cell_dim; ++b)
+    hist(b) = bottom_right[b] - bottom_left[b] - top_right[b] + top_left[b];
+}
+
+void bob::ip::DenseHOG::descriptor_(const int y, const int x, 
+  blitz::Array<double,3>& cells, blitz::Array<double,1>& output) const
+{
+  blitz::Range rall = blitz::Range::all();
+  // Computes the histograms for each cell
+  for(size_t cy=0; cy<m_nb_cells_y; ++cy)
+    for(size_t cx=0; cx<m_nb_cells_x; ++cx)
+    {
+      blitz::Array<double,1> hist = cells(cy,cx,rall);
+      histogram(y + cy*(m_cell_y-m_cell_ov_y), x + cx*(m_cell_x-m_cell_ov_x),
+        m_cell_y, m_cell_x, hist);
+    }
+
+  // Normalizes by block
+  const int block_dim = m_block_y * m_block_x * m_cell_dim;
+  for(size_t by=0; by<m_nb_blocks_y; ++by)
+    for(size_t bx=0; bx<m_nb_blocks_x; ++bx)
+    {
+      const int c_y = by * (m_block_y - m_block_ov_y);
+      const int c_x = bx * (m_block_x - m_block_ov_x);
+      blitz::Array<double,3> cells_block = cells(
+        blitz::Range(c_y, c_y + m_block_y - 1), 
+        blitz::Range(c_x, c_x + m_block_x - 1), rall);
+      const int offset = (by * m_nb_blocks_x + bx) * block_dim;
+      blitz::Array<double,1> block = 
+        output(blitz::Range(offset, offset + block_dim - 1));
+      normalizeBlock_(cells_block, block, m_block_norm, 
+        m_block_norm_eps, m_block_norm_threshold);
+    }
+}
+
+void bob::ip::DenseHOG::descriptor(const int y, const int x,
+  blitz::Array<double,3>& output) const
+{
+  bob::core::array::assertSameShape(output, getOutputShape());
+  bob::core::array::assertCZeroBaseContiguous(output);
+  if (y < 0 || y + m_height > getImageHeight())
+    throw bob::core::InvalidArgumentException("y", y, 0, (int)(getImageHeight() - m_height));
+  if (x < 0 || x + m_width > getImageWidth())
+    throw bob::core::InvalidArgumentException("x", x, 0, (int)(getImageWidth() - m_width));
+
+  blitz::Array<double,3> cells(m_nb_cells_y, m_nb_cells_x, m_cell_dim);
+  blitz::Array<double,1> flat(output.data(), blitz::shape(output.size()), 
+    blitz::neverDeleteData);
+  descriptor_(y, x, cells, flat);
+}
+
+void bob::ip::DenseHOG::descriptorRows(size_t, size_t begin, size_t end, 
+  const size_t step_y, const size_t step_x, 
+  blitz::Array<double,3>& output) const
+{
+  // the cell cache is shared by all windows of this thread
+  blitz::Array<double,3> cells(m_nb_cells_y, m_nb_cells_x, m_cell_dim);
+  for(size_t i=begin; i<end; ++i)
+    for(int j=0; j<output.extent(1); ++j)
+    {
+      // wraps the descriptor from the output data, as slicing the shared
+      // output array is not thread-safe
+      blitz::Array<double,1> descr(
+        output.data() + i * output.stride(0) + j * output.stride(1),
+        blitz::shape(output.extent(2)), blitz::shape(output.stride(2)),
+        blitz::neverDeleteData);
+      descriptor_(i * step_y, j * step_x, cells, descr);
+    }
+}
+
+void bob::ip::DenseHOG::descriptors(const size_t step_y, const size_t step_x,
+  blitz::Array<double,3>& output, const size_t number_of_threads) const
+{
+  bob::core::array::assertZeroBase(output);
+  bob::core::array::assertSameShape(output, getGridShape(step_y, step_x));
+
+  bob::core::parallel_for(output.extent(0), 
+    boost::bind(&DenseHOG::descriptorRows, this, _1, _2, _3, step_y, step_x,
+      boost::ref(output)), number_of_threads);
+}
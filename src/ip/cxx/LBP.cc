@@ -25,6 +25,7 @@
  */
 
 #include <bob/ip/LBP.h>
+#include <bob/core/check.h>
 
 #include <boost/math/constants/constants.hpp>
 
@@ -257,3 +258,115 @@ int bob::ip::LBP::getMaxLabel() const {
     }
   }
 }
+
+
+void bob::ip::LBP::interpolation_columns(int x, int width, int* columns,
+    double* weights) const
+{
+  for (int p = 0; p < m_P; ++p){
+    for (int i = 0; i < width; ++i, columns += 2, weights += 2){
+      // the absolute position, so that the weights are identical to the ones
+      // of bob::sp::detail::bilinearInterpolationNoCheck()
+      const double px = (x + i) + m_positions(p,1);
+      const int xl = static_cast<int>(floor(px)), xh = static_cast<int>(ceil(px));
+      columns[0] = xl;
+      columns[1] = xh;
+      weights[0] = xh - px;
+      weights[1] = 1 - (xh - px);
+    }
+  }
+}
+
+/**
+ * The comparison that is used for all LBP variants: greater or (almost) equal
+ */
+static inline bool greater_equal(double a, double b){
+  return a > b || bob::core::isClose(a, b);
+}
+
+/**
+ * Computes the LBP codes of a row of pixels for one specific LBP variant,
+ * which is resolved at compile time. Each loop runs over a whole row.
+ */
+template <bob::ip::ELBPType TYPE, bool TO_AVERAGE, bool ADD_AVERAGE_BIT>
+static void lbp_row_codes(const double* values, const double* center, int P,
+    int width, double* cmp_point, uint16_t* codes)
+{
+  // the point to compare with
+  for (int i = 0; i < width; ++i) cmp_point[i] = center[i];
+  if (TO_AVERAGE){
+    for (int p = 0; p < P; ++p)
+      for (int i = 0; i < width; ++i)
+        cmp_point[i] += values[p * width + i];
+    for (int i = 0; i < width; ++i)
+      cmp_point[i] /= (P + 1); // /(P+1) since (averaged over P+1 points)
+  }
+
+  for (int i = 0; i < width; ++i) codes[i] = 0;
+
+  // the formulas are implemented from Cosmin's thesis
+  switch (TYPE){
+    case bob::ip::ELBP_REGULAR:{
+      for (int p = 0; p < P; ++p){
+        const double* v = values + p * width;
+        for (int i = 0; i < width; ++i)
+          codes[i] = (codes[i] << 1) | greater_equal(v[i], cmp_point[i]);
+      }
+      if (ADD_AVERAGE_BIT)
+        for (int i = 0; i < width; ++i)
+          codes[i] = (codes[i] << 1) | greater_equal(center[i], cmp_point[i]);
+      break;
+    }
+
+    case bob::ip::ELBP_TRANSITIONAL:{
+      for (int p = 0; p < P; ++p){
+        const double* v = values + p * width, * w = values + ((p+1) % P) * width;
+        for (int i = 0; i < width; ++i)
+          codes[i] = (codes[i] << 1) | greater_equal(v[i], w[i]);
+      }
+      break;
+    }
+
+    case bob::ip::ELBP_DIRECTION_CODED:{
+      const int p_half = P/2;
+      for (int p = 0; p < p_half; ++p){
+        const double* v = values + p * width, * w = values + (p + p_half) * width;
+        for (int i = 0; i < width; ++i){
+          const double d1 = v[i] - cmp_point[i], d2 = w[i] - cmp_point[i];
+          codes[i] = (codes[i] << 2) | (d1 * d2 >= 0.) | (greater_equal(std::abs(d1), std::abs(d2)) << 1);
+        }
+      }
+      break;
+    }
+  }
+}
+
+void bob::ip::LBP::lbp_codes(const double* values, const double* center,
+    int width, double* scratch, uint16_t* codes) const
+{
+  // the average bit is only added for regular, non-uniform and non-rotation-invariant LBP's
+  const bool add_average_bit = m_add_average_bit && !m_rotation_invariant && !m_uniform;
+
+  switch (m_eLBP_type){
+    case ELBP_REGULAR:
+      if (m_to_average){
+        if (add_average_bit) lbp_row_codes<ELBP_REGULAR, true, true>(values, center, m_P, width, scratch, codes);
+        else lbp_row_codes<ELBP_REGULAR, true, false>(values, center, m_P, width, scratch, codes);
+      } else {
+        if (add_average_bit) lbp_row_codes<ELBP_REGULAR, false, true>(values, center, m_P, width, scratch, codes);
+        else lbp_row_codes<ELBP_REGULAR, false, false>(values, center, m_P, width, scratch, codes);
+      }
+      break;
+    case ELBP_TRANSITIONAL:
+      lbp_row_codes<ELBP_TRANSITIONAL, false, false>(values, center, m_P, width, scratch, codes);
+      break;
+    case ELBP_DIRECTION_CODED:
+      if (m_to_average) lbp_row_codes<ELBP_DIRECTION_CODED, true, false>(values, center, m_P, width, scratch, codes);
+      else lbp_row_codes<ELBP_DIRECTION_CODED, false, false>(values, center, m_P, width, scratch, codes);
+      break;
+  }
+
+  // convert the lbp codes according to the requested setup (uniform, rotation invariant, ...)
+  for (int i = 0; i < width; ++i)
+    codes[i] = m_lut(codes[i]);
+}
@@ -0,0 +1,140 @@
+/**
+ * @file ip/cxx/LBPHSFeatures.cc
+ * @date Thu Jun 13 11:02:47 2013 +0200
+ * @author Manuel Guenther <Manuel.Guenther@idiap.ch>
+ *
+ * @brief Computes the block histograms of LBPHS features from the LBP codes
+ *   of the whole image
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/ip/LBPHSFeatures.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * Computes the sorted borders of the cells that the given blocks cut one axis
+ * into, and the indices of the first and the last border of each block
+ */
+static void cell_borders(const int n_blocks, const int step, const int size,
+  std::vector<int>& borders, std::vector<int>& first, std::vector<int>& last)
+{
+  borders.clear();
+  for (int b = 0; b < n_blocks; ++b) {
+    borders.push_back(b * step);
+    borders.push_back(b * step + size);
+  }
+  std::sort(borders.begin(), borders.end());
+  borders.erase(std::unique(borders.begin(), borders.end()), borders.end());
+
+  first.resize(n_blocks);
+  last.resize(n_blocks);
+  for (int b = 0; b < n_blocks; ++b) {
+    first[b] = std::lower_bound(borders.begin(), borders.end(), b * step) - borders.begin();
+    last[b] = std::lower_bound(borders.begin(), borders.end(), b * step + size) - borders.begin();
+  }
+}
+
+/**
+ * Returns, for each position on one axis, the index of the cell it lies in,
+ * or -1 if it lies outside of all cells
+ */
+static std::vector<int> cell_indices(const int length, const std::vector<int>& borders)
+{
+  std::vector<int> indices(length, -1);
+  for (size_t c = 0; c + 1 < borders.size(); ++c)
+    for (int i = borders[c]; i < borders[c+1] && i < length; ++i)
+      indices[i] = c;
+  return indices;
+}
+
+void bob::ip::LBPHSFeatures::histograms(const int height, const int width,
+  const blitz::Array<uint16_t,2>& codes, blitz::Array<uint64_t,2>& dst) const
+{
+  // Determine the number of blocks per row and column
+  const int step_h = m_block_h - m_overlap_h;
+  const int step_w = m_block_w - m_overlap_w;
+  const int n_blocks_h = (height - m_overlap_h) / step_h;
+  const int n_blocks_w = (width - m_overlap_w) / step_w;
+
+  // The size of the blocks in the LBP code image
+  const blitz::TinyVector<double,2> radii = m_lbp.getRadii();
+  const int size_h = std::max(0, m_block_h - 2 * (int)ceil(radii[0]));
+  const int size_w = std::max(0, m_block_w - 2 * (int)ceil(radii[1]));
+  const int n_bins = dst.extent(1);
+
+  dst = 0;
+  if (!size_h || !size_w) return;
+
+  std::vector<int> borders_h, first_h, last_h, borders_w, first_w, last_w;
+  cell_borders(n_blocks_h, step_h, size_h, borders_h, first_h, last_h);
+  cell_borders(n_blocks_w, step_w, size_w, borders_w, first_w, last_w);
+  const int cells_h = borders_h.size(), cells_w = borders_w.size();
+
+  // When there are many bins and only few pixels per block (or no overlap),
+  // counting the codes of each block directly is cheaper
+  if ((double)cells_h * cells_w * n_bins >= (double)dst.extent(0) * size_h * size_w) {
+    for (int h = 0; h < n_blocks_h; ++h)
+      for (int w = 0; w < n_blocks_w; ++w) {
+        const int b = h * n_blocks_w + w;
+        for (int y = h * step_h; y < h * step_h + size_h; ++y)
+          for (int x = w * step_w; x < w * step_w + size_w; ++x)
+            ++dst(b, codes(y, x));
+      }
+    return;
+  }
+
+  // Integral histogram over the cells: entry (j,i) holds the histogram of all
+  // codes in the rows [0, borders_h[j]) and the columns [0, borders_w[i]).
+  // Border 0 is always 0, so that the first row and column stay empty.
+  std::vector<uint64_t> integral((size_t)cells_h * cells_w * n_bins, 0);
+  const std::vector<int> index_h = cell_indices(codes.extent(0), borders_h);
+  const std::vector<int> index_w = cell_indices(codes.extent(1), borders_w);
+
+  // count the codes of each cell
+  for (int y = 0; y < codes.extent(0); ++y) {
+    if (index_h[y] < 0) continue;
+    uint64_t* row = &integral[(size_t)(index_h[y] + 1) * cells_w * n_bins];
+    for (int x = 0; x < codes.extent(1); ++x)
+      if (index_w[x] >= 0)
+        ++row[(size_t)(index_w[x] + 1) * n_bins + codes(y, x)];
+  }
+
+  // accumulate the cell histograms
+  for (int j = 1; j < cells_h; ++j)
+    for (int i = 1; i < cells_w; ++i) {
+      uint64_t* current = &integral[((size_t)j * cells_w + i) * n_bins];
+      const uint64_t* up = current - (size_t)cells_w * n_bins;
+      const uint64_t* left = current - n_bins;
+      const uint64_t* up_left = up - n_bins;
+      for (int k = 0; k < n_bins; ++k)
+        current[k] += up[k] + left[k] - up_left[k];
+    }
+
+  // extract the histogram of each block with four look-ups per bin
+  for (int h = 0; h < n_blocks_h; ++h)
+    for (int w = 0; w < n_blocks_w; ++w) {
+      const int b = h * n_blocks_w + w;
+      const uint64_t* top_left = &integral[((size_t)first_h[h] * cells_w + first_w[w]) * n_bins];
+      const uint64_t* top_right = &integral[((size_t)first_h[h] * cells_w + last_w[w]) * n_bins];
+      const uint64_t* bottom_left = &integral[((size_t)last_h[h] * cells_w + first_w[w]) * n_bins];
+      const uint64_t* bottom_right = &integral[((size_t)last_h[h] * cells_w + last_w[w]) * n_bins];
+      for (int k = 0; k < n_bins; ++k)
+        dst(b, k) = bottom_right[k] - bottom_left[k] - top_right[k] + top_left[k];
+    }
+}
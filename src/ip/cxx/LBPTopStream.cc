@@ -0,0 +1,185 @@
+/**
+ * @file ip/cxx/LBPTopStream.cc
+ * @date Fri Jun 14 10:12:36 2013 +0200
+ * @author Manuel Guenther <Manuel.Guenther@idiap.ch>
+ *
+ * @brief Computes LBP-Top planes incrementally over a stream of video frames
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/ip/LBPTopStream.h>
+#include <bob/ip/color.h>
+#include <bob/core/parallel.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static int ceil_radius(const double radius) { return (int)ceil(radius); }
+
+bob::ip::LBPTopStream::LBPTopStream(const bob::ip::LBP& lbp_xy,
+    const bob::ip::LBP& lbp_xt, const bob::ip::LBP& lbp_yt,
+    const size_t number_of_threads)
+: m_lbp_xy(lbp_xy),
+  m_lbp_xt(lbp_xt),
+  m_lbp_yt(lbp_yt),
+  m_number_of_threads(number_of_threads),
+  m_count(0)
+{
+  init();
+}
+
+bob::ip::LBPTopStream::LBPTopStream(const bob::ip::LBPTop& lbp_top,
+    const size_t number_of_threads)
+: m_lbp_xy(lbp_top.getXY()),
+  m_lbp_xt(lbp_top.getXT()),
+  m_lbp_yt(lbp_top.getYT()),
+  m_number_of_threads(number_of_threads),
+  m_count(0)
+{
+  init();
+}
+
+void bob::ip::LBPTopStream::init()
+{
+  // the XY plane is (Y,X), the XT plane is (T,X) and the YT plane is (T,Y)
+  m_r_t = std::max(ceil_radius(m_lbp_xt.getRadii()[0]), ceil_radius(m_lbp_yt.getRadii()[0]));
+  m_border = std::max(
+      std::max(ceil_radius(m_lbp_xy.getRadii()[0]), ceil_radius(m_lbp_xy.getRadii()[1])),
+      std::max(ceil_radius(m_lbp_xt.getRadii()[1]), ceil_radius(m_lbp_yt.getRadii()[1])));
+  m_buffer_size = 2 * m_r_t + 1;
+}
+
+void bob::ip::LBPTopStream::reset()
+{
+  m_count = 0;
+}
+
+void bob::ip::LBPTopStream::resize(const int height, const int width)
+{
+  if (height <= 2 * m_border)
+    throw bob::core::InvalidArgumentException("height", height, 2 * m_border + 1, std::numeric_limits<int>::max());
+  if (width <= 2 * m_border)
+    throw bob::core::InvalidArgumentException("width", width, 2 * m_border + 1, std::numeric_limits<int>::max());
+
+  m_frames.resize(2 * m_buffer_size, height, width);
+  const blitz::TinyVector<int,2> xy_shape = m_lbp_xy.getLBPShape(m_frames(0, blitz::Range::all(), blitz::Range::all()));
+  m_xy_codes.resize(m_buffer_size, xy_shape[0], xy_shape[1]);
+  m_xy.resize(height - 2 * m_border, width - 2 * m_border);
+  m_xt.resize(m_xy.shape());
+  m_yt.resize(m_xy.shape());
+}
+
+bool bob::ip::LBPTopStream::push(const blitz::Array<uint8_t,3>& frame)
+{
+  blitz::Array<uint8_t,2> gray(frame.extent(1), frame.extent(2));
+  bob::ip::rgb_to_gray(frame, gray);
+  return push(gray);
+}
+
+bool bob::ip::LBPTopStream::update(const int slot)
+{
+  const blitz::Range all = blitz::Range::all();
+
+  // the XY codes of each frame are computed only once
+  const blitz::Array<double,2> frame = m_frames(slot, all, all);
+  blitz::Array<uint16_t,2> codes = m_xy_codes(slot, all, all);
+  m_lbp_xy(frame, codes);
+
+  if (++m_count < (size_t)m_buffer_size) return false;
+
+  // the buffered frames are stored contiguously in the slots following the
+  // current one, the central frame is the one in the middle
+  const int first_slot = slot + 1;
+  const int center = (first_slot + m_r_t) % m_buffer_size;
+  const int r_y = ceil_radius(m_lbp_xy.getRadii()[0]), r_x = ceil_radius(m_lbp_xy.getRadii()[1]);
+  m_xy = m_xy_codes(center,
+      blitz::Range(m_border - r_y, m_border - r_y + m_xy.extent(0) - 1),
+      blitz::Range(m_border - r_x, m_border - r_x + m_xy.extent(1) - 1));
+
+  bob::core::parallel_for(m_xt.extent(0),
+      boost::bind(&LBPTopStream::xt_rows, this, _1, _2, _3, first_slot),
+      m_number_of_threads);
+  bob::core::parallel_for(m_yt.extent(1),
+      boost::bind(&LBPTopStream::yt_columns, this, _1, _2, _3, first_slot),
+      m_number_of_threads);
+  return true;
+}
+
+void bob::ip::LBPTopStream::xt_rows(size_t, size_t begin, size_t end,
+    const int first_slot)
+{
+  // only the frames required by the XT operator are taken into account, so
+  // that the LBP codes of exactly one row are computed
+  const int center = first_slot + m_r_t;
+  const int r_t = ceil_radius(m_lbp_xt.getRadii()[0]), r_x = ceil_radius(m_lbp_xt.getRadii()[1]);
+  blitz::Array<uint16_t,2> codes(1, m_frames.extent(2) - 2 * r_x);
+
+  // the XT planes are wrapped from the frame data, since slicing the shared
+  // frames is not thread-safe
+  double* first = m_frames.data() + (center - r_t) * m_frames.stride(0);
+  for (int j = begin; j < (int)end; ++j){
+    const blitz::Array<double,2> plane(first + (j + m_border) * m_frames.stride(1),
+        blitz::shape(2 * r_t + 1, m_frames.extent(2)),
+        blitz::shape(m_frames.stride(0), m_frames.stride(2)),
+        blitz::neverDeleteData);
+    m_lbp_xt(plane, codes);
+    for (int x = 0; x < m_xt.extent(1); ++x)
+      m_xt(j, x) = codes(0, x + m_border - r_x);
+  }
+}
+
+void bob::ip::LBPTopStream::yt_columns(size_t, size_t begin, size_t end,
+    const int first_slot)
+{
+  const int center = first_slot + m_r_t;
+  const int r_t = ceil_radius(m_lbp_yt.getRadii()[0]), r_y = ceil_radius(m_lbp_yt.getRadii()[1]);
+  blitz::Array<uint16_t,2> codes(1, m_frames.extent(1) - 2 * r_y);
+
+  // the YT planes are wrapped from the frame data (see xt_rows())
+  double* first = m_frames.data() + (center - r_t) * m_frames.stride(0);
+  for (int i = begin; i < (int)end; ++i){
+    const blitz::Array<double,2> plane(first + (i + m_border) * m_frames.stride(2),
+        blitz::shape(2 * r_t + 1, m_frames.extent(1)),
+        blitz::shape(m_frames.stride(0), m_frames.stride(1)),
+        blitz::neverDeleteData);
+    m_lbp_yt(plane, codes);
+    for (int y = 0; y < m_yt.extent(0); ++y)
+      m_yt(y, i) = codes(0, y + m_border - r_y);
+  }
+}
+
+/**
+ * Computes the histogram of the given LBP codes
+ */
+static void lbp_histogram(const blitz::Array<uint16_t,2>& codes,
+    const bob::ip::LBP& lbp, blitz::Array<uint64_t,1>& histogram)
+{
+  bob::core::array::assertSameDimensionLength(histogram.extent(0), lbp.getMaxLabel());
+  histogram = 0;
+  for (int y = 0; y < codes.extent(0); ++y)
+    for (int x = 0; x < codes.extent(1); ++x)
+      ++histogram(codes(y, x));
+}
+
+void bob::ip::LBPTopStream::histograms(blitz::Array<uint64_t,1>& xy,
+    blitz::Array<uint64_t,1>& xt, blitz::Array<uint64_t,1>& yt) const
+{
+  if (frame() < 0)
+    throw bob::core::InvalidArgumentException("The histograms cannot be computed before the first time step has been completed");
+  lbp_histogram(m_xy, m_lbp_xy, xy);
+  lbp_histogram(m_xt, m_lbp_xt, xt);
+  lbp_histogram(m_yt, m_lbp_yt, yt);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file ip/cxx/benchmark/GaborWaveletTransform.cc
+ * @date 2013-06-03
+ * @author Manuel Guenther <Manuel.Guenther@idiap.ch>
+ *
+ * @brief Compares the runtime of the extraction of Gabor graphs from the full
+ * Gabor jet image with the direct computation of the Gabor jets at the nodes.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/random.hpp>
+#include <blitz/array.h>
+
+#include "bob/core/benchmark.h"
+#include "bob/ip/GaborWaveletTransform.h"
+
+using bob::core::benchmark::param;
+
+/**
+ * Extracts the graph jets from the full Gabor jet image
+ */
+struct FromJetImage {
+  bob::ip::GaborWaveletTransform& gwt;
+  const blitz::Array<std::complex<double>,2>& image;
+  const blitz::Array<int,2>& positions;
+  blitz::Array<double,4>& jet_image;
+  blitz::Array<double,3>& graph_jets;
+  void operator()() const {
+    blitz::Range all = blitz::Range::all();
+    gwt.computeJetImage(image, jet_image);
+    for (int i = 0; i < positions.extent(0); ++i)
+      graph_jets(i,all,all) = jet_image(positions(i,0), positions(i,1), all, all);
+  }
+};
+
+/**
+ * Computes the graph jets directly at the nodes
+ */
+struct AtNodes {
+  bob::ip::GaborWaveletTransform& gwt;
+  const blitz::Array<std::complex<double>,2>& image;
+  const blitz::Array<int,2>& positions;
+  blitz::Array<double,3>& graph_jets;
+  void operator()() const {
+    gwt.computeGraphJets(image, positions, graph_jets);
+  }
+};
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("ip_gwt", argc, argv);
+  const int image_sizes[] = {64, 128, 256};
+  const int node_counts[] = {10, 40, 100};
+
+  boost::mt19937 rng;
+  boost::uniform_int<> pixel(0, 255);
+
+  for (int s = 0; s < 3; ++s){
+    const int size = image_sizes[s];
+    // random image
+    blitz::Array<std::complex<double>,2> image(size, size);
+    for (int y = 0; y < size; ++y)
+      for (int x = 0; x < size; ++x)
+        image(y,x) = pixel(rng);
+
+    bob::ip::GaborWaveletTransform gwt;
+    blitz::Array<double,4> jet_image(size, size, 2, gwt.numberOfKernels());
+    // generate the kernels in advance, so that they are not part of the measurements
+    gwt.generateSpatialKernels(blitz::TinyVector<unsigned,2>(size, size));
+
+    for (int n = 0; n < 3; ++n){
+      const int nodes = node_counts[n];
+      // random node positions
+      blitz::Array<int,2> positions(nodes, 2);
+      boost::uniform_int<> coordinate(0, size-1);
+      for (int i = 0; i < nodes; ++i){
+        positions(i,0) = coordinate(rng);
+        positions(i,1) = coordinate(rng);
+      }
+      blitz::Array<double,3> graph_jets(nodes, 2, gwt.numberOfKernels());
+      const std::string parameters = param("size", size) + "," + param("nodes", nodes);
+
+      FromJetImage fft = {gwt, image, positions, jet_image, graph_jets};
+      suite.run("graph_from_jet_image", parameters, fft);
+      AtNodes direct = {gwt, image, positions, graph_jets};
+      suite.run("graph_at_nodes", parameters, direct);
+    }
+  }
+
+  return suite.finish();
+}
@@ -0,0 +1,76 @@
+/**
+ * @file ip/cxx/benchmark/LBP.cc
+ * @date 2013-07-04
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Measures the extraction of LBP codes from random images, for the
+ * most common LBP variants.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/random.hpp>
+#include <blitz/array.h>
+
+#include "bob/core/benchmark.h"
+#include "bob/ip/LBP.h"
+
+using bob::core::benchmark::param;
+
+struct Extract {
+  const bob::ip::LBP& lbp;
+  const blitz::Array<uint8_t,2>& image;
+  blitz::Array<uint16_t,2>& codes;
+  size_t threads;
+  void operator()() const { lbp(image, codes, threads); }
+};
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("ip_LBP", argc, argv);
+  const int sizes[] = {80, 256, 1024};
+  const size_t threads[] = {1, 0};
+
+  boost::mt19937 rng;
+  boost::uniform_int<> pixel(0, 255);
+
+  const bob::ip::LBP variants[] = {
+    bob::ip::LBP(8, 1., false),
+    bob::ip::LBP(8, 1., true),
+    bob::ip::LBP(8, 2., true, false, false, true),
+    bob::ip::LBP(16, 2., true)
+  };
+  const char* names[] = {"lbp8r1", "lbp8r1_circular", "lbp8r2_circular_u2",
+    "lbp16r2_circular"};
+
+  for (int s = 0; s < 3; ++s){
+    const int size = sizes[s];
+    blitz::Array<uint8_t,2> image(size, size);
+    for (int y = 0; y < size; ++y)
+      for (int x = 0; x < size; ++x)
+        image(y,x) = pixel(rng);
+
+    for (int v = 0; v < 4; ++v){
+      blitz::Array<uint16_t,2> codes(variants[v].getLBPShape(image));
+      // single-threaded and on all cores
+      for (int t = 0; t < 2; ++t){
+        Extract extract = {variants[v], image, codes, threads[t]};
+        suite.run(names[v], param("size", size) + "," +
+            param("threads", t ? "all" : "1"), extract);
+      }
+    }
+  }
+
+  return suite.finish();
+}
@@ -37,6 +37,7 @@
 #include "bob/core/cast.h"
 #include "bob/io/utils.h"
 #include "bob/ip/GaborWaveletTransform.h"
+#include "bob/ip/Exception.h"
 
 
 
@@ -232,4 +233,106 @@ BOOST_AUTO_TEST_CASE( test_GWT_output )
 
 }
 
+BOOST_AUTO_TEST_CASE( test_GWT_real_threaded )
+{
+  char* data = getenv("BOB_TESTDATA_DIR");
+  if (!data){
+    bob::core::error << "Environment variable $BOB_TESTDATA_DIR "
+        "is not set. Have you setup your working environment correctly?" << std::endl;
+    throw bob::core::Exception();
+  }
+  std::string data_dir(data);
+
+  // Load original image
+  boost::filesystem::path image_file = boost::filesystem::path(data_dir) / "image.pgm";
+  blitz::Array<uint8_t,2> uint8_image = bob::io::open(image_file.string(), 'r')->read_all<uint8_t,2>();
+  blitz::Array<std::complex<double>,2> image = bob::core::array::cast<std::complex<double> >(uint8_image);
+  blitz::Array<double,2> real_image = bob::core::array::cast<double>(uint8_image);
+
+  // reference: complex input, single thread
+  bob::ip::GaborWaveletTransform gwt;
+  blitz::Array<std::complex<double>, 3> gwt_image(gwt.numberOfKernels(), image.extent(0), image.extent(1));
+  gwt.performGWT(image, gwt_image);
+  blitz::Array<double,4> jet_image(image.extent(0), image.extent(1), 2, gwt.numberOfKernels());
+  gwt.computeJetImage(image, jet_image, true);
+
+  // real-valued input, several threads
+  bob::ip::GaborWaveletTransform gwt2;
+  gwt2.setNumberOfThreads(3);
+  blitz::Array<std::complex<double>, 3> gwt_image2(gwt.numberOfKernels(), image.extent(0), image.extent(1));
+  gwt2.performGWT(real_image, gwt_image2);
+  test_close(gwt_image2, gwt_image, epsilon);
+  blitz::Array<double,4> jet_image2(image.extent(0), image.extent(1), 2, gwt.numberOfKernels());
+  gwt2.computeJetImage(real_image, jet_image2, true);
+  // compare the absolute values only, since phases of vanishing responses are unstable
+  blitz::Range all = blitz::Range::all(), abs_part(0,0);
+  test_close(jet_image2(all,all,abs_part,all), jet_image(all,all,abs_part,all), epsilon);
+
+  // complex input, several threads
+  gwt_image2 = 0;
+  gwt2.performGWT(image, gwt_image2);
+  test_close(gwt_image2, gwt_image, epsilon);
+}
+
+BOOST_AUTO_TEST_CASE( test_GWT_graph_jets )
+{
+  char* data = getenv("BOB_TESTDATA_DIR");
+  if (!data){
+    bob::core::error << "Environment variable $BOB_TESTDATA_DIR "
+        "is not set. Have you setup your working environment correctly?" << std::endl;
+    throw bob::core::Exception();
+  }
+  std::string data_dir(data);
+
+  // Load original image
+  boost::filesystem::path image_file = boost::filesystem::path(data_dir) / "image.pgm";
+  blitz::Array<uint8_t,2> uint8_image = bob::io::open(image_file.string(), 'r')->read_all<uint8_t,2>();
+  blitz::Array<std::complex<double>,2> image = bob::core::array::cast<std::complex<double> >(uint8_image);
+
+  // compute the full jet image as a reference
+  bob::ip::GaborWaveletTransform gwt;
+  blitz::Array<double,4> jet_image(image.extent(0), image.extent(1), 2, gwt.numberOfKernels());
+  gwt.computeJetImage(image, jet_image, true);
+
+  // positions in the image center and at the image borders
+  int h = image.extent(0), w = image.extent(1);
+  blitz::Array<int,2> positions(5,2);
+  positions = h/2, w/2,
+              0, 0,
+              h-1, w/3,
+              h/4, w-1,
+              h-3, 2;
+
+  // compute graph jets
+  blitz::Array<double,3> graph_jets(positions.extent(0), 2, gwt.numberOfKernels());
+  gwt.computeGraphJets(image, positions, graph_jets, true);
+  blitz::Array<double,2> abs_graph_jets(positions.extent(0), gwt.numberOfKernels());
+  gwt.computeGraphJets(image, positions, abs_graph_jets, true);
+
+  for (int i = 0; i < positions.extent(0); ++i){
+    for (int j = 0; j < (int)gwt.numberOfKernels(); ++j){
+      double ref_abs = jet_image(positions(i,0), positions(i,1), 0, j);
+      double ref_phase = jet_image(positions(i,0), positions(i,1), 1, j);
+      BOOST_CHECK_SMALL(graph_jets(i,0,j) - ref_abs, 1e-3);
+      BOOST_CHECK_SMALL(abs_graph_jets(i,j) - ref_abs, 1e-3);
+      // phases are only stable for non-vanishing responses
+      if (ref_abs > 1e-2){
+        double phase_diff = std::fmod(graph_jets(i,1,j) - ref_phase + 3. * M_PI, 2. * M_PI) - M_PI;
+        BOOST_CHECK_SMALL(phase_diff, 1e-2);
+      }
+    }
+  }
+
+  // positions outside of the image are rejected
+  blitz::Array<int,2> outside(2,2);
+  outside = h/2, w/2,
+            h, 0;
+  blitz::Array<double,3> outside_jets(outside.extent(0), 2, gwt.numberOfKernels());
+  BOOST_CHECK_THROW(gwt.computeGraphJets(image, outside, outside_jets, true), bob::ip::PositionOutOfImage);
+  outside = -1, 0,
+            0, w;
+  blitz::Array<double,2> outside_abs_jets(outside.extent(0), gwt.numberOfKernels());
+  BOOST_CHECK_THROW(gwt.computeGraphJets(image, outside, outside_abs_jets, true), bob::ip::PositionOutOfImage);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
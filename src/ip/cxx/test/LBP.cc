@@ -29,6 +29,8 @@
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 #include "bob/ip/LBP.h"
+#include "bob/sp/interpolate.h"
+#include "bob/core/check.h"
 
 #include <iostream>
 
@@ -296,4 +298,113 @@ BOOST_AUTO_TEST_CASE( test_lbp_other )
   BOOST_CHECK_EQUAL( lbp_16_a2_t, lbp(a2,1,1) );
 }
 
+/**
+ * The LBP code of a single pixel, as computed by the previous, pixel-wise
+ * implementation of bob::ip::LBP
+ */
+template <typename U>
+static uint16_t reference_lbp_code(bob::ip::LBP lbp, const blitz::Array<U,2>& src, int y, int x)
+{
+  const int P = lbp.getNNeighbours();
+  const blitz::Array<double,2> positions = lbp.getRelativePositions();
+  std::vector<double> pixels(P);
+  if (lbp.getCircular())
+    for (int p = 0; p < P; ++p)
+      pixels[p] = bob::sp::detail::bilinearInterpolationNoCheck(src, y + positions(p,0), x + positions(p,1));
+  else
+    for (int p = 0; p < P; ++p)
+      pixels[p] = static_cast<double>(src(y + static_cast<int>(positions(p,0)), x + static_cast<int>(positions(p,1))));
+
+  double center = static_cast<double>(src(y, x));
+  double cmp_point = center;
+  if (lbp.getToAverage())
+    cmp_point = std::accumulate(pixels.begin(), pixels.end(), center) / (P + 1);
+
+  uint16_t lbp_code = 0;
+  switch (lbp.get_eLBP()){
+    case bob::ip::ELBP_REGULAR:{
+      for (int p = 0; p < P; ++p){
+        lbp_code <<= 1;
+        if (pixels[p] > cmp_point || bob::core::isClose(pixels[p], cmp_point)) ++lbp_code;
+      }
+      if (lbp.getAddAverageBit() && !lbp.getRotationInvariant() && !lbp.getUniform()){
+        lbp_code <<= 1;
+        if (center > cmp_point || bob::core::isClose(center, cmp_point)) ++lbp_code;
+      }
+      break;
+    }
+    case bob::ip::ELBP_TRANSITIONAL:{
+      for (int p = 0; p < P; ++p){
+        lbp_code <<= 1;
+        if (pixels[p] > pixels[(p+1)%P] || bob::core::isClose(pixels[p], pixels[(p+1)%P])) ++lbp_code;
+      }
+      break;
+    }
+    case bob::ip::ELBP_DIRECTION_CODED:{
+      int p_half = P/2;
+      for (int p = 0; p < p_half; ++p){
+        lbp_code <<= 2;
+        if ((pixels[p] - cmp_point) * (pixels[p+p_half] - cmp_point) >= 0.) lbp_code += 1;
+        double p1 = std::abs(pixels[p] - cmp_point), p2 = std::abs(pixels[p+p_half] - cmp_point);
+        if (p1 > p2 || bob::core::isClose(p1, p2)) lbp_code += 2;
+      }
+      break;
+    }
+  }
+  return lbp.getLookUpTable()(lbp_code);
+}
+
+template <typename U>
+static void check_lbp_image(const bob::ip::LBP& lbp, const blitz::Array<U,2>& image)
+{
+  blitz::Array<uint16_t,2> result(lbp.getLBPShape(image));
+  const int r_y = image.extent(0) - result.extent(0), r_x = image.extent(1) - result.extent(1);
+  for (size_t threads = 1; threads <= 3; ++threads){
+    result = 0;
+    lbp(image, result, threads);
+    // the whole image codes must be identical to the codes of single pixels,
+    // and to the ones of the previous implementation
+    for (int y = 0; y < result.extent(0); ++y)
+      for (int x = 0; x < result.extent(1); ++x){
+        BOOST_CHECK_EQUAL( lbp(image, y + r_y/2, x + r_x/2), result(y,x) );
+        BOOST_CHECK_EQUAL( reference_lbp_code(lbp, image, y + r_y/2, x + r_x/2), result(y,x) );
+      }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_lbp_image_variants )
+{
+  // a larger image with some flat regions
+  blitz::Array<uint8_t,2> image(23, 31);
+  blitz::firstIndex i; blitz::secondIndex j;
+  image = (i * 17 + j * 29 + (i * j) % 11) % 7 * 30;
+  blitz::Array<double,2> image_d(image.shape());
+  image_d = image / 3.;
+  // an image with arbitrary values, where interpolation rounding matters
+  blitz::Array<double,2> noise(23, 31);
+  noise = blitz::sin(i * 1.7 + j * 0.31) * 100. + (i * j) % 13 / 7.;
+  // a non-contiguous view
+  blitz::Array<uint8_t,2> transposed = image.transpose(1,0);
+
+  const bob::ip::ELBPType types[] = {bob::ip::ELBP_REGULAR, bob::ip::ELBP_TRANSITIONAL, bob::ip::ELBP_DIRECTION_CODED};
+  for (int t = 0; t < 3; ++t){
+    for (int P = 4; P <= 16; P *= 2){
+      for (int variant = 0; variant < 8; ++variant){
+        const bool circular = variant & 1, to_average = variant & 2, uniform = variant & 4;
+        // rectangular LBP16 is not implemented
+        if (P == 16 && !circular) continue;
+        bob::ip::LBP lbp(P, 2., 1.5, circular, to_average, false, uniform, false, types[t]);
+        check_lbp_image(lbp, image);
+        check_lbp_image(lbp, image_d);
+        check_lbp_image(lbp, noise);
+        check_lbp_image(lbp, transposed);
+      }
+    }
+  }
+  // rotation invariant and average bit
+  check_lbp_image(bob::ip::LBP(8, 1., true, false, false, true, true), image);
+  check_lbp_image(bob::ip::LBP(8, 1., false, false, false, false, true), image);
+  check_lbp_image(bob::ip::LBP(8, 1., true, true, true), image);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
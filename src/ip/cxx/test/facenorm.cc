@@ -191,4 +191,49 @@ BOOST_AUTO_TEST_CASE( test_facenorm3 )
   BOOST_CHECK_CLOSE(new_left_eye(1), 48., 1e-8);
 }
 
+BOOST_AUTO_TEST_CASE( test_facenorm_batch )
+{
+  // create a batch of synthetic images
+  const int N = 5;
+  blitz::Array<uint8_t,3> images(N, 60, 50);
+  blitz::firstIndex n; blitz::secondIndex y; blitz::thirdIndex x;
+  images = (n * 37 + y * 7 + x * 13 + (x * y) % 17) % 256;
+  blitz::Array<bool,3> masks(N, 60, 50);
+  masks = (x + y + n) % 9 != 0;
+
+  // eye positions; images 2 and 3 share the eye positions of image 1
+  blitz::Array<double,2> eyes(N, 4);
+  eyes = 20., 15., 22., 35.,
+         25.5, 12.2, 21.3, 33.7,
+         25.5, 12.2, 21.3, 33.7,
+         25.5, 12.2, 21.3, 33.7,
+         -3., 40., 10., 70.;
+
+  bob::ip::FaceEyesNorm facenorm(20, 40, 30, 10, 15);
+  blitz::Array<double,2> single(40, 30);
+  blitz::Array<bool,2> single_mask(40, 30);
+
+  for (size_t threads = 1; threads <= 3; ++threads){
+    blitz::Array<double,3> batch(N, 40, 30), masked_batch(N, 40, 30);
+    blitz::Array<bool,3> batch_mask(N, 40, 30);
+    facenorm(images, eyes, batch, threads);
+    facenorm(images, masks, eyes, masked_batch, batch_mask, threads);
+
+    // the results need to be identical to the ones of the single image versions
+    for (int i = 0; i < N; ++i){
+      blitz::Array<uint8_t,2> image = images(i, blitz::Range::all(), blitz::Range::all());
+      blitz::Array<bool,2> mask = masks(i, blitz::Range::all(), blitz::Range::all());
+      blitz::Array<double,2> result = batch(i, blitz::Range::all(), blitz::Range::all());
+      blitz::Array<double,2> masked_result = masked_batch(i, blitz::Range::all(), blitz::Range::all());
+
+      facenorm(image, single, eyes(i,0), eyes(i,1), eyes(i,2), eyes(i,3));
+      checkBlitzClose(single, result, eps2);
+
+      facenorm(image, mask, single, single_mask, eyes(i,0), eyes(i,1), eyes(i,2), eyes(i,3));
+      checkBlitzClose(single, masked_result, eps2);
+      BOOST_CHECK(blitz::all(single_mask == batch_mask(i, blitz::Range::all(), blitz::Range::all())));
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
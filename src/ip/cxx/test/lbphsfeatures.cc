@@ -28,6 +28,8 @@
 
 #include "bob/core/cast.h"
 #include "bob/ip/LBPHSFeatures.h"
+#include "bob/ip/histo.h"
+#include <list>
 
 struct T {
   blitz::Array<uint32_t,2> src;
@@ -117,4 +119,57 @@ BOOST_AUTO_TEST_CASE( test_lbphs_feature_extract_with_given_lbp )
   }
 }
 
+/**
+ * Compares the histograms of the given extractor with the ones obtained by
+ * applying the LBP operator on each block separately
+ */
+void checkBlockHistograms(const blitz::Array<uint8_t,2>& image,
+  const int block_h, const int block_w, const int overlap_h,
+  const int overlap_w, const bob::ip::LBP& lbp)
+{
+  bob::ip::LBPHSFeatures lbphsfeatures(block_h, block_w, overlap_h, overlap_w, lbp);
+  blitz::Array<uint64_t,2> dst(lbphsfeatures.getOutputShape(image));
+  lbphsfeatures(image, dst);
+
+  std::list<blitz::Array<uint8_t,2> > blocks;
+  bob::ip::blockReference(image, blocks, block_h, block_w, overlap_h, overlap_w);
+  BOOST_CHECK_EQUAL( dst.extent(0), (int)blocks.size() );
+  BOOST_CHECK_EQUAL( dst.extent(1), lbp.getMaxLabel() );
+
+  int i=0;
+  for( std::list<blitz::Array<uint8_t,2> >::const_iterator it = blocks.begin();
+    it != blocks.end(); ++it, ++i)
+  {
+    blitz::Array<uint64_t,1> histo(lbp.getMaxLabel());
+    histo = 0;
+    blitz::Array<uint16_t,2> codes(lbp.getLBPShape(*it));
+    if (codes.size()) {
+      lbp(*it, codes);
+      bob::ip::histogram<uint16_t>(codes, histo, 0, lbp.getMaxLabel()-1, lbp.getMaxLabel());
+    }
+    for (int k=0; k<histo.extent(0); ++k)
+      BOOST_CHECK_EQUAL( dst(i,k), histo(k) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_lbphs_feature_extract_overlap )
+{
+  blitz::Array<uint8_t,2> image(37,41);
+  for (int y=0; y<image.extent(0); ++y)
+    for (int x=0; x<image.extent(1); ++x)
+      image(y,x) = (y*31 + x*17 + (x*y) % 13) % 256;
+
+  // integral histogram path (large blocks, few bins)
+  checkBlockHistograms(image, 20, 20, 10, 10, bob::ip::LBP(8, 1., false, false, false, true));
+  checkBlockHistograms(image, 20, 25, 15, 12, bob::ip::LBP(4, 1.));
+  checkBlockHistograms(image, 21, 19, 8, 9, bob::ip::LBP(4, 2., true, true, true));
+  // direct counting path (small blocks or many bins)
+  checkBlockHistograms(image, 8, 8, 4, 4, bob::ip::LBP(8, 1., false, false, false, true));
+  checkBlockHistograms(image, 10, 7, 5, 3, bob::ip::LBP(8, 2., true, true, false, true, true));
+  checkBlockHistograms(image, 12, 12, 6, 6, bob::ip::LBP(16, 2., true));
+  // no overlap, and blocks without any LBP code
+  checkBlockHistograms(image, 9, 9, 0, 0, bob::ip::LBP(8, 1.));
+  checkBlockHistograms(image, 2, 3, 1, 1, bob::ip::LBP(8, 1.));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
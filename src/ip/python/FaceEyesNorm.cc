@@ -104,6 +104,58 @@ static void call2(bob::ip::FaceEyesNorm& obj, bob::python::const_ndarray input,
   }
 }
 
+template <typename T> static void inner_batch1(bob::ip::FaceEyesNorm& obj, 
+  bob::python::const_ndarray input, bob::python::const_ndarray eye_positions,
+  bob::python::ndarray output, size_t number_of_threads)
+{
+  blitz::Array<double,3> output_ = output.bz<double,3>();
+  obj(input.bz<T,3>(), eye_positions.bz<double,2>(), output_, number_of_threads);
+}
+
+static void batch1(bob::ip::FaceEyesNorm& obj, bob::python::const_ndarray input,
+  bob::python::const_ndarray eye_positions, bob::python::ndarray output,
+  size_t number_of_threads) 
+{
+  const bob::core::array::typeinfo& info = input.type();
+  switch (info.dtype) {
+    case bob::core::array::t_uint8: 
+      return inner_batch1<uint8_t>(obj, input, eye_positions, output, number_of_threads);
+    case bob::core::array::t_uint16:
+      return inner_batch1<uint16_t>(obj, input, eye_positions, output, number_of_threads);
+    case bob::core::array::t_float64: 
+      return inner_batch1<double>(obj, input, eye_positions, output, number_of_threads);
+    default: PYTHON_ERROR(TypeError, "FaceEyesNorm __call__ does not support array of type '%s'.", info.str().c_str());
+  }
+}
+
+template <typename T> static void inner_batch2(bob::ip::FaceEyesNorm& obj, 
+  bob::python::const_ndarray input, bob::python::const_ndarray input_mask,
+  bob::python::const_ndarray eye_positions, bob::python::ndarray output,
+  bob::python::ndarray output_mask, size_t number_of_threads)
+{
+  blitz::Array<double,3> output_ = output.bz<double,3>();
+  blitz::Array<bool,3> output_mask_ = output_mask.bz<bool,3>();
+  obj(input.bz<T,3>(), input_mask.bz<bool,3>(), eye_positions.bz<double,2>(),
+      output_, output_mask_, number_of_threads);
+}
+
+static void batch2(bob::ip::FaceEyesNorm& obj, bob::python::const_ndarray input,
+  bob::python::const_ndarray input_mask, bob::python::const_ndarray eye_positions,
+  bob::python::ndarray output, bob::python::ndarray output_mask,
+  size_t number_of_threads) 
+{
+  const bob::core::array::typeinfo& info = input.type();
+  switch (info.dtype) {
+    case bob::core::array::t_uint8: 
+      return inner_batch2<uint8_t>(obj, input, input_mask, eye_positions, output, output_mask, number_of_threads);
+    case bob::core::array::t_uint16:
+      return inner_batch2<uint16_t>(obj, input, input_mask, eye_positions, output, output_mask, number_of_threads);
+    case bob::core::array::t_float64: 
+      return inner_batch2<double>(obj, input, input_mask, eye_positions, output, output_mask, number_of_threads);
+    default: PYTHON_ERROR(TypeError, "FaceEyesNorm __call__ does not support array of type '%s'.", info.str().c_str());
+  }
+}
+
 void bind_ip_faceeyesnorm() {
   class_<bob::ip::FaceEyesNorm, boost::shared_ptr<bob::ip::FaceEyesNorm> >("FaceEyesNorm", faceeyesnorm_doc, init<const double, const size_t, const size_t, const double, const double>((arg("eyes_distance"), arg("crop_height"), arg("crop_width"), arg("crop_eyecenter_offset_h"), arg("crop_eyecenter_offset_w")), "Constructs a FaceEyeNorm object."))
       .def(init<unsigned, unsigned, unsigned, unsigned, unsigned, unsigned>(args("crop_height", "crop_width", "re_y", "re_x", "le_y", "le_x"), "Creates a FaceEyesNorm class that will put the eyes to the given locations and crop the image to the desired size."))
@@ -117,6 +169,9 @@ void bind_ip_faceeyesnorm() {
       .add_property("crop_offset_w", &bob::ip::FaceEyesNorm::getCropOffsetW, &bob::ip::FaceEyesNorm::setCropOffsetW, "x-coordinate of the point in the cropping area which is the middle of the segment defined by the eyes after the geometric normalization.")
       .add_property("last_angle", &bob::ip::FaceEyesNorm::getLastAngle, "The angle value (in degrees) used by the rotation involved in the last call of the operator ()")
       .add_property("last_scale", &bob::ip::FaceEyesNorm::getLastScale, "The scaling factor used by the scaling involved in the last call of the operator ()")
+      // the batch versions are registered first, so that they are tried last
+      .def("__call__", &batch1, (arg("input"), arg("eye_positions"), arg("output"), arg("number_of_threads")=1), "Extracts the faces of a batch of N images of identical size. Row i of the N x 4 array eye_positions contains the coordinates (re_y, re_x, le_y, le_x) of the eyes in image i. The images are distributed over the given number of threads (0: all cores). This function does not update last_angle and last_scale.")
+      .def("__call__", &batch2, (arg("input"), arg("input_mask"), arg("eye_positions"), arg("output"), arg("output_mask"), arg("number_of_threads")=1), "Extracts the faces of a batch of N images of identical size, taking mask into account. Row i of the N x 4 array eye_positions contains the coordinates (re_y, re_x, le_y, le_x) of the eyes in image i. The images are distributed over the given number of threads (0: all cores). This function does not update last_angle and last_scale.")
       .def("__call__", &call1, (arg("input"), arg("output"), arg("re_y"), arg("re_x"), arg("le_y"), arg("le_x")), "Extracts a face given the coordinates of the left (le_y, le_x) and right (re_y, re_x) eye centers. Please note that the horizontal position le_x of the left eye is usually larger than the position re_x of the right eye.")
       .def("__call__", &call1b, (arg("input"), arg("re_y"), arg("re_x"), arg("le_y"), arg("le_x")), "Extracts a face given the coordinates of the left (le_y, le_x) and right (re_y, re_x) eye centers. Please note that the horizontal position le_x of the left eye is usually larger than the position re_x of the right eye. The output is allocated and returned.")
       .def("__call__", &call2, (arg("input"), arg("input_mask"), arg("output"), arg("output_mask"), arg("re_y"), arg("re_x"), arg("le_y"), arg("le_x")), "Extracts a face given the coordinates of the left (le_y, le_x) and right (re_y, re_x) eye centers, taking mask into account.")
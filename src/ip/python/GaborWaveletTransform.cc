@@ -61,6 +61,37 @@ static inline const blitz::Array<std::complex<double>, 2> convert_image(bob::pyt
   }
 }
 
+template <class T> 
+static inline const blitz::Array<double,2> real_cast (bob::python::const_ndarray input){
+  blitz::Array<T,2> gray(input.type().shape[1],input.type().shape[2]);
+  bob::ip::rgb_to_gray(input.bz<T,3>(), gray);
+  return bob::core::array::cast<double>(gray);
+}
+
+//! converts the given real-valued image into a double gray image, so that the faster real-to-complex Fourier transform can be used
+static inline const blitz::Array<double, 2> convert_real_image(bob::python::const_ndarray input){
+  if (input.type().nd == 3){
+    // perform color type conversion
+    switch (input.type().dtype){
+      case bob::core::array::t_uint8: return real_cast<uint8_t>(input);
+      case bob::core::array::t_uint16: return real_cast<uint16_t>(input);
+      case bob::core::array::t_float64: return real_cast<double>(input);
+      default: throw bob::core::Exception();
+    }
+  } else {
+    switch (input.type().dtype){
+      case bob::core::array::t_uint8: return bob::core::array::cast<double>(input.bz<uint8_t,2>());
+      case bob::core::array::t_uint16: return bob::core::array::cast<double>(input.bz<uint16_t,2>());
+      case bob::core::array::t_float64: return input.bz<double,2>();
+      default: throw bob::core::Exception();
+    }
+  }
+}
+
+static inline bool is_complex(bob::python::const_ndarray input){
+  return input.type().dtype == bob::core::array::t_complex128;
+}
+
 static inline void transform (bob::ip::GaborKernel& kernel, blitz::Array<std::complex<double>,2>& input, blitz::Array<std::complex<double>,2>& output){
  // perform fft on input image
   bob::sp::FFT2D fft(input.extent(0), input.extent(1));
@@ -104,15 +135,21 @@ static blitz::Array<std::complex<double>,3> empty_trafo_image (bob::ip::GaborWav
 }
 
 static void perform_gwt_1 (bob::ip::GaborWaveletTransform& gwt, bob::python::const_ndarray input_image, bob::python::ndarray output_trafo_image){
-  const blitz::Array<std::complex<double>,2>& image = convert_image(input_image);
   blitz::Array<std::complex<double>,3> trafo_image = output_trafo_image.bz<std::complex<double>,3>();
-  gwt.performGWT(image, trafo_image);
+  if (is_complex(input_image)){
+    gwt.performGWT(convert_image(input_image), trafo_image);
+  } else {
+    gwt.performGWT(convert_real_image(input_image), trafo_image);
+  }
 }
 
 static blitz::Array<std::complex<double>,3> perform_gwt_2 (bob::ip::GaborWaveletTransform& gwt, bob::python::const_ndarray input_image){
-  const blitz::Array<std::complex<double>,2>& image = convert_image(input_image);
-  blitz::Array<std::complex<double>,3> trafo_image(gwt.numberOfKernels(), image.shape()[0], image.shape()[1]);
-  gwt.performGWT(image, trafo_image);
+  blitz::Array<std::complex<double>,3> trafo_image = empty_trafo_image(gwt, input_image);
+  if (is_complex(input_image)){
+    gwt.performGWT(convert_image(input_image), trafo_image);
+  } else {
+    gwt.performGWT(convert_real_image(input_image), trafo_image);
+  }
   return trafo_image;
 }
 
@@ -124,9 +161,8 @@ static bob::python::ndarray empty_jet_image(bob::ip::GaborWaveletTransform& gwt,
     return bob::python::ndarray (bob::core::array::t_float64, image.extent(0), image.extent(1), (int)gwt.numberOfKernels());
 }
 
-static void compute_jets_1(bob::ip::GaborWaveletTransform& gwt, bob::python::const_ndarray input_image, bob::python::ndarray output_jet_image, bool normalized){
-  const blitz::Array<std::complex<double>,2>& image = convert_image(input_image);
-
+template <class T>
+static void compute_jets(bob::ip::GaborWaveletTransform& gwt, const blitz::Array<T,2>& image, bob::python::ndarray output_jet_image, bool normalized){
   if (output_jet_image.type().nd == 3){
     // compute jet image with absolute values only
     blitz::Array<double,3> jet_image = output_jet_image.bz<double,3>();
@@ -137,12 +173,43 @@ static void compute_jets_1(bob::ip::GaborWaveletTransform& gwt, bob::python::con
   } else throw bob::core::array::UnexpectedShapeError();
 }
 
+static void compute_jets_1(bob::ip::GaborWaveletTransform& gwt, bob::python::const_ndarray input_image, bob::python::ndarray output_jet_image, bool normalized){
+  if (is_complex(input_image)){
+    compute_jets(gwt, convert_image(input_image), output_jet_image, normalized);
+  } else {
+    compute_jets(gwt, convert_real_image(input_image), output_jet_image, normalized);
+  }
+}
+
 static bob::python::ndarray compute_jets_2(bob::ip::GaborWaveletTransform& gwt, bob::python::const_ndarray input_image, bool include_phases, bool normalized){
   bob::python::ndarray output_jet_image = empty_jet_image(gwt, input_image, include_phases);
   compute_jets_1(gwt, input_image, output_jet_image, normalized);
   return output_jet_image;
 }
 
+static void compute_graph_jets_1(bob::ip::GaborWaveletTransform& gwt, bob::python::const_ndarray input_image, bob::python::const_ndarray positions, bob::python::ndarray output_graph_jets, bool normalized){
+  const blitz::Array<std::complex<double>,2>& image = convert_image(input_image);
+  const blitz::Array<int,2> nodes = positions.bz<int,2>();
+
+  if (output_graph_jets.type().nd == 2){
+    // compute Gabor jets with absolute values only
+    blitz::Array<double,2> graph_jets = output_graph_jets.bz<double,2>();
+    gwt.computeGraphJets(image, nodes, graph_jets, normalized);
+  } else if (output_graph_jets.type().nd == 3){
+    blitz::Array<double,3> graph_jets = output_graph_jets.bz<double,3>();
+    gwt.computeGraphJets(image, nodes, graph_jets, normalized);
+  } else throw bob::core::array::UnexpectedShapeError();
+}
+
+static bob::python::ndarray compute_graph_jets_2(bob::ip::GaborWaveletTransform& gwt, bob::python::const_ndarray input_image, bob::python::const_ndarray positions, bool include_phases, bool normalized){
+  int number_of_nodes = positions.type().shape[0];
+  bob::python::ndarray output_graph_jets = include_phases ?
+    bob::python::ndarray(bob::core::array::t_float64, number_of_nodes, 2, (int)gwt.numberOfKernels()) :
+    bob::python::ndarray(bob::core::array::t_float64, number_of_nodes, (int)gwt.numberOfKernels());
+  compute_graph_jets_1(gwt, input_image, positions, output_graph_jets, normalized);
+  return output_graph_jets;
+}
+
 
 static void normalize_gabor_jet(bob::python::ndarray gabor_jet){
   if (gabor_jet.type().nd == 1){
@@ -251,6 +318,13 @@ void bind_ip_gabor_wavelet_transform() {
     "The number of directions that this Gabor wavelet family holds."
   )
 
+  .add_property(
+    "number_of_threads",
+    &bob::ip::GaborWaveletTransform::numberOfThreads,
+    &bob::ip::GaborWaveletTransform::setNumberOfThreads,
+    "The number of threads that are used to compute the Gabor wavelet transform, i.e., the number of Gabor wavelets that are processed in parallel. If set to 0, all available cores are used."
+  )
+
   .def(
     "empty_trafo_image",
     &empty_trafo_image,
@@ -305,6 +379,20 @@ void bind_ip_gabor_wavelet_transform() {
     &compute_jets_2,
     (boost::python::arg("self"), boost::python::arg("input_image"), boost::python::arg("include_phases")=true, boost::python::arg("normalized")=true),
     "Performs a Gabor wavelet transform and returns the image of Gabor jets, with or without Gabor phases. If the normalized parameter is set to True (the default), the absolute parts of the Gabor jets are normalized to unit Euclidean length."
+  )
+
+  .def(
+    "compute_graph_jets",
+    &compute_graph_jets_1,
+    (boost::python::arg("self"), boost::python::arg("input_image"), boost::python::arg("positions"), boost::python::arg("output_graph_jets"), boost::python::arg("normalized")=true),
+    "Computes the Gabor jets only at the given (y,x) positions and fills the given array of Gabor jets (with or without Gabor phases). Instead of performing the full Gabor wavelet transform, the truncated spatial domain Gabor wavelets are applied at the given positions only. If the normalized parameter is set to True (the default), the absolute parts of the Gabor jets are normalized to unit Euclidean length."
+  )
+
+  .def(
+    "compute_graph_jets",
+    &compute_graph_jets_2,
+    (boost::python::arg("self"), boost::python::arg("input_image"), boost::python::arg("positions"), boost::python::arg("include_phases")=true, boost::python::arg("normalized")=true),
+    "Computes the Gabor jets only at the given (y,x) positions and returns them, with or without Gabor phases. Instead of performing the full Gabor wavelet transform, the truncated spatial domain Gabor wavelets are applied at the given positions only. If the normalized parameter is set to True (the default), the absolute parts of the Gabor jets are normalized to unit Euclidean length."
   );
 
   boost::python::def(
@@ -568,6 +568,68 @@ static object hog_call2_p(bob::ip::HOG<double>& obj,
   return output.self();
 }
 
+static void dense_hog_set_image(bob::ip::DenseHOG& obj, 
+  bob::python::const_ndarray input) 
+{
+  const bob::core::array::typeinfo& info = input.type();
+  switch (info.dtype) {
+    case bob::core::array::t_uint8: 
+      return obj.setImage(bob::core::array::cast<double>(input.bz<uint8_t,2>()));
+    case bob::core::array::t_uint16:
+      return obj.setImage(bob::core::array::cast<double>(input.bz<uint16_t,2>()));
+    case bob::core::array::t_float64: 
+      return obj.setImage(input.bz<double,2>());
+    default: 
+      PYTHON_ERROR(TypeError, 
+        "bob.ip.DenseHOG set_image does not support array with type '%s'.", 
+        info.str().c_str());
+  }
+}
+
+static object dense_hog_histogram(const bob::ip::DenseHOG& obj, 
+  const int y, const int x, const int height, const int width)
+{
+  bob::python::ndarray hist(bob::core::array::t_float64, obj.getCellDim());
+  blitz::Array<double,1> hist_ = hist.bz<double,1>();
+  obj.histogram(y, x, height, width, hist_);
+  return hist.self();
+}
+
+static void dense_hog_descriptor(const bob::ip::DenseHOG& obj, 
+  const int y, const int x, bob::python::ndarray output)
+{
+  blitz::Array<double,3> output_ = output.bz<double,3>();
+  obj.descriptor(y, x, output_);
+}
+
+static object dense_hog_descriptor_p(const bob::ip::DenseHOG& obj, 
+  const int y, const int x)
+{
+  const blitz::TinyVector<int,3> shape = obj.getOutputShape();
+  bob::python::ndarray output(bob::core::array::t_float64, 
+    shape(0), shape(1), shape(2));
+  dense_hog_descriptor(obj, y, x, output);
+  return output.self();
+}
+
+static void dense_hog_descriptors(const bob::ip::DenseHOG& obj, 
+  const size_t step_y, const size_t step_x, bob::python::ndarray output,
+  const size_t number_of_threads)
+{
+  blitz::Array<double,3> output_ = output.bz<double,3>();
+  obj.descriptors(step_y, step_x, output_, number_of_threads);
+}
+
+static object dense_hog_descriptors_p(const bob::ip::DenseHOG& obj, 
+  const size_t step_y, const size_t step_x, const size_t number_of_threads)
+{
+  const blitz::TinyVector<int,3> shape = obj.getGridShape(step_y, step_x);
+  bob::python::ndarray output(bob::core::array::t_float64, 
+    shape(0), shape(1), shape(2));
+  dense_hog_descriptors(obj, step_y, step_x, output, number_of_threads);
+  return output.self();
+}
+
 
 void bind_ip_hog() 
 {
@@ -764,4 +826,31 @@ void bind_ip_hog()
     .def("forward_", &hog_call2_p, (arg("input")),
       "Extract the HOG descriptors. This variant does not check the inputs.")
   ;
+
+  class_<bob::ip::DenseHOG, boost::shared_ptr<bob::ip::DenseHOG> >(
+      "DenseHOG", 
+      "Extracts HOG descriptors densely, e.g., for a sliding window detector. The gradients are computed once on the full image, and an integral image is built for each orientation bin, so that the histogram of any cell (and hence the descriptor of any window) is obtained with four look-ups per bin. All parameters, including the window size, are taken from a HOG extractor. Descriptors are identical to the ones of the HOG extractor applied on the window, except that the gradients at the window border are computed from the neighbouring image pixels.", 
+      init<const bob::ip::HOG<double>&>((arg("hog")),
+        "Constructs a new dense HOG extractor using the parameters of the given HOG extractor."))
+    .add_property("image_height", &bob::ip::DenseHOG::getImageHeight,
+      "Height of the current image.")
+    .add_property("image_width", &bob::ip::DenseHOG::getImageWidth,
+      "Width of the current image.")
+    .def("set_image", &dense_hog_set_image, (arg("self"), arg("image")),
+      "Computes the gradient maps and the integral histograms of the given image.")
+    .def("get_output_shape", &bob::ip::DenseHOG::getOutputShape, (arg("self")),
+      "The shape of the descriptor of one window.")
+    .def("get_grid_shape", &bob::ip::DenseHOG::getGridShape, (arg("self"), arg("step_y"), arg("step_x")),
+      "The shape of the output of descriptors() for the given window steps.")
+    .def("histogram", &dense_hog_histogram, (arg("self"), arg("y"), arg("x"), arg("height"), arg("width")),
+      "Returns the orientation histogram of the given rectangle of the image.")
+    .def("descriptor", &dense_hog_descriptor, (arg("self"), arg("y"), arg("x"), arg("output")),
+      "Computes the HOG descriptor of the window with the given top-left position.")
+    .def("descriptor", &dense_hog_descriptor_p, (arg("self"), arg("y"), arg("x")),
+      "Computes and returns the HOG descriptor of the window with the given top-left position.")
+    .def("descriptors", &dense_hog_descriptors, (arg("self"), arg("step_y"), arg("step_x"), arg("output"), arg("number_of_threads")=1),
+      "Computes the (flattened) HOG descriptors of all windows at positions that are multiples of the given steps; output[i,j] is the descriptor of the window at (i*step_y, j*step_x).")
+    .def("descriptors", &dense_hog_descriptors_p, (arg("self"), arg("step_y"), arg("step_x"), arg("number_of_threads")=1),
+      "Computes and returns the (flattened) HOG descriptors of all windows at positions that are multiples of the given steps.")
+  ;
 }
@@ -26,22 +26,23 @@
 #include <vector>
 #include <bob/ip/LBP.h>
 #include <bob/ip/LBPTop.h>
+#include <bob/ip/LBPTopStream.h>
 #include <bob/ip/LBPHSFeatures.h>
 
 using namespace boost::python;
 
 
 template <typename T>
-static void inner_call_inout (const bob::ip::LBP& lbp, bob::python::const_ndarray input, bob::python::ndarray output) {
+static void inner_call_inout (const bob::ip::LBP& lbp, bob::python::const_ndarray input, bob::python::ndarray output, size_t number_of_threads) {
   blitz::Array<uint16_t,2> out_ = output.bz<uint16_t,2>();
-  lbp(input.bz<T,2>(), out_);
+  lbp(input.bz<T,2>(), out_, number_of_threads);
 }
 
-static void call_inout (const bob::ip::LBP& lbp, bob::python::const_ndarray input, bob::python::ndarray output) {
+static void call_inout (const bob::ip::LBP& lbp, bob::python::const_ndarray input, bob::python::ndarray output, size_t number_of_threads) {
   switch(input.type().dtype) {
-    case bob::core::array::t_uint8: inner_call_inout<uint8_t>(lbp, input, output); break;
-    case bob::core::array::t_uint16: inner_call_inout<uint16_t>(lbp, input, output); break;
-    case bob::core::array::t_float64: inner_call_inout<double>(lbp, input, output); break;
+    case bob::core::array::t_uint8: inner_call_inout<uint8_t>(lbp, input, output, number_of_threads); break;
+    case bob::core::array::t_uint16: inner_call_inout<uint16_t>(lbp, input, output, number_of_threads); break;
+    case bob::core::array::t_float64: inner_call_inout<double>(lbp, input, output, number_of_threads); break;
     default: PYTHON_ERROR(TypeError, "LBP operator cannot process image of type '%s'", input.type().str().c_str()); break;
   }
 }
@@ -105,6 +106,26 @@ static void call_lbptop (const bob::ip::LBPTop& op, bob::python::const_ndarray i
   }
 }
 
+static bool lbptop_stream_push (bob::ip::LBPTopStream& op, bob::python::const_ndarray frame) {
+  const bob::core::array::typeinfo& info = frame.type();
+  if (info.nd == 3) {
+    if (info.dtype != bob::core::array::t_uint8) PYTHON_ERROR(TypeError, "LBPTopStream can only process color frames of type uint8, not '%s'", info.str().c_str());
+    return op.push(frame.bz<uint8_t,3>());
+  }
+  if (info.nd != 2) PYTHON_ERROR(TypeError, "LBPTopStream can only process 2D grayscale or 3D color frames, not '%s'", info.str().c_str());
+  switch(info.dtype) {
+    case bob::core::array::t_uint8: return op.push(frame.bz<uint8_t,2>());
+    case bob::core::array::t_uint16: return op.push(frame.bz<uint16_t,2>());
+    case bob::core::array::t_float64: return op.push(frame.bz<double,2>());
+    default: PYTHON_ERROR(TypeError, "LBPTopStream cannot process frames of type '%s'", info.str().c_str()); return false;
+  }
+}
+
+static tuple lbptop_stream_histograms (const bob::ip::LBPTopStream& op) {
+  blitz::Array<uint64_t,1> xy(op.getXY().getMaxLabel()), xt(op.getXT().getMaxLabel()), yt(op.getYT().getMaxLabel());
+  op.histograms(xy, xt, yt);
+  return make_tuple(xy, xt, yt);
+}
 
 template <typename T>
 static object inner_lbp_apply (bob::ip::LBPHSFeatures& op, bob::python::const_ndarray input) {
@@ -115,6 +136,21 @@ static object inner_lbp_apply (bob::ip::LBPHSFeatures& op, bob::python::const_nd
   return t;
 }
 
+template <typename T>
+static void inner_lbp_apply_inout (const bob::ip::LBPHSFeatures& op, bob::python::const_ndarray input, bob::python::ndarray output) {
+  blitz::Array<uint64_t,2> out_ = output.bz<uint64_t,2>();
+  op(input.bz<T,2>(), out_);
+}
+
+static void lbp_apply_inout (const bob::ip::LBPHSFeatures& op, bob::python::const_ndarray input, bob::python::ndarray output) {
+  switch(input.type().dtype) {
+    case bob::core::array::t_uint8: inner_lbp_apply_inout<uint8_t>(op, input, output); break;
+    case bob::core::array::t_uint16: inner_lbp_apply_inout<uint16_t>(op, input, output); break;
+    case bob::core::array::t_float64: inner_lbp_apply_inout<double>(op, input, output); break;
+    default: PYTHON_ERROR(TypeError, "LBPHS operator cannot process image of type '%s'", input.type().str().c_str()); break;
+  }
+}
+
 static object lbp_apply (bob::ip::LBPHSFeatures& op, bob::python::const_ndarray input) {
   switch(input.type().dtype) {
     case bob::core::array::t_uint8: return inner_lbp_apply<uint8_t>(op, input);
@@ -149,7 +185,7 @@ void bind_ip_lbp() {
     .add_property("relative_positions", &bob::ip::LBP::getRelativePositions)
 
     .def("get_lbp_shape", &get_shape, (arg("self"), arg("input")), "Get a tuple containing the expected size of the output when extracting LBP features.")
-    .def("__call__", &call_inout, (arg("self"), arg("input"), arg("output")), "Call an object of this type to extract LBP features for the whole image.")
+    .def("__call__", &call_inout, (arg("self"), arg("input"), arg("output"), arg("number_of_threads")=1), "Call an object of this type to extract LBP features for the whole image. The rows of the image are distributed over the given number of threads (0: all cores).")
     .def("__call__", &call_pos, (arg("self"), arg("input"), arg("y"), arg("x")), "Call an object of this type to extract LBP features for a given position in the image.")
     .def("__call__", &call_alloc, (arg("self"), arg("input")), "Call an object of this type to extract LBP features for the whole image.")
 
@@ -163,14 +199,32 @@ void bind_ip_lbp() {
     .def("__call__", &call_lbptop, (arg("self"),arg("input"), arg("xy"), arg("xt"), arg("yt")), "Processes a 3D array representing a set of <b>grayscale</b> images and returns (by argument) the three LBP planes calculated. The 3D array has to be arranged in this way:\n\n1st dimension => time\n2nd dimension => frame height\n3rd dimension => frame width\n\nThe central pixel is the point where the LBP planes intersect/have to be calculated from.")
     ;
 
+  class_<bob::ip::LBPTopStream, boost::shared_ptr<bob::ip::LBPTopStream> >("LBPTopStream", "Computes the LBP-Top planes of a video that is given frame by frame, e.g., while reading it with a bob.io.VideoReader. A ring buffer keeps the last 2*R_t+1 frames; each time push() returns True, the XY, XT and YT planes of the frame that lies R_t frames in the past are available. The XY codes of each frame are computed only once.",
+     init<const bob::ip::LBPTop&, optional<const size_t> >((arg("lbp_top"), arg("number_of_threads")=1), "Constructs a new stream using the operators of the given LBPTop; the XT and YT planes are computed by the given number of threads (0: all cores)."))
+    .def(init<const bob::ip::LBP&, const bob::ip::LBP&, const bob::ip::LBP&, optional<const size_t> >((arg("xy"), arg("xt"), arg("yt"), arg("number_of_threads")=1), "Constructs a new stream from the three LBP operators; the XT plane is (time, x), the YT plane is (time, y)."))
+    .add_property("xy", make_function(&bob::ip::LBPTopStream::getXY, return_value_policy<copy_const_reference>()))
+    .add_property("xt", make_function(&bob::ip::LBPTopStream::getXT, return_value_policy<copy_const_reference>()))
+    .add_property("yt", make_function(&bob::ip::LBPTopStream::getYT, return_value_policy<copy_const_reference>()))
+    .add_property("xy_plane", make_function(&bob::ip::LBPTopStream::xyPlane, return_value_policy<copy_const_reference>()), "The LBP codes of the XY plane of the current frame")
+    .add_property("xt_plane", make_function(&bob::ip::LBPTopStream::xtPlane, return_value_policy<copy_const_reference>()), "The LBP codes of the XT plane of the current frame")
+    .add_property("yt_plane", make_function(&bob::ip::LBPTopStream::ytPlane, return_value_policy<copy_const_reference>()), "The LBP codes of the YT plane of the current frame")
+    .add_property("frame", &bob::ip::LBPTopStream::frame, "The index of the frame of which the planes are currently available, or -1 if no time step has been completed yet")
+    .add_property("number_of_frames", &bob::ip::LBPTopStream::numberOfFrames, "The number of frames pushed so far")
+    .add_property("time_radius", &bob::ip::LBPTopStream::timeRadius, "The number of frames that the current frame lags behind the last pushed one")
+    .def("push", &lbptop_stream_push, (arg("self"), arg("frame")), "Pushes the next frame, either a 2D grayscale image or a 3D uint8 color image as read from a bob.io.VideoReader. Returns True if the planes of a new frame are available.")
+    .def("histograms", &lbptop_stream_histograms, (arg("self")), "Returns the histograms of the LBP codes of the XY, XT and YT planes of the current frame as a tuple.")
+    .def("reset", &bob::ip::LBPTopStream::reset, (arg("self")), "Forgets all frames pushed so far.")
+    ;
+
 
   class_<bob::ip::LBPHSFeatures, boost::shared_ptr<bob::ip::LBPHSFeatures> >("LBPHSFeatures", "Constructs a new LBPHSFeatures object to extract histogram of LBP over 2D blitz arrays/images.", no_init)
     .def(init<const int, const int, const int, const int, optional<const double, const int, const bool, const bool, const bool, const bool, const bool> >((arg("block_h"), arg("block_w"), arg("overlap_h"), arg("overlap_w"), arg("lbp_radius")=1., arg("lbp_neighbours")=8, arg("circular")=false,arg("to_average")=false,arg("add_average_bit")=false,arg("uniform")=false, arg("rotation_invariant")=false), "Constructs a new LBPHS features extractor creating a new LBP extractor with the given parameters."))
     .def(init<const int, const int, const int, const int, const bob::ip::LBP& >((arg("block_h"), arg("block_w"), arg("overlap_h"), arg("overlap_w"), arg("lbp")), "Constructs a new LBPHS features extractor using the given LBP extractor."))
     .add_property("n_bins", &bob::ip::LBPHSFeatures::getNBins)
-    .def("get_n_blocks", (const int (bob::ip::LBPHSFeatures::*)(const blitz::Array<uint8_t,2>& src))&bob::ip::LBPHSFeatures::getNBlocks<uint8_t>, (arg("self"),arg("input")), "Return the number of blocks generated when extracting LBPHS Features on the given input")
-    .def("get_n_blocks", (const int (bob::ip::LBPHSFeatures::*)(const blitz::Array<uint16_t,2>& src))&bob::ip::LBPHSFeatures::getNBlocks<uint16_t>, (arg("self"),arg("input")), "Return the number of blocks generated when extracting LBPHS Features on the given input")
-    .def("get_n_blocks", (const int (bob::ip::LBPHSFeatures::*)(const blitz::Array<double,2>& src))&bob::ip::LBPHSFeatures::getNBlocks<double>, (arg("self"),arg("input")), "Return the number of blocks generated when extracting LBPHS Features on the given input")
+    .def("get_n_blocks", (const int (bob::ip::LBPHSFeatures::*)(const blitz::Array<uint8_t,2>& src) const)&bob::ip::LBPHSFeatures::getNBlocks<uint8_t>, (arg("self"),arg("input")), "Return the number of blocks generated when extracting LBPHS Features on the given input")
+    .def("get_n_blocks", (const int (bob::ip::LBPHSFeatures::*)(const blitz::Array<uint16_t,2>& src) const)&bob::ip::LBPHSFeatures::getNBlocks<uint16_t>, (arg("self"),arg("input")), "Return the number of blocks generated when extracting LBPHS Features on the given input")
+    .def("get_n_blocks", (const int (bob::ip::LBPHSFeatures::*)(const blitz::Array<double,2>& src) const)&bob::ip::LBPHSFeatures::getNBlocks<double>, (arg("self"),arg("input")), "Return the number of blocks generated when extracting LBPHS Features on the given input")
     .def("__call__", &lbp_apply, (arg("self"),arg("input")), "Call an object of this type to extract LBP Histogram features.")
+    .def("__call__", &lbp_apply_inout, (arg("self"),arg("input"),arg("output")), "Call an object of this type to extract LBP Histogram features into the given 2D uint64 array of shape (get_n_blocks(input), n_bins), whose rows receive the histograms of the blocks. The LBP codes of the whole image are computed only once.")
     ;
 }
@@ -21,6 +21,7 @@
 
 #include <bob/machine/GMMMachine.h>
 #include <bob/core/assert.h>
+#include <bob/core/instrument.h>
 #include <bob/machine/Exception.h>
 #include <bob/math/log.h>
 
@@ -242,6 +243,9 @@ double bob::machine::GMMMachine::logLikelihood(const blitz::Array<double, 1> &x,
 double bob::machine::GMMMachine::logLikelihood_(const blitz::Array<double, 1> &x,
   blitz::Array<double,1> &log_weighted_gaussian_likelihoods) const
 {
+  BOB_COUNT("machine.gmm.samples", 1);
+  BOB_COUNT("machine.gmm.gaussians", m_n_gaussians);
+
   // Initialise variables
   double log_likelihood = bob::math::Log::LogZero;
 
@@ -285,6 +289,7 @@ void bob::machine::GMMMachine::forward_(const blitz::Array<double,1>& input,
 
 void bob::machine::GMMMachine::accStatistics(const blitz::Array<double,2>& input,
     bob::machine::GMMStats& stats) const {
+  BOB_TIME_SCOPE("machine.gmm.acc_statistics");
   // iterate over data
   blitz::Range a = blitz::Range::all();
   for(int i=0; i<input.extent(0); ++i) {
@@ -296,6 +301,7 @@ void bob::machine::GMMMachine::accStatistics(const blitz::Array<double,2>& input
 }
 
 void bob::machine::GMMMachine::accStatistics_(const blitz::Array<double,2>& input, bob::machine::GMMStats& stats) const {
+  BOB_TIME_SCOPE("machine.gmm.acc_statistics");
   // iterate over data
   blitz::Range a = blitz::Range::all();
   for(int i=0; i<input.extent(0); ++i) {
@@ -21,6 +21,8 @@
  */
 
 #include <bob/machine/GaborGraphMachine.h>
+#include <bob/core/parallel.h>
+#include <boost/bind.hpp>
 #include <complex>
 
 /**
@@ -180,6 +182,46 @@ void bob::machine::GaborGraphMachine::extract(
   }
 }
 
+/**
+ * Computes the Gabor jets (including phase information) at the node positions directly from the given image.
+ * Only the Gabor wavelet responses at the node positions are computed, see bob::ip::GaborWaveletTransform::computeGraphJets.
+ * @param gwt         The Gabor wavelet transform to use
+ * @param gray_image  The image to extract the Gabor jets from
+ * @param graph_jets  The graph that will be filled
+ * @param do_normalize Shall the Gabor jets be normalized?
+ */
+void bob::machine::GaborGraphMachine::extract(
+  bob::ip::GaborWaveletTransform& gwt,
+  const blitz::Array<std::complex<double>,2>& gray_image,
+  blitz::Array<double,3>& graph_jets,
+  bool do_normalize
+) const {
+  // check the positions
+  checkPositions(gray_image.shape()[0], gray_image.shape()[1]);
+  // compute Gabor jets
+  gwt.computeGraphJets(gray_image, m_node_positions, graph_jets, do_normalize);
+}
+
+/**
+ * Computes the Gabor jets (without phase information) at the node positions directly from the given image.
+ * Only the Gabor wavelet responses at the node positions are computed, see bob::ip::GaborWaveletTransform::computeGraphJets.
+ * @param gwt         The Gabor wavelet transform to use
+ * @param gray_image  The image to extract the Gabor jets from
+ * @param graph_jets  The graph that will be filled
+ * @param do_normalize Shall the Gabor jets be normalized?
+ */
+void bob::machine::GaborGraphMachine::extract(
+  bob::ip::GaborWaveletTransform& gwt,
+  const blitz::Array<std::complex<double>,2>& gray_image,
+  blitz::Array<double,2>& graph_jets,
+  bool do_normalize
+) const {
+  // check the positions
+  checkPositions(gray_image.shape()[0], gray_image.shape()[1]);
+  // compute Gabor jets
+  gwt.computeGraphJets(gray_image, m_node_positions, graph_jets, do_normalize);
+}
+
 
 /**
  * Averages the given set of Gabor graphs into a single one by interpolating the Gabor jets
@@ -317,6 +359,98 @@ double bob::machine::GaborGraphMachine::similarity(
 }
 
 
+/**
+ * Computes the average node similarities of the probe graph to the gallery graphs [begin, end).
+ * All graphs are stored contiguously, each node holds jet_size values.
+ */
+static void gallery_similarities(
+  size_t,
+  size_t begin,
+  size_t end,
+  const double* gallery,
+  const double* probe,
+  int nodes,
+  int jet_length,
+  bool with_phases,
+  const bob::machine::GaborJetSimilarity& jet_similarity_function,
+  blitz::Array<double,1>& scores
+)
+{
+  const int jet_size = with_phases ? 2 * jet_length : jet_length;
+  blitz::TinyVector<double,2> disparity;
+  for (size_t p = begin; p < end; ++p){
+    const double* model = gallery + p * nodes * jet_size;
+    double similarity = 0.;
+    for (int i = 0; i < nodes; ++i){
+      if (with_phases)
+        similarity += jet_similarity_function.similarity(model + i * jet_size, probe + i * jet_size, jet_length, disparity);
+      else
+        similarity += jet_similarity_function.similarity(model + i * jet_size, probe + i * jet_size, jet_length);
+    }
+    scores((int)p) = similarity / nodes;
+  }
+}
+
+/**
+ * Computes the similarities of the given probe graph to each graph of the given gallery.
+ * The similarity to each gallery graph is identical to the one computed by similarity(model_graph_jets, probe_graph_jets, jet_similarity_function).
+ * @param gallery_graph_jets  The gallery of N Gabor graphs (absolute values only)
+ * @param probe_graph_jets    The probe graph to compare
+ * @param jet_similarity_function  The similarity function to be used for comparison of two corresponding Gabor jets
+ * @param scores  The N similarities of the probe to the gallery graphs
+ * @param number_of_threads  The number of threads to use; 0 means: all cores
+ */
+void bob::machine::GaborGraphMachine::similarities(
+  const blitz::Array<double,3>& gallery_graph_jets,
+  const blitz::Array<double,2>& probe_graph_jets,
+  const bob::machine::GaborJetSimilarity& jet_similarity_function,
+  blitz::Array<double,1>& scores,
+  unsigned number_of_threads
+) const
+{
+  bob::core::array::assertCZeroBaseContiguous(gallery_graph_jets);
+  bob::core::array::assertCZeroBaseContiguous(probe_graph_jets);
+  bob::core::array::assertSameShape(probe_graph_jets, blitz::shape(gallery_graph_jets.extent(1), gallery_graph_jets.extent(2)));
+  bob::core::array::assertSameShape(scores, blitz::shape(gallery_graph_jets.extent(0)));
+
+  bob::core::parallel_for(gallery_graph_jets.extent(0),
+    boost::bind(&gallery_similarities, _1, _2, _3, gallery_graph_jets.data(), probe_graph_jets.data(),
+      gallery_graph_jets.extent(1), gallery_graph_jets.extent(2), false,
+      boost::cref(jet_similarity_function), boost::ref(scores)),
+    number_of_threads);
+}
+
+/**
+ * Computes the similarities of the given probe graph to each graph of the given gallery.
+ * The similarity to each gallery graph is identical to the one computed by similarity(model_graph_jets, probe_graph_jets, jet_similarity_function).
+ * @param gallery_graph_jets  The gallery of N Gabor graphs (absolute values and phases)
+ * @param probe_graph_jets    The probe graph to compare
+ * @param jet_similarity_function  The similarity function to be used for comparison of two corresponding Gabor jets
+ * @param scores  The N similarities of the probe to the gallery graphs
+ * @param number_of_threads  The number of threads to use; 0 means: all cores
+ */
+void bob::machine::GaborGraphMachine::similarities(
+  const blitz::Array<double,4>& gallery_graph_jets,
+  const blitz::Array<double,3>& probe_graph_jets,
+  const bob::machine::GaborJetSimilarity& jet_similarity_function,
+  blitz::Array<double,1>& scores,
+  unsigned number_of_threads
+) const
+{
+  bob::core::array::assertCZeroBaseContiguous(gallery_graph_jets);
+  bob::core::array::assertCZeroBaseContiguous(probe_graph_jets);
+  bob::core::array::assertSameShape(probe_graph_jets, blitz::shape(gallery_graph_jets.extent(1), gallery_graph_jets.extent(2), gallery_graph_jets.extent(3)));
+  bob::core::array::assertSameDimensionLength(gallery_graph_jets.extent(2), 2);
+  bob::core::array::assertSameShape(scores, blitz::shape(gallery_graph_jets.extent(0)));
+
+  bob::core::parallel_for(gallery_graph_jets.extent(0),
+    boost::bind(&gallery_similarities, _1, _2, _3, gallery_graph_jets.data(), probe_graph_jets.data(),
+      gallery_graph_jets.extent(1), gallery_graph_jets.extent(3), true,
+      boost::cref(jet_similarity_function), boost::ref(scores)),
+    number_of_threads);
+}
+
+
 void bob::machine::GaborGraphMachine::save(bob::io::HDF5File& file) const{
   file.setArray("NodePositions", m_node_positions);
 }
@@ -37,12 +37,18 @@ static double sqr(double x){return x*x;}
 
 void bob::machine::GaborJetSimilarity::init(){
   m_disparity = 0.;
-  m_confidences.resize(m_gwt.numberOfKernels());
-  std::fill(m_confidences.begin(), m_confidences.end(), 0.);
-  m_phase_differences.resize(m_gwt.numberOfKernels());
-  std::fill(m_phase_differences.begin(), m_phase_differences.end(), 0.);
+
+  // store the kernel frequencies in contiguous memory
+  const std::vector<blitz::TinyVector<double,2> >& kernels = m_gwt.kernelFrequencies();
+  m_kernels_x.resize(kernels.size());
+  m_kernels_y.resize(kernels.size());
+  for (unsigned j = 0; j < kernels.size(); ++j){
+    m_kernels_x[j] = kernels[j][1];
+    m_kernels_y[j] = kernels[j][0];
+  }
 
   // used for disparity-like similarity functions only...
+  m_wavelet_extends.clear();
   m_wavelet_extends.reserve(m_gwt.numberOfScales());
   for (unsigned level = 0; level < m_gwt.numberOfScales(); ++level){
     blitz::TinyVector<double,2> k = m_gwt.kernelFrequencies()[level * m_gwt.numberOfDirections()];
@@ -57,18 +63,52 @@ double bob::machine::GaborJetSimilarity::operator()(const blitz::Array<double,1>
   bob::core::array::assertCZeroBaseContiguous(jet2);
   bob::core::array::assertSameShape(jet1,jet2);
 
+  return similarity(jet1.data(), jet2.data(), jet1.extent(0));
+}
+
+
+double bob::machine::GaborJetSimilarity::operator()(const blitz::Array<double,2>& jet1, const blitz::Array<double,2>& jet2) const{
+  return operator()(jet1, jet2, m_disparity);
+}
+
+
+double bob::machine::GaborJetSimilarity::operator()(const blitz::Array<double,2>& jet1, const blitz::Array<double,2>& jet2, blitz::TinyVector<double,2>& disparity) const{
+  if (m_type == SCALAR_PRODUCT || m_type == CANBERRA){
+    // call the function without phases
+    return operator()(jet1(0,blitz::Range::all()), jet2(0,blitz::Range::all()));
+  }
+
+  // Here, only the disparity based similarity functions are executed
+  bob::core::array::assertCZeroBaseContiguous(jet1);
+  bob::core::array::assertCZeroBaseContiguous(jet2);
+  bob::core::array::assertSameShape(jet1,jet2);
+
+  return similarity(jet1.data(), jet2.data(), jet1.extent(1), disparity);
+}
+
+
+/**
+ * Computes the similarity of two Gabor jets that contain absolute values only.
+ * @param jet1   The first Gabor jet, stored contiguously
+ * @param jet2   The second Gabor jet, stored contiguously
+ * @param length The length of the Gabor jets
+ * @return The similarity of the two Gabor jets
+ */
+double bob::machine::GaborJetSimilarity::similarity(const double* jet1, const double* jet2, int length) const{
   switch (m_type){
-    case SCALAR_PRODUCT:
+    case SCALAR_PRODUCT:{
       // normalized scalar product
-      return std::inner_product(jet1.begin(), jet1.end(), jet2.begin(), 0.);
+      double sim = 0.;
+      for (int j = 0; j < length; ++j)
+        sim += jet1[j] * jet2[j];
+      return sim;
+    }
     case CANBERRA:{
       // Canberra similarity
       double sim = 0.;
-      unsigned size = jet1.shape()[0];
-      for (unsigned j = size; j--;){
-        sim += 1. - std::abs(jet1(j) - jet2(j)) / (jet1(j) + jet2(j));
-      }
-      return sim / size;
+      for (int j = 0; j < length; ++j)
+        sim += 1. - std::abs(jet1[j] - jet2[j]) / (jet1[j] + jet2[j]);
+      return sim / length;
     }
     default:
       throw bob::core::NotImplementedError("Disparity similarity (and its derivatives) need Gabor jets including phases");
@@ -76,31 +116,47 @@ double bob::machine::GaborJetSimilarity::operator()(const blitz::Array<double,1>
 }
 
 
-double bob::machine::GaborJetSimilarity::operator()(const blitz::Array<double,2>& jet1, const blitz::Array<double,2>& jet2) const{
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////  Disparity estimation  /////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static double adjustPhase(double phase){
+  return phase - (2.*M_PI)*round(phase / (2.*M_PI));
+}
+
+/**
+ * Computes the similarity of two Gabor jets including phases.
+ * Each Gabor jet is stored contiguously with all absolute values first, followed by all phases.
+ * This function does not modify any member, so it can be called concurrently from several threads.
+ * @param jet1  The first Gabor jet
+ * @param jet2  The second Gabor jet
+ * @param length The length of the Gabor jets, i.e., the number of absolute values
+ * @param disparity  The disparity vector that is estimated from the phase differences (for disparity-like functions only)
+ * @return The similarity of the two Gabor jets
+ */
+double bob::machine::GaborJetSimilarity::similarity(const double* jet1, const double* jet2, int length, blitz::TinyVector<double,2>& disparity) const{
   if (m_type == SCALAR_PRODUCT || m_type == CANBERRA){
-    // call the function without phases
-    return operator()(jet1(0,blitz::Range::all()), jet2(0,blitz::Range::all()));
+    // use only the absolute values
+    return similarity(jet1, jet2, length);
   }
 
-  // Here, only the disparity based similarity functions are executed
-  bob::core::array::assertCZeroBaseContiguous(jet1);
-  bob::core::array::assertCZeroBaseContiguous(jet2);
-  bob::core::array::assertSameShape(jet1,jet2);
+  // the disparity estimation requires one absolute value and phase per Gabor wavelet
+  bob::core::array::assertSameDimensionLength(length, m_kernels_x.size());
 
-  // compute confidence vectors
-  compute_confidences(jet1, jet2);
+  const double* abs1 = jet1, * phase1 = jet1 + length;
+  const double* abs2 = jet2, * phase2 = jet2 + length;
 
   // now, compute the disparity
-  compute_disparity();
+  compute_disparity(abs1, phase1, abs2, phase2, disparity);
 
-  const std::vector<blitz::TinyVector<double,2> >& kernels = m_gwt.kernelFrequencies();
+  const double* kx = &m_kernels_x[0], * ky = &m_kernels_y[0];
+  const double dx = disparity[1], dy = disparity[0];
 
   switch (m_type){
     case DISPARITY:{
       // compute the similarity using the estimated disparity
       double sum = 0.;
-      for (int j = m_confidences.size(); j--;){
-        sum += m_confidences[j] * cos(m_phase_differences[j] - m_disparity[0] * kernels[j][0] - m_disparity[1] * kernels[j][1]);
+      for (int j = 0; j < length; ++j){
+        sum += abs1[j] * abs2[j] * cos(phase1[j] - phase2[j] - dy * ky[j] - dx * kx[j]);
       }
       return sum;
     } // DISPARITY
@@ -108,22 +164,22 @@ double bob::machine::GaborJetSimilarity::operator()(const blitz::Array<double,2>
     case PHASE_DIFF:{
       // compute the similarity using the estimated disparity
       double sum = 0.;
-      for (int j = m_phase_differences.size(); j--;){
-        sum += cos(m_phase_differences[j] - m_disparity[0] * kernels[j][0] - m_disparity[1] * kernels[j][1]);
+      for (int j = 0; j < length; ++j){
+        sum += cos(phase1[j] - phase2[j] - dy * ky[j] - dx * kx[j]);
       }
-      return sum / jet1.shape()[1];
+      return sum / length;
     } // PHASE_DIFF
 
     case PHASE_DIFF_PLUS_CANBERRA:{
       // compute the similarity using the estimated disparity
       double sum = 0.;
-      for (int j = m_phase_differences.size(); j--;){
+      for (int j = 0; j < length; ++j){
         // add disparity term
-        sum += cos(m_phase_differences[j] - m_disparity[0] * kernels[j][0] - m_disparity[1] * kernels[j][1]);
+        sum += cos(phase1[j] - phase2[j] - dy * ky[j] - dx * kx[j]);
         // add Canberra term
-        sum += 1. - std::abs(jet1(0,j) - jet2(0,j)) / (jet1(0,j) + jet2(0,j));
+        sum += 1. - std::abs(abs1[j] - abs2[j]) / (abs1[j] + abs2[j]);
       }
-      return sum / (2. * jet1.shape()[1]);
+      return sum / (2. * length);
     }
 
     default:
@@ -132,37 +188,20 @@ double bob::machine::GaborJetSimilarity::operator()(const blitz::Array<double,2>
   }
 }
 
-
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-////////////////  Disparity estimation  /////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-static double adjustPhase(double phase){
-  return phase - (2.*M_PI)*round(phase / (2.*M_PI));
-}
-
-void bob::machine::GaborJetSimilarity::compute_confidences(const blitz::Array<double,2>& jet1, const blitz::Array<double,2>& jet2) const{
-  // first, fill confidence and phase difference vectors
-  for (int j = m_confidences.size(); j--;){
-    m_confidences[j] = jet1(0,j) * jet2(0,j);
-    m_phase_differences[j] = adjustPhase(jet1(1,j) - jet2(1,j));
-  }
-}
-
-void bob::machine::GaborJetSimilarity::compute_disparity() const{
+void bob::machine::GaborJetSimilarity::compute_disparity(const double* abs1, const double* phase1, const double* abs2, const double* phase2, blitz::TinyVector<double,2>& disparity) const{
   // approximate the disparity from the phase differences
   double gamma_x_x = 0., gamma_x_y = 0., gamma_y_y = 0., phi_x = 0., phi_y = 0.;
   // initialize the disparity with 0
-  m_disparity = 0.;
+  disparity = 0.;
 
-  const std::vector<blitz::TinyVector<double,2> >& kernels = m_gwt.kernelFrequencies();
   // iterate backwards through the vector to start with the lowest frequency wavelets
-  for (int j = m_confidences.size()-1, level = m_gwt.numberOfScales()-1; level >= 0; --level){
+  for (int j = m_kernels_x.size()-1, level = m_gwt.numberOfScales()-1; level >= 0; --level){
     for (int direction = m_gwt.numberOfDirections()-1; direction >= 0; --direction, --j){
       double
-          kjx = kernels[j][1],
-          kjy = kernels[j][0],
-          conf = m_confidences[j],
-          diff = m_phase_differences[j];
+          kjx = m_kernels_x[j],
+          kjy = m_kernels_y[j],
+          conf = abs1[j] * abs2[j],
+          diff = adjustPhase(phase1[j] - phase2[j]);
 
       // totalize gamma matrix
       gamma_x_x += kjx * kjx * conf;
@@ -171,7 +210,7 @@ void bob::machine::GaborJetSimilarity::compute_disparity() const{
 
       // totalize phi vector
       // estimate the number of cycles that we are off
-      double nL = round((diff - m_disparity[1] * kjx - m_disparity[0] * kjy) / (2.*M_PI));
+      double nL = round((diff - disparity[1] * kjx - disparity[0] * kjy) / (2.*M_PI));
       // totalize corrected phi vector elements
       phi_x += (diff - nL * 2. * M_PI) * conf * kjx;
       phi_y += (diff - nL * 2. * M_PI) * conf * kjy;
@@ -179,8 +218,8 @@ void bob::machine::GaborJetSimilarity::compute_disparity() const{
 
     // re-calculate disparity as d=\Gamma^{-1}\Phi of the (low frequency) wavelet scales that we used up to now
     double gamma_det = gamma_x_x * gamma_y_y - sqr(gamma_x_y);
-    m_disparity[1] = (gamma_y_y * phi_x - gamma_x_y * phi_y) / gamma_det;
-    m_disparity[0] = (gamma_x_x * phi_y - gamma_x_y * phi_x) / gamma_det;
+    disparity[1] = (gamma_y_y * phi_x - gamma_x_y * phi_y) / gamma_det;
+    disparity[0] = (gamma_x_x * phi_y - gamma_x_y * phi_x) / gamma_det;
 
   } // for level
 }
@@ -0,0 +1,83 @@
+/**
+ * @file machine/cxx/benchmark/GMMMachine.cc
+ * @date 2013-07-04
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Measures the accumulation of GMM statistics over random samples,
+ * for typical numbers of Gaussians and feature dimensions.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/random.hpp>
+#include <blitz/array.h>
+
+#include "bob/core/benchmark.h"
+#include "bob/machine/GMMMachine.h"
+#include "bob/machine/GMMStats.h"
+
+using bob::core::benchmark::param;
+
+struct AccStatistics {
+  const bob::machine::GMMMachine& gmm;
+  const blitz::Array<double,2>& samples;
+  bob::machine::GMMStats& stats;
+  void operator()() const {
+    stats.init();
+    gmm.accStatistics_(samples, stats);
+  }
+};
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("machine_GMMMachine", argc, argv);
+  const int gaussians[] = {16, 256, 512};
+  const int dimensions[] = {20, 60};
+  const int n_samples = 1000;
+
+  boost::mt19937 rng;
+  boost::normal_distribution<> normal;
+  boost::uniform_real<> uniform(0.5, 1.5);
+
+  for (int g = 0; g < 3; ++g){
+    for (int d = 0; d < 2; ++d){
+      const int G = gaussians[g], D = dimensions[d];
+      // random means around the origin, unit-ish variances, uniform weights
+      blitz::Array<double,2> means(G, D), variances(G, D), samples(n_samples, D);
+      for (int i = 0; i < G; ++i)
+        for (int j = 0; j < D; ++j){
+          means(i,j) = normal(rng);
+          variances(i,j) = uniform(rng);
+        }
+      for (int i = 0; i < n_samples; ++i)
+        for (int j = 0; j < D; ++j)
+          samples(i,j) = normal(rng);
+      blitz::Array<double,1> weights(G);
+      weights = 1. / G;
+
+      bob::machine::GMMMachine gmm(G, D);
+      gmm.setMeans(means);
+      gmm.setVariances(variances);
+      gmm.setWeights(weights);
+      bob::machine::GMMStats stats(G, D);
+
+      AccStatistics acc = {gmm, samples, stats};
+      suite.run("accStatistics",
+          param("gaussians", G) + "," + param("dim", D) + "," +
+          param("samples", n_samples), acc);
+    }
+  }
+
+  return suite.finish();
+}
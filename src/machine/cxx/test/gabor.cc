@@ -125,3 +125,57 @@ BOOST_AUTO_TEST_CASE( test_gabor_graph_machine )
     BOOST_CHECK_CLOSE(similarity, 1., epsilon);
   }
 }
+
+BOOST_AUTO_TEST_CASE( test_gabor_graph_similarities )
+{
+  // create a gallery of graphs with deterministic pseudo-random jets
+  bob::ip::GaborWaveletTransform gwt;
+  const int gallery_size = 7, nodes = 5, length = gwt.numberOfKernels();
+  blitz::Array<double,4> gallery(gallery_size, nodes, 2, length);
+  blitz::Array<double,3> probe(nodes, 2, length);
+  unsigned seed = 42;
+  for (int p = 0; p <= gallery_size; ++p)
+    for (int n = 0; n < nodes; ++n)
+      for (int j = 0; j < length; ++j){
+        seed = seed * 1103515245u + 12345u;
+        double a = 0.1 + (seed % 1000) / 1000.;
+        seed = seed * 1103515245u + 12345u;
+        double ph = ((seed % 2000) / 1000. - 1.) * M_PI;
+        if (p < gallery_size){
+          gallery(p,n,0,j) = a; gallery(p,n,1,j) = ph;
+        } else {
+          probe(n,0,j) = a; probe(n,1,j) = ph;
+        }
+      }
+  // the absolute-value-only part of the gallery and the probe
+  blitz::Array<double,3> abs_gallery(gallery(blitz::Range::all(), blitz::Range::all(), 0, blitz::Range::all()).copy());
+  blitz::Array<double,2> abs_probe(probe(blitz::Range::all(), 0, blitz::Range::all()).copy());
+
+  bob::machine::GaborGraphMachine machine;
+  std::vector<boost::shared_ptr<bob::machine::GaborJetSimilarity> > sim_fcts;
+  sim_fcts.push_back(boost::shared_ptr<bob::machine::GaborJetSimilarity>(new bob::machine::GaborJetSimilarity(bob::machine::GaborJetSimilarity::SCALAR_PRODUCT)));
+  sim_fcts.push_back(boost::shared_ptr<bob::machine::GaborJetSimilarity>(new bob::machine::GaborJetSimilarity(bob::machine::GaborJetSimilarity::CANBERRA)));
+  sim_fcts.push_back(boost::shared_ptr<bob::machine::GaborJetSimilarity>(new bob::machine::GaborJetSimilarity(bob::machine::GaborJetSimilarity::DISPARITY, gwt)));
+  sim_fcts.push_back(boost::shared_ptr<bob::machine::GaborJetSimilarity>(new bob::machine::GaborJetSimilarity(bob::machine::GaborJetSimilarity::PHASE_DIFF,gwt)));
+  sim_fcts.push_back(boost::shared_ptr<bob::machine::GaborJetSimilarity>(new bob::machine::GaborJetSimilarity(bob::machine::GaborJetSimilarity::PHASE_DIFF_PLUS_CANBERRA,gwt)));
+
+  blitz::Array<double,1> scores(gallery_size);
+  for (int i = sim_fcts.size(); i--;){
+    // batched scores must be identical to the scores of the single comparisons, regardless of the number of threads
+    for (unsigned threads = 1; threads <= 3; ++threads){
+      machine.similarities(gallery, probe, *sim_fcts[i], scores, threads);
+      for (int p = 0; p < gallery_size; ++p){
+        blitz::Array<double,3> model(gallery(p, blitz::Range::all(), blitz::Range::all(), blitz::Range::all()).copy());
+        BOOST_CHECK_CLOSE(scores(p), machine.similarity(model, probe, *sim_fcts[i]), epsilon);
+      }
+    }
+
+    if (i < 2){
+      machine.similarities(abs_gallery, abs_probe, *sim_fcts[i], scores, 2);
+      for (int p = 0; p < gallery_size; ++p){
+        blitz::Array<double,2> model(abs_gallery(p, blitz::Range::all(), blitz::Range::all()).copy());
+        BOOST_CHECK_CLOSE(scores(p), machine.similarity(model, abs_probe, *sim_fcts[i]), epsilon);
+      }
+    }
+  }
+}
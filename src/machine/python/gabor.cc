@@ -103,6 +103,32 @@ static double bob_similarity(bob::machine::GaborGraphMachine& self, bob::python:
   }
 }
 
+static void bob_similarities(const bob::machine::GaborGraphMachine& self, bob::python::const_ndarray gallery_graphs, bob::python::const_ndarray probe_graph, const bob::machine::GaborJetSimilarity& similarity_function, bob::python::ndarray scores, unsigned number_of_threads){
+  blitz::Array<double,1> s = scores.bz<double,1>();
+  switch (probe_graph.type().nd){
+    case 2:{ // Gabor graphs including jets without phases
+      const blitz::Array<double,3> gallery = gallery_graphs.bz<double,3>();
+      const blitz::Array<double,2> probe = probe_graph.bz<double,2>();
+      self.similarities(gallery, probe, similarity_function, s, number_of_threads);
+      break;
+    }
+    case 3:{ // Gabor graphs including jets with phases
+      const blitz::Array<double,4> gallery = gallery_graphs.bz<double,4>();
+      const blitz::Array<double,3> probe = probe_graph.bz<double,3>();
+      self.similarities(gallery, probe, similarity_function, s, number_of_threads);
+      break;
+    }
+    default: // unknown graph shape
+      throw bob::core::array::UnexpectedShapeError();
+  }
+}
+
+static bob::python::ndarray bob_similarities2(const bob::machine::GaborGraphMachine& self, bob::python::const_ndarray gallery_graphs, bob::python::const_ndarray probe_graph, const bob::machine::GaborJetSimilarity& similarity_function, unsigned number_of_threads){
+  bob::python::ndarray scores(bob::core::array::t_float64, gallery_graphs.type().shape[0]);
+  bob_similarities(self, gallery_graphs, probe_graph, similarity_function, scores, number_of_threads);
+  return scores;
+}
+
 static double bob_jet_sim(const bob::machine::GaborJetSimilarity& self, bob::python::const_ndarray jet1, bob::python::const_ndarray jet2){
   switch (jet1.type().nd){
     case 1:{
@@ -259,6 +285,20 @@ void bind_machine_gabor(){
       &bob_similarity,
       (boost::python::arg("self"), boost::python::arg("model_graph_jets"), boost::python::arg("probe_graph_jets"), boost::python::arg("jet_similarity_function")),
       "Computes the similarity between the given probe graph and the gallery, which might be a single graph or a collection of graphs"
+    )
+
+    .def(
+      "similarities",
+      &bob_similarities,
+      (boost::python::arg("self"), boost::python::arg("gallery_graph_jets"), boost::python::arg("probe_graph_jets"), boost::python::arg("jet_similarity_function"), boost::python::arg("scores"), boost::python::arg("number_of_threads")=1),
+      "Computes the similarities between the given probe graph and each of the graphs in the gallery; the gallery graphs are distributed over the given number of threads (0: all cores)"
+    )
+
+    .def(
+      "similarities",
+      &bob_similarities2,
+      (boost::python::arg("self"), boost::python::arg("gallery_graph_jets"), boost::python::arg("probe_graph_jets"), boost::python::arg("jet_similarity_function"), boost::python::arg("number_of_threads")=1),
+      "Computes and returns the similarities between the given probe graph and each of the graphs in the gallery; the gallery graphs are distributed over the given number of threads (0: all cores)"
   );
 
 }
@@ -30,10 +30,73 @@
 #include <bob/core/check.h>
 #include <limits>
 
+/**
+ * Matrix operations required by the solvers, for dense and sparse A
+ */
+static int lp_rows(const blitz::Array<double,2>& A) { return A.extent(0); }
+static int lp_rows(const bob::math::SparseMatrix& A) { return A.rows(); }
+static int lp_cols(const blitz::Array<double,2>& A) { return A.extent(1); }
+static int lp_cols(const bob::math::SparseMatrix& A) { return A.cols(); }
+
+// y = A*x
+static void lp_prod(const blitz::Array<double,2>& A,
+  const blitz::Array<double,1>& x, blitz::Array<double,1>& y)
+{
+  bob::math::prod(A, x, y);
+}
+
+static void lp_prod(const bob::math::SparseMatrix& A,
+  const blitz::Array<double,1>& x, blitz::Array<double,1>& y)
+{
+  A.prod(x, y);
+}
+
+// y = transpose(A)*x
+static void lp_prod_t(const blitz::Array<double,2>& A,
+  const blitz::Array<double,1>& x, blitz::Array<double,1>& y)
+{
+  // ugly fix for old blitz version
+  const blitz::Array<double,2> A_t = 
+    const_cast<blitz::Array<double,2>&>(A).transpose(1,0);
+  bob::math::prod(A_t, x, y);
+}
+
+static void lp_prod_t(const bob::math::SparseMatrix& A,
+  const blitz::Array<double,1>& x, blitz::Array<double,1>& y)
+{
+  A.prodTrans(x, y);
+}
+
+// C = A*diag(d)*transpose(A)
+static void lp_prod_diag_t(const blitz::Array<double,2>& A,
+  const blitz::Array<double,1>& d, blitz::Array<double,2>& C,
+  blitz::Array<double,1>& work)
+{
+  const blitz::Range all = blitz::Range::all();
+  if (work.extent(0) != A.extent(1)) work.resize(A.extent(1));
+  for (int i=0; i<A.extent(0); ++i)
+  {
+    work = A(i,all) * d;
+    for (int j=0; j<=i; ++j)
+    {
+      C(i,j) = blitz::sum(work * A(j,all));
+      C(j,i) = C(i,j);
+    }
+  }
+}
+
+static void lp_prod_diag_t(const bob::math::SparseMatrix& A,
+  const blitz::Array<double,1>& d, blitz::Array<double,2>& C,
+  blitz::Array<double,1>& work)
+{
+  A.prodDiagTrans(d, C, work);
+}
+
 
 bob::math::LPInteriorPoint::LPInteriorPoint(const size_t M, const size_t N, 
     const double epsilon):
-  m_M(M), m_N(N), m_epsilon(epsilon), m_lambda(M), m_mu(N)
+  m_M(M), m_N(N), m_epsilon(epsilon), m_normal_equations(false),
+  m_lambda(M), m_mu(N)
 {
   m_lambda = 0.;
   m_mu = 0.;
@@ -43,6 +106,7 @@ bob::math::LPInteriorPoint::LPInteriorPoint(const size_t M, const size_t N,
 bob::math::LPInteriorPoint::LPInteriorPoint(
   const bob::math::LPInteriorPoint &other):
   m_M(other.m_M), m_N(other.m_N), m_epsilon(other.m_epsilon), 
+  m_normal_equations(other.m_normal_equations),
   m_lambda(bob::core::array::ccopy(other.m_lambda)),
   m_mu(bob::core::array::ccopy(other.m_mu))
 {
@@ -59,9 +123,15 @@ void bob::math::LPInteriorPoint::resetCache()
   m_cache_lambda.resize(m_M);
   m_cache_mu.resize(m_N);
 
-  m_cache_A_large.resize(m_M+2*m_N, m_M+2*m_N);
-  m_cache_b_large.resize(m_M+2*m_N);
+  // The large system is only allocated when it is used
+  m_cache_A_large.free();
+  m_cache_b_large.free();
   m_cache_x_large.resize(m_M+2*m_N);
+
+  m_cache_A_normal.resize(m_M, m_M);
+  m_cache_D.resize(m_N);
+  m_cache_r.resize(m_N);
+  m_cache_work.resize(m_N);
 }
 
 bob::math::LPInteriorPoint& bob::math::LPInteriorPoint::operator=(
@@ -72,6 +142,7 @@ bob::math::LPInteriorPoint& bob::math::LPInteriorPoint::operator=(
     m_M = other.m_M;
     m_N = other.m_N;
     m_epsilon = other.m_epsilon;
+    m_normal_equations = other.m_normal_equations;
     m_lambda = bob::core::array::ccopy(other.m_lambda);
     m_mu = bob::core::array::ccopy(other.m_mu);
     resetCache();
@@ -84,6 +155,7 @@ bool bob::math::LPInteriorPoint::operator==(
 {
   return (m_M == other.m_M && m_N == other.m_N && 
           m_epsilon == other.m_epsilon &&
+          m_normal_equations == other.m_normal_equations &&
           bob::core::array::isEqual(m_lambda, other.m_lambda) &&
           bob::core::array::isEqual(m_mu, other.m_mu));
 }
@@ -107,10 +179,27 @@ bool bob::math::LPInteriorPoint::isFeasible(const blitz::Array<double,2>& A,
   const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
   const blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
   const blitz::Array<double,1>& mu) const
+{
+  return isFeasibleImpl(A, b, c, x, lambda, mu);
+}
+
+bool bob::math::LPInteriorPoint::isFeasible(const bob::math::SparseMatrix& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  const blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
+  const blitz::Array<double,1>& mu) const
+{
+  return isFeasibleImpl(A, b, c, x, lambda, mu);
+}
+
+template <typename TMatrix>
+bool bob::math::LPInteriorPoint::isFeasibleImpl(const TMatrix& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  const blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
+  const blitz::Array<double,1>& mu) const
 {
   // Check
-  bob::core::array::assertSameDimensionLength(A.extent(0), m_M);
-  bob::core::array::assertSameDimensionLength(A.extent(1), m_N);
+  bob::core::array::assertSameDimensionLength(lp_rows(A), m_M);
+  bob::core::array::assertSameDimensionLength(lp_cols(A), m_N);
   bob::core::array::assertSameDimensionLength(b.extent(0), m_M);
   bob::core::array::assertSameDimensionLength(c.extent(0), m_N);
   bob::core::array::assertSameDimensionLength(x.extent(0), m_N);
@@ -126,16 +215,13 @@ bool bob::math::LPInteriorPoint::isFeasible(const blitz::Array<double,2>& A,
     return false;
 
   // A*x = b (abs(A*x-b)<=epsilon)
-  bob::math::prod(A, x, m_cache_M);
+  lp_prod(A, x, m_cache_M);
   m_cache_M -= b;
   if (blitz::any(blitz::fabs(m_cache_M) > m_epsilon))
     return false;
 
   // A'*lambda + mu = c (abs(A'*lambda+mu-c)<=epsilon)
-  // ugly fix for old blitz version
-  const blitz::Array<double,2> A_t = 
-    const_cast<blitz::Array<double,2>&>(A).transpose(1,0); 
-  bob::math::prod(A_t, lambda, m_cache_N);
+  lp_prod_t(A, lambda, m_cache_N);
   m_cache_N += mu - c;
   return (!blitz::any(blitz::fabs(m_cache_N) > m_epsilon));
 }
@@ -166,51 +252,68 @@ bool bob::math::LPInteriorPoint::isInVS(const blitz::Array<double,2>& A,
   return (isFeasible(A, b, c, x, lambda, mu) && isInV(x, mu, theta));
 }
 
+bool bob::math::LPInteriorPoint::isInVS(const bob::math::SparseMatrix& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  const blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
+  const blitz::Array<double,1>& mu, const double theta) const
+{
+  return (isFeasible(A, b, c, x, lambda, mu) && isInV(x, mu, theta));
+}
+
+template <typename TMatrix>
 double bob::math::LPInteriorPoint::logBarrierLP(
-  const blitz::Array<double,2>& A_t, const blitz::Array<double,1>& c) const
+  const TMatrix& A, const blitz::Array<double,1>& c) const
 {
-  bob::math::prod( A_t, m_lambda, m_cache_N);
+  lp_prod_t( A, m_lambda, m_cache_N);
   if (blitz::any(c - m_cache_N <= 0.))
     return std::numeric_limits<double>::infinity();
   return blitz::sum( -blitz::log(c - m_cache_N));
 }
 
 
+template <typename TMatrix>
 void bob::math::LPInteriorPoint::gradientLogBarrierLP(
-  const blitz::Array<double,2>& A, const blitz::Array<double,1>& c)
+  const TMatrix& A, const blitz::Array<double,1>& c)
 {
-  // ugly fix for old blitz versions
-  const blitz::Array<double,2> A_t = 
-    const_cast<blitz::Array<double,2>&>(A).transpose(1,0);
-  bob::math::prod( A_t, m_lambda, m_cache_N);
+  lp_prod_t( A, m_lambda, m_cache_N);
   m_cache_N = c - m_cache_N; // c-transpose(A)*lambda
   const double eps = std::numeric_limits<double>::epsilon();
   m_cache_N = blitz::where( m_cache_N < eps, eps, m_cache_N);
-  blitz::firstIndex i1;
-  blitz::secondIndex i2;
-  m_cache_gradient = -sum( A(i1,i2) / m_cache_N(i2), i2);
+  // -A*(1./(c-transpose(A)*lambda))
+  m_cache_N = 1. / m_cache_N;
+  lp_prod( A, m_cache_N, m_cache_gradient);
+  m_cache_gradient *= -1.;
 }
 
 
 void bob::math::LPInteriorPoint::initializeDualLambdaMu(
   const blitz::Array<double,2>& A, const blitz::Array<double,1>& c)
+{
+  initializeDualLambdaMuImpl(A, c);
+}
+
+void bob::math::LPInteriorPoint::initializeDualLambdaMu(
+  const bob::math::SparseMatrix& A, const blitz::Array<double,1>& c)
+{
+  initializeDualLambdaMuImpl(A, c);
+}
+
+template <typename TMatrix>
+void bob::math::LPInteriorPoint::initializeDualLambdaMuImpl(
+  const TMatrix& A, const blitz::Array<double,1>& c)
 {
   // Check
-  bob::core::array::assertSameDimensionLength(A.extent(0), m_M);
-  bob::core::array::assertSameDimensionLength(A.extent(1), m_N);
+  bob::core::array::assertSameDimensionLength(lp_rows(A), m_M);
+  bob::core::array::assertSameDimensionLength(lp_cols(A), m_N);
   bob::core::array::assertSameDimensionLength(c.extent(0), m_N);
 
-  // Ugly fix for old blitz version
-  const blitz::Array<double,2> A_t = 
-    const_cast<blitz::Array<double,2>&>(A).transpose(1,0);
-
   // Loop until we find a tuple (lambda,mu) which satisfies the constraint:
   //   transpose(A)*lambda + mu = c, with mu>=0
   while (true)
   {
     double alpha = std::numeric_limits<double>::epsilon();
     // Compute the value of the logarithm barrier function
-    double f_old = logBarrierLP(A_t, c);
+    double f_old = logBarrierLP(A, c);
 
     // Find an alpha/lambda which decreases the barrier function
     while (alpha != std::numeric_limits<double>::infinity())
@@ -222,7 +325,7 @@ void bob::math::LPInteriorPoint::initializeDualLambdaMu(
       m_lambda += alpha * m_cache_gradient;
       
       // Compute the new value of the barrier
-      double f_new = logBarrierLP( A_t, c);
+      double f_new = logBarrierLP( A, c);
     
       // Break if the value of the barrier decreases
       if (f_new < f_old)
@@ -233,7 +336,7 @@ void bob::math::LPInteriorPoint::initializeDualLambdaMu(
     }
 
     // Update mu (= c - transpose(A)*lambda )
-    bob::math::prod( A_t, m_lambda, m_cache_N);
+    lp_prod_t( A, m_lambda, m_cache_N);
     m_mu = c - m_cache_N; // c-transpose(A)*lambda
     
     // break if all the mu_i are positive
@@ -245,14 +348,27 @@ void bob::math::LPInteriorPoint::initializeDualLambdaMu(
 
 void bob::math::LPInteriorPoint::centeringV(const blitz::Array<double,2>& A, 
   const double theta, blitz::Array<double,1>& x)
+{
+  centeringVImpl(A, theta, x);
+}
+
+void bob::math::LPInteriorPoint::centeringV(const bob::math::SparseMatrix& A,
+  const double theta, blitz::Array<double,1>& x)
+{
+  centeringVImpl(A, theta, x);
+}
+
+template <typename TMatrix>
+void bob::math::LPInteriorPoint::centeringVImpl(const TMatrix& A,
+  const double theta, blitz::Array<double,1>& x)
 {
   // Get dimensions from the A matrix
-  const int m = A.extent(0);
-  const int n = A.extent(1);
+  const int m = lp_rows(A);
+  const int n = lp_cols(A);
   blitz::Range r_m(0,m-1);
   blitz::Range r_n(0,n-1);
 
-  initializeLargeSystem(A);
+  initializeDirection(A);
 
   int k=0;  
   while (true)
@@ -261,9 +377,8 @@ void bob::math::LPInteriorPoint::centeringV(const blitz::Array<double,2>& A,
     if (isInV(x, m_mu, theta) )
       break;
 
-    // 2) Update the big system and solve it
-    updateLargeSystem( x, 1., m);
-    bob::math::linsolve( m_cache_A_large, m_cache_x_large, m_cache_b_large);
+    // 2) Compute the Newton direction
+    computeDirection( A, x, 1.);
 
     // 4) Find alpha and update x, lamda and mu
     double alpha=1.;
@@ -299,6 +414,12 @@ void bob::math::LPInteriorPoint::initializeLargeSystem(
     const_cast<blitz::Array<double,2>&>(A).transpose(1,0);
 
   // Initialize
+  const int size = m + 2*n;
+  if (m_cache_A_large.extent(0) != size)
+  {
+    m_cache_A_large.resize(size, size);
+    m_cache_b_large.resize(size);
+  }
   m_cache_A_large = 0.;
 
   blitz::Range r_m(0,m-1);
@@ -335,6 +456,72 @@ void bob::math::LPInteriorPoint::updateLargeSystem(const blitz::Array<double,1>&
   m_cache_b_large(r_n+m+n) = -x*m_mu + nu_sigma;
 }
 
+void bob::math::LPInteriorPoint::initializeDirection(
+  const blitz::Array<double,2>& A) const
+{
+  if (!m_normal_equations)
+    initializeLargeSystem(A);
+}
+
+void bob::math::LPInteriorPoint::initializeDirection(
+  const bob::math::SparseMatrix& A) const
+{
+}
+
+void bob::math::LPInteriorPoint::computeDirection(
+  const blitz::Array<double,2>& A, const blitz::Array<double,1>& x,
+  const double sigma) const
+{
+  if (m_normal_equations)
+    normalDirection(A, x, sigma);
+  else
+  {
+    updateLargeSystem( x, sigma, A.extent(0));
+    bob::math::linsolve( m_cache_A_large, m_cache_x_large, m_cache_b_large);
+  }
+}
+
+void bob::math::LPInteriorPoint::computeDirection(
+  const bob::math::SparseMatrix& A, const blitz::Array<double,1>& x,
+  const double sigma) const
+{
+  normalDirection(A, x, sigma);
+}
+
+template <typename TMatrix>
+void bob::math::LPInteriorPoint::normalDirection(const TMatrix& A,
+  const blitz::Array<double,1>& x, const double sigma) const
+{
+  // Get dimensions from the A matrix
+  const int m = lp_rows(A);
+  const int n = lp_cols(A);
+  blitz::Range r_m(0,m-1);
+  blitz::Range r_n(0,n-1);
+
+  // The direction is stored as in the large system: [Dx Dlambda Dmu]
+  blitz::Array<double,1> dx = m_cache_x_large(r_n);
+  blitz::Array<double,1> dlambda = m_cache_x_large(r_m+n);
+  blitz::Array<double,1> dmu = m_cache_x_large(r_n+m+n);
+
+  // Compute nu*sigma
+  double nu_sigma = sigma * bob::math::dot(x, m_mu) / n;
+
+  // D = X*S^-1 and S^-1*r, where r = -X S e + nu sigma e
+  m_cache_D = x / m_mu;
+  m_cache_r = (nu_sigma - x*m_mu) / m_mu;
+
+  // A*D*A^T*Dlambda = -A*S^-1*r
+  lp_prod_diag_t(A, m_cache_D, m_cache_A_normal, m_cache_work);
+  lp_prod(A, m_cache_r, m_cache_M);
+  m_cache_M *= -1.;
+  m_cache_solver.solve(m_cache_A_normal, dlambda, m_cache_M);
+
+  // Dmu = -A^T*Dlambda and Dx = S^-1*r - D*Dmu
+  lp_prod_t(A, dlambda, dmu);
+  dmu *= -1.;
+  dx = m_cache_r - m_cache_D * dmu;
+}
+
 
 
 bob::math::LPInteriorPointShortstep::LPInteriorPointShortstep(
@@ -377,14 +564,31 @@ bool bob::math::LPInteriorPointShortstep::operator!=(
   return !(this->operator==(other));
 }
 
-void bob::math::LPInteriorPointShortstep::solve(const blitz::Array<double,2>& A, 
+void bob::math::LPInteriorPointShortstep::solve(const blitz::Array<double,2>& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
+  const blitz::Array<double,1>& mu)
+{
+  solveImpl(A, b, c, x, lambda, mu);
+}
+
+void bob::math::LPInteriorPointShortstep::solve(const bob::math::SparseMatrix& A,
   const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
-  blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda, 
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
+  const blitz::Array<double,1>& mu)
+{
+  solveImpl(A, b, c, x, lambda, mu);
+}
+
+template <typename TMatrix>
+void bob::math::LPInteriorPointShortstep::solveImpl(const TMatrix& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
   const blitz::Array<double,1>& mu)
 {
   // Check
-  bob::core::array::assertSameDimensionLength(A.extent(0), m_M);
-  bob::core::array::assertSameDimensionLength(A.extent(1), m_N);
+  bob::core::array::assertSameDimensionLength(lp_rows(A), m_M);
+  bob::core::array::assertSameDimensionLength(lp_cols(A), m_N);
   bob::core::array::assertSameDimensionLength(b.extent(0), m_M);
   bob::core::array::assertSameDimensionLength(c.extent(0), m_N);
   bob::core::array::assertSameDimensionLength(x.extent(0), m_N);
@@ -392,8 +596,8 @@ void bob::math::LPInteriorPointShortstep::solve(const blitz::Array<double,2>& A,
   bob::core::array::assertSameDimensionLength(mu.extent(0), m_N);
 
   // Get dimensions from the A matrix
-  const int m = A.extent(0);
-  const int n = A.extent(1);
+  const int m = lp_rows(A);
+  const int n = lp_cols(A);
   blitz::Range r_m(0,m-1);
   blitz::Range r_n(0,n-1);
 
@@ -402,7 +606,7 @@ void bob::math::LPInteriorPointShortstep::solve(const blitz::Array<double,2>& A,
   double nu;
 
   // Declare and initialize arrays for the large linear system
-  initializeLargeSystem(A);
+  initializeDirection(A);
   m_lambda = lambda;
   m_mu = mu;
 
@@ -415,9 +619,8 @@ void bob::math::LPInteriorPointShortstep::solve(const blitz::Array<double,2>& A,
     if( nu < m_epsilon )
       break;
 
-    // 2) Update the big system and solve it
-    updateLargeSystem( x, sigma, m);
-    bob::math::linsolve( m_cache_A_large, m_cache_x_large, m_cache_b_large);
+    // 2) Compute the Newton direction
+    computeDirection(A, x, sigma);
 
     // 3) Update x, lamda and mu
     m_lambda += m_cache_x_large( r_m+n);
@@ -432,10 +635,25 @@ void bob::math::LPInteriorPointShortstep::solve(const blitz::Array<double,2>& A,
 void bob::math::LPInteriorPointShortstep::solve(const blitz::Array<double,2>& A,
   const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
   blitz::Array<double,1>& x)
+{
+  solveImpl(A, b, c, x);
+}
+
+void bob::math::LPInteriorPointShortstep::solve(const bob::math::SparseMatrix& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  blitz::Array<double,1>& x)
+{
+  solveImpl(A, b, c, x);
+}
+
+template <typename TMatrix>
+void bob::math::LPInteriorPointShortstep::solveImpl(const TMatrix& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  blitz::Array<double,1>& x)
 {
   // Check
-  bob::core::array::assertSameDimensionLength(A.extent(0), m_M);
-  bob::core::array::assertSameDimensionLength(A.extent(1), m_N);
+  bob::core::array::assertSameDimensionLength(lp_rows(A), m_M);
+  bob::core::array::assertSameDimensionLength(lp_cols(A), m_N);
   bob::core::array::assertSameDimensionLength(b.extent(0), m_M);
   bob::core::array::assertSameDimensionLength(c.extent(0), m_N);
   bob::core::array::assertSameDimensionLength(x.extent(0), m_N);
@@ -449,7 +667,7 @@ void bob::math::LPInteriorPointShortstep::solve(const blitz::Array<double,2>& A,
   centeringV( A, m_theta, x);
 
   // Launch the short step algorithm
-  solve( A, b, c, x, m_lambda, m_mu);
+  solve(A, b, c, x, m_lambda, m_mu);
 }
 
 
@@ -499,12 +717,29 @@ bool bob::math::LPInteriorPointPredictorCorrector::operator!=(
 
 void bob::math::LPInteriorPointPredictorCorrector::solve(const blitz::Array<double,2>& A,
   const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
-  blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda, 
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
+  const blitz::Array<double,1>& mu)
+{
+  solveImpl(A, b, c, x, lambda, mu);
+}
+
+void bob::math::LPInteriorPointPredictorCorrector::solve(const bob::math::SparseMatrix& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
+  const blitz::Array<double,1>& mu)
+{
+  solveImpl(A, b, c, x, lambda, mu);
+}
+
+template <typename TMatrix>
+void bob::math::LPInteriorPointPredictorCorrector::solveImpl(const TMatrix& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
   const blitz::Array<double,1>& mu)
 {
   // Check
-  bob::core::array::assertSameDimensionLength(A.extent(0), m_M);
-  bob::core::array::assertSameDimensionLength(A.extent(1), m_N);
+  bob::core::array::assertSameDimensionLength(lp_rows(A), m_M);
+  bob::core::array::assertSameDimensionLength(lp_cols(A), m_N);
   bob::core::array::assertSameDimensionLength(b.extent(0), m_M);
   bob::core::array::assertSameDimensionLength(c.extent(0), m_N);
   bob::core::array::assertSameDimensionLength(x.extent(0), m_N);
@@ -512,8 +747,8 @@ void bob::math::LPInteriorPointPredictorCorrector::solve(const blitz::Array<doub
   bob::core::array::assertSameDimensionLength(mu.extent(0), m_N);
 
   // Get dimensions from the A matrix
-  const int m = A.extent(0);
-  const int n = A.extent(1);
+  const int m = lp_rows(A);
+  const int n = lp_cols(A);
   blitz::Range r_m(0,m-1);
   blitz::Range r_n(0,n-1);
 
@@ -521,7 +756,7 @@ void bob::math::LPInteriorPointPredictorCorrector::solve(const blitz::Array<doub
   double nu;
 
   // Declare and initialize arrays for the large linear system
-  initializeLargeSystem(A);
+  initializeDirection(A);
   m_lambda = lambda;
   m_mu = mu;
 
@@ -536,9 +771,8 @@ void bob::math::LPInteriorPointPredictorCorrector::solve(const blitz::Array<doub
     if (nu < m_epsilon)
       break;
 
-    // 2) Update the big system and solve it
-    updateLargeSystem( x, 0., m);
-    bob::math::linsolve( m_cache_A_large, m_cache_x_large, m_cache_b_large);
+    // 2) Compute the Newton direction
+    computeDirection(A, x, 0.);
 
     // 3) alpha=1
     double alpha = 1.;
@@ -569,9 +803,8 @@ void bob::math::LPInteriorPointPredictorCorrector::solve(const blitz::Array<doub
     if( nu < m_epsilon )
       break;
 
-    // 7) Update the big system and solve it
-    updateLargeSystem( x, 1., m);
-    bob::math::linsolve( m_cache_A_large, m_cache_x_large, m_cache_b_large);
+    // 7) Compute the Newton direction
+    computeDirection(A, x, 1.);
 
     // 8) Update x
     m_lambda += m_cache_x_large(r_m+n);
@@ -583,13 +816,28 @@ void bob::math::LPInteriorPointPredictorCorrector::solve(const blitz::Array<doub
   } 
 }
 
-void bob::math::LPInteriorPointPredictorCorrector::solve(const blitz::Array<double,2>& A, 
+void bob::math::LPInteriorPointPredictorCorrector::solve(const blitz::Array<double,2>& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  blitz::Array<double,1>& x)
+{
+  solveImpl(A, b, c, x);
+}
+
+void bob::math::LPInteriorPointPredictorCorrector::solve(const bob::math::SparseMatrix& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  blitz::Array<double,1>& x)
+{
+  solveImpl(A, b, c, x);
+}
+
+template <typename TMatrix>
+void bob::math::LPInteriorPointPredictorCorrector::solveImpl(const TMatrix& A,
   const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
   blitz::Array<double,1>& x)
 {
   // Check
-  bob::core::array::assertSameDimensionLength(A.extent(0), m_M);
-  bob::core::array::assertSameDimensionLength(A.extent(1), m_N);
+  bob::core::array::assertSameDimensionLength(lp_rows(A), m_M);
+  bob::core::array::assertSameDimensionLength(lp_cols(A), m_N);
   bob::core::array::assertSameDimensionLength(b.extent(0), m_M);
   bob::core::array::assertSameDimensionLength(c.extent(0), m_N);
   bob::core::array::assertSameDimensionLength(x.extent(0), m_N);
@@ -663,14 +911,31 @@ bool bob::math::LPInteriorPointLongstep::isInV(const blitz::Array<double,1>& x,
   return (!blitz::any(x*mu < gamma*nu));
 }
 
-void bob::math::LPInteriorPointLongstep::solve(const blitz::Array<double,2>& A, 
+void bob::math::LPInteriorPointLongstep::solve(const blitz::Array<double,2>& A,
   const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
-  blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda, 
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
+  const blitz::Array<double,1>& mu)
+{
+  solveImpl(A, b, c, x, lambda, mu);
+}
+
+void bob::math::LPInteriorPointLongstep::solve(const bob::math::SparseMatrix& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
+  const blitz::Array<double,1>& mu)
+{
+  solveImpl(A, b, c, x, lambda, mu);
+}
+
+template <typename TMatrix>
+void bob::math::LPInteriorPointLongstep::solveImpl(const TMatrix& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& lambda,
   const blitz::Array<double,1>& mu)
 {
   // Check
-  bob::core::array::assertSameDimensionLength(A.extent(0), m_M);
-  bob::core::array::assertSameDimensionLength(A.extent(1), m_N);
+  bob::core::array::assertSameDimensionLength(lp_rows(A), m_M);
+  bob::core::array::assertSameDimensionLength(lp_cols(A), m_N);
   bob::core::array::assertSameDimensionLength(b.extent(0), m_M);
   bob::core::array::assertSameDimensionLength(c.extent(0), m_N);
   bob::core::array::assertSameDimensionLength(x.extent(0), m_N);
@@ -678,15 +943,15 @@ void bob::math::LPInteriorPointLongstep::solve(const blitz::Array<double,2>& A,
   bob::core::array::assertSameDimensionLength(mu.extent(0), m_N);
 
   // Get dimensions from the A matrix
-  const int m = A.extent(0);
-  const int n = A.extent(1);
+  const int m = lp_rows(A);
+  const int n = lp_cols(A);
   blitz::Range r_m(0,m-1);
   blitz::Range r_n(0,n-1);
 
   // Declare and initialize variables
   double nu;
 
-  initializeLargeSystem(A);
+  initializeDirection(A);
   m_lambda = lambda;
   m_mu = mu;
 
@@ -699,9 +964,8 @@ void bob::math::LPInteriorPointLongstep::solve(const blitz::Array<double,2>& A,
     if (nu < m_epsilon)
       break;
 
-    // 2) Update the big system and solve it
-    updateLargeSystem(x, m_sigma, m);
-    bob::math::linsolve(m_cache_A_large, m_cache_x_large, m_cache_b_large);
+    // 2) Compute the Newton direction
+    computeDirection(A, x, m_sigma);
 
     // 3) alpha=1
     double alpha = 1.;
@@ -726,13 +990,28 @@ void bob::math::LPInteriorPointLongstep::solve(const blitz::Array<double,2>& A,
 }
 
 
-void bob::math::LPInteriorPointLongstep::solve(const blitz::Array<double,2>& A, 
+void bob::math::LPInteriorPointLongstep::solve(const blitz::Array<double,2>& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  blitz::Array<double,1>& x)
+{
+  solveImpl(A, b, c, x);
+}
+
+void bob::math::LPInteriorPointLongstep::solve(const bob::math::SparseMatrix& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  blitz::Array<double,1>& x)
+{
+  solveImpl(A, b, c, x);
+}
+
+template <typename TMatrix>
+void bob::math::LPInteriorPointLongstep::solveImpl(const TMatrix& A,
   const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
   blitz::Array<double,1>& x)
 {
   // Check
-  bob::core::array::assertSameDimensionLength(A.extent(0), m_M);
-  bob::core::array::assertSameDimensionLength(A.extent(1), m_N);
+  bob::core::array::assertSameDimensionLength(lp_rows(A), m_M);
+  bob::core::array::assertSameDimensionLength(lp_cols(A), m_N);
   bob::core::array::assertSameDimensionLength(b.extent(0), m_M);
   bob::core::array::assertSameDimensionLength(c.extent(0), m_N);
   bob::core::array::assertSameDimensionLength(x.extent(0), m_N);
@@ -0,0 +1,141 @@
+/**
+ * @file math/cxx/SparseMatrix.cc
+ * @date Tue Jun 18 10:27:51 2013 +0200
+ * @author Laurent El Shafey <Laurent.El-Shafey@idiap.ch>
+ *
+ * @brief Sparse matrix in compressed sparse row (CSR) format
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/math/SparseMatrix.h>
+#include <bob/core/Exception.h>
+#include <bob/core/array_copy.h>
+#include <bob/core/assert.h>
+
+bob::math::SparseMatrix::SparseMatrix():
+  m_offsets(1), m_cols(0)
+{
+  m_offsets = 0;
+}
+
+bob::math::SparseMatrix::SparseMatrix(const blitz::Array<double,2>& A):
+  m_values(blitz::count(A != 0.)), m_columns(m_values.extent(0)),
+  m_offsets(A.extent(0)+1), m_cols(A.extent(1))
+{
+  int p = 0;
+  for (int i=0; i<A.extent(0); ++i)
+  {
+    m_offsets(i) = p;
+    for (int j=0; j<A.extent(1); ++j)
+      if (A(i+A.lbound(0), j+A.lbound(1)) != 0.)
+      {
+        m_values(p) = A(i+A.lbound(0), j+A.lbound(1));
+        m_columns(p) = j;
+        ++p;
+      }
+  }
+  m_offsets(A.extent(0)) = p;
+}
+
+bob::math::SparseMatrix::SparseMatrix(const blitz::Array<double,1>& values,
+    const blitz::Array<int,1>& columns, const blitz::Array<int,1>& offsets,
+    const int cols):
+  m_values(bob::core::array::ccopy(values)),
+  m_columns(bob::core::array::ccopy(columns)),
+  m_offsets(bob::core::array::ccopy(offsets)),
+  m_cols(cols)
+{
+  if (m_columns.extent(0) != m_values.extent(0))
+    throw bob::core::InvalidArgumentException("The values and column indices of a sparse matrix must have the same length");
+  if (m_offsets.extent(0) < 1 || m_offsets(0) != 0 ||
+      m_offsets(m_offsets.extent(0)-1) != m_values.extent(0))
+    throw bob::core::InvalidArgumentException("The offsets of a sparse matrix must start with 0 and end with the number of values");
+  for (int i=1; i<m_offsets.extent(0); ++i)
+    if (m_offsets(i) < m_offsets(i-1))
+      throw bob::core::InvalidArgumentException("The offsets of a sparse matrix must not be decreasing");
+  if (m_values.extent(0) && (blitz::min(m_columns) < 0 || blitz::max(m_columns) >= m_cols))
+    throw bob::core::InvalidArgumentException("The column indices of a sparse matrix must lie in the range [0, cols)");
+}
+
+void bob::math::SparseMatrix::prod(const blitz::Array<double,1>& x,
+  blitz::Array<double,1>& y) const
+{
+  bob::core::array::assertZeroBase(x);
+  bob::core::array::assertZeroBase(y);
+  bob::core::array::assertSameDimensionLength(x.extent(0), m_cols);
+  bob::core::array::assertSameDimensionLength(y.extent(0), rows());
+
+  for (int i=0; i<rows(); ++i)
+  {
+    double sum = 0.;
+    for (int p=m_offsets(i); p<m_offsets(i+1); ++p)
+      sum += m_values(p) * x(m_columns(p));
+    y(i) = sum;
+  }
+}
+
+void bob::math::SparseMatrix::prodTrans(const blitz::Array<double,1>& x,
+  blitz::Array<double,1>& y) const
+{
+  bob::core::array::assertZeroBase(x);
+  bob::core::array::assertZeroBase(y);
+  bob::core::array::assertSameDimensionLength(x.extent(0), rows());
+  bob::core::array::assertSameDimensionLength(y.extent(0), m_cols);
+
+  y = 0.;
+  for (int i=0; i<rows(); ++i)
+    for (int p=m_offsets(i); p<m_offsets(i+1); ++p)
+      y(m_columns(p)) += m_values(p) * x(i);
+}
+
+void bob::math::SparseMatrix::prodDiagTrans(const blitz::Array<double,1>& d,
+  blitz::Array<double,2>& C, blitz::Array<double,1>& work) const
+{
+  bob::core::array::assertZeroBase(d);
+  bob::core::array::assertZeroBase(C);
+  bob::core::array::assertSameDimensionLength(d.extent(0), m_cols);
+  bob::core::array::assertSameShape(C, blitz::TinyVector<int,2>(rows(), rows()));
+  if (work.extent(0) != m_cols) work.resize(m_cols);
+
+  // Scatters row i of A*diag(d) to the dense working array, and computes
+  // its dot products with the (sparse) rows j<=i of A
+  work = 0.;
+  for (int i=0; i<rows(); ++i)
+  {
+    for (int p=m_offsets(i); p<m_offsets(i+1); ++p)
+      work(m_columns(p)) += m_values(p) * d(m_columns(p));
+    for (int j=0; j<=i; ++j)
+    {
+      double sum = 0.;
+      for (int p=m_offsets(j); p<m_offsets(j+1); ++p)
+        sum += m_values(p) * work(m_columns(p));
+      C(i,j) = sum;
+      C(j,i) = sum;
+    }
+    for (int p=m_offsets(i); p<m_offsets(i+1); ++p)
+      work(m_columns(p)) = 0.;
+  }
+}
+
+blitz::Array<double,2> bob::math::SparseMatrix::toDense() const
+{
+  blitz::Array<double,2> A(rows(), m_cols);
+  A = 0.;
+  for (int i=0; i<rows(); ++i)
+    for (int p=m_offsets(i); p<m_offsets(i+1); ++p)
+      A(i, m_columns(p)) += m_values(p);
+  return A;
+}
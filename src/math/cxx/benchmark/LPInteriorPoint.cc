@@ -0,0 +1,113 @@
+/**
+ * @file math/cxx/benchmark/LPInteriorPoint.cc
+ * @date 2013-06-18
+ * @author Laurent El Shafey <Laurent.El-Shafey@idiap.ch>
+ *
+ * @brief Compares the runtime of the long-step interior point solver when
+ * the Newton directions are computed with the large dense system, with the
+ * normal equations and with the normal equations of a sparse matrix, for a
+ * growing number N of variables.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/random.hpp>
+#include <blitz/array.h>
+
+#include "bob/core/benchmark.h"
+#include "bob/math/LPInteriorPoint.h"
+#include "bob/math/SparseMatrix.h"
+
+using bob::core::benchmark::param;
+
+/**
+ * Generates the problem min c^T x, s.t. [B I]*x = b, x >= 0, where B is a
+ * random sparse non-negative MxK matrix and b = B*1 + 1, so that x0 = 1 is
+ * a strictly feasible starting point.
+ */
+static void generateProblem(const int M, const int K, boost::mt19937& rng,
+    blitz::Array<double,2>& A, blitz::Array<double,1>& b,
+    blitz::Array<double,1>& c){
+  boost::uniform_real<> uniform(0., 1.);
+  A.resize(M, K+M);
+  b.resize(M);
+  c.resize(K+M);
+  A = 0.;
+  for (int i = 0; i < M; ++i){
+    for (int k = 0; k < K; ++k)
+      if (uniform(rng) < 0.2) A(i,k) = uniform(rng);
+    A(i,K+i) = 1.;
+    b(i) = blitz::sum(A(i, blitz::Range::all()));
+  }
+  for (int j = 0; j < K+M; ++j)
+    c(j) = 0.5 + uniform(rng);
+}
+
+/**
+ * Solves the problem from the strictly feasible starting point, with the
+ * dense matrix or its normal equations, or with the sparse matrix
+ */
+template <typename Matrix>
+struct Solve {
+  bob::math::LPInteriorPointLongstep& solver;
+  const Matrix& A;
+  const blitz::Array<double,1>& b;
+  const blitz::Array<double,1>& c;
+  blitz::Array<double,1>& x;
+  bool normal;
+  void operator()() const {
+    solver.setNormalEquations(normal);
+    x = 1.;
+    solver.solve(A, b, c, x);
+  }
+};
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("math_LPInteriorPoint", argc, argv);
+  const int M = 10;
+  const int variables[] = {100, 200, 400, 1600, 6400, 25600};
+  const int n_variables = suite.quick() ? 4 : 6;
+  // the large system has (M+2N)^2 elements, so it is only solved for small N
+  const int max_dense = 400;
+
+  boost::mt19937 rng;
+
+  for (int v = 0; v < n_variables; ++v){
+    const int K = variables[v], N = K + M;
+    blitz::Array<double,2> A;
+    blitz::Array<double,1> b, c;
+    generateProblem(M, K, rng, A, b, c);
+    const bob::math::SparseMatrix A_sparse(A);
+
+    bob::math::LPInteriorPointLongstep solver(M, N, 1e-3, 0.1, 1e-6);
+    blitz::Array<double,1> x(N);
+
+    // large dense system
+    if (K <= max_dense){
+      Solve<blitz::Array<double,2> > dense = {solver, A, b, c, x, false};
+      suite.run("dense", param("N", N), dense);
+    }
+
+    // normal equations of the dense matrix
+    Solve<blitz::Array<double,2> > normal = {solver, A, b, c, x, true};
+    suite.run("normal", param("N", N), normal);
+
+    // normal equations of the sparse matrix
+    Solve<bob::math::SparseMatrix> sparse = {solver, A_sparse, b, c, x, false};
+    suite.run("sparse", param("N", N), sparse);
+  }
+
+  return suite.finish();
+}
@@ -0,0 +1,106 @@
+/**
+ * @file math/cxx/benchmark/linear.cc
+ * @date 2013-07-04
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Measures matrix products and the SVD and symmetric eigenvalue
+ * decompositions on random square matrices.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/random.hpp>
+#include <blitz/array.h>
+
+#include "bob/core/benchmark.h"
+#include "bob/math/linear.h"
+#include "bob/math/svd.h"
+#include "bob/math/eig.h"
+
+using bob::core::benchmark::param;
+
+struct MatrixProduct {
+  const blitz::Array<double,2>& A;
+  const blitz::Array<double,2>& B;
+  blitz::Array<double,2>& C;
+  void operator()() const { bob::math::prod_(A, B, C); }
+};
+
+struct MatrixVectorProduct {
+  const blitz::Array<double,2>& A;
+  const blitz::Array<double,1>& b;
+  blitz::Array<double,1>& c;
+  void operator()() const { bob::math::prod_(A, b, c); }
+};
+
+struct SVD {
+  const blitz::Array<double,2>& A;
+  blitz::Array<double,2>& U;
+  blitz::Array<double,1>& sigma;
+  blitz::Array<double,2>& Vt;
+  void operator()() const { bob::math::svd_(A, U, sigma, Vt); }
+};
+
+struct EigSym {
+  const blitz::Array<double,2>& A;
+  blitz::Array<double,2>& V;
+  blitz::Array<double,1>& D;
+  void operator()() const { bob::math::eigSym_(A, V, D); }
+};
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("math_linear", argc, argv);
+  const int sizes[] = {16, 64, 256, 512};
+  const int n_sizes = suite.quick() ? 3 : 4;
+
+  boost::mt19937 rng;
+  boost::uniform_real<> uniform(-1., 1.);
+
+  for (int s = 0; s < n_sizes; ++s){
+    const int n = sizes[s];
+    blitz::Array<double,2> A(n, n), B(n, n), C(n, n), S(n, n);
+    blitz::Array<double,1> b(n), c(n);
+    for (int i = 0; i < n; ++i){
+      b(i) = uniform(rng);
+      for (int j = 0; j < n; ++j){
+        A(i,j) = uniform(rng);
+        B(i,j) = uniform(rng);
+      }
+    }
+    // symmetric positive definite matrix for eigSym
+    blitz::firstIndex i;
+    blitz::secondIndex j;
+    blitz::thirdIndex k;
+    S = blitz::sum(A(i,k) * A(j,k), k);
+    for (int d = 0; d < n; ++d) S(d,d) += n;
+
+    MatrixProduct mm = {A, B, C};
+    suite.run("prod_matrix_matrix", param("n", n), mm);
+    MatrixVectorProduct mv = {A, b, c};
+    suite.run("prod_matrix_vector", param("n", n), mv);
+
+    blitz::Array<double,2> U(n, n), Vt(n, n);
+    blitz::Array<double,1> sigma(n);
+    SVD svd = {A, U, sigma, Vt};
+    suite.run("svd", param("n", n), svd);
+
+    blitz::Array<double,2> V(n, n);
+    blitz::Array<double,1> D(n);
+    EigSym eig = {S, V, D};
+    suite.run("eigSym", param("n", n), eig);
+  }
+
+  return suite.finish();
+}
@@ -0,0 +1,530 @@
+/**
+ * @file math/cxx/solvers.cc
+ * @date Mon Jun 17 09:41:25 2013 +0200
+ * @author Laurent El Shafey <Laurent.El-Shafey@idiap.ch>
+ *
+ * @brief Solver objects that keep their LAPACK workspace across calls
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/math/solvers.h>
+#include <bob/math/Exception.h>
+#include <bob/core/assert.h>
+#include <bob/core/check.h>
+#include <bob/core/parallel.h>
+#if !defined (HAVE_BLITZ_TINYVEC2_H)
+#include <blitz/tinyvec-et.h>
+#endif
+#include <algorithm>
+
+// Declaration of the external LAPACK functions
+// LU decomposition of a general matrix (dgetrf)
+extern "C" void dgetrf_( const int *M, const int *N, double *A,
+  const int *lda, int *ipiv, int *info);
+// Solves a general linear system using the LU decomposition (dgetrs)
+extern "C" void dgetrs_( const char *trans, const int *N, const int *nrhs,
+  const double *A, const int *lda, const int *ipiv, double *B,
+  const int *ldb, int *info);
+// Inverse of a general matrix using the LU decomposition (dgetri)
+extern "C" void dgetri_( const int *N, double *A, const int *lda,
+  const int *ipiv, double *work, const int *lwork, int *info);
+// Cholesky decomposition of a real symmetric definite-positive matrix (dpotrf)
+extern "C" void dpotrf_( const char *uplo, const int *N, double *A,
+  const int *lda, int *info);
+// Solves a symmetric definite-positive linear system using the Cholesky
+// decomposition (dpotrs)
+extern "C" void dpotrs_( const char *uplo, const int *N, const int *nrhs,
+  const double *A, const int *lda, double *B, const int *ldb, int *info);
+// Eigenvalue decomposition of a real symmetric matrix (dsyevd)
+extern "C" void dsyevd_( const char *jobz, const char *uplo, const int *N,
+  double *A, const int *lda, double *W, double *work, const int *lwork,
+  int *iwork, const int *liwork, int *info);
+// Singular value decomposition (Divide and conquer dgesdd)
+extern "C" void dgesdd_( const char *jobz, const int *M, const int *N,
+  double *A, const int *lda, double *S, double *U, const int* ldu, double *VT,
+  const int *ldvt, double *work, const int *lwork, int *iwork, int *info);
+
+/**
+ * Resizes the given workspace array, but only if its shape changes
+ */
+template <typename T, int N>
+static void reserve(blitz::Array<T,N>& array,
+  const blitz::TinyVector<int,N>& shape)
+{
+  if (blitz::any(array.shape() != shape)) array.resize(shape);
+}
+
+/**
+ * Checks that A is a squared matrix and returns its size
+ */
+static int squared_size(const blitz::Array<double,2>& A)
+{
+  bob::core::array::assertZeroBase(A);
+  bob::core::array::assertSameDimensionLength(A.extent(0), A.extent(1));
+  return A.extent(0);
+}
+
+
+void bob::math::LinearSolver::factorize(const blitz::Array<double,2>& A)
+{
+  const int N = squared_size(A);
+  reserve(m_lu, blitz::TinyVector<int,2>(N,N));
+  reserve(m_ipiv, blitz::TinyVector<int,1>(N));
+
+  // A row-major copy of A is the column-major representation of A^T.
+  // Hence, the LU decomposition of A^T is computed, and the transposed
+  // systems are solved afterwards.
+  m_lu = A;
+  int info = 0;
+  dgetrf_( &N, &N, m_lu.data(), &N, m_ipiv.data(), &info);
+  if (info != 0)
+    throw bob::math::LapackError("The LAPACK dgetrf function returned a non-zero value.");
+}
+
+void bob::math::LinearSolver::solve(const blitz::Array<double,2>& A,
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& b)
+{
+  factorize(A);
+  const int N = A.extent(0);
+  bob::core::array::assertZeroBase(x);
+  bob::core::array::assertZeroBase(b);
+  bob::core::array::assertSameDimensionLength(x.extent(0), N);
+  bob::core::array::assertSameDimensionLength(b.extent(0), N);
+
+  // Tries to use x directly
+  blitz::Array<double,1> x_lapack;
+  const bool x_direct_use = bob::core::array::isCZeroBaseContiguous(x);
+  if (x_direct_use) x_lapack.reference(x);
+  else {
+    reserve(m_x, blitz::TinyVector<int,1>(N));
+    x_lapack.reference(m_x);
+  }
+  x_lapack = b;
+
+  // (A^T)^T * x = b
+  const char trans = 'T';
+  const int nrhs = 1;
+  int info = 0;
+  dgetrs_( &trans, &N, &nrhs, m_lu.data(), &N, m_ipiv.data(), x_lapack.data(),
+    &N, &info);
+  if (info != 0)
+    throw bob::math::LapackError("The LAPACK dgetrs function returned a non-zero value.");
+
+  if (!x_direct_use) x = m_x;
+}
+
+void bob::math::LinearSolver::solve(const blitz::Array<double,2>& A,
+  blitz::Array<double,2>& X, const blitz::Array<double,2>& B)
+{
+  factorize(A);
+  const int N = A.extent(0);
+  const int P = B.extent(1);
+  bob::core::array::assertZeroBase(X);
+  bob::core::array::assertZeroBase(B);
+  bob::core::array::assertSameShape(X, blitz::TinyVector<int,2>(N,P));
+  bob::core::array::assertSameShape(B, blitz::TinyVector<int,2>(N,P));
+
+  // The right hand sides need to be in column-major order; X is used
+  // directly if this is already the case
+  blitz::Array<double,2> Xt = X.transpose(1,0);
+  blitz::Array<double,2> X_lapack;
+  const bool X_direct_use = bob::core::array::isCZeroBaseContiguous(Xt);
+  if (X_direct_use) X_lapack.reference(Xt);
+  else {
+    reserve(m_X, blitz::TinyVector<int,2>(P,N));
+    X_lapack.reference(m_X);
+  }
+  // Ugly fix for non-const transpose
+  X_lapack = const_cast<blitz::Array<double,2>&>(B).transpose(1,0);
+
+  const char trans = 'T';
+  int info = 0;
+  dgetrs_( &trans, &N, &P, m_lu.data(), &N, m_ipiv.data(), X_lapack.data(),
+    &N, &info);
+  if (info != 0)
+    throw bob::math::LapackError("The LAPACK dgetrs function returned a non-zero value.");
+
+  if (!X_direct_use) Xt = m_X;
+}
+
+
+void bob::math::SymposSolver::factorize(const blitz::Array<double,2>& A)
+{
+  const int N = squared_size(A);
+  reserve(m_chol, blitz::TinyVector<int,2>(N,N));
+
+  // A is symmetric, so that its row-major copy is also its column-major
+  // representation. The upper triangular factor U (A = U^T*U) in
+  // column-major order is the lower triangular factor L = U^T in row-major
+  // order.
+  m_chol = A;
+  const char uplo = 'U';
+  int info = 0;
+  dpotrf_( &uplo, &N, m_chol.data(), &N, &info);
+  if (info != 0)
+    throw bob::math::LapackError("The LAPACK dpotrf function returned a non-zero value.");
+}
+
+void bob::math::SymposSolver::chol(const blitz::Array<double,2>& A,
+  blitz::Array<double,2>& L)
+{
+  factorize(A);
+  bob::core::array::assertZeroBase(L);
+  bob::core::array::assertSameShape(A, L);
+
+  // Copies the lower triangular part and sets the strictly upper triangular
+  // part to 0
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+  L = blitz::where(i < j, 0., m_chol);
+}
+
+void bob::math::SymposSolver::solve(const blitz::Array<double,2>& A,
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& b)
+{
+  factorize(A);
+  const int N = A.extent(0);
+  bob::core::array::assertZeroBase(x);
+  bob::core::array::assertZeroBase(b);
+  bob::core::array::assertSameDimensionLength(x.extent(0), N);
+  bob::core::array::assertSameDimensionLength(b.extent(0), N);
+
+  blitz::Array<double,1> x_lapack;
+  const bool x_direct_use = bob::core::array::isCZeroBaseContiguous(x);
+  if (x_direct_use) x_lapack.reference(x);
+  else {
+    reserve(m_x, blitz::TinyVector<int,1>(N));
+    x_lapack.reference(m_x);
+  }
+  x_lapack = b;
+
+  const char uplo = 'U';
+  const int nrhs = 1;
+  int info = 0;
+  dpotrs_( &uplo, &N, &nrhs, m_chol.data(), &N, x_lapack.data(), &N, &info);
+  if (info != 0)
+    throw bob::math::LapackError("The LAPACK dpotrs function returned a non-zero value.");
+
+  if (!x_direct_use) x = m_x;
+}
+
+void bob::math::SymposSolver::solve(const blitz::Array<double,2>& A,
+  blitz::Array<double,2>& X, const blitz::Array<double,2>& B)
+{
+  factorize(A);
+  const int N = A.extent(0);
+  const int P = B.extent(1);
+  bob::core::array::assertZeroBase(X);
+  bob::core::array::assertZeroBase(B);
+  bob::core::array::assertSameShape(X, blitz::TinyVector<int,2>(N,P));
+  bob::core::array::assertSameShape(B, blitz::TinyVector<int,2>(N,P));
+
+  blitz::Array<double,2> Xt = X.transpose(1,0);
+  blitz::Array<double,2> X_lapack;
+  const bool X_direct_use = bob::core::array::isCZeroBaseContiguous(Xt);
+  if (X_direct_use) X_lapack.reference(Xt);
+  else {
+    reserve(m_X, blitz::TinyVector<int,2>(P,N));
+    X_lapack.reference(m_X);
+  }
+  // Ugly fix for non-const transpose
+  X_lapack = const_cast<blitz::Array<double,2>&>(B).transpose(1,0);
+
+  const char uplo = 'U';
+  int info = 0;
+  dpotrs_( &uplo, &N, &P, m_chol.data(), &N, X_lapack.data(), &N, &info);
+  if (info != 0)
+    throw bob::math::LapackError("The LAPACK dpotrs function returned a non-zero value.");
+
+  if (!X_direct_use) Xt = m_X;
+}
+
+
+void bob::math::Inverter::inv(const blitz::Array<double,2>& A,
+  blitz::Array<double,2>& B)
+{
+  const int N = squared_size(A);
+  bob::core::array::assertZeroBase(B);
+  bob::core::array::assertSameShape(A, B);
+
+  // Queries the optimal size of the working array, if the size changed
+  int info = 0;
+  if (!m_work.extent(0) || N != m_n) {
+    m_ipiv.resize(N);
+    const int lwork_query = -1;
+    double work_query;
+    dgetri_( &N, 0, &N, m_ipiv.data(), &work_query, &lwork_query, &info);
+    m_work.resize(std::max(1, static_cast<int>(work_query)));
+    m_n = N;
+  }
+
+  // Tries to use B directly. As inverse(A^T) = inverse(A)^T, we can ignore
+  // the problem of column- and row-major order conversions.
+  blitz::Array<double,2> A_lapack;
+  const bool B_direct_use = bob::core::array::isCZeroBaseContiguous(B);
+  if (B_direct_use) A_lapack.reference(B);
+  else {
+    reserve(m_A, blitz::TinyVector<int,2>(N,N));
+    A_lapack.reference(m_A);
+  }
+  A_lapack = A;
+
+  dgetrf_( &N, &N, A_lapack.data(), &N, m_ipiv.data(), &info);
+  if (info != 0)
+    throw bob::math::LapackError("The LAPACK dgetrf function returned a non-zero value.");
+
+  const int lwork = m_work.extent(0);
+  dgetri_( &N, A_lapack.data(), &N, m_ipiv.data(), m_work.data(), &lwork,
+    &info);
+  if (info != 0)
+    throw bob::math::LapackError("The LAPACK dgetri function returned a non-zero value. The matrix might not be invertible.");
+
+  if (!B_direct_use) B = m_A;
+}
+
+
+void bob::math::EigSymSolver::eigSym(const blitz::Array<double,2>& A,
+  blitz::Array<double,2>& V, blitz::Array<double,1>& D)
+{
+  const int N = squared_size(A);
+  bob::core::array::assertZeroBase(V);
+  bob::core::array::assertZeroBase(D);
+  bob::core::array::assertSameShape(A, V);
+  bob::core::array::assertSameDimensionLength(D.extent(0), N);
+
+  const char jobz = 'V'; // Get both the eigenvalues and the eigenvectors
+  const char uplo = 'U';
+  int info = 0;
+
+  // Queries the optimal size of the working arrays, if the size changed
+  if (!m_work.extent(0) || N != m_n) {
+    const int lwork_query = -1;
+    double work_query;
+    const int liwork_query = -1;
+    int iwork_query;
+    dsyevd_( &jobz, &uplo, &N, 0, &N, 0, &work_query, &lwork_query,
+      &iwork_query, &liwork_query, &info);
+    m_work.resize(std::max(1, static_cast<int>(work_query)));
+    m_iwork.resize(std::max(1, iwork_query));
+    m_n = N;
+  }
+
+  // A is symmetric, so that it does not need to be transposed. The
+  // eigenvectors are returned in the columns of the column-major matrix,
+  // hence V is used directly if it is in column-major order.
+  blitz::Array<double,2> Vt = V.transpose(1,0);
+  blitz::Array<double,2> A_lapack;
+  const bool V_direct_use = bob::core::array::isCZeroBaseContiguous(Vt);
+  if (V_direct_use) A_lapack.reference(Vt);
+  else {
+    reserve(m_A, blitz::TinyVector<int,2>(N,N));
+    A_lapack.reference(m_A);
+  }
+  A_lapack = A;
+  blitz::Array<double,1> D_lapack;
+  const bool D_direct_use = bob::core::array::isCZeroBaseContiguous(D);
+  if (D_direct_use) D_lapack.reference(D);
+  else {
+    reserve(m_D, blitz::TinyVector<int,1>(N));
+    D_lapack.reference(m_D);
+  }
+
+  const int lwork = m_work.extent(0);
+  const int liwork = m_iwork.extent(0);
+  dsyevd_( &jobz, &uplo, &N, A_lapack.data(), &N, D_lapack.data(),
+    m_work.data(), &lwork, m_iwork.data(), &liwork, &info);
+  if (info != 0)
+    throw bob::math::LapackError("The LAPACK dsyevd function returned a non-zero value.");
+
+  if (!V_direct_use) Vt = m_A;
+  if (!D_direct_use) D = m_D;
+}
+
+
+void bob::math::SVDSolver::svd(const blitz::Array<double,2>& A,
+  blitz::Array<double,2>& U, blitz::Array<double,1>& sigma,
+  blitz::Array<double,2>& Vt)
+{
+  const int M = A.extent(0);
+  const int N = A.extent(1);
+  const int nb_singular = std::min(M,N);
+  bob::core::array::assertZeroBase(A);
+  bob::core::array::assertZeroBase(U);
+  bob::core::array::assertZeroBase(sigma);
+  bob::core::array::assertZeroBase(Vt);
+  bob::core::array::assertSameShape(U, blitz::TinyVector<int,2>(M,M));
+  bob::core::array::assertSameDimensionLength(sigma.extent(0), nb_singular);
+  bob::core::array::assertSameShape(Vt, blitz::TinyVector<int,2>(N,N));
+
+  // We decompose A^T rather than A, as for svd_:
+  // If A = U.S.V^T, then A^T = V.S.U^T
+  const char jobz = 'A'; // Get All left singular vectors
+  int info = 0;
+
+  // Queries the optimal size of the working arrays, if the shape changed
+  if (!m_work.extent(0) || M != m_m || N != m_n) {
+    m_iwork.resize(std::max(1, 8*nb_singular));
+    const int lwork_query = -1;
+    double work_query;
+    dgesdd_( &jobz, &N, &M, 0, &N, 0, 0, &N, 0, &M, &work_query,
+      &lwork_query, m_iwork.data(), &info);
+    m_work.resize(std::max(1, static_cast<int>(work_query)));
+    m_m = M;
+    m_n = N;
+  }
+
+  // dgesdd overwrites its input
+  reserve(m_A, blitz::TinyVector<int,2>(M,N));
+  m_A = A;
+  // Tries to use U, Vt and sigma directly
+  blitz::Array<double,1> S_lapack;
+  const bool sigma_direct_use = bob::core::array::isCZeroBaseContiguous(sigma);
+  if (sigma_direct_use) S_lapack.reference(sigma);
+  else {
+    reserve(m_S, blitz::TinyVector<int,1>(nb_singular));
+    S_lapack.reference(m_S);
+  }
+  // U_lapack = V^T
+  blitz::Array<double,2> U_lapack;
+  const bool U_direct_use = bob::core::array::isCZeroBaseContiguous(Vt);
+  if (U_direct_use) U_lapack.reference(Vt);
+  else {
+    reserve(m_U, blitz::TinyVector<int,2>(N,N));
+    U_lapack.reference(m_U);
+  }
+  // V^T_lapack = U
+  blitz::Array<double,2> VT_lapack;
+  const bool VT_direct_use = bob::core::array::isCZeroBaseContiguous(U);
+  if (VT_direct_use) VT_lapack.reference(U);
+  else {
+    reserve(m_VT, blitz::TinyVector<int,2>(M,M));
+    VT_lapack.reference(m_VT);
+  }
+
+  const int lwork = m_work.extent(0);
+  dgesdd_( &jobz, &N, &M, m_A.data(), &N, S_lapack.data(), U_lapack.data(),
+    &N, VT_lapack.data(), &M, m_work.data(), &lwork, m_iwork.data(), &info);
+  if (info != 0)
+    throw bob::math::LapackError("The LAPACK dgesdd function returned a non-zero value.");
+
+  if (!U_direct_use) Vt = m_U;
+  if (!VT_direct_use) U = m_VT;
+  if (!sigma_direct_use) sigma = m_S;
+}
+
+
+/**
+ * Checks that A is a batch of squared matrices
+ */
+static void check_batch(const blitz::Array<double,3>& A)
+{
+  bob::core::array::assertZeroBase(A);
+  bob::core::array::assertSameDimensionLength(A.extent(1), A.extent(2));
+}
+
+/**
+ * Wraps the k-th matrix of a batch from its data. Slicing the shared batch
+ * inside the workers is not thread-safe, as it updates the reference count of
+ * the underlying blitz memory block.
+ */
+static blitz::Array<double,2> matrix_at(const blitz::Array<double,3>& A,
+  const int k)
+{
+  return blitz::Array<double,2>(const_cast<double*>(A.data()) + k*A.stride(0),
+    blitz::shape(A.extent(1), A.extent(2)),
+    blitz::shape(A.stride(1), A.stride(2)), blitz::neverDeleteData);
+}
+
+/**
+ * Wraps the k-th vector of a batch from its data (see matrix_at()).
+ */
+static blitz::Array<double,1> vector_at(const blitz::Array<double,2>& X,
+  const int k)
+{
+  return blitz::Array<double,1>(const_cast<double*>(X.data()) + k*X.stride(0),
+    blitz::shape(X.extent(1)), blitz::shape(X.stride(1)),
+    blitz::neverDeleteData);
+}
+
+static void chol_chunk(size_t, size_t begin, size_t end,
+  const blitz::Array<double,3>& A, blitz::Array<double,3>& L)
+{
+  // one solver per thread, which reuses its workspace for all its matrices
+  bob::math::SymposSolver solver;
+  for (int k = begin; k < (int)end; ++k) {
+    blitz::Array<double,2> L_k = matrix_at(L, k);
+    solver.chol(matrix_at(A, k), L_k);
+  }
+}
+
+void bob::math::cholBatch(const blitz::Array<double,3>& A,
+  blitz::Array<double,3>& L, const size_t number_of_threads)
+{
+  check_batch(A);
+  bob::core::array::assertZeroBase(L);
+  bob::core::array::assertSameShape(A, L);
+  bob::core::parallel_for(A.extent(0),
+    boost::bind(&chol_chunk, _1, _2, _3, boost::cref(A), boost::ref(L)),
+    number_of_threads);
+}
+
+static void linsolve_sympos_chunk(size_t, size_t begin, size_t end,
+  const blitz::Array<double,3>& A, blitz::Array<double,2>& X,
+  const blitz::Array<double,2>& B)
+{
+  bob::math::SymposSolver solver;
+  for (int k = begin; k < (int)end; ++k) {
+    blitz::Array<double,1> x_k = vector_at(X, k);
+    solver.solve(matrix_at(A, k), x_k, vector_at(B, k));
+  }
+}
+
+void bob::math::linsolveSymposBatch(const blitz::Array<double,3>& A,
+  blitz::Array<double,2>& X, const blitz::Array<double,2>& B,
+  const size_t number_of_threads)
+{
+  check_batch(A);
+  bob::core::array::assertZeroBase(X);
+  bob::core::array::assertZeroBase(B);
+  const blitz::TinyVector<int,2> shape(A.extent(0), A.extent(1));
+  bob::core::array::assertSameShape(X, shape);
+  bob::core::array::assertSameShape(B, shape);
+  bob::core::parallel_for(A.extent(0),
+    boost::bind(&linsolve_sympos_chunk, _1, _2, _3, boost::cref(A),
+      boost::ref(X), boost::cref(B)),
+    number_of_threads);
+}
+
+static void inv_chunk(size_t, size_t begin, size_t end,
+  const blitz::Array<double,3>& A, blitz::Array<double,3>& B)
+{
+  bob::math::Inverter inverter;
+  for (int k = begin; k < (int)end; ++k) {
+    blitz::Array<double,2> B_k = matrix_at(B, k);
+    inverter.inv(matrix_at(A, k), B_k);
+  }
+}
+
+void bob::math::invBatch(const blitz::Array<double,3>& A,
+  blitz::Array<double,3>& B, const size_t number_of_threads)
+{
+  check_batch(A);
+  bob::core::array::assertZeroBase(B);
+  bob::core::array::assertSameShape(A, B);
+  bob::core::parallel_for(A.extent(0),
+    boost::bind(&inv_chunk, _1, _2, _3, boost::cref(A), boost::ref(B)),
+    number_of_threads);
+}
@@ -32,6 +32,7 @@
 #include <bob/core/array_type.h>
 #include <bob/math/linear.h>
 #include <bob/math/LPInteriorPoint.h>
+#include <bob/math/SparseMatrix.h>
 
 struct T {
   double eps;
@@ -85,6 +86,39 @@ void checkBlitzClose( blitz::Array<T,1>& t1, blitz::Array<T,1>& t2,
     BOOST_CHECK_SMALL( fabs( t2(i)-t1(i) ), eps);
 }
 
+/**
+ * Checks that two primal or dual variables agree, relatively to their
+ * magnitude
+ */
+void checkBlitzRelClose( const blitz::Array<double,1>& t1,
+  const blitz::Array<double,1>& t2, const double eps )
+{
+  BOOST_REQUIRE_EQUAL(t1.extent(0), t2.extent(0));
+  for( int i=0; i<t1.extent(0); ++i)
+    BOOST_CHECK_SMALL( fabs( t2(i)-t1(i) ) / (1. + fabs(t2(i))), eps);
+}
+
+/**
+ * Solves the problem with the dense system and with the normal equations
+ * and checks that both lead to the same primal and dual variables
+ */
+template <typename TSolver>
+void checkNormalEquations( TSolver& solver, const blitz::Array<double,2>& A,
+  const blitz::Array<double,1>& b, const blitz::Array<double,1>& c,
+  const blitz::Array<double,1>& x0, const double eps )
+{
+  TSolver normal(solver);
+  blitz::Array<double,1> x_dense(bob::core::array::ccopy(x0));
+  solver.setNormalEquations(false);
+  solver.solve(A, b, c, x_dense);
+  blitz::Array<double,1> x_normal(bob::core::array::ccopy(x0));
+  normal.setNormalEquations(true);
+  normal.solve(A, b, c, x_normal);
+  checkBlitzRelClose(x_normal, x_dense, eps);
+  checkBlitzRelClose(normal.getLambda(), solver.getLambda(), eps);
+  checkBlitzRelClose(normal.getMu(), solver.getMu(), eps);
+}
+
 void generateProblem( const int n, blitz::Array<double,2>& A,
   blitz::Array<double,1>& b, blitz::Array<double,1>& c, 
   blitz::Array<double,1>& x0)
@@ -157,6 +191,119 @@ BOOST_AUTO_TEST_CASE( test_solve )
  
 
 
+BOOST_AUTO_TEST_CASE( test_solve_normal_equations )
+{
+  blitz::Array<double,2> A;
+  blitz::Array<double,1> b;
+  blitz::Array<double,1> c;
+  blitz::Array<double,1> x0;
+  blitz::Array<double,1> sol;
+
+  // The normal equations lead to the same solutions, with dense and sparse A
+  for (int n=1; n<=10; ++n)
+  {
+    generateProblem(n, A, b, c, x0);
+    const bob::math::SparseMatrix A_sparse(A);
+    sol.resize(n);
+    sol = 0.;
+    sol(n-1) = pow(5., n);
+
+    // Short step
+    blitz::Array<double,1> x2(bob::core::array::ccopy(x0));
+    bob::math::LPInteriorPointShortstep solver2(n, 2*n, 0.4, 1e-6);
+    solver2.setNormalEquations(true);
+    solver2.solve(A, b, c, x2);
+    for( int i=0; i<n; ++i)
+      BOOST_CHECK_SMALL( fabs(x2(i)-sol(i)), eps);
+    x2 = x0;
+    solver2.setNormalEquations(false);
+    solver2.solve(A_sparse, b, c, x2);
+    for( int i=0; i<n; ++i)
+      BOOST_CHECK_SMALL( fabs(x2(i)-sol(i)), eps);
+
+    // Predictor corrector
+    blitz::Array<double,1> x3(bob::core::array::ccopy(x0));
+    bob::math::LPInteriorPointPredictorCorrector solver3(n, 2*n, 0.5, 0.25, 1e-6);
+    solver3.setNormalEquations(true);
+    solver3.solve(A, b, c, x3);
+    for( int i=0; i<n; ++i)
+      BOOST_CHECK_SMALL( fabs( x3(i)-sol(i)), eps);
+    x3 = x0;
+    solver3.solve(A_sparse, b, c, x3);
+    for( int i=0; i<n; ++i)
+      BOOST_CHECK_SMALL( fabs( x3(i)-sol(i)), eps);
+
+    // Long step
+    blitz::Array<double,1> x4(bob::core::array::ccopy(x0));
+    bob::math::LPInteriorPointLongstep solver4(n, 2*n, 1e-3, 0.1, 1e-6);
+    solver4.setNormalEquations(true);
+    solver4.solve(A, b, c, x4);
+    for( int i=0; i<n; ++i)
+      BOOST_CHECK_SMALL( fabs( x4(i)-sol(i)), eps);
+    x4 = x0;
+    solver4.solve(A_sparse, b, c, x4);
+    for( int i=0; i<n; ++i)
+      BOOST_CHECK_SMALL( fabs( x4(i)-sol(i)), eps);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_normal_equations_dense_system )
+{
+  blitz::Array<double,2> A;
+  blitz::Array<double,1> b;
+  blitz::Array<double,1> c;
+  blitz::Array<double,1> x0;
+
+  // The normal equations compute the same Newton directions as the dense
+  // system, which leads to the same primal and dual variables
+  for (int n=1; n<=10; ++n)
+  {
+    generateProblem(n, A, b, c, x0);
+
+    bob::math::LPInteriorPointShortstep solver2(n, 2*n, 0.4, 1e-6);
+    checkNormalEquations(solver2, A, b, c, x0, eps);
+
+    bob::math::LPInteriorPointPredictorCorrector solver3(n, 2*n, 0.5, 0.25, 1e-6);
+    checkNormalEquations(solver3, A, b, c, x0, eps);
+
+    bob::math::LPInteriorPointLongstep solver4(n, 2*n, 1e-3, 0.1, 1e-6);
+    checkNormalEquations(solver4, A, b, c, x0, eps);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_sparse_matrix )
+{
+  blitz::Array<double,2> A;
+  blitz::Array<double,1> b;
+  blitz::Array<double,1> c;
+  blitz::Array<double,1> x0;
+  generateProblem(4, A, b, c, x0);
+  const bob::math::SparseMatrix A_sparse(A);
+  BOOST_CHECK_EQUAL( A_sparse.rows(), 4);
+  BOOST_CHECK_EQUAL( A_sparse.cols(), 8);
+  BOOST_CHECK_EQUAL( A_sparse.nonZeros(), 14);
+  blitz::Array<double,2> A_dense = A_sparse.toDense();
+  checkBlitzEqual( A, A_dense);
+
+  // A*x, transpose(A)*y and A*diag(d)*transpose(A)
+  blitz::Array<double,1> y(4), y_ref(4), z(8), z_ref(8);
+  A_sparse.prod(x0, y);
+  bob::math::prod(A, x0, y_ref);
+  checkBlitzClose( y_ref, y, eps);
+  blitz::Array<double,2> A_t = A.transpose(1,0);
+  A_sparse.prodTrans(y, z);
+  bob::math::prod(A_t, y, z_ref);
+  checkBlitzClose( z_ref, z, eps);
+
+  blitz::Array<double,2> C(4,4);
+  blitz::Array<double,1> work;
+  A_sparse.prodDiagTrans(x0, C, work);
+  for (int i=0; i<4; ++i)
+    for (int j=0; j<4; ++j)
+      BOOST_CHECK_SMALL( fabs( C(i,j) - 
+        blitz::sum(A(i,blitz::Range::all()) * x0 * A(j,blitz::Range::all()))), eps);
+}
+
 BOOST_AUTO_TEST_CASE( test_detail_neighborhood )
 {
   // Test math::detail::isFeasible
@@ -0,0 +1,207 @@
+/**
+ * @file math/cxx/test/solvers.cc
+ * @date Mon Jun 17 09:41:25 2013 +0200
+ * @author Laurent El Shafey <Laurent.El-Shafey@idiap.ch>
+ *
+ * @brief Test the solver objects that reuse their LAPACK workspace
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE math-solvers Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <blitz/array.h>
+#include "bob/math/solvers.h"
+#include "bob/math/linsolve.h"
+#include "bob/math/lu.h"
+#include "bob/math/inv.h"
+#include "bob/math/eig.h"
+#include "bob/math/svd.h"
+
+
+struct T {
+  blitz::Array<double,2> A33_2, A33_3, B33_1, S33_2, S33_3, A24;
+  blitz::Array<double,1> b3_1, b3_2, s3_2, s3_3;
+  double eps;
+
+  T(): A33_2(3,3), A33_3(3,3), B33_1(3,3), S33_2(3,3), S33_3(3,3), A24(2,4),
+        b3_1(3), b3_2(3), s3_2(3), s3_3(3), eps(1e-6)
+  {
+    A33_2 = 1., 3., 5., 7., 9., 1., 3., 5., 7.;
+    b3_2 = 2., 4., 6.;
+    s3_2 = 3., -2., 1.;
+    A33_3 = 2., -1., 0., -1, 2., -1., 0., -1., 2.;
+    b3_1 = 7., 5., 3.;
+    s3_3 = 8.5, 10., 6.5;
+    B33_1 = 4., 23., 5., 7., 8., 2., 1., 9., 5.;
+    S33_2 = -5.45, -24.7, -2.2, 5.15, 20.4, 1.9, -1.2, -2.7, 0.3;
+    S33_3 = 6.75, 23.5, 6., 9.5, 24., 7., 5.25, 16.5, 6.;
+    A24 = 0.8147, 0.1270, 0.6324, 0.2785, 0.9058, 0.9134, 0.0975, 0.5469;
+  }
+
+  ~T() {}
+};
+
+/**
+ * Generates a symmetric positive definite matrix of the given size
+ */
+static blitz::Array<double,2> sympos(const int N, const int seed)
+{
+  blitz::Array<double,2> M(N,N), A(N,N);
+  for (int i = 0; i < N; ++i)
+    for (int j = 0; j < N; ++j)
+      M(i,j) = ((i * 7 + j * 13 + seed * 5) % 11) / 11. - 0.5;
+  for (int i = 0; i < N; ++i)
+    for (int j = 0; j < N; ++j) {
+      A(i,j) = (i == j ? N : 0.);
+      for (int k = 0; k < N; ++k) A(i,j) += M(i,k) * M(j,k);
+    }
+  return A;
+}
+
+template<typename T, int d>
+void checkBlitzClose( const blitz::Array<T,d>& t1, const blitz::Array<T,d>& t2,
+  const double eps )
+{
+  for( int i=0; i<d; ++i)
+    BOOST_REQUIRE_EQUAL(t1.extent(i), t2.extent(i));
+  BOOST_CHECK_SMALL( blitz::max(blitz::abs(t2-t1)), eps);
+}
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_linear_solver )
+{
+  bob::math::LinearSolver solver;
+  blitz::Array<double,1> x(3);
+  blitz::Array<double,2> X(3,3);
+
+  solver.solve(A33_2, x, b3_2);
+  checkBlitzClose(s3_2, x, eps);
+  solver.solve(A33_2, X, B33_1);
+  checkBlitzClose(S33_2, X, eps);
+  // The workspace is reused for another system
+  solver.solve(A33_3, x, b3_1);
+  checkBlitzClose(s3_3, x, eps);
+  solver.solve(A33_3, X, B33_1);
+  checkBlitzClose(S33_3, X, eps);
+
+  // Non-contiguous output
+  blitz::Array<double,2> Y(3,6);
+  blitz::Array<double,1> y = Y(1, blitz::Range(0,5,2));
+  solver.solve(A33_2, y, b3_2);
+  checkBlitzClose(s3_2, y, eps);
+}
+
+BOOST_AUTO_TEST_CASE( test_sympos_solver )
+{
+  bob::math::SymposSolver solver;
+  blitz::Array<double,1> x(3);
+  blitz::Array<double,2> X(3,3), L(3,3), L_ref(3,3);
+
+  solver.solve(A33_3, x, b3_1);
+  checkBlitzClose(s3_3, x, eps);
+  solver.solve(A33_3, X, B33_1);
+  checkBlitzClose(S33_3, X, eps);
+  solver.chol(A33_3, L);
+  bob::math::chol(A33_3, L_ref);
+  checkBlitzClose(L_ref, L, eps);
+
+  // The workspace is resized for larger matrices
+  blitz::Array<double,2> A = sympos(7, 1);
+  blitz::Array<double,2> L7(7,7), L7_ref(7,7);
+  solver.chol(A, L7);
+  bob::math::chol(A, L7_ref);
+  checkBlitzClose(L7_ref, L7, eps);
+}
+
+BOOST_AUTO_TEST_CASE( test_inverter )
+{
+  bob::math::Inverter inverter;
+  blitz::Array<double,2> B(3,3), B_ref(3,3);
+  inverter.inv(A33_2, B);
+  bob::math::inv(A33_2, B_ref);
+  checkBlitzClose(B_ref, B, eps);
+  inverter.inv(A33_3, B);
+  bob::math::inv(A33_3, B_ref);
+  checkBlitzClose(B_ref, B, eps);
+
+  // Non-contiguous output
+  blitz::Array<double,2> C(6,3);
+  blitz::Array<double,2> C_view = C(blitz::Range(0,5,2), blitz::Range::all());
+  inverter.inv(A33_3, C_view);
+  checkBlitzClose(B_ref, C_view, eps);
+}
+
+BOOST_AUTO_TEST_CASE( test_eig_sym_solver )
+{
+  bob::math::EigSymSolver solver;
+  for (int N = 3; N < 6; ++N) {
+    blitz::Array<double,2> A = sympos(N, N);
+    blitz::Array<double,2> V(N,N), V_ref(N,N);
+    blitz::Array<double,1> D(N), D_ref(N);
+    solver.eigSym(A, V, D);
+    bob::math::eigSym(A, V_ref, D_ref);
+    checkBlitzClose(D_ref, D, eps);
+    checkBlitzClose(V_ref, V, eps);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_svd_solver )
+{
+  bob::math::SVDSolver solver;
+  blitz::Array<double,2> U(2,2), U_ref(2,2), Vt(4,4), Vt_ref(4,4);
+  blitz::Array<double,1> S(2), S_ref(2);
+  for (int i = 0; i < 2; ++i) {
+    solver.svd(A24, U, S, Vt);
+    bob::math::svd(A24, U_ref, S_ref, Vt_ref);
+    checkBlitzClose(U_ref, U, eps);
+    checkBlitzClose(S_ref, S, eps);
+    checkBlitzClose(Vt_ref, Vt, eps);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_batch )
+{
+  const int K = 13, N = 5;
+  const blitz::Range all = blitz::Range::all();
+  blitz::Array<double,3> A(K,N,N), L(K,N,N), Ainv(K,N,N);
+  blitz::Array<double,2> X(K,N), B(K,N);
+  for (int k = 0; k < K; ++k) {
+    A(k, all, all) = sympos(N, k);
+    for (int i = 0; i < N; ++i) B(k, i) = k - i;
+  }
+
+  for (size_t threads = 1; threads < 5; threads += 3) {
+    bob::math::cholBatch(A, L, threads);
+    bob::math::linsolveSymposBatch(A, X, B, threads);
+    bob::math::invBatch(A, Ainv, threads);
+
+    for (int k = 0; k < K; ++k) {
+      blitz::Array<double,2> L_ref(N,N), Ainv_ref(N,N);
+      blitz::Array<double,1> x_ref(N);
+      bob::math::chol(A(k, all, all), L_ref);
+      bob::math::linsolveSympos(A(k, all, all), x_ref, B(k, all));
+      bob::math::inv(A(k, all, all), Ainv_ref);
+      checkBlitzClose(L_ref, L(k, all, all), eps);
+      checkBlitzClose(x_ref, X(k, all), eps);
+      checkBlitzClose(Ainv_ref, Ainv(k, all, all), eps);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -141,6 +141,7 @@ void bind_math_lp_interiorpoint()
     .add_property("m", &bob::math::LPInteriorPoint::getDimM, &bob::math::LPInteriorPoint::setDimM, "The first dimension M of the problem/A matrix")
     .add_property("n", &bob::math::LPInteriorPoint::getDimN, &bob::math::LPInteriorPoint::setDimN, "The second dimension N of the problem/A matrix")
     .add_property("epsilon", &bob::math::LPInteriorPoint::getEpsilon, &bob::math::LPInteriorPoint::setEpsilon, "The precision to determine whether an equality constraint is fulfilled or not")
+    .add_property("normal_equations", &bob::math::LPInteriorPoint::getNormalEquations, &bob::math::LPInteriorPoint::setNormalEquations, "Whether the Newton directions are computed by solving the MxM normal equations A*D*A^T with a Cholesky decomposition instead of the dense (M+2N)x(M+2N) system, which is much faster for large N")
     .add_property("lambda_", &get_lambda, "The value of the lambda dual variable (read-only)")
     .add_property("mu", &get_mu, "The value of the mu dual variable (read-only)")
     .def("reset", &bob::math::LPInteriorPoint::reset, (arg("self"), arg("M"), arg("N")), "Reset the size of the problem (M and N correspond to the dimensions of the A matrix")
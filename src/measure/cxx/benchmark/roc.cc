@@ -0,0 +1,72 @@
+/**
+ * @file measure/cxx/benchmark/roc.cc
+ * @date 2013-07-04
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Measures the ROC curve and EER threshold computations on random
+ * scores.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/random.hpp>
+#include <blitz/array.h>
+
+#include "bob/core/benchmark.h"
+#include "bob/measure/error.h"
+
+using bob::core::benchmark::param;
+
+struct ROC {
+  const blitz::Array<double,1>& negatives;
+  const blitz::Array<double,1>& positives;
+  size_t points;
+  void operator()() const { bob::measure::roc(negatives, positives, points); }
+};
+
+struct EERThreshold {
+  const blitz::Array<double,1>& negatives;
+  const blitz::Array<double,1>& positives;
+  void operator()() const {
+    bob::measure::eerThreshold(negatives, positives);
+  }
+};
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("measure_roc", argc, argv);
+  const int scores[] = {1000, 10000, 100000};
+  const size_t points[] = {100, 1000};
+
+  boost::mt19937 rng;
+  boost::normal_distribution<> normal;
+
+  for (int s = 0; s < 3; ++s){
+    // impostors are 10 times more numerous than genuine scores
+    const int n_positives = scores[s] / 10, n_negatives = scores[s];
+    blitz::Array<double,1> negatives(n_negatives), positives(n_positives);
+    for (int i = 0; i < n_negatives; ++i) negatives(i) = normal(rng) - 1.;
+    for (int i = 0; i < n_positives; ++i) positives(i) = normal(rng) + 1.;
+
+    for (int p = 0; p < 2; ++p){
+      ROC roc = {negatives, positives, points[p]};
+      suite.run("roc", param("negatives", n_negatives) + "," +
+          param("points", points[p]), roc);
+    }
+    EERThreshold eer = {negatives, positives};
+    suite.run("eerThreshold", param("negatives", n_negatives), eer);
+  }
+
+  return suite.finish();
+}
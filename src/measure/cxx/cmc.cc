@@ -0,0 +1,141 @@
+/**
+ * @file measure/cxx/cmc.cc
+ * @date Tue Jun 11 14:32:08 2013 +0200
+ * @author Manuel Guenther <Manuel.Guenther@idiap.ch>
+ *
+ * @brief Implements the cumulative match characteristic (CMC)
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <boost/format.hpp>
+#include <bob/measure/cmc.h>
+#include <bob/core/Exception.h>
+#include <bob/core/array_copy.h>
+#include <bob/core/parallel.h>
+
+bob::measure::CMCScores::CMCScores()
+: m_negative_offsets(1),
+  m_positive_offsets(1)
+{
+  m_negative_offsets = 0;
+  m_positive_offsets = 0;
+}
+
+/**
+ * Checks that the given offsets describe a valid partition of the given
+ * number of scores
+ */
+static void check_offsets(const blitz::Array<int,1>& offsets, int scores,
+    const char* name) {
+  if (offsets.extent(0) < 1 || offsets(0) != 0 ||
+      offsets(offsets.extent(0)-1) != scores)
+    throw bob::core::InvalidArgumentException((boost::format("The %s offsets must start with 0 and end with the number of %s scores (%d)") % name % name % scores).str());
+  for (int p = 1; p < offsets.extent(0); ++p)
+    if (offsets(p) < offsets(p-1))
+      throw bob::core::InvalidArgumentException((boost::format("The %s offsets must not be decreasing") % name).str());
+}
+
+bob::measure::CMCScores::CMCScores(const blitz::Array<double,1>& negatives,
+    const blitz::Array<int,1>& negative_offsets,
+    const blitz::Array<double,1>& positives,
+    const blitz::Array<int,1>& positive_offsets,
+    const std::vector<std::string>& probes)
+: m_negatives(bob::core::array::ccopy(negatives)),
+  m_negative_offsets(bob::core::array::ccopy(negative_offsets)),
+  m_positives(bob::core::array::ccopy(positives)),
+  m_positive_offsets(bob::core::array::ccopy(positive_offsets)),
+  m_probes(probes)
+{
+  check_offsets(m_negative_offsets, m_negatives.extent(0), "negative");
+  check_offsets(m_positive_offsets, m_positives.extent(0), "positive");
+  if (m_negative_offsets.extent(0) != m_positive_offsets.extent(0))
+    throw bob::core::InvalidArgumentException("The negative and positive offsets must describe the same number of probes");
+  if (!m_probes.empty() && m_probes.size() != size())
+    throw bob::core::InvalidArgumentException("The number of probe labels must be identical to the number of probes");
+  for (int p = 1; p < m_positive_offsets.extent(0); ++p)
+    if (m_positive_offsets(p) == m_positive_offsets(p-1))
+      throw bob::core::InvalidArgumentException((boost::format("Probe %d does not have any positive score") % (p-1)).str());
+}
+
+/**
+ * Computes the ranks of the probes [begin, end). The negative scores of each
+ * probe are contiguous in memory.
+ */
+static void compute_ranks(size_t, size_t begin, size_t end,
+    const bob::measure::CMCScores& scores, blitz::Array<int,1>& ranks) {
+  const double* negatives = scores.negatives().data();
+  const double* positives = scores.positives().data();
+  const blitz::Array<int,1>& neg_offsets = scores.negativeOffsets();
+  const blitz::Array<int,1>& pos_offsets = scores.positiveOffsets();
+
+  for (size_t p = begin; p < end; ++p) {
+    // get the maximum positive score for the current probe item
+    // (usually, there is only one positive score, but just in case...)
+    double max_pos = positives[pos_offsets(p)];
+    for (int i = pos_offsets(p) + 1; i < pos_offsets(p+1); ++i)
+      max_pos = std::max(max_pos, positives[i]);
+
+    // count the number of negative scores that are higher than the best
+    // positive score
+    int rank = 0;
+    for (int i = neg_offsets(p); i < neg_offsets(p+1); ++i)
+      rank += negatives[i] > max_pos;
+    ranks(p) = rank;
+  }
+}
+
+blitz::Array<int,1> bob::measure::ranks(const bob::measure::CMCScores& scores,
+    size_t number_of_threads) {
+  blitz::Array<int,1> retval(scores.size());
+  bob::core::parallel_for(scores.size(), boost::bind(&compute_ranks, _1, _2,
+        _3, boost::cref(scores), boost::ref(retval)), number_of_threads);
+  return retval;
+}
+
+double bob::measure::recognitionRate(const bob::measure::CMCScores& scores,
+    size_t number_of_threads) {
+  if (!scores.size())
+    throw bob::core::InvalidArgumentException("The recognition rate cannot be computed without probes");
+  blitz::Array<int,1> r = ranks(scores, number_of_threads);
+  return blitz::count(r == 0) / (double)scores.size();
+}
+
+blitz::Array<double,1> bob::measure::cmc(const bob::measure::CMCScores& scores,
+    size_t number_of_threads) {
+  if (!scores.size())
+    throw bob::core::InvalidArgumentException("The CMC cannot be computed without probes");
+  blitz::Array<int,1> r = ranks(scores, number_of_threads);
+
+  // the CMC has one element more than the largest number of negatives
+  const blitz::Array<int,1>& offsets = scores.negativeOffsets();
+  int max_negatives = 0;
+  for (size_t p = 0; p < scores.size(); ++p)
+    max_negatives = std::max(max_negatives, offsets(p+1) - offsets(p));
+
+  // compute match characteristic
+  blitz::Array<double,1> retval(max_negatives + 1);
+  retval = 0.;
+  for (size_t p = 0; p < scores.size(); ++p) retval(r(p)) += 1.;
+
+  // cumulate
+  double count = 0.;
+  for (int i = 0; i < retval.extent(0); ++i) {
+    count += retval(i);
+    retval(i) = count / scores.size();
+  }
+  return retval;
+}
@@ -0,0 +1,337 @@
+/**
+ * @file measure/cxx/load.cc
+ * @date Tue Jun 11 14:32:08 2013 +0200
+ * @author Manuel Guenther <Manuel.Guenther@idiap.ch>
+ *
+ * @brief Implements the multi-threaded score file loader
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <boost/format.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <bob/measure/load.h>
+#include <bob/core/Exception.h>
+#include <bob/core/logging.h>
+#include <bob/core/parallel.h>
+
+/**
+ * Interns strings, i.e., assigns consecutive indices in order of first
+ * occurrence
+ */
+class StringTable {
+
+  public:
+
+    int intern(const char* begin, const char* end) {
+      std::string label(begin, end);
+      boost::unordered_map<std::string,int>::const_iterator it = m_index.find(label);
+      if (it != m_index.end()) return it->second;
+      int index = m_labels.size();
+      m_index.insert(std::make_pair(label, index));
+      m_labels.push_back(label);
+      return index;
+    }
+
+    int intern(const std::string& label) {
+      return intern(label.data(), label.data() + label.size());
+    }
+
+    const std::vector<std::string>& labels() const { return m_labels; }
+
+  private:
+
+    boost::unordered_map<std::string,int> m_index;
+    std::vector<std::string> m_labels;
+};
+
+/**
+ * The result of parsing a consecutive block of lines, with labels interned
+ * into chunk-local tables
+ */
+struct ScoreChunk {
+  const char* begin;
+  const char* end;
+  std::vector<double> scores;
+  std::vector<int> claimed_ids, real_ids, probe_ids;
+  StringTable identities, probes;
+  // the number of lines read and the first error that occurred
+  size_t lines;
+  std::string error;
+  // the global index of the first score and the mapping to global labels
+  size_t offset;
+  std::vector<int> identity_map, probe_map;
+};
+
+static bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * Parses a single score from the given field, which is not null-terminated
+ */
+static bool parse_score(const char* begin, const char* end, double& score) {
+  char buffer[64];
+  size_t length = end - begin;
+  if (length >= sizeof(buffer)) return false;
+  std::memcpy(buffer, begin, length);
+  buffer[length] = '\0';
+  char* stop;
+  score = std::strtod(buffer, &stop);
+  return stop == buffer + length;
+}
+
+/**
+ * Parses all lines of the given chunk; stops at the first invalid line
+ */
+static void parse_chunk(ScoreChunk& chunk, int columns) {
+  // the indices of the columns that we need
+  const int claimed = 0, real = columns == 4 ? 1 : 2,
+        probe = columns == 4 ? 2 : 3, score = columns - 1;
+  const char* fields[5][2];
+
+  chunk.lines = 0;
+  for (const char* line = chunk.begin; line < chunk.end; ++chunk.lines) {
+    const char* eol = static_cast<const char*>(std::memchr(line, '\n', chunk.end - line));
+    if (!eol) eol = chunk.end;
+
+    // split the line into (at most columns) fields
+    int count = 0;
+    const char* c = line;
+    while (count < columns) {
+      while (c < eol && is_space(*c)) ++c;
+      if (c == eol) break;
+      if (count == 0 && *c == '#') break; // comment line
+      fields[count][0] = c;
+      while (c < eol && !is_space(*c)) ++c;
+      fields[count++][1] = c;
+    }
+
+    // empty or comment line
+    if (count == 0) { line = eol + 1; continue; }
+
+    if (count < columns) {
+      chunk.error = (boost::format("is invalid: %s") % std::string(line, eol)).str();
+      return;
+    }
+
+    double value;
+    if (!parse_score(fields[score][0], fields[score][1], value)) {
+      chunk.error = (boost::format("cannot be converted to float: %s") % std::string(line, eol)).str();
+      return;
+    }
+
+    chunk.scores.push_back(value);
+    chunk.claimed_ids.push_back(chunk.identities.intern(fields[claimed][0], fields[claimed][1]));
+    chunk.real_ids.push_back(chunk.identities.intern(fields[real][0], fields[real][1]));
+    chunk.probe_ids.push_back(chunk.probes.intern(fields[probe][0], fields[probe][1]));
+
+    line = eol + 1;
+  }
+}
+
+static void parse_chunks(size_t, size_t begin, size_t end,
+    std::vector<ScoreChunk>& chunks, int columns) {
+  for (size_t i = begin; i < end; ++i) parse_chunk(chunks[i], columns);
+}
+
+/**
+ * Copies the scores and the globally interned labels of the given chunks
+ * into the final arrays
+ */
+static void merge_chunks(size_t, size_t begin, size_t end,
+    const std::vector<ScoreChunk>& chunks, blitz::Array<double,1>& scores,
+    blitz::Array<int,1>& claimed_ids, blitz::Array<int,1>& real_ids,
+    blitz::Array<int,1>& probe_ids) {
+  for (size_t i = begin; i < end; ++i) {
+    const ScoreChunk& chunk = chunks[i];
+    for (size_t j = 0; j < chunk.scores.size(); ++j) {
+      int k = chunk.offset + j;
+      scores(k) = chunk.scores[j];
+      claimed_ids(k) = chunk.identity_map[chunk.claimed_ids[j]];
+      real_ids(k) = chunk.identity_map[chunk.real_ids[j]];
+      probe_ids(k) = chunk.probe_map[chunk.probe_ids[j]];
+    }
+  }
+}
+
+bob::measure::ScoreFile::ScoreFile(const std::string& filename, int columns,
+    size_t number_of_threads, size_t chunk_size)
+: m_columns(columns)
+{
+  if (columns != 4 && columns != 5)
+    throw bob::core::InvalidArgumentException("columns", columns, 4, 5);
+  if (!chunk_size)
+    throw bob::core::InvalidArgumentException("The chunk size must be positive");
+
+  boost::system::error_code ec;
+  size_t file_size = boost::filesystem::file_size(filename, ec);
+  if (ec)
+    throw bob::core::InvalidArgumentException((boost::format("Score file \"%s\" cannot be read") % filename).str());
+
+  // empty files cannot be memory mapped
+  if (!file_size) {
+    m_scores.resize(0); m_claimed_ids.resize(0); m_real_ids.resize(0); m_probe_ids.resize(0);
+    return;
+  }
+
+  boost::iostreams::mapped_file_source file;
+  try {
+    file.open(filename);
+  }
+  catch (std::exception&) {
+    throw bob::core::InvalidArgumentException((boost::format("Score file \"%s\" cannot be memory mapped") % filename).str());
+  }
+  const char* data = file.data();
+  const char* data_end = data + file.size();
+
+  // split the file into chunks of consecutive lines, one per thread
+  size_t threads = bob::core::number_of_threads(number_of_threads);
+  size_t chunk_count = std::max<size_t>(1, std::min(threads, file.size() / chunk_size));
+  std::vector<ScoreChunk> chunks(chunk_count);
+  const char* begin = data;
+  for (size_t i = 0; i < chunk_count; ++i) {
+    const char* end = data + file.size() * (i+1) / chunk_count;
+    if (end < begin) end = begin;
+    if (i + 1 < chunk_count) {
+      // move the chunk end behind the next line break
+      const char* eol = static_cast<const char*>(std::memchr(end, '\n', data_end - end));
+      end = eol ? eol + 1 : data_end;
+    }
+    else end = data_end;
+    chunks[i].begin = begin;
+    chunks[i].end = end;
+    begin = end;
+  }
+
+  bob::core::parallel_for(chunk_count, boost::bind(&parse_chunks, _1, _2, _3,
+        boost::ref(chunks), columns), chunk_count);
+
+  // report the first error, with the line number in the complete file
+  size_t lines = 0, total = 0;
+  for (size_t i = 0; i < chunk_count; ++i) {
+    if (!chunks[i].error.empty())
+      throw bob::core::InvalidArgumentException((boost::format("Line %d of file \"%s\" %s") % (lines + chunks[i].lines) % filename % chunks[i].error).str());
+    lines += chunks[i].lines;
+    chunks[i].offset = total;
+    total += chunks[i].scores.size();
+  }
+
+  // intern the labels of all chunks globally, in the order of the file
+  StringTable identities, probes;
+  for (size_t i = 0; i < chunk_count; ++i) {
+    const std::vector<std::string>& ids = chunks[i].identities.labels();
+    chunks[i].identity_map.resize(ids.size());
+    for (size_t j = 0; j < ids.size(); ++j)
+      chunks[i].identity_map[j] = identities.intern(ids[j]);
+    const std::vector<std::string>& prs = chunks[i].probes.labels();
+    chunks[i].probe_map.resize(prs.size());
+    for (size_t j = 0; j < prs.size(); ++j)
+      chunks[i].probe_map[j] = probes.intern(prs[j]);
+  }
+  m_identities = identities.labels();
+  m_probe_labels = probes.labels();
+
+  m_scores.resize(total);
+  m_claimed_ids.resize(total);
+  m_real_ids.resize(total);
+  m_probe_ids.resize(total);
+  bob::core::parallel_for(chunk_count, boost::bind(&merge_chunks, _1, _2, _3,
+        boost::cref(chunks), boost::ref(m_scores), boost::ref(m_claimed_ids),
+        boost::ref(m_real_ids), boost::ref(m_probe_ids)), chunk_count);
+}
+
+std::pair<blitz::Array<double,1>, blitz::Array<double,1> >
+bob::measure::ScoreFile::split() const {
+  int positive_count = blitz::count(m_claimed_ids == m_real_ids);
+  blitz::Array<double,1> negatives(size() - positive_count), positives(positive_count);
+  for (int i = 0, n = 0, p = 0; i < (int)size(); ++i) {
+    if (m_claimed_ids(i) == m_real_ids(i)) positives(p++) = m_scores(i);
+    else negatives(n++) = m_scores(i);
+  }
+  return std::make_pair(negatives, positives);
+}
+
+/**
+ * Compares probe indices by their labels
+ */
+struct ProbeLabelLess {
+  ProbeLabelLess(const std::vector<std::string>& labels) : m_labels(labels) {}
+  bool operator()(int a, int b) const { return m_labels[a] < m_labels[b]; }
+  const std::vector<std::string>& m_labels;
+};
+
+bob::measure::CMCScores bob::measure::ScoreFile::cmcScores() const {
+  // count the negatives and positives of each probe
+  const size_t probe_count = m_probe_labels.size();
+  std::vector<int> negative_count(probe_count, 0), positive_count(probe_count, 0);
+  for (int i = 0; i < (int)size(); ++i) {
+    if (m_claimed_ids(i) == m_real_ids(i)) ++positive_count[m_probe_ids(i)];
+    else ++negative_count[m_probe_ids(i)];
+  }
+
+  // sort the probes by name and keep only those with positives and negatives
+  std::vector<int> order(probe_count);
+  for (size_t p = 0; p < probe_count; ++p) order[p] = p;
+  std::sort(order.begin(), order.end(), ProbeLabelLess(m_probe_labels));
+
+  std::vector<int> position(probe_count, -1);
+  std::vector<std::string> labels;
+  for (size_t k = 0; k < probe_count; ++k) {
+    int p = order[k];
+    if (!negative_count[p])
+      bob::core::warn << "For probe name \"" << m_probe_labels[p] << "\" there are only positive scores. This probe name is ignored." << std::endl;
+    else if (!positive_count[p])
+      bob::core::warn << "For probe name \"" << m_probe_labels[p] << "\" there are only negative scores. This probe name is ignored." << std::endl;
+    else {
+      position[p] = labels.size();
+      labels.push_back(m_probe_labels[p]);
+    }
+  }
+
+  // compute the CSR offsets
+  blitz::Array<int,1> negative_offsets(labels.size() + 1), positive_offsets(labels.size() + 1);
+  negative_offsets(0) = positive_offsets(0) = 0;
+  for (size_t p = 0; p < probe_count; ++p) {
+    if (position[p] < 0) continue;
+    negative_offsets(position[p] + 1) = negative_count[p];
+    positive_offsets(position[p] + 1) = positive_count[p];
+  }
+  for (int k = 1; k < negative_offsets.extent(0); ++k) {
+    negative_offsets(k) += negative_offsets(k-1);
+    positive_offsets(k) += positive_offsets(k-1);
+  }
+
+  // fill the scores, keeping the order of the file for each probe
+  blitz::Array<double,1> negatives(negative_offsets(labels.size())), positives(positive_offsets(labels.size()));
+  std::vector<int> next_negative(labels.size()), next_positive(labels.size());
+  for (size_t k = 0; k < labels.size(); ++k) {
+    next_negative[k] = negative_offsets(k);
+    next_positive[k] = positive_offsets(k);
+  }
+  for (int i = 0; i < (int)size(); ++i) {
+    int p = position[m_probe_ids(i)];
+    if (p < 0) continue;
+    if (m_claimed_ids(i) == m_real_ids(i)) positives(next_positive[p]++) = m_scores(i);
+    else negatives(next_negative[p]++) = m_scores(i);
+  }
+
+  return bob::measure::CMCScores(negatives, negative_offsets, positives, positive_offsets, labels);
+}
@@ -0,0 +1,102 @@
+/**
+ * @file measure/python/load.cc
+ * @date Tue Jun 11 14:32:08 2013 +0200
+ * @author Manuel Guenther <Manuel.Guenther@idiap.ch>
+ *
+ * @brief Binds the score file loader and the CMC computation to python
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+#include "bob/measure/load.h"
+#include "bob/core/python/ndarray.h"
+
+using namespace boost::python;
+
+static list to_list(const std::vector<std::string>& labels) {
+  list retval;
+  for (std::vector<std::string>::const_iterator it = labels.begin(); it != labels.end(); ++it)
+    retval.append(*it);
+  return retval;
+}
+
+static boost::shared_ptr<bob::measure::CMCScores> cmc_scores_init(
+    bob::python::const_ndarray negatives,
+    bob::python::const_ndarray negative_offsets,
+    bob::python::const_ndarray positives,
+    bob::python::const_ndarray positive_offsets
+){
+  return boost::shared_ptr<bob::measure::CMCScores>(new bob::measure::CMCScores(
+        negatives.cast<double,1>(), negative_offsets.cast<int,1>(),
+        positives.cast<double,1>(), positive_offsets.cast<int,1>()));
+}
+
+static tuple cmc_scores_getitem(const bob::measure::CMCScores& self, int index) {
+  if (index < 0) index += self.size();
+  if (index < 0 || index >= (int)self.size())
+    throw std::out_of_range("CMCScores index out of range");
+  blitz::Range neg(self.negativeOffsets()(index), self.negativeOffsets()(index+1) - 1);
+  blitz::Range pos(self.positiveOffsets()(index), self.positiveOffsets()(index+1) - 1);
+  blitz::Array<double,1> negatives(self.negatives()(neg).copy()), positives(self.positives()(pos).copy());
+  return make_tuple(negatives, positives);
+}
+
+static list cmc_scores_probes(const bob::measure::CMCScores& self) {
+  return to_list(self.probes());
+}
+
+static tuple score_file_split(const bob::measure::ScoreFile& self) {
+  std::pair<blitz::Array<double,1>, blitz::Array<double,1> > retval = self.split();
+  return make_tuple(retval.first, retval.second);
+}
+
+static list score_file_identities(const bob::measure::ScoreFile& self) {
+  return to_list(self.identities());
+}
+
+static list score_file_probe_labels(const bob::measure::ScoreFile& self) {
+  return to_list(self.probeLabels());
+}
+
+void bind_measure_load() {
+
+  class_<bob::measure::CMCScores, boost::shared_ptr<bob::measure::CMCScores> >("CMCScores", "The negative and positive scores of a set of probes, stored in compressed sparse row (CSR) format: the negative scores of probe ``p`` are ``negatives[negative_offsets[p]:negative_offsets[p+1]]``, and likewise for the positives. Iterating over this object yields one ``(negatives, positives)`` tuple per probe, so it can be used wherever a list of such tuples is expected.", init<>("Creates an empty set of scores."))
+    .def("__init__", make_constructor(&cmc_scores_init, default_call_policies(), (arg("negatives"), arg("negative_offsets"), arg("positives"), arg("positive_offsets"))), "Creates the set of scores from the given CSR arrays; the offset arrays have one element more than there are probes.")
+    .add_property("negatives", make_function(&bob::measure::CMCScores::negatives, return_value_policy<copy_const_reference>()), "All negative scores, grouped by probe")
+    .add_property("negative_offsets", make_function(&bob::measure::CMCScores::negativeOffsets, return_value_policy<copy_const_reference>()), "The offsets of the negative scores of each probe")
+    .add_property("positives", make_function(&bob::measure::CMCScores::positives, return_value_policy<copy_const_reference>()), "All positive scores, grouped by probe")
+    .add_property("positive_offsets", make_function(&bob::measure::CMCScores::positiveOffsets, return_value_policy<copy_const_reference>()), "The offsets of the positive scores of each probe")
+    .add_property("probes", &cmc_scores_probes, "The labels of the probes; might be empty")
+    .def("__len__", &bob::measure::CMCScores::size, (arg("self")), "The number of probes")
+    .def("__getitem__", &cmc_scores_getitem, (arg("self"), arg("index")), "Returns the tuple (negatives, positives) of the probe with the given index")
+    .def("ranks", &bob::measure::ranks, (arg("self"), arg("number_of_threads")=1), "Computes the rank of each probe, i.e., the number of negative scores that are greater than the highest positive score of the probe. The probes are distributed over the given number of threads (0: all cores).")
+    .def("recognition_rate", &bob::measure::recognitionRate, (arg("self"), arg("number_of_threads")=1), "Computes the recognition rate, i.e., the relative number of probes with rank 0.")
+    .def("cmc", &bob::measure::cmc, (arg("self"), arg("number_of_threads")=1), "Computes the cumulative match characteristic (CMC); element r is the relative number of probes with a rank of at most r.")
+    ;
+
+  class_<bob::measure::ScoreFile, boost::shared_ptr<bob::measure::ScoreFile> >("ScoreFile", "A score file in four or five column format, loaded to memory. The file is memory-mapped and parsed by several threads; all string labels are interned, i.e., stored as indices into the tables of identities and probe labels.", init<const std::string&, optional<int, size_t, size_t> >((arg("self"), arg("filename"), arg("columns")=4, arg("number_of_threads")=0, arg("chunk_size")=1<<20), "Loads the given score file with the given number of columns (4 or 5) using the given number of threads (0: all cores). Each thread parses at least chunk_size bytes of the file."))
+    .def("__len__", &bob::measure::ScoreFile::size, (arg("self")), "The number of scores in the file")
+    .add_property("columns", &bob::measure::ScoreFile::columns, "The number of columns of the score file")
+    .add_property("scores", make_function(&bob::measure::ScoreFile::scores, return_value_policy<copy_const_reference>()), "All scores in the order of the file")
+    .add_property("claimed_ids", make_function(&bob::measure::ScoreFile::claimedIds, return_value_policy<copy_const_reference>()), "The indices of the claimed identities into the identities table")
+    .add_property("real_ids", make_function(&bob::measure::ScoreFile::realIds, return_value_policy<copy_const_reference>()), "The indices of the real identities into the identities table")
+    .add_property("probe_ids", make_function(&bob::measure::ScoreFile::probeIds, return_value_policy<copy_const_reference>()), "The indices of the test labels into the probe labels table")
+    .add_property("identities", &score_file_identities, "The interned identities, in order of first occurrence")
+    .add_property("probe_labels", &score_file_probe_labels, "The interned test labels, in order of first occurrence")
+    .def("split", &score_file_split, (arg("self")), "Splits the scores into a tuple (negatives, positives); a score is positive if the claimed identity equals the real identity.")
+    .def("cmc_scores", &bob::measure::ScoreFile::cmcScores, (arg("self")), "Groups the scores by test label (sorted by name) and returns them as CMCScores. Test labels with only positive or only negative scores are ignored.")
+    ;
+}
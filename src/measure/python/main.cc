@@ -23,10 +23,12 @@
 #include "bob/core/python/ndarray.h"
 
 void bind_measure_error();
+void bind_measure_load();
 
 BOOST_PYTHON_MODULE(_measure) {
 
   bob::python::setup_python("bob error measure classes and sub-classes");
 
   bind_measure_error();
+  bind_measure_load();
 }
@@ -25,6 +25,8 @@
 #include <bob/core/assert.h>
 #include <fftw3.h>
 
+#include "planner.h"
+
 bob::sp::DCT1DAbstract::DCT1DAbstract(const size_t length):
   m_length(length)
 {
@@ -128,9 +130,15 @@ void bob::sp::DCT1D::operator()(const blitz::Array<double,1>& src,
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_r2r_1d(src.extent(0), src_, dst_, FFTW_REDFT10, FFTW_ESTIMATE);
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    p = fftw_plan_r2r_1d(src.extent(0), src_, dst_, FFTW_REDFT10, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    fftw_destroy_plan(p);
+  }
 
   // Normalize
   dst(0) *= m_sqrt_1byl/2.;
@@ -186,8 +194,14 @@ void bob::sp::IDCT1D::operator()(const blitz::Array<double,1>& src,
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_r2r_1d(src.extent(0), dst_, dst_, FFTW_REDFT01, FFTW_ESTIMATE);
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    p = fftw_plan_r2r_1d(src.extent(0), dst_, dst_, FFTW_REDFT01, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    fftw_destroy_plan(p);
+  }
 }
 
@@ -25,6 +25,8 @@
 #include <bob/core/assert.h>
 #include <fftw3.h>
 
+#include "planner.h"
+
 
 bob::sp::DCT2DAbstract::DCT2DAbstract(const size_t height, const size_t width):
   m_height(height), m_width(width)
@@ -137,9 +139,15 @@ void bob::sp::DCT2D::operator()(const blitz::Array<double,2>& src,
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_r2r_2d(src.extent(0), src.extent(1), src_, dst_, FFTW_REDFT10, FFTW_REDFT10, FFTW_ESTIMATE);
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    p = fftw_plan_r2r_2d(src.extent(0), src.extent(1), src_, dst_, FFTW_REDFT10, FFTW_REDFT10, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    fftw_destroy_plan(p);
+  }
 
   // Rescale the result
   for (int i=0; i<(int)m_height; ++i)
@@ -191,9 +199,15 @@ void bob::sp::IDCT2D::operator()(const blitz::Array<double,2>& src,
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_r2r_2d(src.extent(0), src.extent(1), dst_, dst_, FFTW_REDFT01, FFTW_REDFT01, FFTW_ESTIMATE);
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    p = fftw_plan_r2r_2d(src.extent(0), src.extent(1), dst_, dst_, FFTW_REDFT01, FFTW_REDFT01, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    fftw_destroy_plan(p);
+  }
   
   // Rescale the result by the size of the input 
   // (as this is not performed by FFW)
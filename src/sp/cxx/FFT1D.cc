@@ -25,6 +25,8 @@
 #include <bob/core/assert.h>
 #include <fftw3.h>
 
+#include "planner.h"
+
 
 bob::sp::FFT1DAbstract::FFT1DAbstract(const size_t length):
   m_length(length)
@@ -107,9 +109,15 @@ void bob::sp::FFT1D::operator()(const blitz::Array<std::complex<double>,1>& src,
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_dft_1d(src.extent(0), src_, dst_, FFTW_FORWARD, FFTW_ESTIMATE);
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    p = fftw_plan_dft_1d(src.extent(0), src_, dst_, FFTW_FORWARD, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    fftw_destroy_plan(p);
+  }
 }
 
 
@@ -149,9 +157,15 @@ void bob::sp::IFFT1D::operator()(const blitz::Array<std::complex<double>,1>& src
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_dft_1d(src.extent(0), src_, dst_, FFTW_BACKWARD, FFTW_ESTIMATE);
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    p = fftw_plan_dft_1d(src.extent(0), src_, dst_, FFTW_BACKWARD, FFTW_ESTIMATE);
+  }
   fftw_execute(p); /* repeat as needed */
-  fftw_destroy_plan(p);
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    fftw_destroy_plan(p);
+  }
 
   // Rescale as FFTW is not doing it
   dst /= static_cast<double>(m_length);
@@ -25,6 +25,39 @@
 #include <bob/core/assert.h>
 #include <fftw3.h>
 
+#include "planner.h"
+
+boost::mutex& bob::sp::detail::planner_mutex()
+{
+  static boost::mutex s_mutex;
+  return s_mutex;
+}
+
+static void destroy_plan(void* plan)
+{
+  boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+  fftw_destroy_plan(static_cast<fftw_plan>(plan));
+}
+
+/**
+ * Creates a complex 2D plan for the given shape. The plan is created using
+ * temporary buffers and FFTW_UNALIGNED, so that it can be executed on any
+ * array of the same shape using fftw_execute_dft(). The planner mutex must be
+ * held by the caller.
+ */
+static boost::shared_ptr<void> create_plan(const size_t height,
+  const size_t width, const int sign, const bool inplace)
+{
+  fftw_complex* in = static_cast<fftw_complex*>(fftw_malloc(sizeof(fftw_complex)*height*width));
+  fftw_complex* out = inplace ? in : static_cast<fftw_complex*>(fftw_malloc(sizeof(fftw_complex)*height*width));
+  // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
+  // for large arrays
+  fftw_plan p = fftw_plan_dft_2d(height, width, in, out, sign, FFTW_ESTIMATE | FFTW_UNALIGNED);
+  if (!inplace) fftw_free(out);
+  fftw_free(in);
+  return boost::shared_ptr<void>(p, destroy_plan);
+}
+
 bob::sp::FFT2DAbstract::FFT2DAbstract(const size_t height, const size_t width):
   m_height(height), m_width(width)
 {
@@ -63,6 +96,54 @@ void bob::sp::FFT2DAbstract::reset(const size_t height, const size_t width)
   // Update the height and width
   m_height = height;
   m_width = width;
+  // Drop the plans of the old shape
+  m_plan.reset();
+  m_plan_inplace.reset();
+}
+
+boost::shared_ptr<void> bob::sp::FFT2DAbstract::getPlan(const int sign,
+  const bool inplace) const
+{
+  boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+  boost::shared_ptr<void>& plan = inplace ? m_plan_inplace : m_plan;
+  if (!plan) plan = create_plan(m_height, m_width, sign, inplace);
+  return plan;
+}
+
+/**
+ * Executes the 2D complex FFT from src to dst (which might be identical).
+ * If the shape of the arrays corresponds to the shape of the transform, the
+ * cached plan is used, otherwise a temporary plan is created.
+ */
+static void execute(boost::shared_ptr<void> plan, const int sign,
+  const blitz::Array<std::complex<double>,2>& src,
+  blitz::Array<std::complex<double>,2>& dst)
+{
+  // Reinterpret cast to fftw format
+  fftw_complex* src_ = reinterpret_cast<fftw_complex*>(const_cast<std::complex<double>* >(src.data()));
+  fftw_complex* dst_ = reinterpret_cast<fftw_complex*>(dst.data());
+
+  if (plan) {
+    fftw_execute_dft(static_cast<fftw_plan>(plan.get()), src_, dst_);
+  }
+  else {
+    fftw_plan p;
+    {
+      boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+      // FFTW_ESTIMATE -> The planner is computed quickly but may not be
+      // optimized for large arrays
+      p = fftw_plan_dft_2d(src.extent(0), src.extent(1), src_, dst_, sign, FFTW_ESTIMATE);
+    }
+    fftw_execute(p);
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    fftw_destroy_plan(p);
+  }
+}
+
+static inline bool has_shape(const blitz::Array<std::complex<double>,2>& a,
+  const size_t height, const size_t width)
+{
+  return a.extent(0) == (int)height && a.extent(1) == (int)width;
 }
 
 bob::sp::FFT2D::FFT2D():
@@ -94,16 +175,10 @@ void bob::sp::FFT2D::operator()(const blitz::Array<std::complex<double>,2>& src,
   bob::core::array::assertCZeroBaseContiguous(dst);
   bob::core::array::assertSameShape( dst, src);
 
-  // Reinterpret cast to fftw format
-  fftw_complex* src_ = reinterpret_cast<fftw_complex*>(const_cast<std::complex<double>* >(src.data()));
-  fftw_complex* dst_ = reinterpret_cast<fftw_complex*>(dst.data());
-  
-  fftw_plan p;
-  // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
-  // for large arrays
-  p = fftw_plan_dft_2d(src.extent(0), src.extent(1), src_, dst_, FFTW_FORWARD, FFTW_ESTIMATE);
-  fftw_execute(p);
-  fftw_destroy_plan(p);
+  const bool inplace = src.data() == dst.data();
+  boost::shared_ptr<void> plan;
+  if (has_shape(src, m_height, m_width)) plan = getPlan(FFTW_FORWARD, inplace);
+  execute(plan, FFTW_FORWARD, src, dst);
 }
 
 
@@ -112,15 +187,9 @@ void bob::sp::FFT2D::operator()(blitz::Array<std::complex<double>,2>& src_dst) c
   // check data
   bob::core::array::assertCZeroBaseContiguous(src_dst);
 
-  // Reinterpret cast to fftw format
-  fftw_complex* src_dst_ = reinterpret_cast<fftw_complex*>(src_dst.data());
-
-  fftw_plan p;
-  // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized
-  // for large arrays
-  p = fftw_plan_dft_2d(src_dst.extent(0), src_dst.extent(1), src_dst_, src_dst_, FFTW_FORWARD, FFTW_ESTIMATE);
-  fftw_execute(p);
-  fftw_destroy_plan(p);
+  boost::shared_ptr<void> plan;
+  if (has_shape(src_dst, m_height, m_width)) plan = getPlan(FFTW_FORWARD, true);
+  execute(plan, FFTW_FORWARD, src_dst, src_dst);
 }
 
 
@@ -153,20 +222,14 @@ void bob::sp::IFFT2D::operator()(const blitz::Array<std::complex<double>,2>& src
   bob::core::array::assertCZeroBaseContiguous(dst);
   bob::core::array::assertSameShape( dst, src);
 
-  // Reinterpret cast to fftw format
-  fftw_complex* src_ = reinterpret_cast<fftw_complex*>(const_cast<std::complex<double>* >(src.data()));
-  fftw_complex* dst_ = reinterpret_cast<fftw_complex*>(dst.data());
-  
-  fftw_plan p;
-  // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
-  // for large arrays
-  p = fftw_plan_dft_2d(src.extent(0), src.extent(1), src_, dst_, FFTW_BACKWARD, FFTW_ESTIMATE);
-  fftw_execute(p);
-  fftw_destroy_plan(p);
+  const bool inplace = src.data() == dst.data();
+  boost::shared_ptr<void> plan;
+  if (has_shape(src, m_height, m_width)) plan = getPlan(FFTW_BACKWARD, inplace);
+  execute(plan, FFTW_BACKWARD, src, dst);
 
   // Rescale the result by the size of the input 
   // (as this is not performed by FFTW)
-  dst /= static_cast<double>(m_width*m_height);
+  dst /= static_cast<double>(src.extent(0)*src.extent(1));
 }
 
 void bob::sp::IFFT2D::operator()(blitz::Array<std::complex<double>,2>& src_dst) const
@@ -174,17 +237,94 @@ void bob::sp::IFFT2D::operator()(blitz::Array<std::complex<double>,2>& src_dst)
   // check data
   bob::core::array::assertCZeroBaseContiguous(src_dst);
 
-  // Reinterpret cast to fftw format
-  fftw_complex* src_dst_ = reinterpret_cast<fftw_complex*>(src_dst.data());
-
-  fftw_plan p;
-  // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized
-  // for large arrays
-  p = fftw_plan_dft_2d(src_dst.extent(0), src_dst.extent(1), src_dst_, src_dst_, FFTW_BACKWARD, FFTW_ESTIMATE);
-  fftw_execute(p);
-  fftw_destroy_plan(p);
+  boost::shared_ptr<void> plan;
+  if (has_shape(src_dst, m_height, m_width)) plan = getPlan(FFTW_BACKWARD, true);
+  execute(plan, FFTW_BACKWARD, src_dst, src_dst);
 
   // Rescale the result by the size of the input
   // (as this is not performed by FFTW)
-  src_dst /= static_cast<double>(m_width*m_height);
+  src_dst /= static_cast<double>(src_dst.extent(0)*src_dst.extent(1));
+}
+
+
+bob::sp::RealFFT2D::RealFFT2D(const size_t height, const size_t width):
+  m_height(height), m_width(width)
+{
+}
+
+bob::sp::RealFFT2D::RealFFT2D(const bob::sp::RealFFT2D& other):
+  m_height(other.m_height), m_width(other.m_width), m_plan(other.m_plan)
+{
+}
+
+bob::sp::RealFFT2D::~RealFFT2D()
+{
+}
+
+bob::sp::RealFFT2D&
+bob::sp::RealFFT2D::operator=(const bob::sp::RealFFT2D& other)
+{
+  if (this != &other) {
+    reset(other.m_height, other.m_width);
+  }
+  return *this;
+}
+
+bool bob::sp::RealFFT2D::operator==(const bob::sp::RealFFT2D& b) const
+{
+  return (this->m_height == b.m_height && this->m_width == b.m_width);
+}
+
+bool bob::sp::RealFFT2D::operator!=(const bob::sp::RealFFT2D& b) const
+{
+  return !(this->operator==(b));
+}
+
+void bob::sp::RealFFT2D::reset(const size_t height, const size_t width)
+{
+  m_height = height;
+  m_width = width;
+  m_plan.reset();
+}
+
+void bob::sp::RealFFT2D::operator()(const blitz::Array<double,2>& src,
+  blitz::Array<std::complex<double>,2>& dst) const
+{
+  // check input
+  bob::core::array::assertCZeroBaseContiguous(src);
+  bob::core::array::assertSameShape(src, blitz::shape(m_height, m_width));
+
+  // Check output
+  bob::core::array::assertCZeroBaseContiguous(dst);
+  bob::core::array::assertSameShape(dst, src);
+
+  const int height = m_height, width = m_width, half = width/2 + 1;
+  boost::shared_ptr<void> plan;
+  {
+    boost::lock_guard<boost::mutex> lock(bob::sp::detail::planner_mutex());
+    if (!m_plan) {
+      // The half spectrum is written directly into the first width/2+1
+      // columns of the (full width) destination array
+      double* in = static_cast<double*>(fftw_malloc(sizeof(double)*height*width));
+      fftw_complex* out = static_cast<fftw_complex*>(fftw_malloc(sizeof(fftw_complex)*height*width));
+      int n[2] = {height, width};
+      int onembed[2] = {height, width};
+      fftw_plan p = fftw_plan_many_dft_r2c(2, n, 1, in, 0, 1, 0, out, onembed, 1, 0, FFTW_ESTIMATE | FFTW_UNALIGNED);
+      fftw_free(out);
+      fftw_free(in);
+      m_plan = boost::shared_ptr<void>(p, destroy_plan);
+    }
+    plan = m_plan;
+  }
+
+  fftw_execute_dft_r2c(static_cast<fftw_plan>(plan.get()),
+    const_cast<double*>(src.data()), reinterpret_cast<fftw_complex*>(dst.data()));
+
+  // Fill the second half of the spectrum using the Hermitian symmetry
+  // F(y,x) = conj(F(-y,-x))
+  for (int y = 0; y < height; ++y) {
+    const int my = (height - y) % height;
+    for (int x = half; x < width; ++x)
+      dst(y,x) = std::conj(dst(my, width - x));
+  }
 }
@@ -0,0 +1,93 @@
+/**
+ * @file sp/cxx/benchmark/transforms.cc
+ * @date 2013-07-04
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Measures the FFT and DCT transforms on random signals and images.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <complex>
+#include <boost/random.hpp>
+#include <blitz/array.h>
+
+#include "bob/core/benchmark.h"
+#include "bob/sp/FFT1D.h"
+#include "bob/sp/FFT2D.h"
+#include "bob/sp/DCT2D.h"
+
+using bob::core::benchmark::param;
+
+/**
+ * Applies a transform from src to dst
+ */
+template <typename Transform, typename Src, typename Dst>
+struct Apply {
+  const Transform& transform;
+  const Src& src;
+  Dst& dst;
+  void operator()() const { transform(src, dst); }
+};
+
+template <typename Transform, typename Src, typename Dst>
+Apply<Transform,Src,Dst> apply(const Transform& t, const Src& src, Dst& dst) {
+  Apply<Transform,Src,Dst> retval = {t, src, dst};
+  return retval;
+}
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("sp_transforms", argc, argv);
+
+  boost::mt19937 rng;
+  boost::uniform_real<> uniform(-1., 1.);
+
+  // signals, including a length that is not a power of two
+  const int lengths[] = {256, 1000, 4096, 65536};
+  for (int l = 0; l < 4; ++l){
+    const int n = lengths[l];
+    blitz::Array<std::complex<double>,1> src(n), dst(n);
+    for (int i = 0; i < n; ++i)
+      src(i) = std::complex<double>(uniform(rng), uniform(rng));
+    bob::sp::FFT1D fft(n);
+    bob::sp::IFFT1D ifft(n);
+    suite.run("FFT1D", param("n", n), apply(fft, src, dst));
+    suite.run("IFFT1D", param("n", n), apply(ifft, src, dst));
+  }
+
+  // images
+  const int sizes[] = {64, 128, 256, 1024};
+  const int n_sizes = suite.quick() ? 3 : 4;
+  for (int s = 0; s < n_sizes; ++s){
+    const int n = sizes[s];
+    const std::string shape = param("shape", n) + "x" +
+      boost::lexical_cast<std::string>(n);
+    blitz::Array<double,2> image(n, n), dct(n, n);
+    blitz::Array<std::complex<double>,2> csrc(n, n), cdst(n, n);
+    for (int y = 0; y < n; ++y)
+      for (int x = 0; x < n; ++x){
+        image(y,x) = uniform(rng);
+        csrc(y,x) = image(y,x);
+      }
+    bob::sp::FFT2D fft(n, n);
+    bob::sp::RealFFT2D rfft(n, n);
+    bob::sp::DCT2D dct2d(n, n);
+    suite.run("FFT2D", shape, apply(fft, csrc, cdst));
+    suite.run("RealFFT2D", shape, apply(rfft, image, cdst));
+    suite.run("DCT2D", shape, apply(dct2d, image, dct));
+  }
+
+  return suite.finish();
+}
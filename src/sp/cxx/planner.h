@@ -0,0 +1,40 @@
+/**
+ * @file sp/cxx/planner.h
+ * @date Mon Jun 10 14:02:51 2013 +0200
+ * @author Manuel Guenther <Manuel.Guenther@idiap.ch>
+ *
+ * @brief The lock shared by all users of the FFTW planner in bob::sp
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_SP_PLANNER_H
+#define BOB_SP_PLANNER_H
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+namespace bob { namespace sp { namespace detail {
+
+  /**
+   * The FFTW planner is not thread-safe, hence all plan creations and
+   * destructions of the FFT and DCT classes are serialized using this mutex.
+   * Only fftw_execute*() may be called concurrently.
+   */
+  boost::mutex& planner_mutex();
+
+}}}
+
+#endif /* BOB_SP_PLANNER_H */
@@ -211,6 +211,25 @@ void test_fft2Dinplace( const blitz::Array<std::complex<double>,2> t, double eps
       BOOST_CHECK_SMALL( abs(t_fft(i,j)-t(i,j)), eps);
 }
 
+void test_rfft2D( const blitz::Array<double,2> t, double eps)
+{
+  // process using the real FFT
+  blitz::Array<std::complex<double>,2> t_rfft(t.extent(0), t.extent(1)),
+    t_fft(t.extent(0), t.extent(1));
+  bob::sp::RealFFT2D rfft(t.extent(0), t.extent(1));
+  rfft(t, t_rfft);
+
+  // get complex FFT answer and compare with real FFT
+  blitz::Array<std::complex<double>,2> t_complex(t.extent(0), t.extent(1));
+  t_complex = blitz::cast<std::complex<double> >(t);
+  bob::sp::FFT2D fft(t.extent(0), t.extent(1));
+  fft(t_complex, t_fft);
+  // Compare
+  for (int i=0; i < t_fft.extent(0); ++i)
+    for (int j=0; j < t_fft.extent(1); ++j)
+      BOOST_CHECK_SMALL( abs(t_rfft(i,j)-t_fft(i,j)), eps);
+}
+
 void test_fftshift( const blitz::Array<std::complex<double>,1> t, double eps) 
 {
   // process using fftshift
@@ -393,6 +412,27 @@ BOOST_AUTO_TEST_CASE( test_fft2D_range1x1to64x64_random )
 }
 
 
+BOOST_AUTO_TEST_CASE( test_rfft2D_range1x1to64x64_random )
+{
+  // This tests the real 2D FFT using 10 random arrays
+  // The size of each dimension is randomly chosen between 1 and 64
+  for (int loop=0; loop < 10; ++loop) {
+    // size of the data
+    int M = (rand() % 64 + 1);
+    int N = (rand() % 64 + 1);
+
+    // set up simple 2D random tensor
+    blitz::Array<double,2> t(M,N);
+    for (int i=0; i < M; ++i)
+      for (int j=0; j < N; ++j)
+        t(i,j) = (rand()/(double)RAND_MAX)*10.;
+
+    // call the test function
+    test_rfft2D( t, eps);
+  }
+}
+
+
 BOOST_AUTO_TEST_CASE( test_fftshift1D_simple )
 {
   // set up simple 1D random tensor 
@@ -21,6 +21,7 @@
 #include <bob/trainer/GMMTrainer.h>
 #include <bob/core/assert.h>
 #include <bob/core/check.h>
+#include <vector>
 
 bob::trainer::GMMTrainer::GMMTrainer(const bool update_means, 
     const bool update_variances, const bool update_weights,
@@ -50,12 +51,76 @@ void bob::trainer::GMMTrainer::initialization(bob::machine::GMMMachine& gmm,
   m_ss.resize(gmm.getNGaussians(),gmm.getNInputs());
 }
 
+/**
+ * The sufficient statistics of a subset of the samples. This computes the
+ * same statistics as GMMMachine::accStatistics(), but with its own buffers
+ * instead of the caches of the machine, so that several accumulators can
+ * share the same machine.
+ */
+class GMMAccumulator {
+
+  public:
+
+    GMMAccumulator(const bob::machine::GMMMachine& gmm,
+        const blitz::Array<double,2>& data):
+      m_gmm(gmm), m_data(data),
+      m_stats(gmm.getNGaussians(), gmm.getNInputs()),
+      m_x(gmm.getNInputs()),
+      m_log_weighted_gaussian_likelihoods(gmm.getNGaussians()),
+      m_P(gmm.getNGaussians()),
+      m_Px(gmm.getNGaussians(), gmm.getNInputs())
+    {
+    }
+
+    void reset() { m_stats.init(); }
+
+    void accumulate(size_t begin, size_t end) {
+      blitz::firstIndex i;
+      blitz::secondIndex j;
+      for(int s=begin; s<(int)end; ++s) {
+        // copy the sample, as slicing the data is not thread-safe
+        for(int d=0; d<m_x.extent(0); ++d) m_x(d) = m_data(s,d);
+
+        double log_likelihood = m_gmm.logLikelihood_(m_x,
+            m_log_weighted_gaussian_likelihoods);
+        m_P = blitz::exp(m_log_weighted_gaussian_likelihoods - log_likelihood);
+
+        m_stats.log_likelihood += log_likelihood;
+        m_stats.T++;
+        m_stats.n += m_P;
+        m_Px = m_P(i) * m_x(j);
+        m_stats.sumPx += m_Px;
+        m_stats.sumPxx += (m_Px(i,j) * m_x(j));
+      }
+    }
+
+    void merge(const GMMAccumulator& other) { m_stats += other.m_stats; }
+
+    const bob::machine::GMMStats& stats() const { return m_stats; }
+
+  private:
+
+    const bob::machine::GMMMachine& m_gmm;
+    const blitz::Array<double,2>& m_data;
+    bob::machine::GMMStats m_stats;
+    blitz::Array<double,1> m_x;
+    blitz::Array<double,1> m_log_weighted_gaussian_likelihoods;
+    blitz::Array<double,1> m_P;
+    blitz::Array<double,2> m_Px;
+
+};
+
 void bob::trainer::GMMTrainer::eStep(bob::machine::GMMMachine& gmm,
   const blitz::Array<double,2>& data) 
 {
-  m_ss.init();
-  // Calculate the sufficient statistics and save in m_ss
-  gmm.accStatistics(data, m_ss);
+  bob::core::array::assertSameDimensionLength(data.extent(1), gmm.getNInputs());
+  // Calculate the sufficient statistics on as many threads as requested,
+  // and save them in m_ss
+  std::vector<boost::shared_ptr<GMMAccumulator> > accumulators(numberOfAccumulators());
+  for(size_t k=0; k<accumulators.size(); ++k)
+    accumulators[k].reset(new GMMAccumulator(gmm, data));
+  accumulate(accumulators, data.extent(0));
+  m_ss = accumulators[0]->stats();
 }
 
 double bob::trainer::GMMTrainer::computeLikelihood(bob::machine::GMMMachine& gmm)
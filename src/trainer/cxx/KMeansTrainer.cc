@@ -21,8 +21,11 @@
 
 #include <bob/trainer/KMeansTrainer.h>
 #include <bob/core/array_copy.h>
+#include <bob/core/assert.h>
 #include <bob/trainer/Exception.h>
 #include <boost/random.hpp>
+#include <limits>
+#include <vector>
 
 #if BOOST_VERSION >= 104700
 #include <boost/random/discrete_distribution.hpp>
@@ -39,8 +42,7 @@ bob::trainer::KMeansTrainer::KMeansTrainer(double convergence_threshold,
 }
 
 bob::trainer::KMeansTrainer::KMeansTrainer(const bob::trainer::KMeansTrainer& other):
-  bob::trainer::EMTrainer<bob::machine::KMeansMachine, blitz::Array<double,2> >(
-    other.m_convergence_threshold, other.m_max_iterations, other.m_compute_likelihood), 
+  bob::trainer::EMTrainer<bob::machine::KMeansMachine, blitz::Array<double,2> >(other), 
   m_initialization_method(other.m_initialization_method),
   m_rng(other.m_rng), m_average_min_distance(other.m_average_min_distance),
   m_zeroethOrderStats(bob::core::array::ccopy(other.m_zeroethOrderStats)), 
@@ -182,29 +184,93 @@ void bob::trainer::KMeansTrainer::initialization(bob::machine::KMeansMachine& km
   m_firstOrderStats.resize(kmeans.getNMeans(), kmeans.getNInputs());
 }
 
+/**
+ * The E-step statistics of a subset of the samples. Samples and means are
+ * read element by element, so that no blitz array shared between threads is
+ * referenced.
+ */
+class KMeansAccumulator {
+
+  public:
+
+    KMeansAccumulator(const bob::machine::KMeansMachine& kmeans,
+        const blitz::Array<double,2>& ar):
+      m_means(kmeans.getMeans()), m_ar(ar),
+      m_zeroethOrderStats(kmeans.getNMeans()),
+      m_firstOrderStats(kmeans.getNMeans(), kmeans.getNInputs()),
+      m_sum_min_distance(0)
+    {
+    }
+
+    void reset() {
+      m_zeroethOrderStats = 0;
+      m_firstOrderStats = 0;
+      m_sum_min_distance = 0;
+    }
+
+    void accumulate(size_t begin, size_t end) {
+      const int n_means = m_means.extent(0);
+      const int n_inputs = m_means.extent(1);
+      for(int i=begin; i<(int)end; ++i) {
+        // find closest mean, and distance from that mean
+        int closest_mean = 0;
+        double min_distance = std::numeric_limits<double>::max();
+        for(int k=0; k<n_means; ++k) {
+          double distance = 0;
+          for(int d=0; d<n_inputs; ++d) {
+            double diff = m_means(k,d) - m_ar(i,d);
+            distance += diff * diff;
+          }
+          if(distance < min_distance) {
+            min_distance = distance;
+            closest_mean = k;
+          }
+        }
+
+        // accumulate the stats
+        m_sum_min_distance += min_distance;
+        ++m_zeroethOrderStats(closest_mean);
+        for(int d=0; d<n_inputs; ++d)
+          m_firstOrderStats(closest_mean,d) += m_ar(i,d);
+      }
+    }
+
+    void merge(const KMeansAccumulator& other) {
+      m_zeroethOrderStats += other.m_zeroethOrderStats;
+      m_firstOrderStats += other.m_firstOrderStats;
+      m_sum_min_distance += other.m_sum_min_distance;
+    }
+
+    const blitz::Array<double,1>& zeroethOrderStats() const
+    { return m_zeroethOrderStats; }
+    const blitz::Array<double,2>& firstOrderStats() const
+    { return m_firstOrderStats; }
+    double sumMinDistance() const { return m_sum_min_distance; }
+
+  private:
+
+    const blitz::Array<double,2>& m_means;
+    const blitz::Array<double,2>& m_ar;
+    blitz::Array<double,1> m_zeroethOrderStats;
+    blitz::Array<double,2> m_firstOrderStats;
+    double m_sum_min_distance;
+
+};
+
 void bob::trainer::KMeansTrainer::eStep(bob::machine::KMeansMachine& kmeans, 
   const blitz::Array<double,2>& ar)
 {
-  // initialise the accumulators
-  resetAccumulators(kmeans);
+  bob::core::array::assertSameDimensionLength(ar.extent(1), kmeans.getNInputs());
+  // accumulate the stats of the samples on as many threads as requested
+  std::vector<boost::shared_ptr<KMeansAccumulator> > accumulators(numberOfAccumulators());
+  for(size_t k=0; k<accumulators.size(); ++k)
+    accumulators[k].reset(new KMeansAccumulator(kmeans, ar));
+  accumulate(accumulators, ar.extent(0));
 
-  // iterate over data samples
-  blitz::Range a = blitz::Range::all();
-  for(int i=0; i<ar.extent(0); ++i) {
-    // get example
-    blitz::Array<double, 1> x(ar(i,a));
-
-    // find closest mean, and distance from that mean
-    size_t closest_mean = 0;
-    double min_distance = 0;
-    kmeans.getClosestMean(x,closest_mean,min_distance);
-
-    // accumulate the stats
-    m_average_min_distance += min_distance;
-    ++m_zeroethOrderStats(closest_mean);
-    m_firstOrderStats(closest_mean,blitz::Range::all()) += x;
-  }
-  m_average_min_distance /= static_cast<double>(ar.extent(0));
+  m_zeroethOrderStats = accumulators[0]->zeroethOrderStats();
+  m_firstOrderStats = accumulators[0]->firstOrderStats();
+  m_average_min_distance = accumulators[0]->sumMinDistance() / 
+    static_cast<double>(ar.extent(0));
 }
 
 void bob::trainer::KMeansTrainer::mStep(bob::machine::KMeansMachine& kmeans, 
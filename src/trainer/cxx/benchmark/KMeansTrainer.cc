@@ -0,0 +1,67 @@
+/**
+ * @file trainer/cxx/benchmark/KMeansTrainer.cc
+ * @date 2013-07-04
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Measures the E-step of the k-means trainer on random data.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/random.hpp>
+#include <blitz/array.h>
+
+#include "bob/core/benchmark.h"
+#include "bob/machine/KMeansMachine.h"
+#include "bob/trainer/KMeansTrainer.h"
+
+using bob::core::benchmark::param;
+
+struct EStep {
+  bob::trainer::KMeansTrainer& trainer;
+  bob::machine::KMeansMachine& kmeans;
+  const blitz::Array<double,2>& data;
+  void operator()() const { trainer.eStep(kmeans, data); }
+};
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("trainer_KMeansTrainer", argc, argv);
+  const int means[] = {16, 256, 512};
+  const int dimensions[] = {20, 60};
+  const int n_samples = suite.quick() ? 1000 : 10000;
+
+  boost::mt19937 rng;
+  boost::normal_distribution<> normal;
+
+  for (int m = 0; m < 3; ++m){
+    for (int d = 0; d < 2; ++d){
+      const int M = means[m], D = dimensions[d];
+      blitz::Array<double,2> data(n_samples, D);
+      for (int i = 0; i < n_samples; ++i)
+        for (int j = 0; j < D; ++j)
+          data(i,j) = normal(rng);
+
+      bob::machine::KMeansMachine kmeans(M, D);
+      bob::trainer::KMeansTrainer trainer;
+      trainer.initialization(kmeans, data);
+
+      EStep estep = {trainer, kmeans, data};
+      suite.run("eStep", param("means", M) + "," + param("dim", D) + "," +
+          param("samples", n_samples), estep);
+    }
+  }
+
+  return suite.finish();
+}
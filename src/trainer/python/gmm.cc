@@ -38,6 +38,7 @@ void bind_trainer_gmm() {
   class_<EMTrainerGMMBase, boost::noncopyable>("EMTrainerGMM", "The base python class for all EM-based trainers.", no_init)
     .add_property("convergence_threshold", &EMTrainerGMMBase::getConvergenceThreshold, &EMTrainerGMMBase::setConvergenceThreshold, "Convergence threshold")
     .add_property("max_iterations", &EMTrainerGMMBase::getMaxIterations, &EMTrainerGMMBase::setMaxIterations, "Max iterations")
+    .add_property("number_of_threads", &EMTrainerGMMBase::getNumberOfThreads, &EMTrainerGMMBase::setNumberOfThreads, "The number of threads used to accumulate the statistics in the E-step (0 means: all cores). The results only depend on this number, not on the scheduling of the threads.")
     .def("train", &EMTrainerGMMBase::train, (arg("machine"), arg("data")), "Train a machine using data")
     .def("initialization", &EMTrainerGMMBase::initialization, (arg("machine"), arg("data")), "This method is called before the EM algorithm")
     .def("finalization", &EMTrainerGMMBase::finalization, (arg("machine"), arg("data")), "This method is called after the EM algorithm")
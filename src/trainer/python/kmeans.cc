@@ -66,6 +66,7 @@ void bind_trainer_kmeans()
     .add_property("max_iterations", &EMTrainerKMeansBase::getMaxIterations, &EMTrainerKMeansBase::setMaxIterations, "Max iterations")
     .add_property("compute_likelihood", &EMTrainerKMeansBase::getComputeLikelihood, &EMTrainerKMeansBase::setComputeLikelihood, "Tells whether we compute the average min (square Euclidean) distance or not.")
     .add_property("rng", &EMTrainerKMeansBase::getRng, &EMTrainerKMeansBase::setRng, "The Mersenne Twister mt19937 random generator used for the initialization of subspaces/arrays before the EM loop.")
+    .add_property("number_of_threads", &EMTrainerKMeansBase::getNumberOfThreads, &EMTrainerKMeansBase::setNumberOfThreads, "The number of threads used to accumulate the statistics in the E-step (0 means: all cores). The results only depend on this number, not on the scheduling of the threads.")
     .def(self == self)
     .def(self != self)
     .def("train", &EMTrainerKMeansBase::train, (arg("machine"), arg("data")), "Train a machine using data")
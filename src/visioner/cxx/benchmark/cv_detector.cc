@@ -0,0 +1,111 @@
+/**
+ * @file visioner/cxx/benchmark/cv_detector.cc
+ * @date 2013-07-04
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Measures the sliding-window scan of the face detector on random
+ * images. The detection model is also random, with LUTs biased towards
+ * rejection, so that most sub-windows are discarded, as in real images.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/random.hpp>
+
+#include "bob/core/benchmark.h"
+#include "bob/core/logging.h"
+#include "bob/visioner/cv/cv_detector.h"
+#include "bob/visioner/model/mdecoder.h"
+
+using bob::core::benchmark::param;
+
+/**
+ * Saves a model with random LUTs on random features
+ */
+static void generate_model(const std::string& filename, uint64_t n_luts,
+    boost::mt19937& rng){
+  bob::visioner::param_t p;
+  p.m_labels.push_back("face");
+  boost::shared_ptr<bob::visioner::Model> model = bob::visioner::make_model(p);
+
+  boost::uniform_int<uint64_t> feature(0, model->n_features() - 1);
+  boost::uniform_real<> entry(-1., 0.5);
+  std::vector<std::vector<bob::visioner::LUT> > mluts(model->n_outputs());
+  for (uint64_t o = 0; o < mluts.size(); ++o)
+    for (uint64_t l = 0; l < n_luts; ++l){
+      bob::visioner::LUT lut(feature(rng), model->n_fvalues());
+      for (uint64_t v = 0; v < lut.n_fvalues(); ++v) lut[v] = entry(rng);
+      mluts[o].push_back(lut);
+    }
+  model->set(mluts);
+  model->save(filename);
+}
+
+/**
+ * Builds the image pyramid
+ */
+struct Load {
+  bob::visioner::CVDetector& detector;
+  const std::vector<uint8_t>& image;
+  int rows, cols;
+  void operator()() const { detector.load(&image[0], rows, cols); }
+};
+
+/**
+ * Scans the loaded image pyramid
+ */
+struct Scan {
+  const bob::visioner::CVDetector& detector;
+  void operator()() const {
+    std::vector<bob::visioner::detection_t> detections;
+    detector.scan(detections);
+  }
+};
+
+int main(int argc, char** argv){
+  bob::core::benchmark::Suite suite("visioner_cv_detector", argc, argv);
+  const int rows[] = {240, 480};
+  const int cols[] = {320, 640};
+  const uint64_t levels[] = {0, 10};
+
+  boost::mt19937 rng;
+  boost::uniform_int<> pixel(0, 255);
+
+  const std::string model = bob::core::tmpfile(".vbin");
+  generate_model(model, 100, rng);
+
+  for (int s = 0; s < 2; ++s){
+    std::vector<uint8_t> image(rows[s] * cols[s]);
+    for (size_t i = 0; i < image.size(); ++i) image[i] = pixel(rng);
+
+    const std::string shape = param("shape", rows[s]) + "x" +
+      boost::lexical_cast<std::string>(cols[s]);
+
+    for (int l = 0; l < 2; ++l){
+      bob::visioner::CVDetector detector(model, 0.0, levels[l], 2, 0.05,
+          bob::visioner::CVDetector::Scanning);
+      Load load = {detector, image, rows[s], cols[s]};
+      load();
+      if (l == 0) suite.run("load", shape, load);
+      Scan scan = {detector};
+      suite.run("scan", shape + "," + param("levels", levels[l]), scan);
+    }
+  }
+
+  boost::filesystem::remove(model);
+  return suite.finish();
+}
@@ -27,6 +27,7 @@
 #include <boost/format.hpp>
 
 #include "bob/core/logging.h"
+#include "bob/core/instrument.h"
 
 #include "bob/visioner/cv/cv_detector.h"
 #include "bob/visioner/model/mdecoder.h"
@@ -257,6 +258,7 @@ namespace bob { namespace visioner {
     }
 
     // Scan the image ... 
+    BOB_TIME_SCOPE("visioner.detector.scan");
     Timer timer;
     for (uint64_t is = 0; is < m_ipyramid.size(); is ++)
     {
@@ -279,6 +281,7 @@ namespace bob { namespace visioner {
 
               // Update statistics
               m_stats.m_evals += lend - lbegin;
+              BOB_COUNT("visioner.detector.evaluations", lend - lbegin);
             }
 
             // Threshold detection and map it to the original image size
@@ -292,6 +295,7 @@ namespace bob { namespace visioner {
 
             // Update statistics
             m_stats.m_sws ++;
+            BOB_COUNT("visioner.detector.subwindows", 1);
           }
       }
     }
@@ -40,15 +40,104 @@ namespace bob { namespace visioner {
       load(qimage, grays);
   }
 
+  // Size of the image scaled to a specific <scale> of the original size
+  void scale_size(uint64_t rows, uint64_t cols, double scale,
+      uint64_t& new_rows, uint64_t& new_cols)
+  {
+    scale = range(scale, 0.01, 1.00);
+    const uint64_t w = (uint64_t)(0.5 + scale * cols);
+    const uint64_t h = (uint64_t)(0.5 + scale * rows);
+
+    // Keep the aspect ratio (as QSize::scaled() does)
+    const uint64_t rw = rows ? h * cols / rows : 0;
+    if (rw <= w)
+    {
+      new_cols = rw, new_rows = h;
+    }
+    else
+    {
+      new_cols = w, new_rows = cols ? w * rows / cols : 0;
+    }
+  }
+
+  // Area (box) filter to resample <n_src> pixels to <n_dst> <= <n_src>
+  // pixels: the output pixel <o> averages the source pixels in the range
+  // [begins[o], begins[o + 1]) with the weights stored at the same positions.
+  static void area_filter(uint64_t n_src, uint64_t n_dst,
+      std::vector<uint64_t>& indices, std::vector<uint64_t>& begins,
+      std::vector<float>& weights)
+  {
+    const double ratio = (double)n_src / (double)n_dst;
+    const double inv_ratio = 1.0 / ratio;
+
+    indices.clear();
+    weights.clear();
+    begins.resize(n_dst + 1);
+    for (uint64_t o = 0; o < n_dst; o ++)
+    {
+      begins[o] = indices.size();
+
+      const double start = o * ratio, stop = std::min((o + 1) * ratio, (double)n_src);
+      for (uint64_t i = (uint64_t)start; i < n_src && (double)i < stop; i ++)
+      {
+        const double overlap = std::min((double)(i + 1), stop) - std::max((double)i, start);
+        if (overlap > 0.0)
+        {
+          indices.push_back(i);
+          weights.push_back((float)(overlap * inv_ratio));
+        }
+      }
+    }
+    begins[n_dst] = indices.size();
+  }
+
   // Scale the image to a specific <scale> of the <src> source image
   bool scale(const Matrix<uint8_t>& src, double scale, Matrix<uint8_t>& dst)
   {
-    scale = range(scale, 0.01, 1.00);
-    const int new_w = (int)(0.5 + scale * src.cols());
-    const int new_h = (int)(0.5 + scale * src.rows());
+    uint64_t new_rows, new_cols;
+    scale_size(src.rows(), src.cols(), scale, new_rows, new_cols);
+    dst.resize(new_rows, new_cols);
+    if (new_rows == 0 || new_cols == 0)
+    {
+      return false;
+    }
+
+    const uint64_t src_cols = src.cols();
 
-    QImage qimage = convert(src);
-    return load(qimage.scaled(new_w, new_h, Qt::KeepAspectRatio, Qt::SmoothTransformation), dst);
+    std::vector<uint64_t> x_indices, x_begins, y_indices, y_begins;
+    std::vector<float> x_weights, y_weights;
+    area_filter(src.cols(), new_cols, x_indices, x_begins, x_weights);
+    area_filter(src.rows(), new_rows, y_indices, y_begins, y_weights);
+
+    // The filter is separable: the source rows covered by an output row are
+    // first averaged into a single row, which is then resampled horizontally.
+    std::vector<float> row(src_cols);
+    for (uint64_t y = 0; y < new_rows; y ++)
+    {
+      std::fill(row.begin(), row.end(), 0.0f);
+      for (uint64_t k = y_begins[y]; k < y_begins[y + 1]; k ++)
+      {
+        const uint8_t* src_row = src[y_indices[k]];
+        const float w = y_weights[k];
+        for (uint64_t x = 0; x < src_cols; x ++)
+        {
+          row[x] += w * src_row[x];
+        }
+      }
+
+      uint8_t* dst_row = dst[y];
+      for (uint64_t x = 0; x < new_cols; x ++)
+      {
+        float sum = 0.0f;
+        for (uint64_t k = x_begins[x]; k < x_begins[x + 1]; k ++)
+        {
+          sum += x_weights[k] * row[x_indices[k]];
+        }
+        dst_row[x] = (uint8_t)std::min(255.0f, sum + 0.5f);
+      }
+    }
+
+    return true;
   }
 
   // Convert from <Matrix<uint8_t>> to <QImage>
@@ -0,0 +1,92 @@
+/**
+ * @file visioner/cxx/integral.cc
+ * @date Thu Jun 20 14:12:36 2013 +0200
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Integral image of grayscale images
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "bob/visioner/vision/integral.h"
+
+namespace bob { namespace visioner {
+
+  // Prefix sums of a row of pixels, added to the previous output row
+  // (<last_row> is NULL for the first row)
+  static void integral_row(const uint8_t* src, const uint32_t* last_row,
+      uint32_t* crt_row, int w)
+  {
+    int x = 0;
+    uint32_t row_sum = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i carry = _mm_setzero_si128();
+    for (; x + 4 <= w; x += 4)
+    {
+      int32_t pixels;
+      std::memcpy(&pixels, src + x, sizeof(pixels));
+
+      // Widen the 4 pixels to 32 bits
+      __m128i v = _mm_cvtsi32_si128(pixels);
+      v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero);
+
+      // Prefix sums within the register, plus the sum of the previous pixels
+      v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+      v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+      v = _mm_add_epi32(v, carry);
+      carry = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+
+      if (last_row != 0)
+      {
+        v = _mm_add_epi32(v,
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(last_row + x)));
+      }
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(crt_row + x), v);
+    }
+    row_sum = (uint32_t)_mm_cvtsi128_si32(carry);
+#endif
+
+    for (; x < w; x ++)
+    {
+      row_sum += src[x];
+      crt_row[x] = (last_row != 0 ? last_row[x] : 0) + row_sum;
+    }
+  }
+
+  void integral(const Matrix<uint8_t>& in, Matrix<uint32_t>& out)
+  {
+    const int w = in.cols(), h = in.rows();
+    if (w < 2 || h < 2)
+    {
+      return;
+    }
+    out.resize(h, w);
+
+    integral_row(in[0], 0, out[0], w);
+    for (int y = 1; y < h; y ++)
+    {
+      integral_row(in[y], out[y - 1], out[y], w);
+    }
+  }
+
+}}
@@ -24,9 +24,13 @@
 
 #include <boost/format.hpp>
 
+#include <boost/bind.hpp>
+#include <boost/lambda/lambda.hpp>
+
 #include "bob/visioner/model/ipyramid.h"
 #include "bob/visioner/vision/image.h"
 #include "bob/visioner/vision/integral.h"
+#include "bob/visioner/util/threads.h"
 
 namespace bob { namespace visioner {
 
@@ -110,8 +114,8 @@ namespace bob { namespace visioner {
   }
 
   // Constructor
-  ipyramid_t::ipyramid_t(const param_t& param)
-    :       Parametrizable(param)
+  ipyramid_t::ipyramid_t(const param_t& param, size_t threads)
+    :       Parametrizable(param), m_threads(threads)
   {                
   }
 
@@ -124,46 +128,31 @@ namespace bob { namespace visioner {
   // Loads scaled versions of an image and its ground truth
   bool ipyramid_t::load(const std::string& ifile, const std::string& gfile)
   {
-    Matrix<uint8_t> tmp_image;
-    visioner::load(ifile, tmp_image);
+    m_ipscales.resize(std::max((uint64_t)1, size()));
+    ipscale_t& top = m_ipscales[0];
+    visioner::load(ifile, top.m_image);
 
     // Compute the scalling factors
-    const std::vector<double> scales = scan_scales(m_param.m_rows, m_param.m_cols, tmp_image.rows(), tmp_image.cols(), m_param.m_ds);
+    const std::vector<double> scales = scan_scales(m_param.m_rows, m_param.m_cols, top.rows(), top.cols(), m_param.m_ds);
     if (scales.empty()) {
       boost::format m("The number of scales for image file '%s' is empty. Relevant parameters are model shape: %d x %d; image shape: %d x %d, sliding windows: %d");
       m % ifile % m_param.m_rows % m_param.m_cols;
-      m % tmp_image.rows() % tmp_image.cols() % m_param.m_ds;
+      m % top.rows() % top.cols() % m_param.m_ds;
       throw std::runtime_error(m.str());
     }
 
-    m_ipscales.resize(scales.size());
-
     // Load the ground truth and the image to the top of the pyramid
-    m_ipscales[0].m_scale = 1.0;
-    m_ipscales[0].m_inv_scale = 1.0;
-    if (visioner::Object::load(gfile, m_ipscales[0].m_objects) == false) {
+    top.m_scale = 1.0;
+    top.m_inv_scale = 1.0;
+    if (visioner::Object::load(gfile, top.m_objects) == false) {
       boost::format m("The ground-thruth file '%s' could not be loaded");
       m % gfile;
       throw std::runtime_error(m.str());
     }
-    m_ipscales[0].m_image = tmp_image;
-    update_ipscale(m_ipscales[0], m_param);
+    update_ipscale(top, m_param);
 
     // Build the scaled versions of the original image
-    const ipscale_t& src = m_ipscales[0];
-    for (uint64_t i = 1; i < scales.size(); i ++)
-    {
-      ipscale_t& dst = m_ipscales[i];
-      src.scale(scales[i], dst);
-      update_ipscale(dst, m_param);
-
-      if (	dst.m_scan_min_x >= dst.m_scan_max_x ||
-          dst.m_scan_min_y >= dst.m_scan_max_y)
-      {
-        m_ipscales.erase(m_ipscales.begin() + i, m_ipscales.end());
-        break;
-      }
-    }
+    build(scales);
 
     // OK
     return true;
@@ -172,34 +161,23 @@ namespace bob { namespace visioner {
   // Loads scaled versions of an image and its ground truth
   bool ipyramid_t::load(const ipscale_t& ipscale)
   {
-    m_ipscales.clear();
-
     // Compute the scalling factors
     const std::vector<double> scales = scan_scales(m_param.m_rows, m_param.m_cols, ipscale.rows(), ipscale.cols(), m_param.m_ds);
 
-    if (scales.empty()) return false;
-
-    m_ipscales.resize(scales.size());
+    if (scales.empty()) {
+      m_ipscales.clear();
+      return false;
+    }
 
     // Load the ground truth and the image
+    m_ipscales.resize(std::max((uint64_t)1, size()));
     m_ipscales[0] = ipscale;
     m_ipscales[0].m_scale = 1.0;
     m_ipscales[0].m_inv_scale = 1.0;
     update_ipscale(m_ipscales[0], m_param);
 
     // Build the scaled versions of the original image
-    const ipscale_t& src = m_ipscales[0];
-    for (uint64_t i = 1; i < scales.size(); i ++) {
-      ipscale_t& dst = m_ipscales[i];
-      src.scale(scales[i], dst);
-      update_ipscale(dst, m_param);
-
-      if (dst.m_scan_min_x >= dst.m_scan_max_x ||
-          dst.m_scan_min_y >= dst.m_scan_max_y) {
-        m_ipscales.erase(m_ipscales.begin() + i, m_ipscales.end());
-        break;
-      }
-    }
+    build(scales);
 
     // OK
     return true;
@@ -208,39 +186,72 @@ namespace bob { namespace visioner {
   // Loads scaled versions of an image without its ground-thruth
   bool ipyramid_t::load(const uint8_t* image, uint64_t rows, uint64_t cols)
   {
-    //AA: no simple way not to have a copy here...
-    Matrix<uint8_t> tmp_image(rows, cols, image);
-
     // Compute the scalling factors
-    const std::vector<double> scales = scan_scales(m_param.m_rows, m_param.m_cols, tmp_image.rows(), tmp_image.cols(), m_param.m_ds);
+    const std::vector<double> scales = scan_scales(m_param.m_rows, m_param.m_cols, rows, cols, m_param.m_ds);
     if (scales.empty()) return false;
 
-    m_ipscales.resize(scales.size());
-
-    // Load the ground truth and the image
-    m_ipscales[0].m_scale = 1.0;
-    m_ipscales[0].m_inv_scale = 1.0;
-    m_ipscales[0].m_image = tmp_image;
-    update_ipscale(m_ipscales[0], m_param);
+    // Load the image, reusing the buffers of the previous call
+    m_ipscales.resize(std::max((uint64_t)1, size()));
+    ipscale_t& top = m_ipscales[0];
+    top.m_image.resize(rows, cols);
+    std::copy(image, image + rows * cols, top.m_image.begin());
+    top.m_objects.clear();
+    top.m_scale = 1.0;
+    top.m_inv_scale = 1.0;
+    update_ipscale(top, m_param);
 
     // Build the scaled versions of the original image
-    const ipscale_t& src = m_ipscales[0];
-    for (uint64_t i = 1; i < scales.size(); i ++)
-    {
-      ipscale_t& dst = m_ipscales[i];
-      src.scale(scales[i], dst);
-      update_ipscale(dst, m_param);
+    build(scales);
 
-      if (	dst.m_scan_min_x >= dst.m_scan_max_x ||
-          dst.m_scan_min_y >= dst.m_scan_max_y)
+    // OK
+    return true;
+  }
+
+  // Build the scaled versions of the top of the pyramid
+  void ipyramid_t::build(const std::vector<double>& scales)
+  {
+    // Only keep the scales where the model fits
+    const ipscale_t& top = m_ipscales[0];
+    uint64_t n_scales = 1;
+    for ( ; n_scales < scales.size(); n_scales ++)
+    {
+      uint64_t rows, cols;
+      scale_size(top.rows(), top.cols(), range(scales[n_scales], 0.0, 1.0), rows, cols);
+      if (	m_param.min_col(rows, cols) >= m_param.max_col(rows, cols) ||
+          m_param.min_row(rows, cols) >= m_param.max_row(rows, cols))
       {
-        m_ipscales.erase(m_ipscales.begin() + i, m_ipscales.end());
         break;
       }
     }
+    m_ipscales.resize(n_scales);
 
-    // OK
-    return true;
+    // The scaled images are all computed from the original image and their
+    // size decreases with the scale: the threads process interleaved scales
+    const size_t threads = std::min((size_t)(n_scales - 1), m_threads);
+    if (threads < 2)
+    {
+      build_mt(scales, 1, 0, std::pair<uint64_t, uint64_t>(0, 1));
+    }
+    else
+    {
+      thread_iloop(
+          boost::bind(&ipyramid_t::build_mt, this, boost::cref(scales),
+            threads, boost::lambda::_1, boost::lambda::_2),
+          threads, threads);
+    }
+  }
+
+  // Build the scaled images <1 + ith>, <1 + ith + step>, ...
+  void ipyramid_t::build_mt(const std::vector<double>& scales, uint64_t step,
+      uint64_t ith, std::pair<uint64_t, uint64_t>)
+  {
+    const ipscale_t& src = m_ipscales[0];
+    for (uint64_t i = 1 + ith; i < size(); i += step)
+    {
+      ipscale_t& dst = m_ipscales[i];
+      src.scale(scales[i], dst);
+      update_ipscale(dst, m_param);
+    }
   }
 
   // Map regions (at the original scale) to sub-windows
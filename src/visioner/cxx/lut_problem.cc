@@ -70,41 +70,56 @@ namespace bob { namespace visioner {
 
     m_threads(threads)
     {
-      std::vector<double> counts(n_entries());
-      std::vector<std::pair<double, uint64_t> > stats(n_entries());
-
-      const double cutoff = 0.90;
-
       // Mask the entries that are not frequent enough                
       //      - the associated response is fixed to zero!
-      for (uint64_t f = 0; f < n_features(); f ++)
-      {
-        std::fill(counts.begin(), counts.end(), 0.0);
-        for (uint64_t s = 0; s < n_samples(); s ++)
-        {
-          const uint16_t u = fvalue(f, s);
-          counts[u] += cost(s);
-        }
-        const double thres = cutoff * std::accumulate(counts.begin(), counts.end(), 0.0);
-
-        for (uint64_t u = 0; u < n_entries(); u ++)
-        {
-          stats[u].first = counts[u];
-          stats[u].second = u;
-        }                        
-        std::sort(stats.begin(), stats.end(), std::greater<std::pair<double, uint64_t> >());                        
-
-        double sum = 0.0;
-        for (uint64_t uu = 0; uu < n_entries() && sum < thres; uu ++)
-        {
-          const double cnt = stats[uu].first;
-          const uint64_t u = stats[uu].second;
-
-          m_umasks(f, u) = 1.0;                                
-          sum += cnt;
+      if (!m_threads) {
+        mask_mt(std::make_pair<uint64_t,uint64_t>(0, n_features()));
+      }
+      else {
+        thread_loop(boost::bind(&LUTProblem::mask_mt,
+              this, boost::lambda::_1),
+            n_features(), m_threads);
+      }
+    }
+
+  void LUTProblem::mask_mt(const std::pair<uint64_t,uint64_t>& range) {
+    if (n_samples() == 0) {
+      return;
+    }
+
+    // Buffers local to this thread
+    std::vector<double> counts(n_entries());
+    std::vector<std::pair<double, uint64_t> > stats;
+    stats.reserve(n_entries());
+
+    const double cutoff = 0.90;
+    const double* costs = &m_data.costs()[0];
+
+    for (uint64_t f = range.first; f < range.second; ++f) {
+      std::fill(counts.begin(), counts.end(), 0.0);
+      const uint16_t* values = fvalues(f);
+      for (uint64_t s = 0; s < n_samples(); ++s) {
+        counts[values[s]] += costs[s];
+      }
+      const double thres = cutoff * std::accumulate(counts.begin(), counts.end(), 0.0);
+
+      // Only the entries that occur can reach the threshold, so there is no
+      // need to sort the (possibly many) remaining ones
+      stats.clear();
+      for (uint64_t u = 0; u < n_entries(); ++u) {
+        if (counts[u] > 0.0) {
+          stats.push_back(std::make_pair(counts[u], u));
         }
       }
+      std::sort(stats.begin(), stats.end(), std::greater<std::pair<double, uint64_t> >());
+
+      double sum = 0.0;
+      for (uint64_t uu = 0; uu < stats.size() && sum < thres; ++uu) {
+        m_umasks(f, stats[uu].second) = 1.0;
+        sum += stats[uu].first;
+      }
     }
+  }
 
   void LUTProblem::update_scores_mt(const std::vector<LUT>& luts,
       const std::pair<uint64_t,uint64_t>& range) {
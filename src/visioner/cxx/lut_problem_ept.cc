@@ -230,12 +230,20 @@ namespace bob { namespace visioner {
   void LUTProblemEPT::histo(uint64_t f, Matrix<double>& histo_grad) const
   {
     histo_grad.fill(0.0);
+    if (n_samples() == 0)
+    {
+      return;
+    }
+
+    // Stream through the values of the feature (stored contiguously)
+    const uint16_t* values = fvalues(f);
     for (uint64_t s = 0; s < n_samples(); s ++)
     {
-      const uint16_t u = fvalue(f, s);
+      double* dst = histo_grad[values[s]];
+      const double* src = m_grad[s];
       for (uint64_t o = 0; o < n_outputs(); o ++)
       {
-        histo_grad(u, o) += m_grad(s, o);
+        dst[o] += src[o];
       }
     }
   }
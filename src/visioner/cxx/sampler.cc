@@ -27,6 +27,7 @@
 #include <boost/bind.hpp>
 #include <boost/lambda/lambda.hpp>
 #include <boost/format.hpp>
+#include <boost/functional/hash.hpp>
 
 #include "bob/core/logging.h"
 
@@ -51,10 +52,31 @@ std::vector<T> stat_cumulate(const std::vector<std::vector<T> >& stats,
 
 namespace bob { namespace visioner {
 
+  // Copy the ground truth and the scanning parameters of a scaled image, but
+  // not its pixels
+  static void copy_header(const ipscale_t& src, ipscale_t& dst) {
+    dst.m_objects = src.m_objects;
+    dst.m_scale = src.m_scale;
+    dst.m_inv_scale = src.m_inv_scale;
+    dst.m_scan_dx = src.m_scan_dx;
+    dst.m_scan_dy = src.m_scan_dy;
+    dst.m_scan_min_x = src.m_scan_min_x;
+    dst.m_scan_max_x = src.m_scan_max_x;
+    dst.m_scan_min_y = src.m_scan_min_y;
+    dst.m_scan_max_y = src.m_scan_max_y;
+    dst.m_scan_w = src.m_scan_w;
+    dst.m_scan_h = src.m_scan_h;
+    dst.m_scan_o_w = src.m_scan_o_w;
+    dst.m_scan_o_h = src.m_scan_o_h;
+  }
+
   // Constructor
-  Sampler::Sampler(const param_t& param, SamplerType type, size_t max_threads) :
+  Sampler::Sampler(const param_t& param, SamplerType type, size_t max_threads,
+      bool compact) :
     m_param(param),
     m_type(type),
+    m_max_threads(max_threads),
+    m_compact(compact),
     m_tagger(make_tagger(m_param)),
     m_loss(make_loss(m_param)),
     m_n_outputs(m_tagger->n_outputs()),
@@ -62,7 +84,7 @@ namespace bob { namespace visioner {
     m_n_types(m_tagger->n_types()),
     m_tcounts(m_tagger->n_types(), 0),
     m_sprobs(m_tagger->n_types(), 0.0),
-    m_rgens(max_threads?max_threads:1,boost::mt19937(param.m_seed)) {
+    m_n_calls(0) {
 
       const std::string& data =
         type == TrainSampler ? param.m_train_data : param.m_valid_data;
@@ -87,46 +109,126 @@ namespace bob { namespace visioner {
   void Sampler::load(const std::vector<std::string>& ifiles,
       const std::vector<std::string>& gfiles) {
 
+    // Tag the samples of each file (in parallel, if possible)
+    std::vector<ifile_t> files(ifiles.size());
+    if (!m_max_threads || ifiles.size() < 2) {
+      th_load(std::pair<uint64_t, uint64_t>(0, ifiles.size()), ifiles,
+          gfiles, files);
+    }
+    else {
+      thread_loop(
+          boost::bind(&Sampler::th_load, this, boost::lambda::_1,
+            boost::cref(ifiles), boost::cref(gfiles), boost::ref(files)),
+          ifiles.size(), std::min((size_t)ifiles.size(), m_max_threads));
+    }
+
+    // Merge the scaled images in the order of the input files
+    m_ipscales.clear();
+    m_ipsbegins.clear();
+    m_ipsends.clear();
+    m_images.clear();
+    m_ipsimages.clear();
+    m_n_samples = 0;
+    std::fill(m_tcounts.begin(), m_tcounts.end(), 0);
+
+    uint64_t n_ipscales = 0;
+    for (uint64_t i = 0; i < files.size(); ++i) {
+      n_ipscales += files[i].m_ipscales.size();
+    }
+    m_ipscales.reserve(n_ipscales);
+    m_ipsbegins.reserve(n_ipscales);
+    m_ipsends.reserve(n_ipscales);
+
+    for (uint64_t i = 0; i < files.size(); ++i) {
+
+      ifile_t& file = files[i];
+      if (file.m_loaded == false) {
+        bob::core::warn << "failed to load the image in file '"
+          << ifiles[i] << "'" << std::endl;
+        continue;
+      }
+
+      if (m_compact && !file.m_ipscales.empty()) {
+        m_images.push_back(file.m_image);
+      }
+
+      for (uint64_t is = 0; is < file.m_ipscales.size(); ++is) {
+        m_ipscales.push_back(file.m_ipscales[is]);
+        m_ipsbegins.push_back(m_n_samples);
+        m_ipsends.push_back(m_n_samples + file.m_n_samples[is]);
+        m_n_samples += file.m_n_samples[is];
+        if (m_compact) m_ipsimages.push_back(m_images.size() - 1);
+      }
+
+      for (uint64_t iti = 0; iti < n_types(); iti ++) {
+        m_tcounts[iti] += file.m_tcounts[iti];
+      }
+
+      // Release the memory as soon as possible
+      file = ifile_t();
+    }
+
+#   ifdef BOB_DEBUG
+    for (uint64_t iti = 0; iti < n_types(); iti ++) {
+      TDEBUG1("" << type2str() << " sampler] target type '" << iti << "'"
+        << " found in " << m_tcounts[iti] << " of " << n_samples()
+        << " samples.");
+    }
+#   endif
+
+  }
+
+  // Loading thread
+  void Sampler::th_load(std::pair<uint64_t, uint64_t> frange,
+      const std::vector<std::string>& ifiles,
+      const std::vector<std::string>& gfiles,
+      std::vector<ifile_t>& files) const {
+
     ipyramid_t ipyramid(m_param);
 
     std::vector<double> targets(n_outputs());
     uint64_t type;
 
-    // Process each image in the list
-    for (uint64_t i = 0; i < ifiles.size(); ++i) {
+    // Process each image in the range
+    for (uint64_t i = frange.first; i < frange.second; ++i) {
 
       TDEBUG1("[" << type2str() << " sampler] loading image "
         << (i + 1) << " of " << ifiles.size() << "...");
 
+      ifile_t& file = files[i];
+
       // Load the scaled images ...
-      if (ipyramid.load(ifiles[i], gfiles[i]) == false) {
-        bob::core::warn << "failed to load the image in file '"
-          << ifiles[i] << "'" << std::endl;
-        continue;
-      }
+      file.m_loaded = ipyramid.load(ifiles[i], gfiles[i]);
+      if (file.m_loaded == false) continue;
+
+      file.m_tcounts.resize(n_types(), 0);
 
       // Build the samples using sliding-windows
       for (uint64_t is = 0; is < ipyramid.size(); ++is) {
 
         const ipscale_t& ip = ipyramid[is];
 
-        uint64_t new_n_samples = 0, old_n_samples = n_samples();
+        uint64_t new_n_samples = 0;
         for (int y = ip.m_scan_min_y; y < ip.m_scan_max_y; y += ip.m_scan_dy)
           for (int x = ip.m_scan_min_x; x < ip.m_scan_max_x; x += ip.m_scan_dx)
           {
             if (m_tagger->check(ip, x, y, targets, type) == true)
             {
-              m_tcounts[type] ++;
+              file.m_tcounts[type] ++;
               new_n_samples ++;
             }
           }
 
         // Make sure to store only images with at least one sample
         if (new_n_samples > 0) {
-          m_ipscales.push_back(ip);
-          m_ipsbegins.push_back(old_n_samples);
-          m_ipsends.push_back(old_n_samples + new_n_samples);
-          m_n_samples += new_n_samples;
+          if (m_compact) {
+            file.m_ipscales.push_back(ipscale_t());
+            copy_header(ip, file.m_ipscales.back());
+          }
+          else {
+            file.m_ipscales.push_back(ip);
+          }
+          file.m_n_samples.push_back(new_n_samples);
         }
 
         // Backgroung image - there is no point in keeping in memory too many scales!
@@ -135,16 +237,12 @@ namespace bob { namespace visioner {
         //         is += 2;//ipyramid.size() / 8;
         // }
       }
-    }
 
-#   ifdef BOB_DEBUG
-    for (uint64_t iti = 0; iti < n_types(); iti ++) {
-      TDEBUG1("" << type2str() << " sampler] target type '" << iti << "'"
-        << " found in " << m_tcounts[iti] << " of " << n_samples()
-        << " samples.");
+      // The scaled images are all computed from the top of the pyramid
+      if (m_compact && !file.m_ipscales.empty()) {
+        file.m_image = ipyramid[0].m_image;
+      }
     }
-#   endif
-
   }
 
   void Sampler::sample(uint64_t n_sel_samples,
@@ -168,16 +266,17 @@ namespace bob { namespace visioner {
         inverse(m_tcounts[iti]);
     }
     samples.clear();
-    th_usample(0, std::pair<uint64_t, uint64_t>(0, n_samples()), samples);
+    ++m_n_calls;
+    th_usample(std::pair<uint64_t, uint64_t>(0, n_samples()), samples);
     std::sort(samples.begin(), samples.end());
   }
 
   void Sampler::sample_uniformily_multi(uint64_t n_sel_samples,
       std::vector<uint64_t>& samples, size_t threads) const {
 
-    if (threads > m_rgens.size()) {
+    if (threads > std::max(m_max_threads, (size_t)1)) {
       boost::format m("Sampling with a number of threads (%d) greater than the initially specified maximum (%d) cannot be done.");
-      m % threads % m_rgens.size();
+      m % threads % std::max(m_max_threads, (size_t)1);
       throw std::runtime_error(m.str());
     }
 
@@ -188,10 +287,11 @@ namespace bob { namespace visioner {
     }
 
     //splits the computation (select the samples)
+    ++m_n_calls;
     std::vector<std::vector<uint64_t> > th_samples;
-    thread_iloop(
+    thread_loop(
         boost::bind(&Sampler::th_usample,
-          this, boost::lambda::_1, boost::lambda::_2, boost::lambda::_3),
+          this, boost::lambda::_1, boost::lambda::_2),
         n_samples(), th_samples, threads);
 
     // Merge results
@@ -227,8 +327,9 @@ namespace bob { namespace visioner {
         inverse(terrors[iti]);
     }
 
+    ++m_n_calls;
     samples.clear();
-    th_esample(0, std::pair<uint64_t, uint64_t>(0,n_samples()), model, samples);
+    th_esample(std::pair<uint64_t, uint64_t>(0,n_samples()), model, samples);
     std::sort(samples.begin(), samples.end());
   }
 
@@ -236,9 +337,9 @@ namespace bob { namespace visioner {
       const Model& model, std::vector<uint64_t>& samples, size_t threads) 
     const {
 
-    if (threads > m_rgens.size()) {
+    if (threads > std::max(m_max_threads, (size_t)1)) {
       boost::format m("Sampling with a number of threads (%d) greater than the initially specified maximum (%d) cannot be done.");
-      m % threads % m_rgens.size();
+      m % threads % std::max(m_max_threads, (size_t)1);
       throw std::runtime_error(m.str());
     }
 
@@ -259,10 +360,11 @@ namespace bob { namespace visioner {
     }
 
     //splits the computation (select the samples)
+    ++m_n_calls;
     std::vector<std::vector<uint64_t> > th_samples;
-    thread_iloop(
+    thread_loop(
         boost::bind(&Sampler::th_esample,
-          this, boost::lambda::_1, boost::lambda::_2, boost::cref(model), boost::lambda::_3), n_samples(), th_samples, threads);
+          this, boost::lambda::_1, boost::cref(model), boost::lambda::_2), n_samples(), th_samples, threads);
 
     //merges results
     samples.clear();
@@ -320,9 +422,9 @@ namespace bob { namespace visioner {
   // Map selected samples to a dataset, multi-threaded version
   void Sampler::map_multi(const std::vector<uint64_t>& _samples, const Model& model, DataSet& data, size_t threads) const
   {
-    if (threads > m_rgens.size()) {
+    if (threads > std::max(m_max_threads, (size_t)1)) {
       boost::format m("Sample mapping with a number of threads (%d) greater than the initially specified maximum (%d) cannot be done.");
-      m % threads % m_rgens.size();
+      m % threads % std::max(m_max_threads, (size_t)1);
       throw std::runtime_error(m.str());
     }
 
@@ -369,16 +471,41 @@ namespace bob { namespace visioner {
   // Map the given sample to image
   uint64_t Sampler::sample2image(uint64_t s) const
   {
-    for (uint64_t i = 0; i < n_images(); i ++)
+    // The sample intervals are contiguous and sorted
+    return std::upper_bound(m_ipsends.begin(), m_ipsends.end(), s) -
+      m_ipsends.begin();
+  }
+
+  // Access the given scaled image
+  const ipscale_t& Sampler::ipscale(uint64_t i, ipscale_t& buffer) const
+  {
+    if (m_compact == false)
     {
-      if (    m_ipsbegins[i] <= s &&
-          s < m_ipsends[i])
-      {
-        return i;
-      }
+      return m_ipscales[i];
     }
 
-    return n_images();
+    const ipscale_t& ip = m_ipscales[i];
+    const Matrix<uint8_t>& image = m_images[m_ipsimages[i]];
+    copy_header(ip, buffer);
+    if (ip.m_scale == 1.0)
+    {
+      buffer.m_image = image;
+    }
+    else
+    {
+      visioner::scale(image, ip.m_scale, buffer.m_image);
+    }
+    return buffer;
+  }
+
+  // Seed the random number generator for sampling the given image
+  void Sampler::seed(uint64_t i, boost::mt19937& gen) const
+  {
+    std::size_t value = 0;
+    boost::hash_combine(value, m_param.m_seed);
+    boost::hash_combine(value, m_n_calls);
+    boost::hash_combine(value, i);
+    gen.seed((boost::uint32_t)value);
   }
 
   // Compute the error of the given sample
@@ -408,7 +535,7 @@ namespace bob { namespace visioner {
   }
 
   // Uniform sampling thread
-  void Sampler::th_usample(uint64_t ith, std::pair<uint64_t, uint64_t> srange, std::vector<uint64_t>& samples) const
+  void Sampler::th_usample(std::pair<uint64_t, uint64_t> srange, std::vector<uint64_t>& samples) const
   {
     if (srange.first >= srange.second)
     {
@@ -418,7 +545,7 @@ namespace bob { namespace visioner {
     std::vector<double> targets(n_outputs());
     uint64_t type;
 
-    boost::mt19937& gen = m_rgens[ith];
+    boost::mt19937 gen;
     boost::uniform_01<> die;
 
     // Process the valid samples in the range ...
@@ -426,6 +553,7 @@ namespace bob { namespace visioner {
         s < srange.second && i < n_images(); i ++)
     {
       const ipscale_t& ip = m_ipscales[i];
+      seed(i, gen);
 
       for (int y = ip.m_scan_min_y; y < ip.m_scan_max_y; y += ip.m_scan_dy)
         for (int x = ip.m_scan_min_x; x < ip.m_scan_max_x; x += ip.m_scan_dx)
@@ -437,6 +565,10 @@ namespace bob { namespace visioner {
               const double cost = m_sprobs[type];
               sample(s, cost, gen, die, samples);
             }
+            else if (s < srange.first)
+            {
+              die(gen); // the same draws as if the image was fully processed
+            }
             s ++;
           }
         }
@@ -447,7 +579,7 @@ namespace bob { namespace visioner {
   }
 
   // Error-based sampling thread
-  void Sampler::th_esample(uint64_t ith, std::pair<uint64_t, uint64_t> srange, const Model& bmodel, std::vector<uint64_t>& samples) const
+  void Sampler::th_esample(std::pair<uint64_t, uint64_t> srange, const Model& bmodel, std::vector<uint64_t>& samples) const
   {
     if (srange.first >= srange.second)
     {
@@ -458,14 +590,16 @@ namespace bob { namespace visioner {
     std::vector<double> targets(n_outputs()), scores(n_outputs());
     uint64_t type;
 
-    boost::mt19937& gen = m_rgens[ith];
+    boost::mt19937 gen;
     boost::uniform_01<> die;
+    ipscale_t buffer;
 
     // Process the valid samples in the range ...
     for (uint64_t i = sample2image(srange.first), s = m_ipsbegins[i];
         s < srange.second && i < n_images(); i ++) {
 
-      const ipscale_t& ip = m_ipscales[i];
+      const ipscale_t& ip = ipscale(i, buffer);
+      seed(i, gen);
 
       model->preprocess(ip);
 
@@ -480,6 +614,10 @@ namespace bob { namespace visioner {
                 error(x, y, targets, *model, scores) * m_sprobs[type];
               sample(s, cost, gen, die, samples);
             }
+            else if (s < srange.first)
+            {
+              die(gen); // the same draws as if the image was fully processed
+            }
             s ++;
           }
         }
@@ -504,12 +642,13 @@ namespace bob { namespace visioner {
     const boost::shared_ptr<Model> model = bmodel.clone();
     std::vector<double> targets(n_outputs()), scores(n_outputs());
     uint64_t type;
+    ipscale_t buffer;
 
     // Process the valid samples in the range ...
     for (uint64_t i = sample2image(srange.first), s = m_ipsbegins[i];
         s < srange.second && i < n_images(); i ++)
     {
-      const ipscale_t& ip = m_ipscales[i];
+      const ipscale_t& ip = ipscale(i, buffer);
 
       model->preprocess(ip);
 
@@ -542,12 +681,20 @@ namespace bob { namespace visioner {
     const boost::shared_ptr<Model> model = bmodel.clone();
     std::vector<double> targets(n_outputs());
     uint64_t type;
+    ipscale_t buffer;
 
     // Process the valid samples in the range ...
     for (uint64_t ss = srange.first, i = sample2image(samples[ss]), s = m_ipsbegins[i];
         ss < srange.second && i < n_images(); i ++)
     {
-      const ipscale_t& ip = m_ipscales[i];
+      // Skip the images without any selected sample
+      if (samples[ss] >= m_ipsends[i])
+      {
+        s = m_ipsends[i];
+        continue;
+      }
+
+      const ipscale_t& ip = ipscale(i, buffer);
 
       model->preprocess(ip);
 
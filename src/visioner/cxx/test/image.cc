@@ -0,0 +1,125 @@
+/**
+ * @file visioner/cxx/test/image.cc
+ * @date Fri Jul  5 10:21:40 2013 +0200
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Tests the scaling of grayscale images of the Visioner
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Visioner-Image Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/random.hpp>
+#include <stdint.h>
+#include <cstdlib>
+#include <QImage>
+#include <QSize>
+
+#include "bob/visioner/vision/image.h"
+
+static void random_image(uint64_t rows, uint64_t cols, boost::mt19937& rng,
+    bob::visioner::Matrix<uint8_t>& image)
+{
+  boost::uniform_int<> pixel(0, 255);
+  image.resize(rows, cols);
+  for (uint64_t y = 0; y < rows; ++y)
+    for (uint64_t x = 0; x < cols; ++x)
+      image(y, x) = (uint8_t)pixel(rng);
+}
+
+BOOST_AUTO_TEST_SUITE( test_setup )
+
+BOOST_AUTO_TEST_CASE( test_scale_size )
+{
+  // the sizes must match the ones of the previous (Qt-based) implementation
+  const double scales[] = {1.0, 0.97, 0.8, 0.5, 0.33, 0.1, 0.01};
+  const int sizes[][2] = {{453, 604}, {480, 640}, {24, 24}, {101, 37}};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    for (size_t k = 0; k < sizeof(scales) / sizeof(scales[0]); ++k) {
+      const int rows = sizes[s][0], cols = sizes[s][1];
+      const QSize expected = QSize(cols, rows).scaled(
+          (int)(0.5 + scales[k] * cols), (int)(0.5 + scales[k] * rows),
+          Qt::KeepAspectRatio);
+
+      uint64_t new_rows, new_cols;
+      bob::visioner::scale_size(rows, cols, scales[k], new_rows, new_cols);
+      BOOST_CHECK_EQUAL(new_rows, (uint64_t)expected.height());
+      BOOST_CHECK_EQUAL(new_cols, (uint64_t)expected.width());
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_scale_identity )
+{
+  boost::mt19937 rng(0);
+  bob::visioner::Matrix<uint8_t> image, scaled;
+  random_image(31, 47, rng, image);
+
+  BOOST_CHECK(bob::visioner::scale(image, 1.0, scaled));
+  BOOST_REQUIRE_EQUAL(scaled.rows(), image.rows());
+  BOOST_REQUIRE_EQUAL(scaled.cols(), image.cols());
+  for (uint64_t y = 0; y < image.rows(); ++y)
+    for (uint64_t x = 0; x < image.cols(); ++x)
+      BOOST_CHECK_EQUAL(scaled(y, x), image(y, x));
+}
+
+BOOST_AUTO_TEST_CASE( test_scale_half )
+{
+  // each output pixel is the (rounded) average of a 2x2 block
+  boost::mt19937 rng(1);
+  bob::visioner::Matrix<uint8_t> image, scaled;
+  random_image(32, 48, rng, image);
+
+  BOOST_CHECK(bob::visioner::scale(image, 0.5, scaled));
+  BOOST_REQUIRE_EQUAL(scaled.rows(), (size_t)16);
+  BOOST_REQUIRE_EQUAL(scaled.cols(), (size_t)24);
+  for (uint64_t y = 0; y < scaled.rows(); ++y)
+    for (uint64_t x = 0; x < scaled.cols(); ++x) {
+      const int sum = image(2 * y, 2 * x) + image(2 * y, 2 * x + 1) +
+        image(2 * y + 1, 2 * x) + image(2 * y + 1, 2 * x + 1);
+      BOOST_CHECK_EQUAL((int)scaled(y, x), (sum + 2) / 4);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_scale_qt )
+{
+  // Qt also averages the covered source pixels when downscaling, but with
+  // fixed-point arithmetic, so the pixels may differ by a small rounding
+  // error from the previous implementation
+  boost::mt19937 rng(2);
+  bob::visioner::Matrix<uint8_t> image, scaled, expected;
+  random_image(453, 604, rng, image);
+
+  const double scales[] = {0.9, 0.63, 0.5, 0.27};
+  for (size_t k = 0; k < sizeof(scales) / sizeof(scales[0]); ++k) {
+    BOOST_CHECK(bob::visioner::scale(image, scales[k], scaled));
+
+    const QImage qimage = bob::visioner::convert(image).scaled(
+        (int)(0.5 + scales[k] * image.cols()),
+        (int)(0.5 + scales[k] * image.rows()),
+        Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    BOOST_REQUIRE(bob::visioner::convert(qimage, expected));
+
+    BOOST_REQUIRE_EQUAL(scaled.rows(), expected.rows());
+    BOOST_REQUIRE_EQUAL(scaled.cols(), expected.cols());
+    for (uint64_t y = 0; y < expected.rows(); ++y)
+      for (uint64_t x = 0; x < expected.cols(); ++x)
+        BOOST_CHECK_LE(std::abs((int)scaled(y, x) - (int)expected(y, x)), 2);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
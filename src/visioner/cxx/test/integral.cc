@@ -0,0 +1,84 @@
+/**
+ * @file visioner/cxx/test/integral.cc
+ * @date Fri Jul  5 10:21:40 2013 +0200
+ * @author Andre Anjos <andre.anjos@idiap.ch>
+ *
+ * @brief Compares the grayscale (SSE2) integral image of the Visioner with
+ * the generic template implementation
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Visioner-Integral Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/random.hpp>
+#include <stdint.h>
+
+#include "bob/visioner/vision/integral.h"
+
+static void random_image(uint64_t rows, uint64_t cols, boost::mt19937& rng,
+    bob::visioner::Matrix<uint8_t>& image)
+{
+  boost::uniform_int<> pixel(0, 255);
+  image.resize(rows, cols);
+  for (uint64_t y = 0; y < rows; ++y)
+    for (uint64_t x = 0; x < cols; ++x)
+      image(y, x) = (uint8_t)pixel(rng);
+}
+
+static void check_integral(const bob::visioner::Matrix<uint8_t>& image)
+{
+  bob::visioner::Matrix<uint32_t> reference, result;
+  bob::visioner::integral<uint8_t, uint32_t>(image, reference);
+  bob::visioner::integral(image, result);
+
+  BOOST_REQUIRE_EQUAL(result.rows(), reference.rows());
+  BOOST_REQUIRE_EQUAL(result.cols(), reference.cols());
+  for (uint64_t y = 0; y < reference.rows(); ++y)
+    for (uint64_t x = 0; x < reference.cols(); ++x)
+      BOOST_CHECK_EQUAL(result(y, x), reference(y, x));
+}
+
+BOOST_AUTO_TEST_SUITE( test_setup )
+
+BOOST_AUTO_TEST_CASE( test_integral_widths )
+{
+  // widths that are and are not a multiple of the 4 pixels processed at once
+  boost::mt19937 rng(0);
+  bob::visioner::Matrix<uint8_t> image;
+  for (uint64_t cols = 2; cols < 20; ++cols) {
+    random_image(7, cols, rng, image);
+    check_integral(image);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_integral_saturated )
+{
+  // the largest sums an image of this size can have
+  bob::visioner::Matrix<uint8_t> image(480, 641, 255);
+  check_integral(image);
+}
+
+BOOST_AUTO_TEST_CASE( test_integral_image )
+{
+  boost::mt19937 rng(1);
+  bob::visioner::Matrix<uint8_t> image;
+  random_image(453, 604, rng, image);
+  check_integral(image);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -147,6 +147,33 @@ static void sampler_load(bob::visioner::Sampler& s, boost::python::object images
   s.load(i, g);
 }
 
+static boost::python::list sampler_sample(const bob::visioner::Sampler& s,
+    uint64_t n_samples, size_t threads) {
+  std::vector<uint64_t> samples;
+  s.sample(n_samples, samples, threads);
+  boost::python::list retval;
+  BOOST_FOREACH(uint64_t k, samples) retval.append(k);
+  return retval;
+}
+
+static boost::python::tuple sampler_map(const bob::visioner::Sampler& s,
+    boost::python::object samples, const bob::visioner::Model& model,
+    size_t threads) {
+  boost::python::stl_input_iterator<uint64_t> begin(samples), end;
+  std::vector<uint64_t> indices(begin, end);
+  bob::visioner::DataSet data;
+  s.map(indices, model, data, threads);
+  blitz::Array<double,2> targets(data.n_samples(), data.n_outputs());
+  for (uint64_t i = 0; i < data.n_samples(); ++i)
+    for (uint64_t o = 0; o < data.n_outputs(); ++o)
+      targets(i, o) = data.target(i, o);
+  blitz::Array<uint16_t,2> values(data.n_features(), data.n_samples());
+  for (uint64_t f = 0; f < data.n_features(); ++f)
+    for (uint64_t i = 0; i < data.n_samples(); ++i)
+      values(f, i) = data.value(f, i);
+  return boost::python::make_tuple(targets, values);
+}
+
 static boost::shared_ptr<bob::visioner::Sampler> 
 sampler_from_files(const bob::visioner::param_t& param,
     bob::visioner::Sampler::SamplerType type, boost::python::object images,
@@ -207,7 +234,7 @@ void bind_visioner_train() {
     .value("Validation", bob::visioner::Sampler::ValidSampler)
     ;
 
-  boost::python::class_<bob::visioner::Sampler>("Sampler", "Object used for sampling uniformly, such that the same number of samples are obtained for distinct target values.", boost::python::init<bob::visioner::param_t, bob::visioner::Sampler::SamplerType, boost::python::optional<size_t> >((boost::python::arg("param"), boost::python::arg("type"), boost::python::arg("max_threads")=0), "Default constructor with parameters and the type of sampler this sampler will be. Set the maximum number of threads to zero if you want the job to be executed in the current thread, or to 1 or more if you would like to have more threads spawn. At this point, this parameter will only create as many random number generators as you specify (with a minimum of 1, if you set 0 there)."))
+  boost::python::class_<bob::visioner::Sampler>("Sampler", "Object used for sampling uniformly, such that the same number of samples are obtained for distinct target values.", boost::python::init<bob::visioner::param_t, bob::visioner::Sampler::SamplerType, boost::python::optional<size_t, bool> >((boost::python::arg("param"), boost::python::arg("type"), boost::python::arg("max_threads")=0, boost::python::arg("compact")=false), "Default constructor with parameters and the type of sampler this sampler will be. Set the maximum number of threads to zero if you want the job to be executed in the current thread, or to 1 or more if you would like to have more threads spawn. The images are loaded with this number of threads. If compact is set, only the original images are kept in memory and their scaled versions are re-built when required."))
     .def("__init__", make_constructor(&sampler_from_files, boost::python::default_call_policies(), (boost::python::arg("param"), boost::python::arg("type"), boost::python::arg("images"), boost::python::arg("ground_thruth"))), "Constructs a new (single-threaded) sampler with parameters, a type and a list of images and (associated) ground-thruth information. Note that if you specify the list of images and ground-thruth inside the parameters object, that list will be read, but discarded in favor of the discrete list provided with the two input parameters.")
     .def("__init__", make_constructor(&sampler_from_files_2, boost::python::default_call_policies(), (boost::python::arg("param"), boost::python::arg("type"), boost::python::arg("images"), boost::python::arg("ground_thruth"), boost::python::arg("max_threads"))), "Constructs a new (multi-threaded) sampler with parameters, a type and a list of images and (associated) ground-thruth information. Note that if you specify the list of images and ground-thruth inside the parameters object, that list will be read, but discarded in favor of the discrete list provided with the two input parameters.")
     .add_property("num_of_images", &bob::visioner::Sampler::n_images)
@@ -215,7 +242,10 @@ void bind_visioner_train() {
     .add_property("num_of_outputs", &bob::visioner::Sampler::n_outputs)
     .add_property("num_of_types", &bob::visioner::Sampler::n_types)
     .add_property("type", &bob::visioner::Sampler::getType, "This sampler's type")
+    .add_property("compact", &bob::visioner::Sampler::compact, "If only the original images are kept in memory")
     .def("load", &sampler_load, (boost::python::arg("self"), boost::python::arg("images"), boost::python::arg("ground_thruth")), "Resets the current contents of this sampler to use the image and (matching) ground-thruth files given. This method input lists or python iterables with the absolute or relative path of images and ground-thruth files you need to load.")
+    .def("sample", &sampler_sample, (boost::python::arg("self"), boost::python::arg("num_of_samples"), boost::python::arg("threads")=0), "Selects about num_of_samples samples uniformly over the target types and returns their indices, in increasing order. The selection only depends on the seed and on the number of previous calls, not on the number of threads (0 to run in the current thread, or at most the maximum number of threads given at construction).")
+    .def("map", &sampler_map, (boost::python::arg("self"), boost::python::arg("samples"), boost::python::arg("model"), boost::python::arg("threads")=0), "Maps the given samples to the features of the given model and returns the tuple (targets, values), where targets has one row of target values per sample and values has one row of feature values per feature. The result does not depend on the number of threads.")
     ;
 
   boost::python::class_<bob::visioner::Model, boost::shared_ptr<bob::visioner::Model>, boost::noncopyable>("Model", "Multivariate model as a linear combination of LUTs. NB: The ::preprocess() must be called before ::get() and ::score() functions.", boost::python::no_init)